@@ -1,5 +1,7 @@
 
 #include "application.hpp"
+#include "counters.hpp"
+#include "metrics.hpp"
 #include "window.hpp"
 
 #include "common/assert_verify.hpp"
@@ -9,16 +11,58 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_config.h>
 
+#include <algorithm>
 #include <chrono>
 #include <thread>
 
 namespace retail
 {
 
-Application::Application()
+namespace
+{
+bool isInputEvent( const SDL_Event& ev )
+{
+    switch ( ev.type )
+    {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+        case SDL_TEXTINPUT:
+        case SDL_MOUSEMOTION:
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+        case SDL_MOUSEWHEEL:
+        case SDL_JOYAXISMOTION:
+        case SDL_JOYBALLMOTION:
+        case SDL_JOYHATMOTION:
+        case SDL_JOYBUTTONDOWN:
+        case SDL_JOYBUTTONUP:
+        case SDL_CONTROLLERAXISMOTION:
+        case SDL_CONTROLLERBUTTONDOWN:
+        case SDL_CONTROLLERBUTTONUP:
+        case SDL_FINGERDOWN:
+        case SDL_FINGERUP:
+        case SDL_FINGERMOTION:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// SDL stamps events in milliseconds of SDL_GetTicks when they are queued
+std::chrono::steady_clock::time_point toSteadyClock( std::uint32_t uiTimestamp )
+{
+    return std::chrono::steady_clock::now() - std::chrono::milliseconds( SDL_GetTicks() - uiTimestamp );
+}
+} // namespace
+
+Application::Application( const Config& config )
     : m_bContinue( true )
-    , m_mainWindow( Window::Config{} )
+    , m_bReplayRealTime( config.bReplayRealTime )
+    , m_hitchRecorder( config.hitch )
 {
+    VERIFY_RTE_MSG( config.recordInput.empty() || config.replayInput.empty(),
+                    "Cannot record and replay input at the same time" );
+
     const int iInitResult = SDL_Init( SDL_INIT_VIDEO ); // Initialize SDL2
     if ( iInitResult )
     {
@@ -33,27 +77,178 @@ Application::Application()
     SDL_SetHint( SDL_HINT_RENDER_SCALE_QUALITY, "1" );
 
     atexit( SDL_Quit );
+
+    VERIFY_RTE_MSG( !config.windows.empty(), "Application requires at least one window" );
+    const int iNumDisplays = std::max( SDL_GetNumVideoDisplays(), 1 );
+    for ( Window::Config windowConfig : config.windows )
+    {
+        // wrap the display index so a config written for a larger installation still runs
+        windowConfig.iDisplay = windowConfig.iDisplay % iNumDisplays;
+        m_windows.emplace_back( std::make_unique< Window >( windowConfig ) );
+        SPDLOG_INFO( "Created window: {} on display: {} with id: {}",
+                     windowConfig.strName,
+                     windowConfig.iDisplay,
+                     m_windows.back()->getID() );
+    }
+
+    // window ids are assigned in creation order so a log is only valid for the same window count
+    const std::uint32_t uiWindowCount = static_cast< std::uint32_t >( m_windows.size() );
+    if ( !config.recordInput.empty() )
+    {
+        m_pInputRecorder = std::make_unique< InputRecorder >( config.recordInput, uiWindowCount );
+    }
+    if ( !config.replayInput.empty() )
+    {
+        m_pInputReplay = std::make_unique< InputReplay >( config.replayInput, uiWindowCount );
+    }
+    if ( !config.metricsEndpoint.empty() )
+    {
+        m_pMetricsServer = std::make_unique< MetricsServer >( config.metricsEndpoint );
+    }
 }
 
 Application::~Application() {}
 
+Window* Application::findWindow( std::uint32_t uiWindowID ) const
+{
+    for ( const WindowPtr& pWindow : m_windows )
+    {
+        if ( pWindow->getID() == uiWindowID )
+            return pWindow.get();
+    }
+    return nullptr;
+}
+
+std::optional< std::chrono::steady_clock::time_point > Application::consumeInput()
+{
+    std::optional< std::chrono::steady_clock::time_point > oldestInput;
+    oldestInput.swap( m_oldestInput );
+    return oldestInput;
+}
+
 void Application::run()
 {
-    std::uint32_t uiFrame = 0U;
+    m_startTime = std::chrono::steady_clock::now();
+    std::optional< std::chrono::steady_clock::time_point > lastFrameStart;
     while ( m_bContinue )
     {
+        m_hitchRecorder.beginFrame();
+        {
+            const std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+            if ( lastFrameStart )
+                observe( Histogram::eFrameInterval,
+                         std::chrono::duration_cast< std::chrono::microseconds >( frameStart - *lastFrameStart ) );
+            lastFrameStart = frameStart;
+        }
+
+        // a replay paces frames by the recorded frame times unless running back to back
+        if ( m_pInputReplay )
+        {
+            if ( m_pInputReplay->isFinished() )
+            {
+                logReplayResults();
+                break;
+            }
+            m_frameTime = m_pInputReplay->getFrameTime();
+            if ( m_bReplayRealTime )
+            {
+                std::this_thread::sleep_until( m_startTime + m_frameTime );
+            }
+            m_hitchRecorder.mark( HitchRecorder::Stage::eSleep );
+        }
+        else
+        {
+            m_frameTime = std::chrono::duration_cast< std::chrono::microseconds >(
+                std::chrono::steady_clock::now() - m_startTime );
+        }
+        if ( m_pInputRecorder )
+        {
+            m_pInputRecorder->beginFrame( m_uiFrame, m_frameTime );
+        }
+        const std::chrono::steady_clock::time_point workStart = std::chrono::steady_clock::now();
+
         frame();
+        m_hitchRecorder.mark( HitchRecorder::Stage::eFrame );
 
-        SDL_Event ev;
+        // events polled after a frame are recorded against it and replayed after the same frame
+        SDL_Event     ev;
+        std::uint64_t uiEvents = 0U;
         while ( SDL_PollEvent( &ev ) )
         {
-            onSDLEvent( ev );
+            if ( m_pInputRecorder )
+            {
+                m_pInputRecorder->record( ev );
+            }
+            // live input would make the replay diverge - window and quit events still apply
+            if ( m_pInputReplay && isInputEvent( ev ) )
+                continue;
+            handleEvent( ev );
+            ++uiEvents;
+        }
+        if ( m_pInputReplay )
+        {
+            // recorded window events described the recording session's windows so only input is injected
+            for ( const SDL_Event& recorded : m_pInputReplay->nextFrame() )
+            {
+                if ( isInputEvent( recorded ) )
+                {
+                    handleEvent( recorded );
+                    ++uiEvents;
+                }
+            }
+        }
+        if ( m_pInputRecorder )
+        {
+            m_pInputRecorder->endFrame();
+        }
+        count( Counter::eEvents, uiEvents );
+        m_hitchRecorder.mark( HitchRecorder::Stage::eEvents );
+
+        if ( m_pInputReplay )
+        {
+            m_replayFrameTimes.add( std::chrono::duration_cast< std::chrono::microseconds >(
+                std::chrono::steady_clock::now() - workStart ) );
+        }
+        else
+        {
+            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+            m_hitchRecorder.mark( HitchRecorder::Stage::eSleep );
         }
 
-        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        ++m_uiFrame;
+        m_hitchRecorder.endFrame();
     }
 }
 
+void Application::handleEvent( const SDL_Event& ev )
+{
+    if ( !m_oldestInput && isInputEvent( ev ) )
+    {
+        m_oldestInput = toSteadyClock( ev.common.timestamp );
+    }
+    onSDLEvent( ev );
+}
+
+void Application::logReplayResults() const
+{
+    const double fSeconds
+        = std::chrono::duration< double >( std::chrono::steady_clock::now() - m_startTime ).count();
+    const double fMeanMS = m_replayFrameTimes.getCount()
+                               ? static_cast< double >( m_replayFrameTimes.getSumUS() )
+                                     / static_cast< double >( m_replayFrameTimes.getCount() ) / 1000.0
+                               : 0.0;
+    SPDLOG_INFO( "Replay {} finished: {} frames in {:.3f}s frame time mean: {:.3f}ms p50: {}us p90: {}us p99: {}us "
+                 "max: {}us",
+                 m_bReplayRealTime ? "in real time" : "back to back",
+                 m_replayFrameTimes.getCount(),
+                 fSeconds,
+                 fMeanMS,
+                 m_replayFrameTimes.getPercentileUS( 50.0f ),
+                 m_replayFrameTimes.getPercentileUS( 90.0f ),
+                 m_replayFrameTimes.getPercentileUS( 99.0f ),
+                 m_replayFrameTimes.getMaxUS() );
+}
+
 void Application::onSDLEvent( const SDL_Event& ev )
 {
     switch ( ev.type )
@@ -91,7 +286,7 @@ void Application::onSDLEvent( const SDL_Event& ev )
         // Window events
         case SDL_WINDOWEVENT: //< Window event data
         {
-            // if( Window* pWindow = findWindow( ev.window.windowID ) )
+            if ( Window* pWindow = findWindow( ev.window.windowID ) )
             {
                 switch ( ev.window.event )
                 {
@@ -109,7 +304,8 @@ void Application::onSDLEvent( const SDL_Event& ev )
                         // event->window.data1,event->window.data2);
                         break;
                     case SDL_WINDOWEVENT_RESIZED:
-                        // pWindow->on_resized( ev.window.data1, ev.window.data2 );
+                        // SDL_Log("Window %d resized to %dx%d", event->window.windowID,
+                        // event->window.data1, event->window.data2);
                         break;
                     case SDL_WINDOWEVENT_MINIMIZED:
                         // SDL_Log("Window %d minimized", event->window.windowID);
@@ -133,7 +329,11 @@ void Application::onSDLEvent( const SDL_Event& ev )
                         // SDL_Log("Window %d lost keyboard focus", event->window.windowID);
                         break;
                     case SDL_WINDOWEVENT_CLOSE:
-                        // SDL_Log("Window %d closed", event->window.windowID);
+                        // closing any window ends the run like SDL_QUIT.  The swapchains and everything
+                        // rendered per window - post chain targets, light clusters, occlusion culling
+                        // draws and queries - are sized for the window count at startup, and a hidden
+                        // window left presenting can block in FIFO mode, so one can't drop out alone
+                        SPDLOG_INFO( "Window {} closed", pWindow->getID() );
                         m_bContinue = false;
                         break;
                     default:
@@ -148,9 +348,9 @@ void Application::onSDLEvent( const SDL_Event& ev )
             break;
         case SDL_KEYDOWN: //< Key pressed
         case SDL_KEYUP:   //< Key released
-            // if( Window* pWindow = findWindow( ev.key.windowID ) )
+            if ( ev.type == SDL_KEYDOWN && !ev.key.repeat )
             {
-                // pWindow->on_event( ev );
+                onKey( ev.key );
             }
             break; //< Keyboard event data
 
@@ -165,23 +365,11 @@ void Application::onSDLEvent( const SDL_Event& ev )
 
         // Mouse events
         case SDL_MOUSEMOTION: // Mouse moved
-            // if( Window* pWindow = findWindow( ev.motion.windowID ) )
-            //{
-            //     pWindow->on_event( ev );
-            // }
             break;
         case SDL_MOUSEBUTTONDOWN: //< Mouse button pressed
         case SDL_MOUSEBUTTONUP:   //< Mouse button released
-            // if( Window* pWindow = findWindow( ev.button.windowID ) )
-            //{
-            //     pWindow->on_event( ev );
-            // }
             break;
         case SDL_MOUSEWHEEL: //< Mouse wheel motion
-            // if( Window* pWindow = findWindow( ev.wheel.windowID ) )
-            //{
-            //     pWindow->on_event( ev );
-            // }
             break;
 
         // Joystick events
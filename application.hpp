@@ -3,14 +3,36 @@
 
 #include "SDL2/SDL_events.h"
 
+#include "histogram.hpp"
+#include "hitch_recorder.hpp"
+#include "input_log.hpp"
+#include "metrics_server.hpp"
 #include "window.hpp"
 
+#include <boost/filesystem/path.hpp>
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
 namespace retail
 {
     class Application
     {
     public:
-        Application();
+        struct Config
+        {
+            std::vector< Window::Config > windows = { Window::Config{} };
+            HitchRecorder::Config         hitch;
+            boost::filesystem::path       recordInput; // input log written when set
+            boost::filesystem::path       replayInput; // input log replayed instead of live input when set
+            bool                          bReplayRealTime = true; // else replay frames back to back
+            std::string                   metricsEndpoint; // localhost port or unix socket path - none when empty
+        };
+
+        Application( const Config& config );
         ~Application();
 
         virtual void frame() = 0;
@@ -18,11 +40,42 @@ namespace retail
         void run();
 
     private:
+        void handleEvent( const SDL_Event& ev );
         void onSDLEvent( const SDL_Event& ev );
+        void logReplayResults() const;
 
-        bool m_bContinue;
+        bool                                                   m_bContinue;
+        std::optional< std::chrono::steady_clock::time_point > m_oldestInput;
+        std::chrono::steady_clock::time_point                  m_startTime;
+        std::chrono::microseconds                              m_frameTime{ 0 };
+        std::uint64_t                                          m_uiFrame = 0U;
+
+        std::unique_ptr< InputRecorder > m_pInputRecorder;
+        std::unique_ptr< InputReplay >   m_pInputReplay;
+        std::unique_ptr< MetricsServer > m_pMetricsServer;
+        const bool                       m_bReplayRealTime;
+        LatencyHistogram                 m_replayFrameTimes; // frame and event handling excluding pacing
     protected:
-        Window m_mainWindow;
+        using WindowPtr    = std::unique_ptr< Window >;
+        using WindowVector = std::vector< WindowPtr >;
+
+        Window* findWindow( std::uint32_t uiWindowID ) const;
+
+        // a key pressed in any window - live or replayed - ignoring auto repeat
+        virtual void onKey( const SDL_KeyboardEvent& ) {}
+
+        // time the oldest input event polled since the previous call was raised - empty without input
+        std::optional< std::chrono::steady_clock::time_point > consumeInput();
+
+        // seconds since run() started that the current frame animates with - taken from the input
+        // log when replaying so a replay animates exactly as the recording did
+        float getTime() const { return std::chrono::duration< float >( m_frameTime ).count(); }
+
+        // run() returns once the current frame's events are handled
+        void quit() { m_bContinue = false; }
+
+        WindowVector  m_windows;
+        HitchRecorder m_hitchRecorder;
     };
 
 }
@@ -0,0 +1,374 @@
+#include "asset_pack.hpp"
+#include "hash.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace retail
+{
+namespace pack
+{
+namespace
+{
+constexpr std::size_t   kMinMatch  = 4U;
+constexpr std::size_t   kMaxOffset = 65535U;
+constexpr std::uint32_t kHashBits  = 14U;
+constexpr std::uint32_t kNoMatch   = std::numeric_limits< std::uint32_t >::max();
+
+std::uint64_t alignUp( std::uint64_t uiValue, std::uint64_t uiAlignment )
+{
+    return ( uiValue + uiAlignment - 1U ) & ~( uiAlignment - 1U );
+}
+
+bool isPowerOfTwo( std::uint64_t uiValue )
+{
+    return uiValue != 0U && ( uiValue & ( uiValue - 1U ) ) == 0U;
+}
+
+void pad( std::ofstream& os, std::uint64_t uiTo )
+{
+    static const char zeros[ kDefaultAlignment ] = {};
+    std::uint64_t     uiPos                      = static_cast< std::uint64_t >( os.tellp() );
+    VERIFY_RTE( uiPos <= uiTo );
+    while ( uiPos != uiTo )
+    {
+        const std::uint64_t uiCount = std::min< std::uint64_t >( uiTo - uiPos, kDefaultAlignment );
+        os.write( zeros, static_cast< std::streamsize >( uiCount ) );
+        uiPos += uiCount;
+    }
+}
+
+std::uint32_t read32( const std::uint8_t* p )
+{
+    std::uint32_t uiValue;
+    std::memcpy( &uiValue, p, sizeof( uiValue ) );
+    return uiValue;
+}
+
+std::uint32_t hashSequence( std::uint32_t uiSequence )
+{
+    return ( uiSequence * 2654435761U ) >> ( 32U - kHashBits );
+}
+
+// lengths of 15 or more continue in bytes of 255 ended by one below 255
+void writeLength( std::vector< std::uint8_t >& output, std::size_t szLength )
+{
+    for ( ; szLength >= 255U; szLength -= 255U )
+        output.push_back( 255U );
+    output.push_back( static_cast< std::uint8_t >( szLength ) );
+}
+
+void writeSequence( std::vector< std::uint8_t >& output,
+                    const std::uint8_t*          pLiterals,
+                    std::size_t                  szLiterals,
+                    std::size_t                  szMatch, // zero for the last sequence
+                    std::size_t                  szOffset )
+{
+    const std::size_t szMatchCode = szMatch ? szMatch - kMinMatch : 0U;
+    output.push_back(
+        static_cast< std::uint8_t >( ( std::min< std::size_t >( szLiterals, 15U ) << 4U )
+                                     | std::min< std::size_t >( szMatchCode, 15U ) ) );
+    if ( szLiterals >= 15U )
+        writeLength( output, szLiterals - 15U );
+    output.insert( output.end(), pLiterals, pLiterals + szLiterals );
+    if ( szMatch )
+    {
+        output.push_back( static_cast< std::uint8_t >( szOffset & 0xFFU ) );
+        output.push_back( static_cast< std::uint8_t >( szOffset >> 8U ) );
+        if ( szMatchCode >= 15U )
+            writeLength( output, szMatchCode - 15U );
+    }
+}
+
+bool readLength( const std::uint8_t*& pSource, const std::uint8_t* pSourceEnd, std::size_t& szLength )
+{
+    std::uint8_t uiByte;
+    do
+    {
+        if ( pSource == pSourceEnd )
+            return false;
+        uiByte = *pSource++;
+        szLength += uiByte;
+    } while ( uiByte == 255U );
+    return true;
+}
+} // namespace
+
+std::vector< std::uint8_t > compressLz( const std::uint8_t* pSource, std::size_t szSize )
+{
+    // positions are held in 32 bits
+    VERIFY_RTE( szSize < kNoMatch );
+
+    std::vector< std::uint8_t > output;
+    output.reserve( szSize / 2U + 16U );
+
+    // greedy - the most recent position with the same four byte hash is the only candidate
+    std::vector< std::uint32_t > table( std::size_t( 1U ) << kHashBits, kNoMatch );
+    std::size_t                  szAnchor = 0U, szPos = 0U;
+    while ( szPos + kMinMatch <= szSize )
+    {
+        const std::uint32_t uiSequence  = read32( pSource + szPos );
+        std::uint32_t&      uiCandidate = table[ hashSequence( uiSequence ) ];
+        const std::size_t   szCandidate = uiCandidate;
+        uiCandidate                     = static_cast< std::uint32_t >( szPos );
+
+        if ( szCandidate == kNoMatch || szPos - szCandidate > kMaxOffset
+             || read32( pSource + szCandidate ) != uiSequence )
+        {
+            ++szPos;
+            continue;
+        }
+
+        std::size_t szMatch = kMinMatch;
+        while ( szPos + szMatch < szSize && pSource[ szCandidate + szMatch ] == pSource[ szPos + szMatch ] )
+            ++szMatch;
+        writeSequence( output, pSource + szAnchor, szPos - szAnchor, szMatch, szPos - szCandidate );
+        szPos += szMatch;
+        szAnchor = szPos;
+    }
+    writeSequence( output, pSource + szAnchor, szSize - szAnchor, 0U, 0U );
+    return output;
+}
+
+bool decompressLz( const std::uint8_t* pSource,
+                   std::size_t         szSourceSize,
+                   std::uint8_t*       pDestination,
+                   std::size_t         szDestinationSize )
+{
+    const std::uint8_t* pSourceEnd      = pSource + szSourceSize;
+    std::uint8_t*       pOutput         = pDestination;
+    std::uint8_t* const pDestinationEnd = pDestination + szDestinationSize;
+
+    while ( pSource != pSourceEnd )
+    {
+        const std::uint8_t uiToken    = *pSource++;
+        std::size_t        szLiterals = uiToken >> 4U;
+        if ( szLiterals == 15U && !readLength( pSource, pSourceEnd, szLiterals ) )
+            return false;
+        if ( szLiterals > static_cast< std::size_t >( pSourceEnd - pSource )
+             || szLiterals > static_cast< std::size_t >( pDestinationEnd - pOutput ) )
+            return false;
+        std::memcpy( pOutput, pSource, szLiterals );
+        pSource += szLiterals;
+        pOutput += szLiterals;
+
+        // the last sequence ends with its literals
+        if ( pSource == pSourceEnd )
+            break;
+
+        if ( pSourceEnd - pSource < 2 )
+            return false;
+        const std::size_t szOffset = std::size_t( pSource[ 0 ] ) | ( std::size_t( pSource[ 1 ] ) << 8U );
+        pSource += 2;
+        std::size_t szMatch = uiToken & 15U;
+        if ( szMatch == 15U && !readLength( pSource, pSourceEnd, szMatch ) )
+            return false;
+        szMatch += kMinMatch;
+        if ( szOffset == 0U || szOffset > static_cast< std::size_t >( pOutput - pDestination )
+             || szMatch > static_cast< std::size_t >( pDestinationEnd - pOutput ) )
+            return false;
+
+        // byte by byte as a match may overlap the bytes it produces
+        const std::uint8_t* pMatch = pOutput - szOffset;
+        for ( std::size_t i = 0; i != szMatch; ++i )
+            pOutput[ i ] = pMatch[ i ];
+        pOutput += szMatch;
+    }
+    return pOutput == pDestinationEnd;
+}
+
+void writeAssetPack( const boost::filesystem::path& filePath, const std::vector< EntryData >& entries )
+{
+    // sort by name hash so the reader can binary search
+    std::vector< const EntryData* > sorted;
+    for ( const EntryData& entryData : entries )
+        sorted.push_back( &entryData );
+    std::sort( sorted.begin(), sorted.end(),
+               []( const EntryData* pLeft, const EntryData* pRight )
+               { return fnv1a64( pLeft->strName ) < fnv1a64( pRight->strName ); } );
+
+    FileHeader header{};
+    header.uiMagic             = kMagic;
+    header.uiVersion           = kVersion;
+    header.uiEntryCount        = static_cast< std::uint32_t >( sorted.size() );
+    header.uiEntryTableOffset  = sizeof( FileHeader );
+    header.uiStringTableOffset = header.uiEntryTableOffset + sizeof( EntryRecord ) * sorted.size();
+
+    std::string                                strings;
+    std::vector< EntryRecord >                 records;
+    std::vector< std::vector< std::uint8_t > > compressed( sorted.size() );
+    for ( std::size_t i = 0; i != sorted.size(); ++i )
+    {
+        const EntryData* pEntry = sorted[ i ];
+        VERIFY_RTE_MSG( isPowerOfTwo( pEntry->uiAlignment ),
+                        "Alignment is not a power of two for: " << pEntry->strName );
+
+        EntryRecord record{};
+        record.uiNameHash   = fnv1a64( pEntry->strName );
+        record.uiNameOffset = static_cast< std::uint32_t >( strings.size() );
+        record.uiNameLength = static_cast< std::uint32_t >( pEntry->strName.size() );
+        record.uiSize       = pEntry->data.size();
+        record.uiStoredSize = record.uiSize;
+        record.compression  = Compression::eNone;
+        record.uiAlignment  = pEntry->uiAlignment;
+        if ( pEntry->bCompress && !pEntry->data.empty() )
+        {
+            compressed[ i ] = compressLz( pEntry->data.data(), pEntry->data.size() );
+            if ( compressed[ i ].size() < pEntry->data.size() )
+            {
+                record.compression  = Compression::eLz;
+                record.uiStoredSize = compressed[ i ].size();
+            }
+            else
+            {
+                compressed[ i ].clear();
+            }
+        }
+        records.push_back( record );
+        strings += pEntry->strName;
+
+        VERIFY_RTE_MSG( records.size() == 1U || records[ records.size() - 2U ].uiNameHash != record.uiNameHash,
+                        "Duplicate asset name hash for: " << pEntry->strName );
+    }
+    header.uiStringTableSize = strings.size();
+    header.uiPayloadOffset   = alignUp( header.uiStringTableOffset + header.uiStringTableSize, kDefaultAlignment );
+
+    std::uint64_t uiOffset = header.uiPayloadOffset;
+    for ( EntryRecord& record : records )
+    {
+        record.uiOffset = alignUp( uiOffset, record.uiAlignment );
+        uiOffset        = record.uiOffset + record.uiStoredSize;
+    }
+    header.uiPayloadSize = alignUp( uiOffset, kDefaultAlignment ) - header.uiPayloadOffset;
+
+    std::ofstream os( filePath.native().c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+    if ( !os.good() )
+    {
+        THROW_RTE( "Failed to open file: " << filePath.string() );
+    }
+    os.write( reinterpret_cast< const char* >( &header ), sizeof( FileHeader ) );
+    os.write( reinterpret_cast< const char* >( records.data() ),
+              static_cast< std::streamsize >( records.size() * sizeof( EntryRecord ) ) );
+    os.write( strings.data(), static_cast< std::streamsize >( strings.size() ) );
+    for ( std::size_t i = 0; i != records.size(); ++i )
+    {
+        pad( os, records[ i ].uiOffset );
+        const std::vector< std::uint8_t >& stored
+            = records[ i ].compression == Compression::eNone ? sorted[ i ]->data : compressed[ i ];
+        os.write( reinterpret_cast< const char* >( stored.data() ), static_cast< std::streamsize >( stored.size() ) );
+    }
+    pad( os, header.uiPayloadOffset + header.uiPayloadSize );
+    VERIFY_RTE_MSG( os.good(), "Failed writing file: " << filePath.string() );
+}
+
+} // namespace pack
+
+AssetPack::AssetPack( const boost::filesystem::path& filePath )
+    : m_filePath( filePath )
+    , m_file( filePath )
+{
+    const std::uint64_t uiFileSize = m_file.size();
+    VERIFY_RTE_MSG( uiFileSize >= sizeof( pack::FileHeader ), "Asset pack too small: " << filePath.string() );
+
+    m_pHeader = reinterpret_cast< const pack::FileHeader* >( m_file.data() );
+    VERIFY_RTE_MSG( m_pHeader->uiMagic == pack::kMagic, "Not an asset pack: " << filePath.string() );
+    VERIFY_RTE_MSG( m_pHeader->uiVersion == pack::kVersion,
+                    "Unsupported asset pack version: " << m_pHeader->uiVersion << " in: " << filePath.string() );
+
+    const std::uint64_t uiTableSize
+        = sizeof( pack::EntryRecord ) * static_cast< std::uint64_t >( m_pHeader->uiEntryCount );
+    VERIFY_RTE_MSG( m_pHeader->uiEntryTableOffset % alignof( pack::EntryRecord ) == 0U
+                        && m_pHeader->uiEntryTableOffset + uiTableSize <= uiFileSize
+                        && m_pHeader->uiStringTableOffset + m_pHeader->uiStringTableSize <= uiFileSize
+                        && m_pHeader->uiPayloadOffset + m_pHeader->uiPayloadSize <= uiFileSize,
+                    "Corrupt asset pack header: " << filePath.string() );
+
+    m_pEntries = reinterpret_cast< const pack::EntryRecord* >( m_file.data() + m_pHeader->uiEntryTableOffset );
+    m_pStrings = reinterpret_cast< const char* >( m_file.data() + m_pHeader->uiStringTableOffset );
+
+    // only the table is validated - the payload pages are not touched
+    for ( std::uint32_t i = 0; i != m_pHeader->uiEntryCount; ++i )
+    {
+        const pack::EntryRecord& entry = m_pEntries[ i ];
+        VERIFY_RTE_MSG( entry.uiNameOffset + static_cast< std::uint64_t >( entry.uiNameLength )
+                                <= m_pHeader->uiStringTableSize
+                            && pack::isPowerOfTwo( entry.uiAlignment ) && entry.uiOffset % entry.uiAlignment == 0U
+                            && entry.uiOffset + entry.uiStoredSize <= uiFileSize
+                            && ( i == 0U || m_pEntries[ i - 1U ].uiNameHash < entry.uiNameHash )
+                            && ( entry.compression == pack::Compression::eLz
+                                 || ( entry.compression == pack::Compression::eNone
+                                      && entry.uiStoredSize == entry.uiSize ) ),
+                        "Corrupt asset pack entry: " << i << " in: " << filePath.string() );
+    }
+
+    m_decompressed.reserve( m_pHeader->uiEntryCount );
+    for ( std::uint32_t i = 0; i != m_pHeader->uiEntryCount; ++i )
+        m_decompressed.emplace_back( nullptr, &std::free );
+}
+
+const pack::EntryRecord& AssetPack::getEntry( std::uint32_t uiIndex ) const
+{
+    VERIFY_RTE( uiIndex < m_pHeader->uiEntryCount );
+    return m_pEntries[ uiIndex ];
+}
+
+const pack::EntryRecord* AssetPack::findEntry( std::string_view strName ) const
+{
+    const std::uint64_t      uiHash = fnv1a64( strName );
+    const pack::EntryRecord* pEnd   = m_pEntries + m_pHeader->uiEntryCount;
+    const pack::EntryRecord* pFound = std::lower_bound( m_pEntries, pEnd, uiHash,
+                                                        []( const pack::EntryRecord& entry, std::uint64_t uiValue )
+                                                        { return entry.uiNameHash < uiValue; } );
+    if ( pFound != pEnd && pFound->uiNameHash == uiHash && getName( *pFound ) == strName )
+        return pFound;
+    return nullptr;
+}
+
+std::string_view AssetPack::getName( const pack::EntryRecord& entry ) const
+{
+    return std::string_view( m_pStrings + entry.uiNameOffset, entry.uiNameLength );
+}
+
+AssetPack::View AssetPack::get( const pack::EntryRecord& entry ) const
+{
+    const std::size_t szIndex = static_cast< std::size_t >( &entry - m_pEntries );
+    VERIFY_RTE( szIndex < m_pHeader->uiEntryCount );
+
+    if ( entry.compression == pack::Compression::eNone )
+        return View{ m_file.data() + entry.uiOffset, entry.uiSize };
+
+    std::lock_guard< std::mutex > lock( m_mutex );
+    AlignedBuffer&                pBuffer = m_decompressed[ szIndex ];
+    if ( !pBuffer )
+    {
+        // aligned_alloc needs a size that is a multiple of the alignment
+        const std::uint64_t uiAllocation
+            = pack::alignUp( std::max< std::uint64_t >( entry.uiSize, 1U ), entry.uiAlignment );
+        AlignedBuffer pDecompressed(
+            static_cast< std::uint8_t* >( std::aligned_alloc( entry.uiAlignment, uiAllocation ) ), &std::free );
+        VERIFY_RTE_MSG( pDecompressed, "Failed to allocate " << uiAllocation << " bytes for: " << getName( entry ) );
+        VERIFY_RTE_MSG( pack::decompressLz( m_file.data() + entry.uiOffset, entry.uiStoredSize, pDecompressed.get(),
+                                            entry.uiSize ),
+                        "Corrupt asset: " << getName( entry ) << " in: " << m_filePath.string() );
+        pBuffer = std::move( pDecompressed );
+    }
+    return View{ pBuffer.get(), entry.uiSize };
+}
+
+AssetPack::View AssetPack::get( std::string_view strName ) const
+{
+    const pack::EntryRecord* pEntry = findEntry( strName );
+    VERIFY_RTE_MSG( pEntry, "No asset: " << strName << " in: " << m_filePath.string() );
+    return get( *pEntry );
+}
+
+void AssetPack::willNeed( const pack::EntryRecord& entry ) const
+{
+    m_file.willNeed( entry.uiOffset, entry.uiStoredSize );
+}
+
+} // namespace retail
@@ -0,0 +1,135 @@
+#ifndef ASSET_PACK_19_OCTOBER_2022
+#define ASSET_PACK_19_OCTOBER_2022
+
+#include "mapped_file.hpp"
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace retail
+{
+namespace pack
+{
+    // Asset pack layout
+    //
+    // FileHeader
+    // EntryRecord[ uiEntryCount ]  - sorted by uiNameHash
+    // char[ uiStringTableSize ]    - entry names
+    // payload                      - entry data each aligned to its record's uiAlignment
+    //
+    // All offsets are from the start of the file so an uncompressed entry is used directly from the
+    // mapping.
+    static constexpr std::uint32_t kMagic            = 0x4B415052U; // "RPAK"
+    static constexpr std::uint32_t kVersion          = 1U;
+    static constexpr std::uint32_t kDefaultAlignment = 64U;
+
+    enum class Compression : std::uint32_t
+    {
+        eNone = 0,
+        eLz   = 1 // see compressLz
+    };
+
+    struct FileHeader
+    {
+        std::uint32_t uiMagic;
+        std::uint32_t uiVersion;
+        std::uint32_t uiEntryCount;
+        std::uint32_t uiReserved;
+        std::uint64_t uiEntryTableOffset;
+        std::uint64_t uiStringTableOffset;
+        std::uint64_t uiStringTableSize;
+        std::uint64_t uiPayloadOffset;
+        std::uint64_t uiPayloadSize;
+    };
+
+    struct EntryRecord
+    {
+        std::uint64_t uiNameHash;
+        std::uint32_t uiNameOffset;
+        std::uint32_t uiNameLength;
+        std::uint64_t uiOffset;
+        std::uint64_t uiStoredSize; // bytes in the file
+        std::uint64_t uiSize;       // bytes once decompressed
+        Compression   compression;
+        std::uint32_t uiAlignment; // of the stored and decompressed data - a power of two
+    };
+
+    static_assert( std::is_trivially_copyable< FileHeader >::value && sizeof( FileHeader ) == 56U );
+    static_assert( std::is_trivially_copyable< EntryRecord >::value && sizeof( EntryRecord ) == 48U );
+
+    // in memory entry used to write a pack
+    struct EntryData
+    {
+        std::string                 strName;
+        std::vector< std::uint8_t > data;
+        std::uint32_t               uiAlignment = kDefaultAlignment;
+        bool                        bCompress   = false; // stored uncompressed when compression does not help
+    };
+
+    void writeAssetPack( const boost::filesystem::path& filePath, const std::vector< EntryData >& entries );
+
+    // Byte oriented LZ77 in the style of LZ4 - each sequence is a token of literal and match
+    // lengths, the literals, a 16 bit match offset and length extensions.  The last sequence has no
+    // match.  Decompression is a few branches per sequence so it is cheap enough to do on first use.
+    std::vector< std::uint8_t > compressLz( const std::uint8_t* pSource, std::size_t szSize );
+    // false when the stream is corrupt or does not decompress to exactly szDestinationSize bytes
+    bool decompressLz( const std::uint8_t* pSource,
+                       std::size_t         szSourceSize,
+                       std::uint8_t*       pDestination,
+                       std::size_t         szDestinationSize );
+
+} // namespace pack
+
+// Memory mapped pack of named assets.  Opening validates the header and entry table only.
+// Uncompressed entries are views of the mapping and compressed entries are decompressed the first
+// time they are requested and kept for the lifetime of the pack.
+class AssetPack
+{
+public:
+    struct View
+    {
+        const std::uint8_t* pData  = nullptr; // aligned to the entry's uiAlignment
+        std::uint64_t       uiSize = 0U;
+    };
+
+    AssetPack( const boost::filesystem::path& filePath );
+
+    const boost::filesystem::path& getPath() const { return m_filePath; }
+
+    std::uint32_t            getEntryCount() const { return m_pHeader->uiEntryCount; }
+    const pack::EntryRecord& getEntry( std::uint32_t uiIndex ) const;
+    const pack::EntryRecord* findEntry( std::string_view strName ) const;
+    std::string_view         getName( const pack::EntryRecord& entry ) const;
+
+    // thread safe
+    View get( const pack::EntryRecord& entry ) const;
+    // throws when there is no such entry
+    View get( std::string_view strName ) const;
+
+    // start paging in an entry ahead of its use
+    void willNeed( const pack::EntryRecord& entry ) const;
+
+private:
+    using AlignedBuffer = std::unique_ptr< std::uint8_t, decltype( &std::free ) >;
+
+    boost::filesystem::path  m_filePath;
+    MappedFile               m_file;
+    const pack::FileHeader*  m_pHeader  = nullptr;
+    const pack::EntryRecord* m_pEntries = nullptr;
+    const char*              m_pStrings = nullptr;
+
+    mutable std::mutex                   m_mutex;
+    mutable std::vector< AlignedBuffer > m_decompressed; // per entry once requested
+};
+
+} // namespace retail
+
+#endif // ASSET_PACK_19_OCTOBER_2022
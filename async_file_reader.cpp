@@ -0,0 +1,542 @@
+#include "async_file_reader.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace retail
+{
+
+const char* AsyncFileReader::toString( Backend backend )
+{
+    switch ( backend )
+    {
+        case Backend::eIoUring:
+            return "io_uring";
+        case Backend::eThreadPool:
+            return "thread pool";
+    }
+    return "unknown";
+}
+
+AsyncFileReader::AsyncFileReader( Backend preferred, std::uint32_t uiQueueDepth, std::uint32_t uiThreads )
+    : m_backend( preferred )
+    , m_uiQueueDepth( uiQueueDepth )
+{
+    // io_uring rings are limited to 4096 entries on older kernels
+    VERIFY_RTE_MSG( m_uiQueueDepth != 0U && m_uiQueueDepth <= 4096U, "Invalid queue depth: " << m_uiQueueDepth );
+
+    m_slots.resize( m_uiQueueDepth );
+    for ( std::uint32_t i = m_uiQueueDepth; i != 0U; --i )
+        m_freeSlots.push_back( i - 1U );
+    m_submitSlots.reserve( m_uiQueueDepth );
+    m_completions.reserve( m_uiQueueDepth );
+
+    if ( m_backend == Backend::eIoUring && !initRing() )
+        m_backend = Backend::eThreadPool;
+
+    if ( m_backend == Backend::eThreadPool )
+    {
+        VERIFY_RTE( uiThreads != 0U );
+        m_workerCompletions.reserve( m_uiQueueDepth );
+        for ( std::uint32_t i = 0; i != uiThreads; ++i )
+        {
+            m_workers.emplace_back( [ this ]() { workerThread(); } );
+        }
+    }
+}
+
+AsyncFileReader::~AsyncFileReader()
+{
+    // the kernel or a worker may still be writing to the destinations
+    wait();
+
+    if ( !m_workers.empty() )
+    {
+        {
+            std::lock_guard< std::mutex > lock( m_mutex );
+            m_bStop = true;
+        }
+        m_wake.notify_all();
+        for ( std::thread& worker : m_workers )
+        {
+            worker.join();
+        }
+    }
+    destroyRing();
+
+    for ( OpenFile& file : m_files )
+    {
+        if ( file.iFile >= 0 )
+            ::close( file.iFile );
+        if ( file.iDirectFile >= 0 )
+            ::close( file.iDirectFile );
+    }
+}
+
+bool AsyncFileReader::initRing()
+{
+    io_uring_params params;
+    std::memset( &params, 0, sizeof( params ) );
+    const int iRing = static_cast< int >( ::syscall( __NR_io_uring_setup, m_uiQueueDepth, &params ) );
+    if ( iRing < 0 )
+    {
+        SPDLOG_WARN( "io_uring unavailable: {} - reading through the thread pool", strerror( errno ) );
+        return false;
+    }
+    m_ring.iRing = iRing;
+
+    // kernels before 5.6 have neither the probe nor IORING_OP_READ
+    {
+        const std::size_t szProbe = sizeof( io_uring_probe ) + 256U * sizeof( io_uring_probe_op );
+        std::vector< std::uint8_t > probeStorage( szProbe, 0U );
+        io_uring_probe*             pProbe = reinterpret_cast< io_uring_probe* >( probeStorage.data() );
+        const long iProbe = ::syscall( __NR_io_uring_register, iRing, IORING_REGISTER_PROBE, pProbe, 256U );
+        if ( iProbe < 0 || pProbe->last_op < IORING_OP_READ
+             || !( pProbe->ops[ IORING_OP_READ ].flags & IO_URING_OP_SUPPORTED ) )
+        {
+            SPDLOG_WARN( "io_uring lacks IORING_OP_READ - reading through the thread pool" );
+            destroyRing();
+            return false;
+        }
+    }
+
+    m_ring.szSubmitRing   = params.sq_off.array + params.sq_entries * sizeof( std::uint32_t );
+    m_ring.szCompleteRing = params.cq_off.cqes + params.cq_entries * sizeof( io_uring_cqe );
+    const bool bSingleMapping = ( params.features & IORING_FEAT_SINGLE_MMAP ) != 0U;
+    if ( bSingleMapping )
+        m_ring.szSubmitRing = std::max( m_ring.szSubmitRing, m_ring.szCompleteRing );
+
+    auto mapRing = [ iRing ]( std::size_t szSize, off_t offset ) -> void*
+    {
+        void* pMapping
+            = ::mmap( nullptr, szSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, iRing, offset );
+        return pMapping == MAP_FAILED ? nullptr : pMapping;
+    };
+    m_ring.pSubmitRing = mapRing( m_ring.szSubmitRing, IORING_OFF_SQ_RING );
+    if ( !bSingleMapping && m_ring.pSubmitRing )
+        m_ring.pCompleteRing = mapRing( m_ring.szCompleteRing, IORING_OFF_CQ_RING );
+    m_ring.szEntries = params.sq_entries * sizeof( io_uring_sqe );
+    m_ring.pEntries  = mapRing( m_ring.szEntries, IORING_OFF_SQES );
+    if ( !m_ring.pSubmitRing || ( !bSingleMapping && !m_ring.pCompleteRing ) || !m_ring.pEntries )
+    {
+        SPDLOG_WARN( "Failed to map io_uring: {} - reading through the thread pool", strerror( errno ) );
+        destroyRing();
+        return false;
+    }
+
+    std::uint8_t* pSubmit   = static_cast< std::uint8_t* >( m_ring.pSubmitRing );
+    std::uint8_t* pComplete
+        = static_cast< std::uint8_t* >( bSingleMapping ? m_ring.pSubmitRing : m_ring.pCompleteRing );
+    m_ring.pSubmitTail    = reinterpret_cast< std::uint32_t* >( pSubmit + params.sq_off.tail );
+    m_ring.pSubmitArray   = reinterpret_cast< std::uint32_t* >( pSubmit + params.sq_off.array );
+    m_ring.uiSubmitMask   = *reinterpret_cast< const std::uint32_t* >( pSubmit + params.sq_off.ring_mask );
+    m_ring.pCompleteHead  = reinterpret_cast< std::uint32_t* >( pComplete + params.cq_off.head );
+    m_ring.pCompleteTail  = reinterpret_cast< std::uint32_t* >( pComplete + params.cq_off.tail );
+    m_ring.uiCompleteMask = *reinterpret_cast< const std::uint32_t* >( pComplete + params.cq_off.ring_mask );
+    m_ring.pCompletions   = pComplete + params.cq_off.cqes;
+
+    SPDLOG_INFO( "Reading through io_uring with {} submission and {} completion entries",
+                 params.sq_entries,
+                 params.cq_entries );
+    return true;
+}
+
+void AsyncFileReader::destroyRing()
+{
+    if ( m_ring.pEntries )
+        ::munmap( m_ring.pEntries, m_ring.szEntries );
+    if ( m_ring.pCompleteRing )
+        ::munmap( m_ring.pCompleteRing, m_ring.szCompleteRing );
+    if ( m_ring.pSubmitRing )
+        ::munmap( m_ring.pSubmitRing, m_ring.szSubmitRing );
+    if ( m_ring.iRing >= 0 )
+        ::close( m_ring.iRing );
+    m_ring = Ring{};
+}
+
+int AsyncFileReader::enterRing( std::uint32_t uiSubmit, std::uint32_t uiWaitFor )
+{
+    const unsigned int uiFlags = uiWaitFor ? IORING_ENTER_GETEVENTS : 0U;
+    const int          iResult = static_cast< int >(
+        ::syscall( __NR_io_uring_enter, m_ring.iRing, uiSubmit, uiWaitFor, uiFlags, nullptr, 0 ) );
+    if ( iResult < 0 )
+    {
+        // interrupted before doing anything - the caller retries
+        if ( errno == EINTR )
+            return 0;
+        THROW_RTE( "io_uring_enter failed: " << strerror( errno ) );
+    }
+    return iResult;
+}
+
+void AsyncFileReader::submitRing( const std::vector< std::uint32_t >& slots )
+{
+    // only this thread writes the submission tail - the kernel advances the head as it consumes
+    std::uint32_t uiTail = *m_ring.pSubmitTail;
+    for ( std::uint32_t uiSlot : slots )
+    {
+        const Piece&        piece   = m_slots[ uiSlot ];
+        const std::uint32_t uiIndex = uiTail & m_ring.uiSubmitMask;
+        io_uring_sqe&       entry   = static_cast< io_uring_sqe* >( m_ring.pEntries )[ uiIndex ];
+        std::memset( &entry, 0, sizeof( entry ) );
+        entry.opcode    = IORING_OP_READ;
+        entry.fd        = piece.iFile;
+        entry.off       = piece.uiOffset;
+        entry.addr      = reinterpret_cast< std::uint64_t >( piece.pDestination );
+        entry.len       = static_cast< std::uint32_t >( piece.uiSize );
+        entry.user_data = uiSlot;
+        m_ring.pSubmitArray[ uiIndex ] = uiIndex;
+        ++uiTail;
+    }
+    __atomic_store_n( m_ring.pSubmitTail, uiTail, __ATOMIC_RELEASE );
+
+    // in flight pieces never exceed the ring size so the whole batch is always accepted
+    std::uint32_t uiRemaining = static_cast< std::uint32_t >( slots.size() );
+    while ( uiRemaining != 0U )
+    {
+        uiRemaining -= static_cast< std::uint32_t >( enterRing( uiRemaining, 0U ) );
+    }
+}
+
+void AsyncFileReader::harvestRing( bool bWait )
+{
+    std::uint32_t uiHead = *m_ring.pCompleteHead;
+    std::uint32_t uiTail = __atomic_load_n( m_ring.pCompleteTail, __ATOMIC_ACQUIRE );
+    while ( bWait && uiHead == uiTail )
+    {
+        enterRing( 0U, 1U );
+        uiTail = __atomic_load_n( m_ring.pCompleteTail, __ATOMIC_ACQUIRE );
+    }
+
+    const io_uring_cqe* pCompletions = static_cast< const io_uring_cqe* >( m_ring.pCompletions );
+    for ( ; uiHead != uiTail; ++uiHead )
+    {
+        const io_uring_cqe& completion = pCompletions[ uiHead & m_ring.uiCompleteMask ];
+        m_completions.push_back(
+            Completion{ static_cast< std::uint32_t >( completion.user_data ), std::int64_t( completion.res ) } );
+    }
+    __atomic_store_n( m_ring.pCompleteHead, uiHead, __ATOMIC_RELEASE );
+}
+
+void AsyncFileReader::workerThread()
+{
+    std::unique_lock< std::mutex > lock( m_mutex );
+    while ( true )
+    {
+        m_wake.wait( lock, [ this ]() { return m_bStop || !m_work.empty(); } );
+        if ( m_bStop )
+            return;
+
+        const std::uint32_t uiSlot = m_work.front();
+        m_work.pop_front();
+        // the slot is not touched by the owning thread until its completion is harvested
+        const Piece piece = m_slots[ uiSlot ];
+        lock.unlock();
+
+        ssize_t iRead = 0;
+        do
+        {
+            iRead = ::pread( piece.iFile, piece.pDestination, piece.uiSize, static_cast< off_t >( piece.uiOffset ) );
+        } while ( iRead < 0 && errno == EINTR );
+        const std::int64_t iResult = iRead < 0 ? -std::int64_t( errno ) : std::int64_t( iRead );
+
+        lock.lock();
+        m_workerCompletions.push_back( Completion{ uiSlot, iResult } );
+        m_completed.notify_one();
+    }
+}
+
+AsyncFileReader::File AsyncFileReader::open( const boost::filesystem::path& filePath, bool bDirect )
+{
+    OpenFile openFile;
+    openFile.strPath = filePath.string();
+    openFile.iFile   = ::open( filePath.native().c_str(), O_RDONLY | O_CLOEXEC );
+    if ( openFile.iFile < 0 )
+    {
+        THROW_RTE( "Failed to open file: " << openFile.strPath << " Error: " << strerror( errno ) );
+    }
+
+    struct stat fileStat;
+    if ( ::fstat( openFile.iFile, &fileStat ) != 0 )
+    {
+        ::close( openFile.iFile );
+        THROW_RTE( "Failed to stat file: " << openFile.strPath << " Error: " << strerror( errno ) );
+    }
+    openFile.uiSize = static_cast< std::uint64_t >( fileStat.st_size );
+
+    // file systems such as tmpfs refuse O_DIRECT - every read of the file is then buffered
+    if ( bDirect )
+        openFile.iDirectFile = ::open( filePath.native().c_str(), O_RDONLY | O_CLOEXEC | O_DIRECT );
+
+    File file;
+    if ( m_freeFiles.empty() )
+    {
+        file = static_cast< File >( m_files.size() );
+        m_files.emplace_back( std::move( openFile ) );
+    }
+    else
+    {
+        file = m_freeFiles.back();
+        m_freeFiles.pop_back();
+        m_files[ file ] = std::move( openFile );
+    }
+    return file;
+}
+
+std::uint64_t AsyncFileReader::getFileSize( File file ) const
+{
+    VERIFY_RTE( file < m_files.size() && m_files[ file ].iFile >= 0 );
+    return m_files[ file ].uiSize;
+}
+
+void AsyncFileReader::close( File file )
+{
+    VERIFY_RTE( file < m_files.size() && m_files[ file ].iFile >= 0 );
+    OpenFile& openFile = m_files[ file ];
+    ::close( openFile.iFile );
+    if ( openFile.iDirectFile >= 0 )
+        ::close( openFile.iDirectFile );
+    openFile = OpenFile{};
+    m_freeFiles.push_back( file );
+}
+
+void AsyncFileReader::read( File          file,
+                            std::uint64_t uiOffset,
+                            std::uint64_t uiSize,
+                            void*         pDestination,
+                            Callback&&    fnCallback )
+{
+    VERIFY_RTE( file < m_files.size() && m_files[ file ].iFile >= 0 );
+    const OpenFile& openFile = m_files[ file ];
+    VERIFY_RTE_MSG( uiSize != 0U && uiOffset + uiSize <= openFile.uiSize,
+                    "Invalid read of " << uiSize << " bytes at " << uiOffset << " from: " << openFile.strPath );
+
+    std::uint32_t uiRequest;
+    if ( m_freeRequests.empty() )
+    {
+        uiRequest = static_cast< std::uint32_t >( m_requests.size() );
+        m_requests.emplace_back();
+    }
+    else
+    {
+        uiRequest = m_freeRequests.back();
+        m_freeRequests.pop_back();
+    }
+    Request& request   = m_requests[ uiRequest ];
+    request.fnCallback = std::move( fnCallback );
+    request.uiSize     = uiSize;
+    request.uiPieces   = 0U;
+    request.iError     = 0;
+    ++m_uiOutstanding;
+
+    // O_DIRECT needs the file offset, destination and length aligned so only the whole pages in the
+    // middle of a read qualify and only when the destination sits at the same offset within a page
+    std::uint8_t*       pBytes        = static_cast< std::uint8_t* >( pDestination );
+    const std::uint64_t uiEnd         = uiOffset + uiSize;
+    std::uint64_t       uiDirectBegin = uiOffset, uiDirectEnd = uiOffset;
+    if ( openFile.iDirectFile >= 0
+         && ( reinterpret_cast< std::uintptr_t >( pBytes ) - uiOffset ) % kDirectAlignment == 0U )
+    {
+        const std::uint64_t uiFirstPage = ( uiOffset + kDirectAlignment - 1U ) & ~( kDirectAlignment - 1U );
+        const std::uint64_t uiLastPage  = uiEnd & ~( kDirectAlignment - 1U );
+        if ( uiFirstPage < uiLastPage )
+        {
+            uiDirectBegin = uiFirstPage;
+            uiDirectEnd   = uiLastPage;
+        }
+    }
+
+    auto split = [ & ]( std::uint64_t uiBegin, std::uint64_t uiRangeEnd, bool bDirect )
+    {
+        for ( std::uint64_t uiPiece = uiBegin; uiPiece < uiRangeEnd; uiPiece += kMaxPieceSize )
+        {
+            queuePiece( Piece{ uiRequest,
+                               file,
+                               bDirect,
+                               -1,
+                               uiPiece,
+                               std::min( kMaxPieceSize, uiRangeEnd - uiPiece ),
+                               pBytes + ( uiPiece - uiOffset ) } );
+        }
+    };
+    split( uiOffset, uiDirectBegin, false );
+    split( uiDirectBegin, uiDirectEnd, true );
+    split( uiDirectEnd, uiEnd, false );
+}
+
+void AsyncFileReader::queuePiece( const Piece& piece )
+{
+    ++m_requests[ piece.uiRequest ].uiPieces;
+    m_queued.push_back( piece );
+}
+
+void AsyncFileReader::submit()
+{
+    m_submitSlots.clear();
+    while ( !m_queued.empty() && !m_freeSlots.empty() )
+    {
+        const std::uint32_t uiSlot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        Piece& piece = m_slots[ uiSlot ];
+        piece        = m_queued.front();
+        m_queued.pop_front();
+        piece.iFile = piece.bDirect ? m_files[ piece.file ].iDirectFile : m_files[ piece.file ].iFile;
+        m_submitSlots.push_back( uiSlot );
+
+        ++m_stats.uiPieces;
+        if ( piece.bDirect )
+            ++m_stats.uiDirect;
+    }
+    if ( m_submitSlots.empty() )
+        return;
+
+    if ( !m_bBusy )
+    {
+        m_bBusy     = true;
+        m_busyStart = std::chrono::steady_clock::now();
+    }
+    const std::uint32_t uiInFlight = getInFlight();
+    ++m_stats.uiSubmits;
+    m_stats.uiDepthTotal += uiInFlight;
+    m_stats.uiMaxDepth = std::max( m_stats.uiMaxDepth, uiInFlight );
+
+    if ( m_backend == Backend::eIoUring )
+    {
+        submitRing( m_submitSlots );
+    }
+    else
+    {
+        {
+            std::lock_guard< std::mutex > lock( m_mutex );
+            m_work.insert( m_work.end(), m_submitSlots.begin(), m_submitSlots.end() );
+        }
+        if ( m_submitSlots.size() == 1U )
+            m_wake.notify_one();
+        else
+            m_wake.notify_all();
+    }
+}
+
+void AsyncFileReader::harvest( bool bWait )
+{
+    if ( m_backend == Backend::eIoUring )
+    {
+        harvestRing( bWait );
+    }
+    else
+    {
+        std::unique_lock< std::mutex > lock( m_mutex );
+        if ( bWait )
+            m_completed.wait( lock, [ this ]() { return !m_workerCompletions.empty(); } );
+        m_completions.insert( m_completions.end(), m_workerCompletions.begin(), m_workerCompletions.end() );
+        m_workerCompletions.clear();
+    }
+}
+
+std::uint32_t AsyncFileReader::complete()
+{
+    std::uint32_t uiCompleted = 0U;
+    for ( const Completion& completion : m_completions )
+    {
+        Piece piece = m_slots[ completion.uiSlot ];
+        m_freeSlots.push_back( completion.uiSlot );
+
+        if ( completion.iResult < 0 && piece.bDirect
+             && ( completion.iResult == -EINVAL || completion.iResult == -EFAULT ) )
+        {
+            // the file system or the destination memory - i.e. a driver mapping - refused direct io
+            piece.bDirect = false;
+            m_queued.push_front( piece );
+            continue;
+        }
+
+        Request& request = m_requests[ piece.uiRequest ];
+        if ( completion.iResult < 0 )
+        {
+            request.iError = static_cast< std::int32_t >( completion.iResult );
+        }
+        else if ( completion.iResult == 0 )
+        {
+            // the file shrank since it was opened
+            request.iError = -EIO;
+        }
+        else
+        {
+            const std::uint64_t uiRead = static_cast< std::uint64_t >( completion.iResult );
+            m_stats.uiBytes += uiRead;
+            if ( piece.bDirect )
+                m_stats.uiDirectBytes += uiRead;
+            if ( uiRead < piece.uiSize )
+            {
+                // continue a short read from where it stopped - direct only while it stays aligned
+                piece.uiOffset += uiRead;
+                piece.uiSize -= uiRead;
+                piece.pDestination += uiRead;
+                piece.bDirect = piece.bDirect && uiRead % kDirectAlignment == 0U;
+                m_queued.push_front( piece );
+                continue;
+            }
+        }
+
+        if ( --request.uiPieces == 0U )
+        {
+            const std::int64_t iResult
+                = request.iError ? std::int64_t( request.iError ) : std::int64_t( request.uiSize );
+            Callback fnCallback = std::move( request.fnCallback );
+            request.fnCallback  = nullptr;
+            m_freeRequests.push_back( piece.uiRequest );
+            --m_uiOutstanding;
+
+            ++m_stats.uiRequests;
+            if ( iResult < 0 )
+                ++m_stats.uiFailed;
+            ++uiCompleted;
+            // may queue further reads and so reallocate m_requests
+            fnCallback( iResult );
+        }
+    }
+    m_completions.clear();
+
+    if ( m_bBusy && getInFlight() == 0U )
+    {
+        m_bBusy = false;
+        m_stats.busy += std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now()
+                                                                                - m_busyStart );
+    }
+    return uiCompleted;
+}
+
+std::uint32_t AsyncFileReader::poll()
+{
+    submit();
+    harvest( false );
+    const std::uint32_t uiCompleted = complete();
+    // pieces requeued by complete and reads queued by the callbacks
+    submit();
+    return uiCompleted;
+}
+
+void AsyncFileReader::wait()
+{
+    while ( m_uiOutstanding != 0U )
+    {
+        // a queued piece is always submitted here so there is something in flight to wait for
+        submit();
+        harvest( true );
+        complete();
+    }
+}
+
+} // namespace retail
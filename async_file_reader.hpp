@@ -0,0 +1,204 @@
+#ifndef ASYNC_FILE_READER_19_OCTOBER_2022
+#define ASYNC_FILE_READER_19_OCTOBER_2022
+
+#include <boost/filesystem/path.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace retail
+{
+
+// Asynchronous file reads into caller owned memory - typically mapped staging memory from the
+// Uploader so file data reaches the GPU without an intermediate copy.
+//
+// Reads are queued by read() and handed to the kernel in batches by submit().  On Linux the
+// batches go through an io_uring submission queue and otherwise to a pool of threads calling
+// pread.  Each read is split into pieces of at most kMaxPieceSize and the part of a read whose file
+// offset and destination share their alignment within a kDirectAlignment page is read with
+// O_DIRECT so it bypasses the page cache.  Pieces a direct read rejects are retried buffered.
+//
+// Completion callbacks run on the thread calling poll() or wait() - never on a worker - so they
+// may call into the Uploader.  The reader itself is not thread safe.
+class AsyncFileReader
+{
+public:
+    enum class Backend
+    {
+        eIoUring,
+        eThreadPool
+    };
+    static const char* toString( Backend backend );
+
+    using File = std::uint32_t;
+
+    // the bytes read or a negative errno
+    using Callback = std::function< void( std::int64_t ) >;
+
+    static constexpr std::uint64_t kDirectAlignment = 4096U;
+    static constexpr std::uint64_t kMaxPieceSize    = 1024U * 1024U;
+
+    struct Stats
+    {
+        std::uint64_t            uiRequests    = 0U; // completed reads
+        std::uint64_t            uiFailed      = 0U;
+        std::uint64_t            uiPieces      = 0U; // submitted to the backend including short read retries
+        std::uint64_t            uiDirect      = 0U; // pieces read with O_DIRECT
+        std::uint64_t            uiBytes       = 0U;
+        std::uint64_t            uiDirectBytes = 0U;
+        std::uint64_t            uiSubmits     = 0U; // batches
+        std::uint64_t            uiDepthTotal  = 0U; // pieces in flight after each batch
+        std::uint32_t            uiMaxDepth    = 0U;
+        std::chrono::nanoseconds busy{ 0 };          // time with at least one piece in flight
+
+        double getMeanDepth() const { return uiSubmits ? double( uiDepthTotal ) / double( uiSubmits ) : 0.0; }
+        // bytes per second while busy
+        double getThroughput() const
+        {
+            return busy.count() ? double( uiBytes ) * 1000000000.0 / double( busy.count() ) : 0.0;
+        }
+    };
+
+    // falls back to the thread pool when io_uring is unavailable - uiQueueDepth bounds the pieces in
+    // flight and uiThreads is the pool size when it is used
+    AsyncFileReader( Backend preferred, std::uint32_t uiQueueDepth, std::uint32_t uiThreads );
+    ~AsyncFileReader();
+
+    AsyncFileReader( const AsyncFileReader& )            = delete;
+    AsyncFileReader& operator=( const AsyncFileReader& ) = delete;
+
+    Backend       getBackend() const { return m_backend; }
+    std::uint32_t getQueueDepth() const { return m_uiQueueDepth; }
+
+    // bDirect allows O_DIRECT for the file where the file system supports it
+    File          open( const boost::filesystem::path& filePath, bool bDirect = true );
+    std::uint64_t getFileSize( File file ) const;
+    // every read of the file must have completed
+    void          close( File file );
+
+    // queues a read of uiSize bytes at uiOffset - pDestination must stay valid until the callback.
+    // Reads past the end of the file fail.
+    void read( File file, std::uint64_t uiOffset, std::uint64_t uiSize, void* pDestination, Callback&& fnCallback );
+
+    // hands queued pieces to the backend up to the queue depth
+    void submit();
+    // submits and runs the callbacks of completed reads without blocking - returns reads completed.
+    // Callbacks must not throw and may queue further reads.
+    std::uint32_t poll();
+    // polls until every read has completed
+    void wait();
+
+    std::uint32_t getOutstanding() const { return m_uiOutstanding; }
+
+    const Stats& getStats() const { return m_stats; }
+    void         resetStats() { m_stats = Stats{}; }
+
+private:
+    struct OpenFile
+    {
+        int           iFile       = -1;
+        int           iDirectFile = -1; // -1 when O_DIRECT is unavailable
+        std::uint64_t uiSize      = 0U;
+        std::string   strPath;
+    };
+    struct Request
+    {
+        Callback      fnCallback;
+        std::uint64_t uiSize   = 0U;
+        std::uint32_t uiPieces = 0U; // not yet completed
+        std::int32_t  iError   = 0;
+    };
+    struct Piece
+    {
+        std::uint32_t uiRequest;
+        File          file;
+        bool          bDirect;
+        int           iFile; // descriptor resolved on submission so workers never read m_files
+        std::uint64_t uiOffset;
+        std::uint64_t uiSize;
+        std::uint8_t* pDestination;
+    };
+    struct Completion
+    {
+        std::uint32_t uiSlot;
+        std::int64_t  iResult;
+    };
+
+    // io_uring submission and completion rings mapped from the kernel
+    struct Ring
+    {
+        int            iRing          = -1;
+        void*          pSubmitRing    = nullptr;
+        std::size_t    szSubmitRing   = 0U;
+        void*          pCompleteRing  = nullptr; // null when it shares the submission ring mapping
+        std::size_t    szCompleteRing = 0U;
+        void*          pEntries       = nullptr;
+        std::size_t    szEntries      = 0U;
+        std::uint32_t* pSubmitTail    = nullptr;
+        std::uint32_t* pSubmitArray   = nullptr;
+        std::uint32_t  uiSubmitMask   = 0U;
+        std::uint32_t* pCompleteHead  = nullptr;
+        std::uint32_t* pCompleteTail  = nullptr;
+        std::uint32_t  uiCompleteMask = 0U;
+        void*          pCompletions   = nullptr;
+    };
+
+    bool initRing();
+    void destroyRing();
+    void submitRing( const std::vector< std::uint32_t >& slots );
+    void harvestRing( bool bWait );
+    int  enterRing( std::uint32_t uiSubmit, std::uint32_t uiWaitFor );
+
+    void workerThread();
+
+    void queuePiece( const Piece& piece );
+    // moves completed pieces to m_completions - blocking until there is one when bWait
+    void harvest( bool bWait );
+    // runs the callbacks of the requests m_completions finishes and requeues short reads
+    std::uint32_t complete();
+    std::uint32_t getInFlight() const
+    {
+        return static_cast< std::uint32_t >( m_slots.size() - m_freeSlots.size() );
+    }
+
+    Backend       m_backend;
+    std::uint32_t m_uiQueueDepth;
+
+    std::vector< OpenFile >      m_files;
+    std::vector< File >          m_freeFiles;
+    std::vector< Request >       m_requests;
+    std::vector< std::uint32_t > m_freeRequests;
+    std::uint32_t                m_uiOutstanding = 0U; // requests not yet called back
+
+    std::deque< Piece >          m_queued;    // awaiting a slot
+    std::vector< Piece >         m_slots;     // one per queue depth - the index identifies a completion
+    std::vector< std::uint32_t > m_freeSlots;
+    std::vector< std::uint32_t > m_submitSlots;
+    std::vector< Completion >    m_completions;
+
+    Ring m_ring;
+
+    // thread pool backend - slots pass to the workers and completions back under m_mutex
+    std::vector< std::thread >  m_workers;
+    std::mutex                  m_mutex;
+    std::condition_variable     m_wake;
+    std::condition_variable     m_completed;
+    std::deque< std::uint32_t > m_work;
+    std::vector< Completion >   m_workerCompletions;
+    bool                        m_bStop = false;
+
+    Stats                                 m_stats;
+    bool                                  m_bBusy = false;
+    std::chrono::steady_clock::time_point m_busyStart;
+};
+
+} // namespace retail
+
+#endif // ASYNC_FILE_READER_19_OCTOBER_2022
@@ -0,0 +1,101 @@
+
+#include "buffer.hpp"
+#include "counters.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include "spdlog/spdlog.h"
+
+namespace retail
+{
+
+std::uint32_t findMemoryType( vk::PhysicalDevice      physicalDevice,
+                              std::uint32_t           uiMemoryTypeBits,
+                              vk::MemoryPropertyFlags requiredFlags )
+{
+    const vk::PhysicalDeviceMemoryProperties memoryProperties = physicalDevice.getMemoryProperties();
+    for ( std::uint32_t i = 0; i != memoryProperties.memoryTypeCount; ++i )
+    {
+        if ( ( uiMemoryTypeBits & ( 1U << i ) )
+             && ( memoryProperties.memoryTypes[ i ].propertyFlags & requiredFlags ) == requiredFlags )
+        {
+            return i;
+        }
+    }
+    THROW_RTE( "Failed to find memory type with flags: " << vk::to_string( requiredFlags ) );
+}
+
+DeviceMemoryBudget readDeviceMemoryBudget( vk::PhysicalDevice physicalDevice )
+{
+    const auto properties = physicalDevice.getMemoryProperties2< vk::PhysicalDeviceMemoryProperties2,
+                                                                 vk::PhysicalDeviceMemoryBudgetPropertiesEXT >();
+    const vk::PhysicalDeviceMemoryProperties& memoryProperties
+        = properties.get< vk::PhysicalDeviceMemoryProperties2 >().memoryProperties;
+    const vk::PhysicalDeviceMemoryBudgetPropertiesEXT& budget
+        = properties.get< vk::PhysicalDeviceMemoryBudgetPropertiesEXT >();
+
+    DeviceMemoryBudget deviceMemory;
+    for ( std::uint32_t i = 0; i != memoryProperties.memoryHeapCount; ++i )
+    {
+        if ( memoryProperties.memoryHeaps[ i ].flags & vk::MemoryHeapFlagBits::eDeviceLocal )
+        {
+            deviceMemory.uiUsage += budget.heapUsage[ i ];
+            deviceMemory.uiBudget += budget.heapBudget[ i ];
+        }
+    }
+    return deviceMemory;
+}
+
+Buffer::Buffer( vk::PhysicalDevice      physicalDevice,
+                vk::Device              device,
+                vk::DeviceSize          size,
+                vk::BufferUsageFlags    usage,
+                vk::MemoryPropertyFlags memoryFlags )
+    : m_device( device )
+    , m_size( size )
+    , m_memoryFlags( memoryFlags )
+{
+    VERIFY_RTE( size > 0U );
+
+    const vk::BufferCreateInfo bufferCreateInfo{ vk::BufferCreateFlags{}, size, usage, vk::SharingMode::eExclusive };
+    m_buffer = m_device.createBuffer( bufferCreateInfo );
+
+    const vk::MemoryRequirements requirements = m_device.getBufferMemoryRequirements( m_buffer );
+    const vk::MemoryAllocateInfo allocateInfo{
+        requirements.size, findMemoryType( physicalDevice, requirements.memoryTypeBits, memoryFlags ) };
+    m_memory = m_device.allocateMemory( allocateInfo );
+    count( Counter::eAllocations );
+    m_device.bindBufferMemory( m_buffer, m_memory, 0U );
+
+    if ( memoryFlags & vk::MemoryPropertyFlagBits::eHostVisible )
+    {
+        m_pMapped = static_cast< std::uint8_t* >( m_device.mapMemory( m_memory, 0U, VK_WHOLE_SIZE ) );
+    }
+}
+
+Buffer::~Buffer()
+{
+    if ( m_pMapped )
+    {
+        m_device.unmapMemory( m_memory );
+    }
+    if ( m_buffer )
+    {
+        m_device.destroyBuffer( m_buffer );
+    }
+    if ( m_memory )
+    {
+        m_device.freeMemory( m_memory );
+    }
+}
+
+void Buffer::flush() const
+{
+    if ( !( m_memoryFlags & vk::MemoryPropertyFlagBits::eHostCoherent ) )
+    {
+        // whole size avoids having to round to nonCoherentAtomSize
+        m_device.flushMappedMemoryRanges( vk::MappedMemoryRange{ m_memory, 0U, VK_WHOLE_SIZE } );
+    }
+}
+
+} // namespace retail
@@ -0,0 +1,58 @@
+#ifndef BUFFER_10_OCTOBER_2022
+#define BUFFER_10_OCTOBER_2022
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include <cstdint>
+
+namespace retail
+{
+
+std::uint32_t findMemoryType( vk::PhysicalDevice      physicalDevice,
+                              std::uint32_t           uiMemoryTypeBits,
+                              vk::MemoryPropertyFlags requiredFlags );
+
+// bytes in use and available to the process across device local heaps - VK_EXT_memory_budget only
+struct DeviceMemoryBudget
+{
+    std::uint64_t uiUsage  = 0U;
+    std::uint64_t uiBudget = 0U;
+};
+DeviceMemoryBudget readDeviceMemoryBudget( vk::PhysicalDevice physicalDevice );
+
+// A buffer with its own dedicated allocation.  Host visible buffers are persistently mapped.
+class Buffer
+{
+public:
+    Buffer( vk::PhysicalDevice      physicalDevice,
+            vk::Device              device,
+            vk::DeviceSize          size,
+            vk::BufferUsageFlags    usage,
+            vk::MemoryPropertyFlags memoryFlags );
+    ~Buffer();
+
+    Buffer( const Buffer& )            = delete;
+    Buffer& operator=( const Buffer& ) = delete;
+
+    vk::Buffer     get() const { return m_buffer; }
+    vk::DeviceSize getSize() const { return m_size; }
+
+    // nullptr unless the memory is host visible
+    std::uint8_t* getMapped() const { return m_pMapped; }
+
+    // required when the memory is not host coherent
+    void flush() const;
+
+private:
+    vk::Device              m_device;
+    vk::Buffer              m_buffer;
+    vk::DeviceMemory        m_memory;
+    vk::DeviceSize          m_size;
+    vk::MemoryPropertyFlags m_memoryFlags;
+    std::uint8_t*           m_pMapped = nullptr;
+};
+
+} // namespace retail
+
+#endif // BUFFER_10_OCTOBER_2022
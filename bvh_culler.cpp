@@ -0,0 +1,432 @@
+#include "bvh_culler.hpp"
+#include "worker_pool.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace retail
+{
+
+namespace
+{
+// spreads the low ten bits so there are two zero bits between each
+std::uint32_t expandBits( std::uint32_t ui )
+{
+    ui = ( ui * 0x00010001U ) & 0xFF0000FFU;
+    ui = ( ui * 0x00000101U ) & 0x0F00F00FU;
+    ui = ( ui * 0x00000011U ) & 0xC30C30C3U;
+    ui = ( ui * 0x00000005U ) & 0x49249249U;
+    return ui;
+}
+
+std::uint32_t morton( const Vec3& position, const Vec3& origin, const Vec3& scale )
+{
+    auto quantise = []( float f ) { return static_cast< std::uint32_t >( std::min( std::max( f, 0.0f ), 1023.0f ) ); };
+    return ( expandBits( quantise( ( position.x - origin.x ) * scale.x ) ) << 2U )
+           | ( expandBits( quantise( ( position.y - origin.y ) * scale.y ) ) << 1U )
+           | expandBits( quantise( ( position.z - origin.z ) * scale.z ) );
+}
+
+std::uint32_t laneMask( std::uint32_t uiCount ) { return ( 1U << uiCount ) - 1U; }
+
+// the vertex furthest along the plane normal is outside when the box is entirely outside and the
+// nearest is inside when the box is entirely inside
+template < typename TNode >
+std::uint32_t testScalar( const TNode& node, const BvhCuller::Frustum& frustum, std::uint32_t& uiInside )
+{
+    std::uint32_t uiVisible = 0U;
+    uiInside                = 0U;
+    for ( std::uint32_t uiLane = 0U; uiLane != node.uiChildCount; ++uiLane )
+    {
+        bool bOutside = false, bStraddles = false;
+        for ( const std::array< float, 4 >& plane : frustum.planes )
+        {
+            const float fFar = plane[ 0 ] * ( plane[ 0 ] >= 0.0f ? node.maxX : node.minX )[ uiLane ]
+                               + plane[ 1 ] * ( plane[ 1 ] >= 0.0f ? node.maxY : node.minY )[ uiLane ]
+                               + plane[ 2 ] * ( plane[ 2 ] >= 0.0f ? node.maxZ : node.minZ )[ uiLane ] + plane[ 3 ];
+            const float fNear = plane[ 0 ] * ( plane[ 0 ] >= 0.0f ? node.minX : node.maxX )[ uiLane ]
+                                + plane[ 1 ] * ( plane[ 1 ] >= 0.0f ? node.minY : node.maxY )[ uiLane ]
+                                + plane[ 2 ] * ( plane[ 2 ] >= 0.0f ? node.minZ : node.maxZ )[ uiLane ] + plane[ 3 ];
+            bOutside   = bOutside || fFar < 0.0f;
+            bStraddles = bStraddles || fNear < 0.0f;
+        }
+        if ( !bOutside )
+        {
+            uiVisible |= 1U << uiLane;
+            uiInside |= bStraddles ? 0U : 1U << uiLane;
+        }
+    }
+    return uiVisible;
+}
+
+#ifdef RETAIL_SIMD_X86
+// four children per plane per instruction - two passes cover the node
+template < typename TNode >
+std::uint32_t testSSE( const TNode& node, const BvhCuller::Frustum& frustum, std::uint32_t& uiInside )
+{
+    std::uint32_t uiOutsideBits = 0U, uiStraddleBits = 0U;
+    for ( std::uint32_t uiHalf = 0U; uiHalf < node.uiChildCount; uiHalf += 4U )
+    {
+        __m128 outside = _mm_setzero_ps(), straddles = _mm_setzero_ps();
+        for ( const std::array< float, 4 >& plane : frustum.planes )
+        {
+            const bool   bX = plane[ 0 ] >= 0.0f, bY = plane[ 1 ] >= 0.0f, bZ = plane[ 2 ] >= 0.0f;
+            const __m128 nx = _mm_set1_ps( plane[ 0 ] ), ny = _mm_set1_ps( plane[ 1 ] ), nz = _mm_set1_ps( plane[ 2 ] );
+            const __m128 d  = _mm_set1_ps( plane[ 3 ] );
+
+            __m128 far = _mm_add_ps( _mm_mul_ps( nx, _mm_load_ps( ( bX ? node.maxX : node.minX ) + uiHalf ) ), d );
+            far = _mm_add_ps( far, _mm_mul_ps( ny, _mm_load_ps( ( bY ? node.maxY : node.minY ) + uiHalf ) ) );
+            far = _mm_add_ps( far, _mm_mul_ps( nz, _mm_load_ps( ( bZ ? node.maxZ : node.minZ ) + uiHalf ) ) );
+            __m128 near = _mm_add_ps( _mm_mul_ps( nx, _mm_load_ps( ( bX ? node.minX : node.maxX ) + uiHalf ) ), d );
+            near = _mm_add_ps( near, _mm_mul_ps( ny, _mm_load_ps( ( bY ? node.minY : node.maxY ) + uiHalf ) ) );
+            near = _mm_add_ps( near, _mm_mul_ps( nz, _mm_load_ps( ( bZ ? node.minZ : node.maxZ ) + uiHalf ) ) );
+
+            outside   = _mm_or_ps( outside, _mm_cmplt_ps( far, _mm_setzero_ps() ) );
+            straddles = _mm_or_ps( straddles, _mm_cmplt_ps( near, _mm_setzero_ps() ) );
+        }
+        uiOutsideBits |= static_cast< std::uint32_t >( _mm_movemask_ps( outside ) ) << uiHalf;
+        uiStraddleBits |= static_cast< std::uint32_t >( _mm_movemask_ps( straddles ) ) << uiHalf;
+    }
+    const std::uint32_t uiVisible = ~uiOutsideBits & laneMask( node.uiChildCount );
+    uiInside                      = uiVisible & ~uiStraddleBits;
+    return uiVisible;
+}
+
+// all eight children per plane per instruction
+template < typename TNode >
+RETAIL_TARGET_AVX2 std::uint32_t
+testAVX2( const TNode& node, const BvhCuller::Frustum& frustum, std::uint32_t& uiInside )
+{
+    __m256 outside = _mm256_setzero_ps(), straddles = _mm256_setzero_ps();
+    for ( const std::array< float, 4 >& plane : frustum.planes )
+    {
+        const bool   bX = plane[ 0 ] >= 0.0f, bY = plane[ 1 ] >= 0.0f, bZ = plane[ 2 ] >= 0.0f;
+        const __m256 nx = _mm256_set1_ps( plane[ 0 ] ), ny = _mm256_set1_ps( plane[ 1 ] );
+        const __m256 nz = _mm256_set1_ps( plane[ 2 ] ), d = _mm256_set1_ps( plane[ 3 ] );
+
+        __m256 far  = _mm256_fmadd_ps( nx, _mm256_load_ps( bX ? node.maxX : node.minX ), d );
+        far         = _mm256_fmadd_ps( ny, _mm256_load_ps( bY ? node.maxY : node.minY ), far );
+        far         = _mm256_fmadd_ps( nz, _mm256_load_ps( bZ ? node.maxZ : node.minZ ), far );
+        __m256 near = _mm256_fmadd_ps( nx, _mm256_load_ps( bX ? node.minX : node.maxX ), d );
+        near        = _mm256_fmadd_ps( ny, _mm256_load_ps( bY ? node.minY : node.maxY ), near );
+        near        = _mm256_fmadd_ps( nz, _mm256_load_ps( bZ ? node.minZ : node.maxZ ), near );
+
+        outside   = _mm256_or_ps( outside, _mm256_cmp_ps( far, _mm256_setzero_ps(), _CMP_LT_OQ ) );
+        straddles = _mm256_or_ps( straddles, _mm256_cmp_ps( near, _mm256_setzero_ps(), _CMP_LT_OQ ) );
+    }
+    const std::uint32_t uiVisible
+        = ~static_cast< std::uint32_t >( _mm256_movemask_ps( outside ) ) & laneMask( node.uiChildCount );
+    uiInside = uiVisible & ~static_cast< std::uint32_t >( _mm256_movemask_ps( straddles ) );
+    return uiVisible;
+}
+#endif
+} // namespace
+
+BvhCuller::Frustum BvhCuller::extractFrustum( const Mat4& viewProjection )
+{
+    // clip = M * p so each clip coordinate is a row of M dotted with p
+    const float* m   = viewProjection.m;
+    auto         row = [ m ]( int r ) { return std::array< float, 4 >{ m[ r ], m[ 4 + r ], m[ 8 + r ], m[ 12 + r ] }; };
+    auto combine = []( const std::array< float, 4 >& a, const std::array< float, 4 >& b, float fSign )
+    {
+        std::array< float, 4 > plane{ a[ 0 ] + b[ 0 ] * fSign, a[ 1 ] + b[ 1 ] * fSign, a[ 2 ] + b[ 2 ] * fSign,
+                                      a[ 3 ] + b[ 3 ] * fSign };
+        const float fLength = length( Vec3{ plane[ 0 ], plane[ 1 ], plane[ 2 ] } );
+        if ( fLength > 0.0f )
+        {
+            for ( float& f : plane )
+                f /= fLength;
+        }
+        return plane;
+    };
+    const std::array< float, 4 > x = row( 0 ), y = row( 1 ), z = row( 2 ), w = row( 3 );
+    const std::array< float, 4 > zero{ 0.0f, 0.0f, 0.0f, 0.0f };
+
+    // -w <= x <= w, -w <= y <= w and 0 <= z <= w
+    return Frustum{ { combine( w, x, 1.0f ),
+                      combine( w, x, -1.0f ),
+                      combine( w, y, 1.0f ),
+                      combine( w, y, -1.0f ),
+                      combine( z, zero, 1.0f ),
+                      combine( w, z, -1.0f ) } };
+}
+
+BvhCuller::BvhCuller()
+    : m_levelStarts{ 0U, 0U }
+{
+    setKernel( getBestSimdKernel() );
+}
+
+void BvhCuller::setKernel( SimdKernel kernel )
+{
+    VERIFY_RTE_MSG( isSupported( kernel ), "Culling kernel not supported: " << toString( kernel ) );
+    m_kernel = kernel;
+    switch ( kernel )
+    {
+#ifdef RETAIL_SIMD_X86
+        case SimdKernel::eSSE:
+            m_pfnTest = &testSSE< Node >;
+            break;
+        case SimdKernel::eAVX2:
+            m_pfnTest = &testAVX2< Node >;
+            break;
+#endif
+        default:
+            m_pfnTest = &testScalar< Node >;
+            break;
+    }
+}
+
+void BvhCuller::setLane( Node& node, std::uint32_t uiLane, const Aabb& bounds )
+{
+    node.minX[ uiLane ] = bounds.min.x;
+    node.minY[ uiLane ] = bounds.min.y;
+    node.minZ[ uiLane ] = bounds.min.z;
+    node.maxX[ uiLane ] = bounds.max.x;
+    node.maxY[ uiLane ] = bounds.max.y;
+    node.maxZ[ uiLane ] = bounds.max.z;
+}
+
+Aabb BvhCuller::getNodeBounds( const Node& node ) const
+{
+    Aabb bounds{ Vec3{ node.minX[ 0 ], node.minY[ 0 ], node.minZ[ 0 ] },
+                 Vec3{ node.maxX[ 0 ], node.maxY[ 0 ], node.maxZ[ 0 ] } };
+    for ( std::uint32_t uiLane = 1U; uiLane < node.uiChildCount; ++uiLane )
+    {
+        bounds.min = Vec3{ std::min( bounds.min.x, node.minX[ uiLane ] ),
+                           std::min( bounds.min.y, node.minY[ uiLane ] ),
+                           std::min( bounds.min.z, node.minZ[ uiLane ] ) };
+        bounds.max = Vec3{ std::max( bounds.max.x, node.maxX[ uiLane ] ),
+                           std::max( bounds.max.y, node.maxY[ uiLane ] ),
+                           std::max( bounds.max.z, node.maxZ[ uiLane ] ) };
+    }
+    return bounds;
+}
+
+void BvhCuller::build( const std::vector< Aabb >& bounds )
+{
+    const std::uint32_t uiObjects = static_cast< std::uint32_t >( bounds.size() );
+    m_nodes.clear();
+    m_levelStarts.assign( 1U, 0U );
+    m_sortedObjects.resize( uiObjects );
+    m_objectPositions.resize( uiObjects );
+    if ( uiObjects == 0U )
+    {
+        m_levelStarts.push_back( 0U );
+        m_dirty.clear();
+        return;
+    }
+
+    // sort along a Morton curve through the centres so consecutive objects are spatial neighbours
+    std::vector< Vec3 > centres( uiObjects );
+    Aabb                centreBounds{ Vec3{ std::numeric_limits< float >::max(),
+                                            std::numeric_limits< float >::max(),
+                                            std::numeric_limits< float >::max() },
+                                      Vec3{ std::numeric_limits< float >::lowest(),
+                                            std::numeric_limits< float >::lowest(),
+                                            std::numeric_limits< float >::lowest() } };
+    for ( std::uint32_t i = 0U; i != uiObjects; ++i )
+    {
+        centres[ i ]     = ( bounds[ i ].min + bounds[ i ].max ) * 0.5f;
+        centreBounds.min = Vec3{ std::min( centreBounds.min.x, centres[ i ].x ),
+                                 std::min( centreBounds.min.y, centres[ i ].y ),
+                                 std::min( centreBounds.min.z, centres[ i ].z ) };
+        centreBounds.max = Vec3{ std::max( centreBounds.max.x, centres[ i ].x ),
+                                 std::max( centreBounds.max.y, centres[ i ].y ),
+                                 std::max( centreBounds.max.z, centres[ i ].z ) };
+    }
+    const Vec3 extent    = centreBounds.max - centreBounds.min;
+    auto       axisScale = []( float fExtent ) { return fExtent > 0.0f ? 1023.0f / fExtent : 0.0f; };
+    const Vec3 scale{ axisScale( extent.x ), axisScale( extent.y ), axisScale( extent.z ) };
+    std::vector< std::uint32_t > codes( uiObjects );
+    for ( std::uint32_t i = 0U; i != uiObjects; ++i )
+        codes[ i ] = morton( centres[ i ], centreBounds.min, scale );
+    std::iota( m_sortedObjects.begin(), m_sortedObjects.end(), 0U );
+    std::stable_sort( m_sortedObjects.begin(),
+                      m_sortedObjects.end(),
+                      [ & ]( std::uint32_t a, std::uint32_t b ) { return codes[ a ] < codes[ b ]; } );
+
+    // leaves take kWidth consecutive objects and each level above kWidth consecutive nodes
+    for ( std::uint32_t uiFirst = 0U; uiFirst < uiObjects; uiFirst += kWidth )
+    {
+        Node node{};
+        node.uiFirst      = uiFirst;
+        node.uiCount      = std::min( kWidth, uiObjects - uiFirst );
+        node.uiChildCount = node.uiCount;
+        for ( std::uint32_t uiLane = 0U; uiLane != node.uiChildCount; ++uiLane )
+        {
+            const std::uint32_t uiObject  = m_sortedObjects[ uiFirst + uiLane ];
+            node.children[ uiLane ]       = uiObject;
+            m_objectPositions[ uiObject ] = uiFirst + uiLane;
+            setLane( node, uiLane, bounds[ uiObject ] );
+        }
+        m_nodes.push_back( node );
+    }
+    m_levelStarts.push_back( getNodeCount() );
+
+    while ( m_levelStarts[ m_levelStarts.size() - 1U ] - m_levelStarts[ m_levelStarts.size() - 2U ] > 1U )
+    {
+        const std::uint32_t uiBegin = m_levelStarts[ m_levelStarts.size() - 2U ];
+        const std::uint32_t uiEnd   = m_levelStarts.back();
+        for ( std::uint32_t uiFirstChild = uiBegin; uiFirstChild < uiEnd; uiFirstChild += kWidth )
+        {
+            Node node{};
+            node.uiChildCount = std::min( kWidth, uiEnd - uiFirstChild );
+            node.uiFirst      = m_nodes[ uiFirstChild ].uiFirst;
+            for ( std::uint32_t uiLane = 0U; uiLane != node.uiChildCount; ++uiLane )
+            {
+                node.children[ uiLane ] = uiFirstChild + uiLane;
+                node.uiCount += m_nodes[ uiFirstChild + uiLane ].uiCount;
+                setLane( node, uiLane, getNodeBounds( m_nodes[ uiFirstChild + uiLane ] ) );
+            }
+            m_nodes.push_back( node );
+        }
+        m_levelStarts.push_back( getNodeCount() );
+    }
+    m_dirty.assign( m_nodes.size(), 0U );
+}
+
+void BvhCuller::setBounds( std::uint32_t uiObject, const Aabb& bounds )
+{
+    const std::uint32_t uiPosition = m_objectPositions[ uiObject ];
+    setLane( m_nodes[ uiPosition / kWidth ], uiPosition % kWidth, bounds );
+    m_dirty[ uiPosition / kWidth ] = 1U;
+}
+
+std::uint32_t BvhCuller::refit()
+{
+    // a level's nodes are consecutive in groups of kWidth under consecutive parents
+    std::uint32_t uiRefitted = 0U;
+    for ( std::size_t szLevel = 0U; szLevel + 1U < m_levelStarts.size(); ++szLevel )
+    {
+        const std::uint32_t uiBegin = m_levelStarts[ szLevel ];
+        const std::uint32_t uiEnd   = m_levelStarts[ szLevel + 1U ];
+        const bool          bRoot   = szLevel + 2U == m_levelStarts.size();
+        for ( std::uint32_t uiNode = uiBegin; uiNode != uiEnd; ++uiNode )
+        {
+            if ( !m_dirty[ uiNode ] )
+                continue;
+            m_dirty[ uiNode ] = 0U;
+            ++uiRefitted;
+            if ( bRoot )
+                continue;
+            const std::uint32_t uiParent = uiEnd + ( uiNode - uiBegin ) / kWidth;
+            setLane( m_nodes[ uiParent ], ( uiNode - uiBegin ) % kWidth, getNodeBounds( m_nodes[ uiNode ] ) );
+            m_dirty[ uiParent ] = 1U;
+        }
+    }
+    return uiRefitted;
+}
+
+void BvhCuller::appendRange( const Node& node, std::vector< std::uint32_t >& visible ) const
+{
+    visible.insert( visible.end(),
+                    m_sortedObjects.begin() + node.uiFirst,
+                    m_sortedObjects.begin() + node.uiFirst + node.uiCount );
+}
+
+void BvhCuller::cullSubtree( const Task& task, const Frustum& frustum, std::vector< std::uint32_t >& visible ) const
+{
+    if ( task.bInside )
+    {
+        appendRange( m_nodes[ task.uiNode ], visible );
+        return;
+    }
+
+    // each pop pushes at most kWidth so this covers far deeper trees than 32 bit indices allow
+    std::array< std::uint32_t, kWidth * 16U > stack;
+    std::uint32_t                             uiStackSize = 0U;
+    stack[ uiStackSize++ ]                                 = task.uiNode;
+    while ( uiStackSize != 0U )
+    {
+        const std::uint32_t uiNode    = stack[ --uiStackSize ];
+        const Node&         node      = m_nodes[ uiNode ];
+        const bool          bLeaf     = isLeaf( uiNode );
+        std::uint32_t       uiInside  = 0U;
+        std::uint32_t       uiVisible = m_pfnTest( node, frustum, uiInside );
+        while ( uiVisible != 0U )
+        {
+            const std::uint32_t uiLane = static_cast< std::uint32_t >( __builtin_ctz( uiVisible ) );
+            uiVisible &= uiVisible - 1U;
+            if ( bLeaf )
+                visible.push_back( node.children[ uiLane ] );
+            else if ( uiInside & ( 1U << uiLane ) )
+                appendRange( m_nodes[ node.children[ uiLane ] ], visible );
+            else
+                stack[ uiStackSize++ ] = node.children[ uiLane ];
+        }
+    }
+}
+
+void BvhCuller::collectTasks( std::uint32_t        uiNode,
+                              std::uint32_t        uiLevel,
+                              std::uint32_t        uiTaskLevel,
+                              const Frustum&       frustum,
+                              std::vector< Task >& tasks ) const
+{
+    const Node&   node      = m_nodes[ uiNode ];
+    std::uint32_t uiInside  = 0U;
+    std::uint32_t uiVisible = m_pfnTest( node, frustum, uiInside );
+    while ( uiVisible != 0U )
+    {
+        const std::uint32_t uiLane = static_cast< std::uint32_t >( __builtin_ctz( uiVisible ) );
+        uiVisible &= uiVisible - 1U;
+        const bool bInside = ( uiInside & ( 1U << uiLane ) ) != 0U;
+        if ( bInside || uiLevel - 1U == uiTaskLevel )
+            tasks.push_back( Task{ node.children[ uiLane ], bInside } );
+        else
+            collectTasks( node.children[ uiLane ], uiLevel - 1U, uiTaskLevel, frustum, tasks );
+    }
+}
+
+void BvhCuller::cull( const Frustum& frustum, std::vector< std::uint32_t >& visible, WorkerPool* pWorkers )
+{
+    visible.clear();
+    if ( m_nodes.empty() )
+        return;
+
+    const std::uint32_t uiRoot     = getNodeCount() - 1U;
+    const std::uint32_t uiTopLevel = static_cast< std::uint32_t >( m_levelStarts.size() ) - 2U;
+
+    // split at the highest level with enough subtrees to balance across the pool
+    std::uint32_t uiTaskLevel = uiTopLevel;
+    if ( pWorkers && pWorkers->getThreadCount() > 1U )
+    {
+        for ( std::uint32_t uiLevel = uiTopLevel; uiLevel-- != 0U; )
+        {
+            if ( m_levelStarts[ uiLevel + 1U ] - m_levelStarts[ uiLevel ] >= pWorkers->getThreadCount() * 4U )
+            {
+                uiTaskLevel = uiLevel;
+                break;
+            }
+        }
+    }
+    if ( uiTaskLevel == uiTopLevel )
+    {
+        cullSubtree( Task{ uiRoot, false }, frustum, visible );
+        return;
+    }
+
+    m_tasks.clear();
+    collectTasks( uiRoot, uiTopLevel, uiTaskLevel, frustum, m_tasks );
+    if ( m_taskVisible.size() < m_tasks.size() )
+        m_taskVisible.resize( m_tasks.size() );
+    pWorkers->parallelFor( static_cast< std::uint32_t >( m_tasks.size() ),
+                           1U,
+                           [ & ]( std::uint32_t uiBegin, std::uint32_t uiEnd )
+                           {
+                               for ( std::uint32_t i = uiBegin; i != uiEnd; ++i )
+                               {
+                                   m_taskVisible[ i ].clear();
+                                   cullSubtree( m_tasks[ i ], frustum, m_taskVisible[ i ] );
+                               }
+                           } );
+    for ( std::size_t i = 0; i != m_tasks.size(); ++i )
+        visible.insert( visible.end(), m_taskVisible[ i ].begin(), m_taskVisible[ i ].end() );
+}
+
+} // namespace retail
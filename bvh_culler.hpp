@@ -0,0 +1,110 @@
+#ifndef BVH_CULLER_19_OCTOBER_2022
+#define BVH_CULLER_19_OCTOBER_2022
+
+#include "math.hpp"
+#include "simd.hpp"
+
+#include <boost/align/aligned_allocator.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace retail
+{
+
+class WorkerPool;
+
+// CPU frustum culling over a bounding volume hierarchy of object bounds.
+//
+// The hierarchy is eight wide and each node keeps its children's bounds as structure of arrays so
+// an AVX2 plane test covers all eight children in one instruction and SSE covers four.  It is built
+// bottom up over the objects sorted along a Morton curve so every node covers a contiguous range
+// of the sorted objects and a subtree entirely inside the frustum is emitted without further tests.
+//
+// Moved objects are refitted in place - rebuild once they have moved far enough that the Morton
+// order no longer groups neighbours.
+class BvhCuller
+{
+public:
+    static constexpr std::uint32_t kWidth = 8U;
+
+    // inward facing planes as xyz normal and w distance - left right bottom top near far
+    struct Frustum
+    {
+        std::array< std::array< float, 4 >, 6 > planes;
+    };
+    // vulkan clip space with depth in [0,1]
+    static Frustum extractFrustum( const Mat4& viewProjection );
+
+    BvhCuller();
+
+    void build( const std::vector< Aabb >& bounds );
+
+    // marks the object for the next refit
+    void setBounds( std::uint32_t uiObject, const Aabb& bounds );
+    // grows and shrinks the ancestors of objects changed by setBounds - returns the nodes refitted
+    std::uint32_t refit();
+
+    // replaces visible with the indices of objects intersecting the frustum - traversal below the
+    // top of the tree is split across the pool when given
+    void cull( const Frustum& frustum, std::vector< std::uint32_t >& visible, WorkerPool* pWorkers = nullptr );
+
+    std::uint32_t getObjectCount() const { return static_cast< std::uint32_t >( m_objectPositions.size() ); }
+    std::uint32_t getNodeCount() const { return static_cast< std::uint32_t >( m_nodes.size() ); }
+
+    // best kernel the cpu supports is used by default
+    void       setKernel( SimdKernel kernel );
+    SimdKernel getKernel() const { return m_kernel; }
+
+private:
+    struct alignas( 64 ) Node
+    {
+        // children's bounds - lanes past uiChildCount are zero and masked out
+        float minX[ kWidth ], minY[ kWidth ], minZ[ kWidth ];
+        float maxX[ kWidth ], maxY[ kWidth ], maxZ[ kWidth ];
+
+        std::uint32_t children[ kWidth ]; // object indices in leaves otherwise node indices
+        std::uint32_t uiChildCount;
+        std::uint32_t uiFirst; // range of m_sortedObjects below the node
+        std::uint32_t uiCount;
+    };
+
+    struct Task
+    {
+        std::uint32_t uiNode;
+        bool          bInside; // no test needed
+    };
+
+    // returns the mask of children intersecting the frustum and sets the mask of those entirely inside
+    using TestFunction = std::uint32_t ( * )( const Node&, const Frustum&, std::uint32_t& );
+
+    bool isLeaf( std::uint32_t uiNode ) const { return uiNode < m_levelStarts[ 1 ]; }
+    Aabb getNodeBounds( const Node& node ) const;
+    void setLane( Node& node, std::uint32_t uiLane, const Aabb& bounds );
+    void collectTasks( std::uint32_t        uiNode,
+                       std::uint32_t        uiLevel,
+                       std::uint32_t        uiTaskLevel,
+                       const Frustum&       frustum,
+                       std::vector< Task >& tasks ) const;
+    void cullSubtree( const Task& task, const Frustum& frustum, std::vector< std::uint32_t >& visible ) const;
+    void appendRange( const Node& node, std::vector< std::uint32_t >& visible ) const;
+
+    // levels are contiguous from the leaves up so the root is the last node
+    std::vector< Node, boost::alignment::aligned_allocator< Node, 64 > > m_nodes;
+    std::vector< std::uint32_t > m_levelStarts; // first node of each level followed by the end
+    std::vector< std::uint32_t > m_sortedObjects;
+    // position in m_sortedObjects - leaf position / kWidth holds the object in lane position % kWidth
+    std::vector< std::uint32_t > m_objectPositions;
+    std::vector< std::uint8_t >  m_dirty; // per node awaiting refit
+
+    std::vector< Task >                         m_tasks;
+    std::vector< std::vector< std::uint32_t > > m_taskVisible; // per task so workers never share an output
+
+    SimdKernel   m_kernel;
+    TestFunction m_pfnTest;
+};
+
+} // namespace retail
+
+#endif // BVH_CULLER_19_OCTOBER_2022
@@ -0,0 +1,70 @@
+#include "command_cache.hpp"
+#include "debug.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include "spdlog/spdlog.h"
+
+namespace retail
+{
+
+CommandCache::CommandCache( const DeviceDispatch& dispatch,
+                            std::uint32_t         uiQueueFamilyIndex,
+                            std::uint32_t         uiEntries )
+    : m_dispatch( dispatch )
+    , m_device( dispatch.getDevice() )
+{
+    VERIFY_RTE( uiEntries > 0U );
+
+    m_commandPool = m_device.createCommandPool(
+        vk::CommandPoolCreateInfo{ vk::CommandPoolCreateFlagBits::eResetCommandBuffer, uiQueueFamilyIndex } );
+    const std::vector< vk::CommandBuffer > commandBuffers = m_device.allocateCommandBuffers(
+        vk::CommandBufferAllocateInfo{ m_commandPool, vk::CommandBufferLevel::eSecondary, uiEntries } );
+
+    m_entries.resize( uiEntries );
+    for ( std::uint32_t i = 0; i != uiEntries; ++i )
+        m_entries[ i ].commandBuffer = commandBuffers[ i ];
+}
+
+CommandCache::~CommandCache()
+{
+    if ( m_commandPool )
+    {
+        m_device.destroyCommandPool( m_commandPool );
+    }
+}
+
+vk::CommandBuffer CommandCache::get( std::uint32_t                           uiEntry,
+                                     const std::vector< std::uint8_t >&      state,
+                                     const vk::CommandBufferInheritanceInfo& inheritance,
+                                     const Record&                           fnRecord )
+{
+    VERIFY_RTE( uiEntry < m_entries.size() );
+    Entry& entry = m_entries[ uiEntry ];
+
+    if ( entry.bValid && entry.state == state )
+    {
+        ++m_stats.uiReplays;
+        return entry.commandBuffer;
+    }
+
+    // not one time submit as the recording is replayed until the state changes
+    const vk::CommandBufferBeginInfo beginInfo{ vk::CommandBufferUsageFlagBits::eRenderPassContinue, &inheritance };
+    VK_CHECK( static_cast< vk::Result >( m_dispatch.resetCommandBuffer( entry.commandBuffer ) ) );
+    VK_CHECK( static_cast< vk::Result >( m_dispatch.beginCommandBuffer( entry.commandBuffer, beginInfo ) ) );
+    fnRecord( entry.commandBuffer );
+    VK_CHECK( static_cast< vk::Result >( m_dispatch.endCommandBuffer( entry.commandBuffer ) ) );
+
+    entry.state  = state;
+    entry.bValid = true;
+    ++m_stats.uiRecords;
+    return entry.commandBuffer;
+}
+
+void CommandCache::invalidate()
+{
+    for ( Entry& entry : m_entries )
+        entry.bValid = false;
+}
+
+} // namespace retail
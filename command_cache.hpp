@@ -0,0 +1,88 @@
+#ifndef COMMAND_CACHE_19_OCTOBER_2022
+#define COMMAND_CACHE_19_OCTOBER_2022
+
+#include "device_dispatch.hpp"
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+namespace retail
+{
+
+// Secondary command buffers recorded once and replayed while the state they were recorded from
+// is unchanged.
+//
+// Each entry keeps the state key of its last recording - the bytes of every handle, offset and
+// draw the recording depends on.  get() compares the key and only records again when it differs
+// so a frame whose content matches the last one for the same entry costs a compare and an
+// execute.  Handles may be reused once destroyed so invalidate() must be called when anything
+// referenced by a recording is destroyed.
+//
+// An entry is reset when it is recorded again so the caller must ensure the GPU has finished
+// with it - i.e. one entry per frame slot.
+class CommandCache
+{
+public:
+    using Record = std::function< void( vk::CommandBuffer ) >;
+
+    struct Stats
+    {
+        std::uint64_t uiReplays = 0U;
+        std::uint64_t uiRecords = 0U;
+    };
+
+    CommandCache( const DeviceDispatch& dispatch, std::uint32_t uiQueueFamilyIndex, std::uint32_t uiEntries );
+    ~CommandCache();
+
+    CommandCache( const CommandCache& )            = delete;
+    CommandCache& operator=( const CommandCache& ) = delete;
+
+    // appends trivially copyable values to a state key
+    template < typename T >
+    static void appendState( std::vector< std::uint8_t >& state, const T* pValues, std::size_t szCount )
+    {
+        static_assert( std::is_trivially_copyable< T >::value );
+        const std::size_t szOffset = state.size();
+        state.resize( szOffset + sizeof( T ) * szCount );
+        if ( szCount )
+            std::memcpy( state.data() + szOffset, pValues, sizeof( T ) * szCount );
+    }
+
+    // the entry's command buffer to execute within the inherited subpass - fnRecord records its
+    // contents only when state differs from the entry's last recording
+    vk::CommandBuffer get( std::uint32_t                           uiEntry,
+                           const std::vector< std::uint8_t >&      state,
+                           const vk::CommandBufferInheritanceInfo& inheritance,
+                           const Record&                           fnRecord );
+
+    // record every entry again on its next use
+    void invalidate();
+
+    std::uint32_t getEntryCount() const { return static_cast< std::uint32_t >( m_entries.size() ); }
+    const Stats&  getStats() const { return m_stats; }
+    void          resetStats() { m_stats = Stats{}; }
+
+private:
+    struct Entry
+    {
+        vk::CommandBuffer           commandBuffer;
+        std::vector< std::uint8_t > state;
+        bool                        bValid = false;
+    };
+
+    const DeviceDispatch& m_dispatch;
+    vk::Device            m_device;
+    vk::CommandPool       m_commandPool;
+    std::vector< Entry >  m_entries;
+    Stats                 m_stats;
+};
+
+} // namespace retail
+
+#endif // COMMAND_CACHE_19_OCTOBER_2022
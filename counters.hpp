@@ -0,0 +1,64 @@
+#ifndef COUNTERS_19_OCTOBER_2022
+#define COUNTERS_19_OCTOBER_2022
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace retail
+{
+
+// Process wide event counters bumped where the event happens and sampled by diagnostics.
+//
+// The counts are statistics that order nothing so every access is relaxed.  Readers take the
+// difference between two samples to get a per frame or per interval rate.
+enum class Counter : std::uint32_t
+{
+    ePipelineBuilds,
+    eAllocations, // vkAllocateMemory calls
+    eSwapchainBuilds,
+    eEvents, // SDL events polled
+    eValidationWarnings,
+    eValidationErrors,
+};
+
+static constexpr std::uint32_t kCounterCount = static_cast< std::uint32_t >( Counter::eValidationErrors ) + 1U;
+
+namespace detail
+{
+inline std::array< std::atomic< std::uint64_t >, kCounterCount > g_counters{};
+} // namespace detail
+
+inline void count( Counter counter, std::uint64_t uiAmount = 1U )
+{
+    detail::g_counters[ static_cast< std::uint32_t >( counter ) ].fetch_add( uiAmount, std::memory_order_relaxed );
+}
+
+inline std::uint64_t readCounter( Counter counter )
+{
+    return detail::g_counters[ static_cast< std::uint32_t >( counter ) ].load( std::memory_order_relaxed );
+}
+
+inline const char* toString( Counter counter )
+{
+    switch ( counter )
+    {
+        case Counter::ePipelineBuilds:
+            return "pipeline_builds";
+        case Counter::eAllocations:
+            return "allocations";
+        case Counter::eSwapchainBuilds:
+            return "swapchain_builds";
+        case Counter::eEvents:
+            return "events";
+        case Counter::eValidationWarnings:
+            return "validation_warnings";
+        case Counter::eValidationErrors:
+            return "validation_errors";
+    }
+    return "unknown";
+}
+
+} // namespace retail
+
+#endif // COUNTERS_19_OCTOBER_2022
@@ -1,5 +1,6 @@
 
 #include "debug.hpp"
+#include "counters.hpp"
 
 #include "common/assert_verify.hpp"
 
@@ -21,11 +22,13 @@ static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback( VkDebugUtilsMessageSeverity
 
     if ( messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT )
     {
+        retail::count( retail::Counter::eValidationErrors );
         SPDLOG_ERROR( "debugCallback: {}", pCallbackData->pMessage );
         THROW_RTE( "debugCallback: " << pCallbackData->pMessage );
     }
     else if ( messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT )
     {
+        retail::count( retail::Counter::eValidationWarnings );
         SPDLOG_WARN( "debugCallback: {}", pCallbackData->pMessage );
     }
     else if ( messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT )
@@ -0,0 +1,228 @@
+#include "deletion_queue.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+
+namespace retail
+{
+
+namespace
+{
+    template < typename T >
+    T fromHandle( std::uint64_t uiHandle )
+    {
+        return T( reinterpret_cast< typename T::CType >( uiHandle ) );
+    }
+} // namespace
+
+DeletionQueue::DeletionQueue( vk::Device device, const std::vector< Timeline* >& timelines )
+    : m_device( device )
+{
+    for ( Timeline* pTimeline : timelines )
+    {
+        if ( pTimeline )
+            m_timelines.push_back( pTimeline );
+    }
+    VERIFY_RTE_MSG( m_timelines.size() <= kMaxTimelines, "Too many timelines: " << m_timelines.size() );
+}
+
+DeletionQueue::~DeletionQueue()
+{
+    drain();
+}
+
+void DeletionQueue::retire( vk::CommandPool commandPool, vk::CommandBuffer commandBuffer )
+{
+    if ( commandPool && commandBuffer )
+        push( makeEntry( vk::ObjectType::eCommandBuffer, toHandle( commandBuffer ), toHandle( commandPool ) ) );
+}
+
+DeletionQueue::Entry
+DeletionQueue::makeEntry( vk::ObjectType type, std::uint64_t uiHandle, std::uint64_t uiParent ) const
+{
+    Entry entry;
+    entry.type     = type;
+    entry.uiHandle = uiHandle;
+    entry.uiParent = uiParent;
+    // the value the next submit will signal covers commands recorded but not yet submitted
+    for ( std::size_t i = 0; i != m_timelines.size(); ++i )
+        entry.values[ i ] = m_timelines[ i ]->getSubmitted() + 1U;
+    return entry;
+}
+
+DeletionQueue::Entry DeletionQueue::makeEntry( vk::ObjectType  type,
+                                               std::uint64_t   uiHandle,
+                                               std::uint64_t   uiParent,
+                                               const Timeline& timeline,
+                                               std::uint64_t   uiValue ) const
+{
+    const auto it = std::find( m_timelines.begin(), m_timelines.end(), &timeline );
+    VERIFY_RTE_MSG( it != m_timelines.end(), "Retired against a timeline the deletion queue does not track" );
+    VERIFY_RTE_MSG( uiValue <= timeline.getSubmitted(),
+                    "Retired at timeline value: " << uiValue << " that was never submitted" );
+
+    Entry entry;
+    entry.type     = type;
+    entry.uiHandle = uiHandle;
+    entry.uiParent = uiParent;
+    entry.values[ static_cast< std::size_t >( it - m_timelines.begin() ) ] = uiValue;
+    return entry;
+}
+
+DeletionQueue::Entry DeletionQueue::makeOwned( std::shared_ptr< void >&& pOwned ) const
+{
+    Entry entry  = makeEntry( vk::ObjectType::eUnknown, 0U, 0U );
+    entry.pOwned = std::move( pOwned );
+    return entry;
+}
+
+void DeletionQueue::push( Entry&& entry )
+{
+    m_entries.emplace_back( std::move( entry ) );
+    ++m_stats.uiRetired;
+    m_stats.uiMaxPending = std::max< std::uint64_t >( m_stats.uiMaxPending, m_entries.size() );
+}
+
+bool DeletionQueue::isReached( const Entry& entry ) const
+{
+    for ( std::size_t i = 0; i != m_timelines.size(); ++i )
+    {
+        // nothing submitted since the object was retired means no recorded use is still to come
+        const std::uint64_t uiRequired = std::min( entry.values[ i ], m_timelines[ i ]->getSubmitted() );
+        if ( m_completed[ i ] < uiRequired )
+            return false;
+    }
+    return true;
+}
+
+std::uint32_t DeletionQueue::collect()
+{
+    if ( m_entries.empty() )
+        return 0U;
+
+    for ( std::size_t i = 0; i != m_timelines.size(); ++i )
+        m_completed[ i ] = m_timelines[ i ]->getCompleted();
+
+    // in order so an object never outlives one retired after it - tags only grow along the queue
+    // unless a value was given explicitly, which at worst delays the objects behind it
+    std::uint32_t uiDestroyed = 0U;
+    while ( !m_entries.empty() && isReached( m_entries.front() ) )
+    {
+        destroy( m_entries.front() );
+        m_entries.pop_front();
+        ++uiDestroyed;
+    }
+    if ( uiDestroyed )
+        ++m_stats.uiCollects;
+    return uiDestroyed;
+}
+
+void DeletionQueue::drain()
+{
+    if ( m_entries.empty() )
+        return;
+
+    // one wait per timeline for the latest value anything still needs rather than a device wait idle
+    for ( std::size_t i = 0; i != m_timelines.size(); ++i )
+    {
+        std::uint64_t uiRequired = 0U;
+        for ( const Entry& entry : m_entries )
+            uiRequired = std::max( uiRequired, std::min( entry.values[ i ], m_timelines[ i ]->getSubmitted() ) );
+        m_timelines[ i ]->wait( uiRequired );
+        m_completed[ i ] = m_timelines[ i ]->getCompleted();
+    }
+
+    // an owned object's destructor may retire more - those are already reached
+    while ( !m_entries.empty() )
+    {
+        destroy( m_entries.front() );
+        m_entries.pop_front();
+    }
+}
+
+void DeletionQueue::destroy( Entry& entry )
+{
+    ++m_stats.uiDestroyed;
+    if ( entry.pOwned )
+    {
+        entry.pOwned.reset();
+        return;
+    }
+
+    const std::uint64_t uiHandle = entry.uiHandle;
+    switch ( entry.type )
+    {
+        case vk::ObjectType::eBuffer:
+            m_device.destroyBuffer( fromHandle< vk::Buffer >( uiHandle ) );
+            break;
+        case vk::ObjectType::eBufferView:
+            m_device.destroyBufferView( fromHandle< vk::BufferView >( uiHandle ) );
+            break;
+        case vk::ObjectType::eImage:
+            m_device.destroyImage( fromHandle< vk::Image >( uiHandle ) );
+            break;
+        case vk::ObjectType::eImageView:
+            m_device.destroyImageView( fromHandle< vk::ImageView >( uiHandle ) );
+            break;
+        case vk::ObjectType::eDeviceMemory:
+            m_device.freeMemory( fromHandle< vk::DeviceMemory >( uiHandle ) );
+            break;
+        case vk::ObjectType::eSampler:
+            m_device.destroySampler( fromHandle< vk::Sampler >( uiHandle ) );
+            break;
+        case vk::ObjectType::eFramebuffer:
+            m_device.destroyFramebuffer( fromHandle< vk::Framebuffer >( uiHandle ) );
+            break;
+        case vk::ObjectType::eRenderPass:
+            m_device.destroyRenderPass( fromHandle< vk::RenderPass >( uiHandle ) );
+            break;
+        case vk::ObjectType::ePipeline:
+            m_device.destroyPipeline( fromHandle< vk::Pipeline >( uiHandle ) );
+            break;
+        case vk::ObjectType::ePipelineLayout:
+            m_device.destroyPipelineLayout( fromHandle< vk::PipelineLayout >( uiHandle ) );
+            break;
+        case vk::ObjectType::ePipelineCache:
+            m_device.destroyPipelineCache( fromHandle< vk::PipelineCache >( uiHandle ) );
+            break;
+        case vk::ObjectType::eShaderModule:
+            m_device.destroyShaderModule( fromHandle< vk::ShaderModule >( uiHandle ) );
+            break;
+        case vk::ObjectType::eDescriptorSetLayout:
+            m_device.destroyDescriptorSetLayout( fromHandle< vk::DescriptorSetLayout >( uiHandle ) );
+            break;
+        case vk::ObjectType::eDescriptorPool:
+            m_device.destroyDescriptorPool( fromHandle< vk::DescriptorPool >( uiHandle ) );
+            break;
+        case vk::ObjectType::eSemaphore:
+            m_device.destroySemaphore( fromHandle< vk::Semaphore >( uiHandle ) );
+            break;
+        case vk::ObjectType::eFence:
+            m_device.destroyFence( fromHandle< vk::Fence >( uiHandle ) );
+            break;
+        case vk::ObjectType::eEvent:
+            m_device.destroyEvent( fromHandle< vk::Event >( uiHandle ) );
+            break;
+        case vk::ObjectType::eQueryPool:
+            m_device.destroyQueryPool( fromHandle< vk::QueryPool >( uiHandle ) );
+            break;
+        case vk::ObjectType::eCommandPool:
+            m_device.destroyCommandPool( fromHandle< vk::CommandPool >( uiHandle ) );
+            break;
+        case vk::ObjectType::eCommandBuffer:
+            m_device.freeCommandBuffers( fromHandle< vk::CommandPool >( entry.uiParent ),
+                                         fromHandle< vk::CommandBuffer >( uiHandle ) );
+            break;
+        case vk::ObjectType::eSwapchainKHR:
+            m_device.destroySwapchainKHR( fromHandle< vk::SwapchainKHR >( uiHandle ) );
+            break;
+        default:
+            SPDLOG_ERROR( "Deletion queue cannot destroy object type: {}", vk::to_string( entry.type ) );
+            break;
+    }
+}
+
+} // namespace retail
@@ -0,0 +1,119 @@
+#ifndef DELETION_QUEUE_19_OCTOBER_2022
+#define DELETION_QUEUE_19_OCTOBER_2022
+
+#include "timeline.hpp"
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace retail
+{
+
+// Frame deferred destruction of Vulkan objects without device wide stalls.
+//
+// retire() tags an object with the value the next submit on every timeline will signal so work
+// already submitted and work recorded but not yet submitted are both covered.  collect() destroys
+// retired objects in retirement order once every timeline has passed its tag - it must not run
+// between recording a use of a retired object and submitting it, i.e. call it once per frame
+// after waiting for the frame slot.  drain() waits on each timeline for the last tagged value
+// only, never for the whole device, and destroys everything that remains.
+//
+// Owned objects such as a Buffer or a PostChain are retired by moving their unique_ptr in so
+// their destructors run at the same point.
+class DeletionQueue
+{
+public:
+    static constexpr std::uint32_t kMaxTimelines = 4U;
+
+    struct Stats
+    {
+        std::uint64_t uiRetired    = 0U;
+        std::uint64_t uiDestroyed  = 0U;
+        std::uint64_t uiCollects   = 0U; // collect() calls that destroyed something
+        std::uint64_t uiMaxPending = 0U;
+    };
+
+    // the timelines must outlive the queue - null entries are ignored
+    DeletionQueue( vk::Device device, const std::vector< Timeline* >& timelines );
+    ~DeletionQueue();
+
+    DeletionQueue( const DeletionQueue& )            = delete;
+    DeletionQueue& operator=( const DeletionQueue& ) = delete;
+
+    // null handles are ignored
+    template < typename T >
+    void retire( T handle )
+    {
+        if ( handle )
+            push( makeEntry( T::objectType, toHandle( handle ), 0U ) );
+    }
+    // last used by work up to and including uiValue on one timeline - nothing on the others
+    template < typename T >
+    void retire( T handle, const Timeline& timeline, std::uint64_t uiValue )
+    {
+        if ( handle )
+            push( makeEntry( T::objectType, toHandle( handle ), 0U, timeline, uiValue ) );
+    }
+    void retire( vk::CommandPool commandPool, vk::CommandBuffer commandBuffer );
+
+    template < typename T >
+    void retire( std::unique_ptr< T >&& pObject )
+    {
+        if ( pObject )
+            push( makeOwned( std::shared_ptr< void >( std::move( pObject ) ) ) );
+    }
+
+    // destroy objects whose last use the GPU has passed - returns the number destroyed
+    std::uint32_t collect();
+    // wait for the last use of everything retired and destroy it all in order
+    void drain();
+
+    std::size_t  getPending() const { return m_entries.size(); }
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    using Values = std::array< std::uint64_t, kMaxTimelines >;
+
+    struct Entry
+    {
+        Values                  values{}; // per timeline - zero when the timeline never used it
+        vk::ObjectType          type     = vk::ObjectType::eUnknown;
+        std::uint64_t           uiHandle = 0U;
+        std::uint64_t           uiParent = 0U; // command pool of a command buffer
+        std::shared_ptr< void > pOwned;        // owned objects only
+    };
+
+    template < typename T >
+    static std::uint64_t toHandle( T handle )
+    {
+        // pointers on 64 bit and already 64 bit integers on 32 bit platforms
+        return reinterpret_cast< std::uint64_t >( static_cast< typename T::CType >( handle ) );
+    }
+
+    Entry makeEntry( vk::ObjectType type, std::uint64_t uiHandle, std::uint64_t uiParent ) const;
+    Entry makeEntry( vk::ObjectType  type,
+                     std::uint64_t   uiHandle,
+                     std::uint64_t   uiParent,
+                     const Timeline& timeline,
+                     std::uint64_t   uiValue ) const;
+    Entry makeOwned( std::shared_ptr< void >&& pOwned ) const;
+    void  push( Entry&& entry );
+    bool  isReached( const Entry& entry ) const;
+    void  destroy( Entry& entry );
+
+    vk::Device               m_device;
+    std::vector< Timeline* > m_timelines;
+    Values                   m_completed{}; // refreshed by collect()
+    std::deque< Entry >      m_entries;     // in retirement order
+    Stats                    m_stats;
+};
+
+} // namespace retail
+
+#endif // DELETION_QUEUE_19_OCTOBER_2022
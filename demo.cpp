@@ -1,6 +1,11 @@
 
 #include "demo.hpp"
 #include "debug.hpp"
+#include "hash.hpp"
+#include "metrics.hpp"
+#include "quantise.hpp"
+#include "shader.hpp"
+#include "texture_file.hpp"
 
 #include "common/assert_verify.hpp"
 #include "common/file.hpp"
@@ -14,6 +19,11 @@
 #include <vulkan/vulkan_handles.hpp>
 #include <vulkan/vulkan_structs.hpp>
 
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
 #include <vector>
 #include <algorithm>
 #include <string>
@@ -37,11 +47,193 @@ uint32_t to_u32( T value )
 
     return static_cast< uint32_t >( value );
 }
+
+// must match the FrameParams uniform block in shaders/shader.vert
+struct FrameParams
+{
+    float lightDirection[ 4 ];
+    float ambient[ 4 ];
+};
+
+// must match the DrawParams struct in shaders/shader.vert
+struct DrawParams
+{
+    float objectToClip[ 16 ];
+    float tint[ 4 ];
+    float positionScale[ 4 ];
+    float positionOffset[ 4 ];
+};
+
+// must match constant_id 0 in shaders/shader.vert
+constexpr std::uint32_t kShadingLit      = 0U;
+constexpr std::uint32_t kShadingLodDebug = 1U;
+
+// must match constant_id 1 in shaders/shader.frag
+constexpr std::uint32_t kLightingClustered  = 0U;
+constexpr std::uint32_t kLightingBruteForce = 1U;
+
+// point lights scattered through the shelves - the far plane of the light clusters is much closer than
+// the camera's as nothing beyond it is lit enough to matter
+constexpr float                          kMaxLightDistance     = 100.0f;
+constexpr float                          kMinLightRadius       = 1.0f;
+constexpr float                          kMaxLightRadius       = 2.5f;
+constexpr std::array< std::uint32_t, 5 > kBenchmarkLightCounts = { 16U, 64U, 256U, 1024U, 4096U };
+// frames rendered after each lighting benchmark change before timing - the timestamps read back trail
+// the CPU by kFramesInFlight
+constexpr std::uint32_t kBenchmarkWarmupFrames = 8U;
+
+// must match the push_constant block in shaders/shader.vert
+struct MeshPushConstants
+{
+    std::uint32_t uiDrawIndex;
+};
+
+// how often the frame statistics are logged
+constexpr std::uint64_t kStatsFrames = 300U;
+
+// particle fountains through the shelves - each keeps its share of the particles alive
+constexpr std::uint32_t                 kMaxFountains     = 16U;
+constexpr float                         kFountainLifetime = 3.0f;
+constexpr std::array< std::uint32_t, 4 > kFountainColours
+    = { 0xFF40C0FFU, 0xFFFF9040U, 0xFF60FF80U, 0xFFFF60E0U }; // rgba8 with red in the low byte
+// a frame's simulation step is clamped so a stall does not throw every particle across the scene
+constexpr float kMaxParticleStep = 0.1f;
+
+// a price tag is a panel, a product image when there are product textures, four glyphs and a
+// highlight stripe
+constexpr std::uint32_t kSpritesPerPriceTag = 7U;
+constexpr std::uint32_t kGlyphCells         = 8U; // glyph atlas is kGlyphCells x kGlyphCells glyphs
+constexpr std::uint32_t kGlyphCellSize      = 8U;
+
+// the smallest box around every one of boundsList
+retail::Aabb unionBounds( const std::vector< retail::Aabb >& boundsList )
+{
+    retail::Aabb result = boundsList.front();
+    for ( const retail::Aabb& bounds : boundsList )
+    {
+        result.min = retail::Vec3{ std::min( result.min.x, bounds.min.x ),
+                                   std::min( result.min.y, bounds.min.y ),
+                                   std::min( result.min.z, bounds.min.z ) };
+        result.max = retail::Vec3{ std::max( result.max.x, bounds.max.x ),
+                                   std::max( result.max.y, bounds.max.y ),
+                                   std::max( result.max.z, bounds.max.z ) };
+    }
+    return result;
+}
+
+// white rounded rectangle with a one pixel soft edge in the alpha channel
+std::unique_ptr< retail::Texture > createPanelTexture( vk::PhysicalDevice physicalDevice,
+                                                       vk::Device         device,
+                                                       retail::Uploader&  uploader )
+{
+    constexpr std::uint32_t uiSize   = 32U;
+    constexpr float         fRadius  = 6.0f;
+    constexpr float         fHalf    = uiSize * 0.5f;
+
+    auto pTexture = std::make_unique< retail::Texture >(
+        physicalDevice, device, vk::Format::eR8G8B8A8Unorm, vk::Extent2D{ uiSize, uiSize } );
+    std::uint8_t* pTexels = uploader.stage( *pTexture, 0U, uiSize * uiSize * 4U );
+    for ( std::uint32_t y = 0; y != uiSize; ++y )
+    {
+        for ( std::uint32_t x = 0; x != uiSize; ++x )
+        {
+            // signed distance to the rounded rectangle
+            const float fDX       = std::max( std::abs( x + 0.5f - fHalf ) - ( fHalf - fRadius ), 0.0f );
+            const float fDY       = std::max( std::abs( y + 0.5f - fHalf ) - ( fHalf - fRadius ), 0.0f );
+            const float fDistance = std::sqrt( fDX * fDX + fDY * fDY ) - fRadius;
+            const float fAlpha    = std::min( std::max( 0.5f - fDistance, 0.0f ), 1.0f );
+            *pTexels++            = 0xFFU;
+            *pTexels++            = 0xFFU;
+            *pTexels++            = 0xFFU;
+            *pTexels++            = static_cast< std::uint8_t >( fAlpha * 255.0f + 0.5f );
+        }
+    }
+    return pTexture;
+}
+
+// atlas of blocky 5x7 glyphs derived from a hash - stands in for a font
+std::unique_ptr< retail::Texture > createGlyphTexture( vk::PhysicalDevice physicalDevice,
+                                                       vk::Device         device,
+                                                       retail::Uploader&  uploader )
+{
+    constexpr std::uint32_t uiSize = kGlyphCells * kGlyphCellSize;
+
+    auto pTexture = std::make_unique< retail::Texture >(
+        physicalDevice, device, vk::Format::eR8G8B8A8Unorm, vk::Extent2D{ uiSize, uiSize } );
+    std::uint8_t* pTexels = uploader.stage( *pTexture, 0U, uiSize * uiSize * 4U );
+    for ( std::uint32_t y = 0; y != uiSize; ++y )
+    {
+        for ( std::uint32_t x = 0; x != uiSize; ++x )
+        {
+            const std::uint32_t uiGlyph = ( y / kGlyphCellSize ) * kGlyphCells + ( x / kGlyphCellSize );
+            const std::uint64_t uiBits  = retail::fnv1a64( &uiGlyph, sizeof( uiGlyph ) );
+            const std::uint32_t uiX     = x % kGlyphCellSize;
+            const std::uint32_t uiY     = y % kGlyphCellSize;
+            bool                bSet    = false;
+            if ( uiX >= 1U && uiX <= 5U && uiY >= 1U && uiY <= 7U )
+            {
+                // mirror the left half so the glyphs look deliberate
+                const std::uint32_t uiColumn = std::min( uiX - 1U, 5U - uiX );
+                bSet                         = ( uiBits >> ( ( uiY - 1U ) * 3U + uiColumn ) ) & 1U;
+            }
+            *pTexels++ = 0xFFU;
+            *pTexels++ = 0xFFU;
+            *pTexels++ = 0xFFU;
+            *pTexels++ = bSet ? 0xFFU : 0x00U;
+        }
+    }
+    return pTexture;
+}
+
+// single triangle drawn when no mesh catalogue is loaded
+retail::mesh::MeshData createDefaultMesh()
+{
+    using namespace retail::mesh;
+
+    const float positions[ 3 ][ 3 ] = { { 0.0f, 0.5f, 0.0f }, { -0.5f, -0.5f, 0.0f }, { 0.5f, -0.5f, 0.0f } };
+    const float normals[ 3 ][ 3 ]   = { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } };
+    const float uvs[ 3 ][ 2 ]       = { { 0.5f, 0.0f }, { 0.0f, 1.0f }, { 1.0f, 1.0f } };
+
+    MeshData meshData;
+    meshData.strName        = "default";
+    meshData.bounds         = Bounds{ { -0.5f, -0.5f, 0.0f }, { 0.5f, 0.5f, 0.0f } };
+    meshData.vertexFormat   = VertexFormat::eQuantised;
+    meshData.uiVertexStride = sizeof( QuantisedVertex );
+    meshData.uiVertexCount  = 3U;
+    meshData.vertices.resize( 3U * sizeof( QuantisedVertex ) );
+    for ( int i = 0; i != 3; ++i )
+    {
+        const QuantisedVertex vertex = quantiseVertex( meshData.bounds, positions[ i ], normals[ i ], uvs[ i ] );
+        std::memcpy( meshData.vertices.data() + i * sizeof( QuantisedVertex ), &vertex, sizeof( QuantisedVertex ) );
+    }
+    meshData.indexFormat  = IndexFormat::eUInt16;
+    meshData.uiIndexCount = 3U;
+    const std::uint16_t indices[ 3 ] = { 0U, 1U, 2U };
+    meshData.indices.resize( sizeof( indices ) );
+    std::memcpy( meshData.indices.data(), indices, sizeof( indices ) );
+    return meshData;
+}
 } // namespace
 
 namespace retail
 {
 
+bool supportsTimelineSemaphores( const vk::PhysicalDevice& gpu )
+{
+    const auto features
+        = gpu.getFeatures2< vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceTimelineSemaphoreFeatures >();
+    return features.get< vk::PhysicalDeviceTimelineSemaphoreFeatures >().timelineSemaphore == VK_TRUE;
+}
+
+bool supportsPresentWait( const vk::PhysicalDevice& gpu )
+{
+    const auto features = gpu.getFeatures2< vk::PhysicalDeviceFeatures2,
+                                            vk::PhysicalDevicePresentIdFeaturesKHR,
+                                            vk::PhysicalDevicePresentWaitFeaturesKHR >();
+    return features.get< vk::PhysicalDevicePresentIdFeaturesKHR >().presentId == VK_TRUE
+           && features.get< vk::PhysicalDevicePresentWaitFeaturesKHR >().presentWait == VK_TRUE;
+}
+
 bool contains( std::vector< vk::ExtensionProperties > const& extensionProperties,
                const std::set< std::string >&                required )
 {
@@ -59,24 +251,8 @@ bool contains( std::vector< vk::ExtensionProperties > const& extensionProperties
     return true;
 }
 
-void loadShader( const boost::filesystem::path& filePath, std::vector< std::uint32_t >& shaderByteCode )
-{
-    std::ifstream inputFileStream( filePath.native().c_str(), std::ios::in );
-    if ( !inputFileStream.good() )
-    {
-        THROW_RTE( "Failed to open file: " << filePath.string() );
-    }
-
-    // default allocator will ensure alignment for std::uint32_t is ok even though vector for char
-    const std::vector< char > temp{
-        std::istreambuf_iterator< char >( inputFileStream ), std::istreambuf_iterator< char >() };
-    VERIFY_RTE( temp.size() );
-    const std::size_t szSize = ( temp.size() / 4U ) + ( ( temp.size() % 4U > 0U ) ? 1U : 0U );
-    shaderByteCode.resize( szSize );
-    memcpy( shaderByteCode.data(), temp.data(), szSize * sizeof( std::uint32_t ) );
-}
-
-Demo::Demo()
+Demo::Demo( const Config& config )
+    : Application( config )
 {
     // initialise the vulkan-hpp DispatchLoaderDynamic
     {
@@ -89,7 +265,11 @@ Demo::Demo()
 
     std::vector< const char* > required_instance_extensions;
     {
-        m_required_instance_extensions = m_mainWindow.getRequiredSDLVulkanExtensions();
+        for ( const WindowPtr& pWindow : m_windows )
+        {
+            const std::set< std::string > windowExtensions = pWindow->getRequiredSDLVulkanExtensions();
+            m_required_instance_extensions.insert( windowExtensions.begin(), windowExtensions.end() );
+        }
         m_required_instance_extensions.insert( VK_KHR_SURFACE_EXTENSION_NAME );
         m_required_instance_extensions.insert( VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME );
         m_required_instance_extensions.insert( VK_EXT_DEBUG_UTILS_EXTENSION_NAME );
@@ -131,7 +311,9 @@ Demo::Demo()
 
     // initialise the instance
     {
-        vk::ApplicationInfo    app( "Vulkan Demo", {}, "Eds Vulkan Prototype", VK_MAKE_VERSION( 1, 0, 0 ) );
+        // Vulkan 1.2 for timeline semaphores
+        vk::ApplicationInfo app(
+            "Vulkan Demo", {}, "Eds Vulkan Prototype", VK_MAKE_VERSION( 1, 0, 0 ), VK_API_VERSION_1_2 );
         vk::InstanceCreateInfo instance_info( {}, &app, supportedValidationLayers, required_instance_extensions );
         m_instance = vk::createInstanceUnique( instance_info );
         // initialise the dispatcher to get function pointers for instance
@@ -139,9 +321,13 @@ Demo::Demo()
         m_pDebugCallback = std::move( std::make_unique< DebugCallback >( m_instance.get() ) );
     }
 
-    // the surface
-    m_surface = m_mainWindow.createVulkanSurface( m_instance.get() );
-    VERIFY_RTE_MSG( m_surface, "Failed to initialise surface" );
+    // the surfaces - one per window
+    for ( const WindowPtr& pWindow : m_windows )
+    {
+        vk::SurfaceKHR surface = pWindow->createVulkanSurface( m_instance.get() );
+        VERIFY_RTE_MSG( surface, "Failed to initialise surface" );
+        m_surfaces.push_back( surface );
+    }
 
     // select m_graphics_queue_index
     {
@@ -149,7 +335,7 @@ Demo::Demo()
         {
             if ( gpu.getProperties().deviceType == vk::PhysicalDeviceType::eDiscreteGpu )
             {
-                if ( gpu.getFeatures().geometryShader )
+                if ( gpu.getFeatures().geometryShader && supportsTimelineSemaphores( gpu ) )
                 {
                     std::vector< vk::QueueFamilyProperties > queue_family_properties = gpu.getQueueFamilyProperties();
                     if ( queue_family_properties.empty() )
@@ -161,7 +347,12 @@ Demo::Demo()
                     const std::uint32_t uiTotalQueueFamilies = to_u32( queue_family_properties.size() );
                     for ( uint32_t uiQueueIndex = 0; uiQueueIndex < uiTotalQueueFamilies; uiQueueIndex++ )
                     {
-                        if ( const vk::Bool32 supports_present = gpu.getSurfaceSupportKHR( uiQueueIndex, m_surface ) )
+                        // the single queue presents to every window so must support all surfaces
+                        const bool bSupportsPresent = std::all_of(
+                            m_surfaces.cbegin(), m_surfaces.cend(),
+                            [ &gpu, uiQueueIndex ]( vk::SurfaceKHR surface )
+                            { return gpu.getSurfaceSupportKHR( uiQueueIndex, surface ) == VK_TRUE; } );
+                        if ( bSupportsPresent )
                         {
                             // Find a queue family which supports graphics and presentation.
                             const vk::QueueFamilyProperties& prop = queue_family_properties[ uiQueueIndex ];
@@ -182,6 +373,24 @@ Demo::Demo()
         VERIFY_RTE_MSG( m_graphics_queue_index.has_value(), "Failed to find graphics device with required queue" );
     }
 
+    // a compute only family is typically backed by separate hardware queues that overlap graphics work
+    if ( config.bAsyncCompute )
+    {
+        const std::vector< vk::QueueFamilyProperties > queue_family_properties
+            = m_physical_device.getQueueFamilyProperties();
+        for ( std::uint32_t uiQueueIndex = 0; uiQueueIndex != to_u32( queue_family_properties.size() ); ++uiQueueIndex )
+        {
+            const vk::QueueFlags flags = queue_family_properties[ uiQueueIndex ].queueFlags;
+            if ( ( flags & vk::QueueFlagBits::eCompute ) && !( flags & vk::QueueFlagBits::eGraphics ) )
+            {
+                m_compute_queue_index = uiQueueIndex;
+                break;
+            }
+        }
+    }
+    SPDLOG_INFO( "Post processing on: {}",
+                 m_compute_queue_index.has_value() ? "async compute queue" : "graphics queue" );
+
     std::vector< const char* > available_device_extensions;
     {
         for ( const vk::ExtensionProperties& extensionProperty :
@@ -196,6 +405,37 @@ Demo::Demo()
     std::vector< const char* > required_device_extensions;
     {
         required_device_extensions.push_back( VK_KHR_SWAPCHAIN_EXTENSION_NAME );
+        if ( m_physical_device.getProperties().apiVersion < VK_API_VERSION_1_2 )
+        {
+            required_device_extensions.push_back( VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME );
+        }
+    }
+
+    // optional - input latency falls back to GPU completion without them
+    {
+        const auto isAvailable = [ &available_device_extensions ]( const char* pExtension )
+        {
+            return std::find_if( available_device_extensions.cbegin(),
+                                 available_device_extensions.cend(),
+                                 [ pExtension ]( const auto& available )
+                                 { return strcmp( pExtension, available ) == 0; } )
+                   != available_device_extensions.cend();
+        };
+        m_bPresentWait = isAvailable( VK_KHR_PRESENT_ID_EXTENSION_NAME )
+                         && isAvailable( VK_KHR_PRESENT_WAIT_EXTENSION_NAME )
+                         && supportsPresentWait( m_physical_device );
+        if ( m_bPresentWait )
+        {
+            required_device_extensions.push_back( VK_KHR_PRESENT_ID_EXTENSION_NAME );
+            required_device_extensions.push_back( VK_KHR_PRESENT_WAIT_EXTENSION_NAME );
+        }
+
+        // the performance HUD shows device memory use only with it
+        m_bMemoryBudget = isAvailable( VK_EXT_MEMORY_BUDGET_EXTENSION_NAME );
+        if ( m_bMemoryBudget )
+        {
+            required_device_extensions.push_back( VK_EXT_MEMORY_BUDGET_EXTENSION_NAME );
+        }
     }
 
     for ( const char* pRequired : required_device_extensions )
@@ -212,247 +452,263 @@ Demo::Demo()
 
     float queue_priority = 1.0f;
 
-    // Create one queue
-    vk::DeviceQueueCreateInfo queue_info( {}, m_graphics_queue_index.value(), 1, &queue_priority );
+    // one graphics queue and one compute queue for async compute
+    std::vector< vk::DeviceQueueCreateInfo > queue_infos{
+        vk::DeviceQueueCreateInfo( {}, m_graphics_queue_index.value(), 1, &queue_priority ) };
+    if ( m_compute_queue_index.has_value() )
+    {
+        queue_infos.push_back( vk::DeviceQueueCreateInfo( {}, m_compute_queue_index.value(), 1, &queue_priority ) );
+    }
 
-    vk::DeviceCreateInfo device_info( {}, queue_info, {}, required_device_extensions );
+    // product textures are block compressed and only loaded with it
+    vk::PhysicalDeviceFeatures enabled_features;
+    enabled_features.textureCompressionBC = m_physical_device.getFeatures().textureCompressionBC;
+    m_bTextureCompressionBC               = enabled_features.textureCompressionBC == VK_TRUE;
+
+    vk::StructureChain< vk::DeviceCreateInfo,
+                        vk::PhysicalDeviceTimelineSemaphoreFeatures,
+                        vk::PhysicalDevicePresentIdFeaturesKHR,
+                        vk::PhysicalDevicePresentWaitFeaturesKHR >
+        device_info = { vk::DeviceCreateInfo( {}, queue_infos, {}, required_device_extensions, &enabled_features ),
+                        vk::PhysicalDeviceTimelineSemaphoreFeatures( true ),
+                        vk::PhysicalDevicePresentIdFeaturesKHR( true ),
+                        vk::PhysicalDevicePresentWaitFeaturesKHR( true ) };
+    if ( !m_bPresentWait )
+    {
+        device_info.unlink< vk::PhysicalDevicePresentIdFeaturesKHR >();
+        device_info.unlink< vk::PhysicalDevicePresentWaitFeaturesKHR >();
+    }
 
-    m_logical_device = m_physical_device.createDevice( device_info );
+    m_logical_device = m_physical_device.createDevice( device_info.get< vk::DeviceCreateInfo >() );
 
     // initialize function pointers for device
     VULKAN_HPP_DEFAULT_DISPATCHER.init( m_logical_device );
 
-    m_queue = m_logical_device.getQueue( m_graphics_queue_index.value(), 0 );
-
-    // initialise the swap chain - refactor from here for resizing window
-    vk::SurfaceCapabilitiesKHR surface_properties = m_physical_device.getSurfaceCapabilitiesKHR( m_surface );
-
-    std::vector< vk::SurfaceFormatKHR > formats = m_physical_device.getSurfaceFormatsKHR( m_surface );
-
-    const vk::SurfaceCapabilitiesKHR surfaceCapabilities     = m_physical_device.getSurfaceCapabilitiesKHR( m_surface );
-    const std::vector< vk::SurfaceFormatKHR > surfaceFormats = m_physical_device.getSurfaceFormatsKHR( m_surface );
-    const std::vector< vk::PresentModeKHR >   presentModes   = m_physical_device.getSurfacePresentModesKHR( m_surface );
-
-    VERIFY_RTE( !surfaceFormats.empty() );
-    VERIFY_RTE( !presentModes.empty() );
-
-    std::optional< vk::SurfaceFormatKHR > idealFormatOpt;
+    m_queue             = m_logical_device.getQueue( m_graphics_queue_index.value(), 0 );
+    m_pDispatch
+        = std::make_unique< DeviceDispatch >( m_logical_device, VULKAN_HPP_DEFAULT_DISPATCHER.vkGetDeviceProcAddr );
+    m_pGraphicsTimeline = std::make_unique< Timeline >( *m_pDispatch, m_queue );
+    if ( m_compute_queue_index.has_value() )
     {
-        for ( const auto& format : surfaceFormats )
-        {
-            if ( !idealFormatOpt.has_value() )
-                idealFormatOpt = format;
-            if ( format.format == vk::Format::eR32G32B32A32Sfloat /*&& 
-                format.colorSpace == vk::ColorSpaceKHR::eSrgbNonlinear*/ )
-            {
-                SPDLOG_INFO( "Found format and colour space" );
-                idealFormatOpt = format;
-                break;
-            }
-        }
-        VERIFY_RTE_MSG( idealFormatOpt.has_value(), "Failed to find ideal format" );
+        m_computeQueue     = m_logical_device.getQueue( m_compute_queue_index.value(), 0 );
+        m_pComputeTimeline = std::make_unique< Timeline >( *m_pDispatch, m_computeQueue );
     }
+    m_pDeletionQueue = std::make_unique< DeletionQueue >(
+        m_logical_device, std::vector< Timeline* >{ m_pGraphicsTimeline.get(), m_pComputeTimeline.get() } );
 
+    // initialise the swap chains - the first window selects the format which the rest must match
+    for ( std::size_t i = 0; i != m_windows.size(); ++i )
     {
-        uint32_t           windowWidth = 0U, windowHeight = 0U;
-        const vk::Extent2D windowExtent = m_mainWindow.getDrawableSize();
-        m_swapchainExtent
-            = vk::Extent2D{ std::min( std::max( windowExtent.width, surfaceCapabilities.minImageExtent.width ),
-                                      surfaceCapabilities.maxImageExtent.width ),
-                            std::min( std::max( windowExtent.height, surfaceCapabilities.minImageExtent.height ),
-                                      surfaceCapabilities.maxImageExtent.height ) };
-        SPDLOG_INFO( "Created Vulkan Window with width: {} and height: {}", windowWidth, windowHeight );
+        std::optional< vk::SurfaceFormatKHR > requiredFormat;
+        if ( !m_swapchains.empty() )
+            requiredFormat = m_swapchains.front()->getFormat();
+        m_swapchains.emplace_back( std::make_unique< Swapchain >( *m_windows[ i ],
+                                                                  m_physical_device,
+                                                                  m_logical_device,
+                                                                  m_surfaces[ i ],
+                                                                  m_graphics_queue_index.value(),
+                                                                  kFramesInFlight,
+                                                                  requiredFormat ) );
     }
+    const vk::SurfaceFormatKHR& swapchainFormat = m_swapchains.front()->getFormat();
 
-    std::optional< vk::PresentModeKHR > bestPresentationMode;
     {
-        for ( const vk::PresentModeKHR& presentationMode : presentModes )
-        {
-            switch ( presentationMode )
-            {
-                case vk::PresentModeKHR::eImmediate: //= VK_PRESENT_MODE_IMMEDIATE_KHR,
-                    break;
-                case vk::PresentModeKHR::eMailbox: //= VK_PRESENT_MODE_MAILBOX_KHR,
-                    break;
-                case vk::PresentModeKHR::eFifo:                       //= VK_PRESENT_MODE_FIFO_KHR,
-                    bestPresentationMode = vk::PresentModeKHR::eFifo; // guarenteed to be available
-                    break;
-                case vk::PresentModeKHR::eFifoRelaxed: //= VK_PRESENT_MODE_FIFO_RELAXED_KHR,
-                    break;
-                case vk::PresentModeKHR::eSharedDemandRefresh: //= VK_PRESENT_MODE_SHARED_DEMAND_REFRESH_KHR,
-                    break;
-                case vk::PresentModeKHR::eSharedContinuousRefresh: //= VK_PRESENT_MODE_SHARED_CONTINUOUS_REFRESH_KHR
-                    break;
-                default:
-                    break;
-            }
-        }
-        VERIFY_RTE_MSG( bestPresentationMode.has_value(), "Failed to find presentation mode" );
-    }
-
-    {
-        std::array< std::uint32_t, 1 > queues{ m_graphics_queue_index.value() };
-        vk::SwapchainCreateInfoKHR     swapchainCreateInfo{
-            vk::SwapchainCreateFlagsKHR{},
-            m_surface,
-            std::min( surfaceCapabilities.minImageCount + 1, surfaceCapabilities.maxImageCount ),
-            idealFormatOpt.value().format,
-            idealFormatOpt.value().colorSpace,
-            m_swapchainExtent,
-            1, // imageArrayLayers_
-            vk::ImageUsageFlagBits::eColorAttachment,
-            VULKAN_HPP_NAMESPACE::SharingMode::eExclusive,
-            queues,
-            surfaceCapabilities.currentTransform, // vk::SurfaceTransformFlagBitsKHR::eIdentity,
-            vk::CompositeAlphaFlagBitsKHR::eOpaque,
-            bestPresentationMode.value(),
-            true, // clipped_
-            {}    // oldSwapchain_
-        };
+        std::vector< vk::SwapchainKHR > swapchains;
+        for ( const SwapchainPtr& pSwapchain : m_swapchains )
+            swapchains.push_back( pSwapchain->getSwapchain() );
+        m_pLatencyTracker = std::make_unique< LatencyTracker >(
+            *m_pDispatch, m_pGraphicsTimeline->getSemaphore(), std::move( swapchains ), m_bPresentWait );
+    }
+
+    // every shader is created from the one mapped pack
+    m_pShaderPack = std::make_unique< AssetPack >( config.shaderPack );
+    SPDLOG_INFO( "Opened shader pack: {} with {} shaders", config.shaderPack.string(), m_pShaderPack->getEntryCount() );
+
+    // shaders stay loaded so pipeline variants can be built on demand
+    m_meshVertexShader   = createShaderModule( m_logical_device, *m_pShaderPack, "vert.spv" );
+    m_meshFragmentShader = createShaderModule( m_logical_device, *m_pShaderPack, "frag.spv" );
 
-        m_swapchain       = m_logical_device.createSwapchainKHR( swapchainCreateInfo );
-        m_swapChainImages = m_logical_device.getSwapchainImagesKHR( m_swapchain );
+    {
+        // vertex pulling reads the mesh vertices from a storage buffer
+        const std::array< vk::DescriptorSetLayoutBinding, 1 > bindings = { vk::DescriptorSetLayoutBinding{
+            0, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eVertex, nullptr } };
+        m_meshDescriptorSetLayout = m_logical_device.createDescriptorSetLayout(
+            vk::DescriptorSetLayoutCreateInfo{ vk::DescriptorSetLayoutCreateFlags{}, bindings } );
     }
 
-    for ( const vk::Image& image : m_swapChainImages )
     {
-        // clang-format off
-        vk::ImageViewCreateInfo imageViewCreateInfo = 
-        {
-            vk::ImageViewCreateFlags{},
-            image,
-            vk::ImageViewType::e2D,
-            idealFormatOpt.value().format,
-            vk::ComponentMapping{},
-            vk::ImageSubresourceRange
-            {
-                vk::ImageAspectFlagBits::eColor,
-                0, //baseMipLevel
-                1, //levelCount
-                0, //baseArrayLayer_
-                1  //layerCount_
-            }
-        };
-        // clang-format on
-        vk::ImageView imageView = m_logical_device.createImageView( imageViewCreateInfo );
-        m_swapChainImageViews.push_back( imageView );
+        // per window and per draw parameters from the uniform ring selected by dynamic offsets
+        const std::array< vk::DescriptorSetLayoutBinding, 2 > bindings
+            = { vk::DescriptorSetLayoutBinding{ 0,
+                                                vk::DescriptorType::eUniformBufferDynamic,
+                                                1,
+                                                vk::ShaderStageFlagBits::eVertex
+                                                    | vk::ShaderStageFlagBits::eFragment,
+                                                nullptr },
+                vk::DescriptorSetLayoutBinding{
+                    1, vk::DescriptorType::eStorageBufferDynamic, 1, vk::ShaderStageFlagBits::eVertex, nullptr } };
+        m_frameDescriptorSetLayout = m_logical_device.createDescriptorSetLayout(
+            vk::DescriptorSetLayoutCreateInfo{ vk::DescriptorSetLayoutCreateFlags{}, bindings } );
     }
 
-    // load shaders
+    m_pipelineCache = m_logical_device.createPipelineCache( vk::PipelineCacheCreateInfo{} );
 
-    vk::ShaderModule vertexShader;
     {
-        std::vector< std::uint32_t > vertShaderData;
-        loadShader( "vert.spv", vertShaderData );
-        vk::ShaderModuleCreateInfo shaderModuleCreateInfo{ vk::ShaderModuleCreateFlags{}, vertShaderData };
-        vertexShader = m_logical_device.createShaderModule( shaderModuleCreateInfo );
-        SPDLOG_INFO( "Loaded vertex shader: {}", "vert.spv" );
+        // the lighting set is set 2 of the scene's pipeline layout
+        std::vector< vk::Extent2D > extents;
+        for ( const SwapchainPtr& pSwapchain : m_swapchains )
+            extents.push_back( pSwapchain->getExtent() );
+        m_pLightClusters = std::make_unique< LightClusters >( m_physical_device,
+                                                              m_logical_device,
+                                                              m_pipelineCache,
+                                                              *m_pShaderPack,
+                                                              std::max( config.uiLights, kBenchmarkLightCounts.back() ),
+                                                              kFramesInFlight,
+                                                              extents );
+        m_bClusteredLighting         = config.bLightClusters;
+        m_lightingBenchmark.uiFrames = config.uiBenchmarkLightingFrames;
     }
-    vk::ShaderModule fragmentShader;
+
     {
-        std::vector< std::uint32_t > fragShaderData;
-        loadShader( "frag.spv", fragShaderData );
-        vk::ShaderModuleCreateInfo shaderModuleCreateInfo{ vk::ShaderModuleCreateFlags{}, fragShaderData };
-        fragmentShader = m_logical_device.createShaderModule( shaderModuleCreateInfo );
-        SPDLOG_INFO( "Loaded fragment shader: {}", "frag.spv" );
+        const std::array< vk::DescriptorSetLayout, 3 > setLayouts
+            = { m_meshDescriptorSetLayout, m_frameDescriptorSetLayout, m_pLightClusters->getSetLayout() };
+        const std::array< vk::PushConstantRange, 1 > pushConstantRanges
+            = { vk::PushConstantRange{ vk::ShaderStageFlagBits::eVertex, 0, sizeof( MeshPushConstants ) } };
+        vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo
+            = { vk::PipelineLayoutCreateFlags{}, setLayouts, pushConstantRanges };
+        m_pipelineLayout = m_logical_device.createPipelineLayout( pipelineLayoutCreateInfo );
+        SPDLOG_INFO( "Created pipeline layout" );
     }
 
-    const vk::PipelineShaderStageCreateInfo vertShaderCreateInfo = {
-        vk::PipelineShaderStageCreateFlags{},
-        vk::ShaderStageFlagBits::eVertex,
-        vertexShader,
-        "main",
-        {} // pSpecializationInfo_
-    };
+    {
+        // the scene renders in HDR and is left ready for the post chain's compute passes to sample.  With
+        // occlusion culling the late pass loads both attachments and draws over the top, so this pass
+        // already leaves them in the layouts the post chain and the depth pyramid read
+        std::array< vk::AttachmentDescription, 2 > attachments = {
+            vk::AttachmentDescription{
+                vk::AttachmentDescriptionFlags{},       // flags_
+                PostChain::kSceneFormat,                // format_
+                vk::SampleCountFlagBits::e1,            // samples_
+                vk::AttachmentLoadOp::eClear,           // loadOp_
+                vk::AttachmentStoreOp::eStore,          // storeOp_
+                vk::AttachmentLoadOp::eDontCare,        // stencilLoadOp_
+                vk::AttachmentStoreOp::eDontCare,       // stencilStoreOp_
+                vk::ImageLayout::eUndefined,            // initialLayout_
+                vk::ImageLayout::eShaderReadOnlyOptimal // finalLayout_
+            },
+            vk::AttachmentDescription{
+                vk::AttachmentDescriptionFlags{},             // flags_
+                PostChain::kDepthFormat,                      // format_
+                vk::SampleCountFlagBits::e1,                  // samples_
+                vk::AttachmentLoadOp::eClear,                 // loadOp_
+                vk::AttachmentStoreOp::eStore,                // storeOp_
+                vk::AttachmentLoadOp::eDontCare,              // stencilLoadOp_
+                vk::AttachmentStoreOp::eDontCare,             // stencilStoreOp_
+                vk::ImageLayout::eUndefined,                  // initialLayout_
+                vk::ImageLayout::eDepthStencilReadOnlyOptimal // finalLayout_
+            } };
 
-    const vk::PipelineShaderStageCreateInfo fragShaderCreateInfo = {
-        vk::PipelineShaderStageCreateFlags{},
-        vk::ShaderStageFlagBits::eFragment,
-        fragmentShader,
-        "main",
-        {} // pSpecializationInfo_
-    };
+        const std::array< vk::AttachmentReference, 1 > subpassColorAttachments
+            = { vk::AttachmentReference{ 0, vk::ImageLayout::eAttachmentOptimal } };
+        const vk::AttachmentReference subpassDepthAttachment{ 1, vk::ImageLayout::eDepthStencilAttachmentOptimal };
 
-    const std::array< vk::PipelineShaderStageCreateInfo, 2 > shaderStages
-        = { vertShaderCreateInfo, fragShaderCreateInfo };
+        const std::array< vk::SubpassDescription, 1 > subpassDescriptions = { vk::SubpassDescription{
+            vk::SubpassDescriptionFlags{},
+            vk::PipelineBindPoint::eGraphics,
+            {},                      // inputAttachments_
+            subpassColorAttachments, // colorAttachments_
+            {},                      // resolveAttachments_
+            &subpassDepthAttachment, // pDepthStencilAttachment_
+            {}                       // preserveAttachments_
+        } };
 
-    const vk::PipelineVertexInputStateCreateInfo vertexInputCreateInfo = {
-        vk::PipelineVertexInputStateCreateFlags{},
-        {}, // std::vector< VertexInputBindingDescription >
-        {}  // std::vector< VertexInputAttributeDescription >
-    };
+        // clang-format off
+        const std::array< vk::SubpassDependency, 2 > subpassDependencies = 
+        { 
+            // the depth was last read by the slot's previous pyramid reduction
+            vk::SubpassDependency
+            {
+                VK_SUBPASS_EXTERNAL, 
+                0, //
+                vk::PipelineStageFlags{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+                                        | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT }, // srcStageMask_
+                vk::PipelineStageFlags{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+                                        | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT }, // dstStageMask_
+                vk::AccessFlags{}, // srcAccessMask_
+                vk::AccessFlags{ VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+                                 | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT }, // dstAccessMask_
+                vk::DependencyFlags{}
+            },
+            // post processing or the depth pyramid in the same command buffer
+            vk::SubpassDependency
+            {
+                0,
+                VK_SUBPASS_EXTERNAL, //
+                vk::PipelineStageFlags{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+                                        | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT }, // srcStageMask_
+                vk::PipelineStageFlags{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT }, // dstStageMask_
+                vk::AccessFlags{ VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+                                 | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT }, // srcAccessMask_
+                vk::AccessFlags{ VK_ACCESS_SHADER_READ_BIT }, // dstAccessMask_
+                vk::DependencyFlags{}
+            }
+        };
+        // clang-format on
 
-    const vk::PipelineInputAssemblyStateCreateInfo inputAssemblyCreateInfo
-        = { vk::PipelineInputAssemblyStateCreateFlags{}, vk::PrimitiveTopology::eTriangleList, false };
-
-    const vk::Viewport viewport = {
-        0.0f, 0.0f, static_cast< float >( m_swapchainExtent.width ), static_cast< float >( m_swapchainExtent.height ),
-        0.0f, 1.0f };
-
-    const vk::Rect2D scissorRect = { { 0, 0 }, m_swapchainExtent };
-
-    std::array< vk::Viewport, 1 >       viewports{ viewport };
-    std::array< vk::Rect2D, 1 >         scissorRects{ scissorRect };
-    vk::PipelineViewportStateCreateInfo viewportCreateInfo
-        = { vk::PipelineViewportStateCreateFlags{}, viewports, scissorRects };
-
-    vk::PipelineRasterizationStateCreateInfo rasterCreateInfo = {
-        vk::PipelineRasterizationStateCreateFlags{},
-        false, // depthClampEnable_
-        false, // rasterizerDiscardEnable_
-        vk::PolygonMode::eFill,
-        vk::CullModeFlagBits::eBack, // vk::CullModeFlags{},
-        vk::FrontFace::eClockwise,
-        false, // depthBiasEnable_
-        0.0f,  // depthBiasConstantFactor_
-        0.0f,  // depthBiasClamp_
-        0.0f,  // depthBiasSlopeFactor_
-        1.0f   // lineWidth_
-    };
+        vk::RenderPassCreateInfo renderPassCreateInfo
+            = { vk::RenderPassCreateFlags{}, attachments, subpassDescriptions, subpassDependencies };
+        m_renderPass = m_logical_device.createRenderPass( renderPassCreateInfo );
+        SPDLOG_INFO( "Created render pass" );
 
-    vk::PipelineMultisampleStateCreateInfo multisamplingCreateInfo = {
-        vk::PipelineMultisampleStateCreateFlags{},
-        vk::SampleCountFlagBits::e1
-    };
+        // compatible with the first so pipelines and framebuffers are shared
+        for ( vk::AttachmentDescription& attachment : attachments )
+        {
+            attachment.loadOp        = vk::AttachmentLoadOp::eLoad;
+            attachment.initialLayout = attachment.finalLayout;
+        }
 
-    vk::ColorComponentFlags colorComponentFlags( vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG
-                                                 | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA );
-    const std::array< vk::PipelineColorBlendAttachmentState, 1 > attachments
-        = { vk::PipelineColorBlendAttachmentState{ false,                  // blendEnable_
-                                                   vk::BlendFactor::eZero, // srcColorBlendFactor_
-                                                   vk::BlendFactor::eZero, // dstColorBlendFactor_
-                                                   vk::BlendOp::eAdd,      // colorBlendOp_
-                                                   vk::BlendFactor::eZero, // srcAlphaBlendFactor_
-                                                   vk::BlendFactor::eZero, // dstAlphaBlendFactor_
-                                                   vk::BlendOp::eAdd,      // alphaBlendOp_
-                                                   colorComponentFlags } };
-
-    vk::PipelineColorBlendStateCreateInfo colorBlendCreateInfo = { vk::PipelineColorBlendStateCreateFlags{},
-                                                                   false, // logicOpEnable_
-                                                                   vk::LogicOp::eNoOp,
-                                                                   attachments,
-                                                                   { 1.0f, 1.0f, 1.0f, 1.0f } };
-
-    {
-        vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo = { vk::PipelineLayoutCreateFlags{}, {}, {} };
-        m_pipelineLayout = m_logical_device.createPipelineLayout( pipelineLayoutCreateInfo );
-        SPDLOG_INFO( "Created pipeline layout" );
-    }
+        // clang-format off
+        const std::array< vk::SubpassDependency, 2 > lateSubpassDependencies = 
+        { 
+            // the early pass's attachments and the pyramid reduction reading its depth
+            vk::SubpassDependency
+            {
+                VK_SUBPASS_EXTERNAL, 
+                0, //
+                vk::PipelineStageFlags{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+                                        | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT
+                                        | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT }, // srcStageMask_
+                vk::PipelineStageFlags{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+                                        | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT }, // dstStageMask_
+                vk::AccessFlags{ VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+                                 | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT }, // srcAccessMask_
+                vk::AccessFlags{ VK_ACCESS_COLOR_ATTACHMENT_READ_BIT
+                                 | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+                                 | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT
+                                 | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT }, // dstAccessMask_
+                vk::DependencyFlags{}
+            },
+            subpassDependencies[ 1 ]
+        };
+        // clang-format on
 
-    const std::vector< vk::DynamicState > dynamicStates = { vk::DynamicState::eViewport, vk::DynamicState::eScissor };
-    const vk::PipelineDynamicStateCreateInfo dynamicState{ vk::PipelineDynamicStateCreateFlags{}, dynamicStates };
+        m_lateRenderPass = m_logical_device.createRenderPass( vk::RenderPassCreateInfo{
+            vk::RenderPassCreateFlags{}, attachments, subpassDescriptions, lateSubpassDependencies } );
+        SPDLOG_INFO( "Created late render pass" );
+    }
 
     {
+        // the post processed image has been blitted in so the UI loads it and draws over the top
         const std::array< vk::AttachmentDescription, 1 > colorAttachments = { vk::AttachmentDescription{
-            vk::AttachmentDescriptionFlags{}, // flags_
-            idealFormatOpt.value().format,    // format_
-            vk::SampleCountFlagBits::e1,      // samples_
-            vk::AttachmentLoadOp::eClear,     // loadOp_
-            vk::AttachmentStoreOp::eStore,    // storeOp_
-            vk::AttachmentLoadOp::eDontCare,  // stencilLoadOp_
-            vk::AttachmentStoreOp::eDontCare, // stencilStoreOp_
-            vk::ImageLayout::eUndefined,      // initialLayout_
-            vk::ImageLayout::ePresentSrcKHR   // finalLayout_
+            vk::AttachmentDescriptionFlags{},    // flags_
+            swapchainFormat.format,              // format_
+            vk::SampleCountFlagBits::e1,         // samples_
+            vk::AttachmentLoadOp::eLoad,         // loadOp_
+            vk::AttachmentStoreOp::eStore,       // storeOp_
+            vk::AttachmentLoadOp::eDontCare,     // stencilLoadOp_
+            vk::AttachmentStoreOp::eDontCare,    // stencilStoreOp_
+            vk::ImageLayout::eTransferDstOptimal, // initialLayout_
+            vk::ImageLayout::ePresentSrcKHR      // finalLayout_
         } };
 
         const std::array< vk::AttachmentReference, 1 > subpassColorAttachments
@@ -475,10 +731,11 @@ Demo::Demo()
             {
                 VK_SUBPASS_EXTERNAL, 
                 0, //
-                vk::PipelineStageFlags{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT }, // srcStageMask_
+                vk::PipelineStageFlags{ VK_PIPELINE_STAGE_TRANSFER_BIT }, // srcStageMask_
                 vk::PipelineStageFlags{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT }, // dstStageMask_
-                vk::AccessFlags{}, // srcAccessMask_
-                vk::AccessFlags{ VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT }, // dstAccessMask_
+                vk::AccessFlags{ VK_ACCESS_TRANSFER_WRITE_BIT }, // srcAccessMask_
+                vk::AccessFlags{ VK_ACCESS_COLOR_ATTACHMENT_READ_BIT
+                                 | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT }, // dstAccessMask_
                 vk::DependencyFlags{}
             } 
         };
@@ -486,51 +743,51 @@ Demo::Demo()
 
         vk::RenderPassCreateInfo renderPassCreateInfo
             = { vk::RenderPassCreateFlags{}, colorAttachments, subpassDescriptions, subpassDependencies };
-        m_renderPass = m_logical_device.createRenderPass( renderPassCreateInfo );
-        SPDLOG_INFO( "Created render pass" );
+        m_uiRenderPass = m_logical_device.createRenderPass( renderPassCreateInfo );
+        SPDLOG_INFO( "Created UI render pass" );
     }
 
     {
-        vk::GraphicsPipelineCreateInfo pipelineCreateInfo = {
-            vk::PipelineCreateFlags{},
-            shaderStages,
-            &vertexInputCreateInfo,
-            &inputAssemblyCreateInfo,
-            nullptr, // pTessellationState_
-            &viewportCreateInfo,
-            &rasterCreateInfo,
-            &multisamplingCreateInfo,
-            nullptr,
-            &colorBlendCreateInfo,
-            &dynamicState,
-            m_pipelineLayout,
-            m_renderPass,
-            0,
-            {}, // basePipelineHandle_
-            {}  // basePipelineIndex_
-        };
-
-        m_pipeline = m_logical_device.createGraphicsPipeline( nullptr, pipelineCreateInfo ).value;
-        SPDLOG_INFO( "Created pipeline" );
+        // vertices are pulled from storage buffers so there is no vertex input state
+        PipelineVariants::Program program;
+        program.vertexShader          = m_meshVertexShader;
+        program.fragmentShader        = m_meshFragmentShader;
+        program.layout                = m_pipelineLayout;
+        program.renderPass            = m_renderPass;
+        program.uiSpecialisationCount = 2U; // shading mode then lighting mode
+        program.bDepth                = true;
+        m_pMeshPipelines = std::make_unique< PipelineVariants >( m_logical_device, m_pipelineCache, program );
+
+        m_meshVariant.specialisation[ 0 ] = config.bLodDebug ? kShadingLodDebug : kShadingLit;
+        m_meshVariant.specialisation[ 1 ] = m_bClusteredLighting ? kLightingClustered : kLightingBruteForce;
+        m_meshPipeline                    = m_pMeshPipelines->request( m_meshVariant );
     }
 
-    m_logical_device.destroyShaderModule( vertexShader );
-    m_logical_device.destroyShaderModule( fragmentShader );
-
-    for ( const vk::ImageView& imageView : m_swapChainImageViews )
+    for ( SwapchainPtr& pSwapchain : m_swapchains )
     {
-        std::array< vk::ImageView, 1 > attachments{ imageView };
-        vk::FramebufferCreateInfo      frameBufferCreateInfo = {
-            vk::FramebufferCreateFlags{},
-            m_renderPass,
-            attachments,
-            m_swapchainExtent.width,
-            m_swapchainExtent.height,
-            1 // layers
-        };
+        pSwapchain->createFramebuffers( m_uiRenderPass );
+    }
 
-        vk::Framebuffer frameBuffer = m_logical_device.createFramebuffer( frameBufferCreateInfo );
-        m_frameBuffers.push_back( frameBuffer );
+    {
+        // targets are per frame slot so post processing of one frame overlaps the next frame's scene
+        std::vector< std::uint32_t > queueFamilies{ m_graphics_queue_index.value() };
+        if ( m_compute_queue_index.has_value() )
+            queueFamilies.push_back( m_compute_queue_index.value() );
+        std::vector< vk::Extent2D > extents;
+        for ( const SwapchainPtr& pSwapchain : m_swapchains )
+            extents.push_back( pSwapchain->getExtent() );
+        const std::uint32_t uiTimestampValidBits
+            = m_physical_device.getQueueFamilyProperties()[ queueFamilies.back() ].timestampValidBits;
+        m_pPostChain = std::make_unique< PostChain >( m_physical_device,
+                                                      m_logical_device,
+                                                      m_pipelineCache,
+                                                      *m_pShaderPack,
+                                                      m_renderPass,
+                                                      queueFamilies,
+                                                      uiTimestampValidBits,
+                                                      kFramesInFlight,
+                                                      extents,
+                                                      PostChain::Settings{} );
     }
 
     {
@@ -541,73 +798,780 @@ Demo::Demo()
 
     {
         vk::CommandBufferAllocateInfo commandBufferAllocateInfo
-            = { m_commandPool, vk::CommandBufferLevel::ePrimary, 1 };
+            = { m_commandPool, vk::CommandBufferLevel::ePrimary, 2U * kFramesInFlight };
         std::vector< vk::CommandBuffer > result = m_logical_device.allocateCommandBuffers( commandBufferAllocateInfo );
-        m_commandBuffer                         = result.front();
+        for ( std::uint32_t i = 0; i != kFramesInFlight; ++i )
+        {
+            m_frameSlots[ i ].commandBuffer          = result[ 2U * i ];
+            m_frameSlots[ i ].compositeCommandBuffer = result[ 2U * i + 1U ];
+        }
     }
 
+    if ( config.bCommandCache )
     {
+        // an early and a late scene pass per window and frame slot - a slot's entries are only
+        // recorded again once the GPU has finished the slot
+        m_pSceneCommands = std::make_unique< CommandCache >(
+            *m_pDispatch, m_graphics_queue_index.value(), to_u32( m_swapchains.size() ) * kFramesInFlight * 2U );
+    }
+
+    if ( m_compute_queue_index.has_value() )
+    {
+        m_computeCommandPool = m_logical_device.createCommandPool( vk::CommandPoolCreateInfo{
+            vk::CommandPoolCreateFlagBits::eResetCommandBuffer, m_compute_queue_index.value() } );
+        std::vector< vk::CommandBuffer > result = m_logical_device.allocateCommandBuffers(
+            vk::CommandBufferAllocateInfo{ m_computeCommandPool, vk::CommandBufferLevel::ePrimary, kFramesInFlight } );
+        for ( std::uint32_t i = 0; i != kFramesInFlight; ++i )
+        {
+            m_frameSlots[ i ].postCommandBuffer = result[ i ];
+        }
+    }
+
+    {
+        // present only accepts binary semaphores
         vk::SemaphoreCreateInfo semaphoreCreateInfo = { vk::SemaphoreCreateFlags{} };
-        m_imageAvailableSemaphore                   = m_logical_device.createSemaphore( semaphoreCreateInfo );
-        m_renderFinishedSemaphore                   = m_logical_device.createSemaphore( semaphoreCreateInfo );
+        for ( FrameSlot& frameSlot : m_frameSlots )
+        {
+            frameSlot.renderFinishedSemaphore = m_logical_device.createSemaphore( semaphoreCreateInfo );
+        }
     }
+
+    m_pUploader = std::make_unique< Uploader >(
+        m_physical_device, m_logical_device, m_graphics_queue_index.value(), *m_pGraphicsTimeline );
+    m_pFileReader = std::make_unique< AsyncFileReader >(
+        config.bIoUring ? AsyncFileReader::Backend::eIoUring : AsyncFileReader::Backend::eThreadPool,
+        kFileReadQueueDepth,
+        kFileReadThreads );
+
+    if ( !config.meshFile.empty() )
     {
-        vk::FenceCreateInfo fenceCreateInfo = { vk::FenceCreateFlagBits::eSignaled };
-        m_inFlightFence                     = m_logical_device.createFence( fenceCreateInfo );
+        loadMeshes( config.meshFile );
+    }
+    if ( m_meshes.empty() )
+    {
+        m_meshes.emplace_back(
+            std::make_unique< Mesh >( m_physical_device, m_logical_device, createDefaultMesh(), *m_pUploader ) );
+        m_pUploader->flush();
+    }
+    createMeshDescriptorSets();
+
+    // price tags over the shelves drawn through the sprite batch
+    {
+        m_uiPriceTags  = config.uiPriceTags;
+        m_pSpriteBatch = std::make_unique< SpriteBatch >( m_physical_device,
+                                                          m_logical_device,
+                                                          m_uiRenderPass,
+                                                          m_pipelineCache,
+                                                          *m_pShaderPack,
+                                                          *m_pUploader,
+                                                          kFramesInFlight,
+                                                          std::max( m_uiPriceTags * kSpritesPerPriceTag, 1U ) );
+        m_uiSpriteAlphaPipeline    = m_pSpriteBatch->createPipeline( PipelineVariants::Blend::eAlpha );
+        m_uiSpriteAdditivePipeline = m_pSpriteBatch->createPipeline( PipelineVariants::Blend::eAdditive );
+
+        m_textures.emplace_back( createPanelTexture( m_physical_device, m_logical_device, *m_pUploader ) );
+        m_uiPanelTexture = m_pSpriteBatch->addTexture( *m_textures.back() );
+        m_textures.emplace_back( createGlyphTexture( m_physical_device, m_logical_device, *m_pUploader ) );
+        m_uiGlyphTexture = m_pSpriteBatch->addTexture( *m_textures.back() );
+
+        // product images - each mip's blocks are copied from the mapped file into staging as they are
+        if ( !config.textureFiles.empty() && !m_bTextureCompressionBC )
+        {
+            SPDLOG_WARN( "Device does not support BC textures - {} product textures skipped",
+                         config.textureFiles.size() );
+        }
+        else if ( !config.textureFiles.empty() )
+        {
+            vk::DeviceSize blockBytes = 0U, uncompressedBytes = 0U, allocatedBytes = 0U;
+            for ( const boost::filesystem::path& filePath : config.textureFiles )
+            {
+                const TextureFile textureFile( filePath );
+                m_textures.emplace_back(
+                    createTexture( m_physical_device, m_logical_device, *m_pUploader, textureFile ) );
+                m_productTextures.push_back( m_pSpriteBatch->addTexture( *m_textures.back() ) );
+
+                for ( std::uint32_t i = 0; i != textureFile.getMipCount(); ++i )
+                    blockBytes += textureFile.getMipSize( i );
+                uncompressedBytes += textureFile.getUncompressedSize();
+                allocatedBytes += m_textures.back()->getMemorySize();
+                SPDLOG_INFO( "Product texture: {} {}x{} {} mips {}",
+                             filePath.string(),
+                             textureFile.getWidth(),
+                             textureFile.getHeight(),
+                             textureFile.getMipCount(),
+                             vk::to_string( m_textures.back()->getFormat() ) );
+            }
+            SPDLOG_INFO( "Product textures: {} bytes of blocks against {} bytes as rgba8 - {:.1f}x smaller - "
+                         "{} bytes of device memory",
+                         blockBytes,
+                         uncompressedBytes,
+                         static_cast< double >( uncompressedBytes ) / static_cast< double >( blockBytes ),
+                         allocatedBytes );
+        }
+        m_pUploader->flush();
+    }
+
+    // performance overlay - its timestamps bracket the scene on the graphics queue
+    {
+        m_pHud = std::make_unique< PerfHud >(
+            m_physical_device,
+            m_logical_device,
+            m_uiRenderPass,
+            m_pipelineCache,
+            *m_pShaderPack,
+            *m_pUploader,
+            kFramesInFlight,
+            m_physical_device.getQueueFamilyProperties()[ m_graphics_queue_index.value() ].timestampValidBits,
+            m_bMemoryBudget,
+            config.hud );
+        m_pUploader->flush();
+    }
+
+    {
+        std::vector< mesh::Bounds > meshBounds;
+        for ( const MeshPtr& pMesh : m_meshes )
+            meshBounds.push_back( pMesh->getBounds() );
+        m_pWorkers = std::make_unique< WorkerPool >( WorkerPool::getDefaultWorkerCount() );
+        m_pScene   = std::make_unique< Scene >( meshBounds, config.uiInstances );
+    }
+    for ( const Scene::Instance& instance : m_pScene->getInstances() )
+        m_instanceBounds.push_back( m_pScene->getWorldBounds( instance ) );
+    if ( config.bCulling )
+    {
+        // the shelves never move so the hierarchy is built once and never refitted
+        m_pCuller = std::make_unique< BvhCuller >();
+        m_pCuller->build( m_instanceBounds );
+        SPDLOG_INFO( "Culling {} instances through {} hierarchy nodes with the {} kernel",
+                     m_pCuller->getObjectCount(),
+                     m_pCuller->getNodeCount(),
+                     toString( m_pCuller->getKernel() ) );
+    }
+    m_visibleInstances.reserve( m_pScene->getInstances().size() );
+    for ( std::size_t i = 0; i != m_swapchains.size(); ++i )
+    {
+        m_lodSelectors.emplace_back( config.fLodPixelError );
+        m_lodSelectors.back().resize( m_pScene->getInstances().size() );
+    }
+    m_sceneDraws.reserve( m_pScene->getInstances().size() );
+    createFrameDescriptorSet();
+
+    if ( config.bOcclusion )
+    {
+        std::vector< vk::Extent2D >  extents;
+        std::vector< vk::ImageView > depthViews;
+        for ( std::uint32_t i = 0; i != to_u32( m_swapchains.size() ); ++i )
+        {
+            extents.push_back( m_swapchains[ i ]->getExtent() );
+            for ( std::uint32_t uiFrameSlot = 0; uiFrameSlot != kFramesInFlight; ++uiFrameSlot )
+                depthViews.push_back( m_pPostChain->getSceneDepthView( i, uiFrameSlot ) );
+        }
+        m_pOcclusionCuller = std::make_unique< OcclusionCuller >( m_physical_device,
+                                                                  m_logical_device,
+                                                                  m_pipelineCache,
+                                                                  *m_pShaderPack,
+                                                                  m_pUniformRing->get(),
+                                                                  to_u32( m_pScene->getInstances().size() ),
+                                                                  kFramesInFlight,
+                                                                  extents,
+                                                                  depthViews );
+    }
+
+    if ( config.uiParticles )
+    {
+        m_pParticles = std::make_unique< ParticleSystem >( m_physical_device,
+                                                           m_logical_device,
+                                                           m_pipelineCache,
+                                                           *m_pShaderPack,
+                                                           *m_pUploader,
+                                                           m_renderPass,
+                                                           config.uiParticles,
+                                                           kFramesInFlight,
+                                                           to_u32( m_swapchains.size() ) );
+        m_pUploader->flush();
+
+        // spread through the shelves alternating sides, shooting up past the top shelf
+        const Aabb          sceneBounds = unionBounds( m_instanceBounds );
+        const float         fDepth      = sceneBounds.max.z - sceneBounds.min.z;
+        const std::uint32_t uiFountains
+            = std::clamp( static_cast< std::uint32_t >( fDepth / 4.0f ), 1U, kMaxFountains );
+        for ( std::uint32_t i = 0; i != uiFountains; ++i )
+        {
+            const float fAcross = ( i % 2U ) ? 0.25f : 0.75f;
+            const float fAlong  = ( static_cast< float >( i ) + 0.5f ) / static_cast< float >( uiFountains );
+            ParticleSystem::Emitter emitter;
+            emitter.position  = Vec3{ sceneBounds.min.x + ( sceneBounds.max.x - sceneBounds.min.x ) * fAcross,
+                                     0.0f,
+                                     sceneBounds.max.z - fDepth * fAlong };
+            emitter.velocity  = Vec3{ 0.0f, 7.0f, 0.0f };
+            emitter.fSpread   = 1.5f;
+            emitter.fLifetime = kFountainLifetime;
+            emitter.fRate     = static_cast< float >( config.uiParticles ) / ( kFountainLifetime * uiFountains );
+            emitter.uiColour  = kFountainColours[ i % kFountainColours.size() ];
+            m_pParticles->addEmitter( emitter );
+        }
+        SPDLOG_INFO( "Added: {} particle fountains", uiFountains );
+    }
+
+    {
+        // warm and cool lights anywhere in the shelves' bounds - every one is uploaded so the benchmark
+        // can light any count up to the maximum
+        const Aabb                          sceneBounds = unionBounds( m_instanceBounds );
+        const std::uint32_t                 uiLights    = std::max( config.uiLights, kBenchmarkLightCounts.back() );
+        std::vector< LightClusters::Light > lights( uiLights );
+        std::uint32_t                       uiSeed = 0x2545F491U;
+        auto                                random = [ &uiSeed ]()
+        {
+            uiSeed ^= uiSeed << 13U;
+            uiSeed ^= uiSeed >> 17U;
+            uiSeed ^= uiSeed << 5U;
+            return static_cast< float >( uiSeed >> 8U ) / static_cast< float >( 1U << 24U );
+        };
+        for ( LightClusters::Light& light : lights )
+        {
+            light.position[ 0 ] = sceneBounds.min.x + ( sceneBounds.max.x - sceneBounds.min.x ) * random();
+            light.position[ 1 ] = sceneBounds.min.y + ( sceneBounds.max.y - sceneBounds.min.y ) * random();
+            light.position[ 2 ] = sceneBounds.min.z + ( sceneBounds.max.z - sceneBounds.min.z ) * random();
+            light.fRadius       = kMinLightRadius + ( kMaxLightRadius - kMinLightRadius ) * random();
+            const bool bWarm    = random() < 0.5f;
+            light.colour[ 0 ]   = bWarm ? 1.0f : 0.4f;
+            light.colour[ 1 ]   = 0.7f;
+            light.colour[ 2 ]   = bWarm ? 0.4f : 1.0f;
+        }
+        m_pLightClusters->setLights( *m_pUploader, lights );
+        m_pLightClusters->setLightCount( config.uiLights );
+        m_pUploader->flush();
+        SPDLOG_INFO( "Added: {} point lights {} lighting index capacity: {}",
+                     config.uiLights,
+                     m_bClusteredLighting ? "clustered" : "brute force",
+                     m_pLightClusters->getIndexCapacity() );
     }
 }
 
-void Demo::frame()
+void Demo::createFrameDescriptorSet()
 {
-    auto r = m_logical_device.waitForFences( m_inFlightFence, true, UINT64_MAX );
-    VK_CHECK( r );
-    m_logical_device.resetFences( m_inFlightFence );
+    // every window writes one FrameParams and a DrawParams and an occlusion candidate per instance each frame
+    const vk::DeviceSize drawParamsSize = m_pScene->getInstances().size() * sizeof( DrawParams );
+    const vk::DeviceSize candidateSize  = m_pScene->getInstances().size() * sizeof( OcclusionCuller::Candidate );
+    const vk::DeviceSize windowSize
+        = sizeof( FrameParams ) + drawParamsSize + candidateSize + 3U * 256U; // alignment slack
+    const vk::DeviceSize maxRange       = std::max< vk::DeviceSize >( sizeof( FrameParams ), drawParamsSize );
+    m_pUniformRing                      = std::make_unique< UniformRing >(
+        m_physical_device, m_logical_device, kFramesInFlight, windowSize * m_swapchains.size(), maxRange );
+
+    {
+        const std::array< vk::DescriptorPoolSize, 2 > poolSizes
+            = { vk::DescriptorPoolSize{ vk::DescriptorType::eUniformBufferDynamic, 1U },
+                vk::DescriptorPoolSize{ vk::DescriptorType::eStorageBufferDynamic, 1U } };
+        m_frameDescriptorPool = m_logical_device.createDescriptorPool(
+            vk::DescriptorPoolCreateInfo{ vk::DescriptorPoolCreateFlags{}, 1U, poolSizes } );
+    }
+    m_frameDescriptorSet = m_logical_device
+                               .allocateDescriptorSets(
+                                   vk::DescriptorSetAllocateInfo{ m_frameDescriptorPool, m_frameDescriptorSetLayout } )
+                               .front();
+
+    // written once - the ring is selected per window by the dynamic offsets
+    const vk::DescriptorBufferInfo frameBufferInfo{ m_pUniformRing->get(), 0U, sizeof( FrameParams ) };
+    const vk::DescriptorBufferInfo drawBufferInfo{ m_pUniformRing->get(), 0U, drawParamsSize };
+    const std::array< vk::WriteDescriptorSet, 2 > writes
+        = { vk::WriteDescriptorSet{
+                m_frameDescriptorSet, 0, 0, vk::DescriptorType::eUniformBufferDynamic, nullptr, frameBufferInfo },
+            vk::WriteDescriptorSet{
+                m_frameDescriptorSet, 1, 0, vk::DescriptorType::eStorageBufferDynamic, nullptr, drawBufferInfo } };
+    m_logical_device.updateDescriptorSets( writes, nullptr );
+}
 
-    std::uint32_t uiImageIndex = 0;
-    auto          r2           = m_logical_device.acquireNextImageKHR(
-                           m_swapchain, UINT64_MAX, m_imageAvailableSemaphore, VK_NULL_HANDLE, &uiImageIndex );
-    VK_CHECK( r2 );
+void Demo::createMeshDescriptorSets()
+{
+    {
+        const std::array< vk::DescriptorPoolSize, 1 > poolSizes
+            = { vk::DescriptorPoolSize{ vk::DescriptorType::eStorageBuffer, to_u32( m_meshes.size() ) } };
+        m_descriptorPool = m_logical_device.createDescriptorPool(
+            vk::DescriptorPoolCreateInfo{ vk::DescriptorPoolCreateFlags{}, to_u32( m_meshes.size() ), poolSizes } );
+    }
 
-    m_commandBuffer.reset( vk::CommandBufferResetFlagBits{} );
+    const std::vector< vk::DescriptorSetLayout > layouts( m_meshes.size(), m_meshDescriptorSetLayout );
+    m_meshDescriptorSets
+        = m_logical_device.allocateDescriptorSets( vk::DescriptorSetAllocateInfo{ m_descriptorPool, layouts } );
 
-    const vk::CommandBufferBeginInfo commandBufferBeginInfo
-        = { vk::CommandBufferUsageFlagBits::eOneTimeSubmit, nullptr };
-    m_commandBuffer.begin( commandBufferBeginInfo );
+    std::vector< vk::DescriptorBufferInfo > bufferInfos;
+    bufferInfos.reserve( m_meshes.size() );
+    std::vector< vk::WriteDescriptorSet > writes;
+    for ( std::size_t i = 0; i != m_meshes.size(); ++i )
+    {
+        bufferInfos.push_back( vk::DescriptorBufferInfo{ m_meshes[ i ]->getVertexBuffer().get(), 0U, VK_WHOLE_SIZE } );
+        writes.push_back( vk::WriteDescriptorSet{
+            m_meshDescriptorSets[ i ], 0, 0, vk::DescriptorType::eStorageBuffer, nullptr, bufferInfos.back() } );
+    }
+    m_logical_device.updateDescriptorSets( writes, nullptr );
+}
+
+void Demo::loadMeshes( const boost::filesystem::path& meshFilePath )
+{
+    const auto startTime = std::chrono::steady_clock::now();
+
+    // the mapping serves the mesh table - the streams are read through the reader
+    m_pMeshFile = std::make_unique< MeshFile >( meshFilePath );
+    const AsyncFileReader::File file = m_pFileReader->open( meshFilePath );
+    m_pFileReader->resetStats();
+
+    std::int64_t                    iError   = 0;
+    const AsyncFileReader::Callback fnLoaded = [ &iError ]( std::int64_t iResult )
+    {
+        if ( iResult < 0 && iError == 0 )
+            iError = iResult;
+    };
+
+    const vk::DeviceSize uploadedBefore = m_pUploader->getTotalUploaded();
+    for ( std::uint32_t i = 0; i != m_pMeshFile->getMeshCount(); ++i )
+    {
+        const mesh::MeshRecord& record = m_pMeshFile->getMesh( i );
+        VERIFY_RTE_MSG( record.vertexFormat == mesh::VertexFormat::eQuantised,
+                        "Mesh: " << m_pMeshFile->getName( record ) << " in: " << meshFilePath.string()
+                                 << " is not quantised - convert it with mesh_optimiser" );
+        m_meshes.emplace_back( std::make_unique< Mesh >( m_physical_device,
+                                                         m_logical_device,
+                                                         *m_pMeshFile,
+                                                         record,
+                                                         *m_pUploader,
+                                                         *m_pFileReader,
+                                                         file,
+                                                         fnLoaded ) );
+        // keep the disk busy while the next mesh's buffers are created
+        m_pFileReader->poll();
+    }
+    m_pFileReader->wait();
+    m_pFileReader->close( file );
+    if ( iError != 0 )
+    {
+        THROW_RTE( "Failed to read meshes from: " << meshFilePath.string() << " Error: " << strerror( -iError ) );
+    }
+    m_pUploader->flush();
+
+    const auto elapsed
+        = std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::steady_clock::now() - startTime );
+    SPDLOG_INFO( "Loaded {} meshes from: {} staging {} bytes in {}us",
+                 m_meshes.size(),
+                 meshFilePath.string(),
+                 m_pUploader->getTotalUploaded() - uploadedBefore,
+                 elapsed.count() );
+
+    const AsyncFileReader::Stats& stats = m_pFileReader->getStats();
+    SPDLOG_INFO( "Read {} streams through {} in {} pieces {} direct - {:.1f}MB/s queue depth mean {:.1f} max {}",
+                 stats.uiRequests,
+                 AsyncFileReader::toString( m_pFileReader->getBackend() ),
+                 stats.uiPieces,
+                 stats.uiDirect,
+                 stats.getThroughput() / ( 1024.0 * 1024.0 ),
+                 stats.getMeanDepth(),
+                 stats.uiMaxDepth );
+}
+
+void Demo::acquireImages( std::uint32_t uiFrameSlot )
+{
+    const auto startTime = std::chrono::steady_clock::now();
+    const DeviceDispatch& dispatch = *m_pDispatch;
+
+    m_frameWaits.clear();
+    m_frameSwapchains.clear();
+    m_frameImageIndices.clear();
+
+    std::unique_lock< std::mutex > swapchainLock( m_pLatencyTracker->getSwapchainMutex(), std::defer_lock );
+    if ( m_bPresentWait )
+        swapchainLock.lock();
+    for ( const SwapchainPtr& pSwapchain : m_swapchains )
+    {
+        std::uint32_t       uiImageIndex   = 0;
+        const vk::Semaphore imageAvailable = pSwapchain->getImageAvailableSemaphore( uiFrameSlot );
+        const vk::Result    result         = static_cast< vk::Result >(
+            dispatch.acquireNextImage( pSwapchain->getSwapchain(), UINT64_MAX, imageAvailable, uiImageIndex ) );
+        if ( result != vk::Result::eSuboptimalKHR )
+        {
+            VK_CHECK( result );
+        }
+
+        // the first write to the swapchain image is the blit of the post processed output
+        m_frameWaits.push_back( Timeline::Wait{ imageAvailable, 0U, vk::PipelineStageFlagBits::eTransfer } );
+        m_frameSwapchains.push_back( pSwapchain->getSwapchain() );
+        m_frameImageIndices.push_back( uiImageIndex );
+    }
+    if ( m_bPresentWait )
+        swapchainLock.unlock();
+    m_pLatencyTracker->onAcquired();
+    m_frameBlocked += std::chrono::steady_clock::now() - startTime;
+    m_hitchRecorder.mark( HitchRecorder::Stage::eAcquire );
+}
+
+void Demo::recordScene( vk::CommandBuffer commandBuffer, std::uint32_t uiFrameSlot )
+{
+    const DeviceDispatch& dispatch = *m_pDispatch;
+    const Scene::Camera&  camera   = m_pScene->getCamera();
+    const Mat4            view     = lookAt( camera.eye, camera.target, Vec3{ 0.0f, 1.0f, 0.0f } );
+
+    // once for every window - the scene passes draw what it leaves alive
+    if ( m_pParticles )
+        m_pParticles->recordUpdate( dispatch, commandBuffer, uiFrameSlot, m_fDeltaSeconds );
+
+    for ( std::uint32_t i = 0; i != to_u32( m_swapchains.size() ); ++i )
     {
-        const std::array< vk::ClearValue, 1 > clearValues{
-            vk::ClearValue{ vk::ClearColorValue{ std::array< float, 4 >{ 0.0f, 0.0f, 0.5f, 1.0f } } } };
-        const vk::RenderPassBeginInfo renderPassBeginInfo
-            = { m_renderPass, m_frameBuffers[ uiImageIndex ], vk::Rect2D{ { 0, 0 }, m_swapchainExtent }, clearValues };
-        m_commandBuffer.beginRenderPass( renderPassBeginInfo, vk::SubpassContents::eInline );
+        const vk::Extent2D& swapchainExtent = m_swapchains[ i ]->getExtent();
+
+        const float fAspect = static_cast< float >( swapchainExtent.width )
+                              / static_cast< float >( std::max( swapchainExtent.height, 1U ) );
+        const Mat4  viewProjection = perspective( camera.fFovY, fAspect, camera.fNear, camera.fFar ) * view;
+        const float fProjectionScale
+            = static_cast< float >( swapchainExtent.height ) / ( 2.0f * std::tan( camera.fFovY * 0.5f ) );
+        if ( m_pParticles )
+            m_pParticles->setCamera( i, uiFrameSlot, view, viewProjection );
+        m_pLightClusters->setCamera( i, uiFrameSlot, view, camera.fFovY, camera.fNear, kMaxLightDistance );
+        if ( m_bClusteredLighting )
+            m_pLightClusters->recordCull( dispatch, commandBuffer, i, uiFrameSlot );
+
+        LodSelector& lodSelector = m_lodSelectors[ i ];
+        const auto&  instances   = m_pScene->getInstances();
+
+        // compact list of the instances this window draws
         {
-            m_commandBuffer.bindPipeline( vk::PipelineBindPoint::eGraphics, m_pipeline );
+            const auto startTime = std::chrono::steady_clock::now();
+            if ( m_pCuller )
+            {
+                m_pCuller->cull( BvhCuller::extractFrustum( viewProjection ), m_visibleInstances, m_pWorkers.get() );
+            }
+            else
+            {
+                m_visibleInstances.resize( instances.size() );
+                std::iota( m_visibleInstances.begin(), m_visibleInstances.end(), 0U );
+            }
+            m_cullStats.time += std::chrono::steady_clock::now() - startTime;
+            m_cullStats.uiVisible += m_visibleInstances.size();
+            m_cullStats.uiCulled += instances.size() - m_visibleInstances.size();
+        }
 
-            const vk::Viewport viewport = { 0.0f,
-                                            0.0f,
-                                            static_cast< float >( m_swapchainExtent.width ),
-                                            static_cast< float >( m_swapchainExtent.height ),
-                                            0.0f,
-                                            1.0f };
-            m_commandBuffer.setViewport( 0, viewport );
+        // window parameters, every draw's parameters and the occlusion candidates come from bump allocations
+        {
+            const UniformRing::Allocation allocation = m_pUniformRing->allocateUniform( sizeof( FrameParams ) );
+            const FrameParams             frameParams{ { 0.32f, 0.84f, 0.44f, 0.0f }, { 0.2f, 0.2f, 0.25f, 0.0f } };
+            std::memcpy( allocation.pData, &frameParams, sizeof( FrameParams ) );
+            m_frameDynamicOffsets[ 0 ] = allocation.uiOffset;
+        }
+        const UniformRing::Allocation drawAllocation
+            = m_pUniformRing->allocateStorage( instances.size() * sizeof( DrawParams ) );
+        DrawParams* pDrawParams    = reinterpret_cast< DrawParams* >( drawAllocation.pData );
+        m_frameDynamicOffsets[ 1 ] = drawAllocation.uiOffset;
 
-            const std::array< vk::Rect2D, 1 > scissors
-                = { vk::Rect2D{ { 0, 0 }, { m_swapchainExtent.width, m_swapchainExtent.height } } };
-            m_commandBuffer.setScissor( 0, scissors );
+        UniformRing::Allocation candidateAllocation{ nullptr, 0U };
+        if ( m_pOcclusionCuller )
+        {
+            candidateAllocation = m_pUniformRing->allocateStorage( m_visibleInstances.size()
+                                                                   * sizeof( OcclusionCuller::Candidate ) );
+        }
+        OcclusionCuller::Candidate* pCandidates
+            = reinterpret_cast< OcclusionCuller::Candidate* >( candidateAllocation.pData );
+
+        m_sceneDraws.clear();
+        for ( std::uint32_t uiDraw = 0; uiDraw != to_u32( m_visibleInstances.size() ); ++uiDraw )
+        {
+            const std::uint32_t    uiInstance = m_visibleInstances[ uiDraw ];
+            const Scene::Instance& instance   = instances[ uiInstance ];
+            const Mesh&            mesh       = *m_meshes[ instance.uiMesh ];
+
+            const float fDistance
+                = std::max( length( instance.position - camera.eye ) - instance.fRadius, camera.fNear );
+            const std::uint32_t  uiLevel = lodSelector.select( uiInstance,
+                                                              mesh.getLods().data(),
+                                                              to_u32( mesh.getLods().size() ),
+                                                              instance.fScale,
+                                                              fDistance,
+                                                              fProjectionScale );
+            const mesh::MeshLod& lod     = mesh.getLods()[ uiLevel ];
+            m_sceneDraws.push_back( SceneDraw{ instance.uiMesh, lod.uiIndexCount, lod.uiFirstIndex } );
+
+            // quantised position -> object -> world -> clip
+            const mesh::Bounds& bounds = mesh.getBounds();
+            const Mat4          objectToClip
+                = viewProjection * m_pScene->getModelMatrix( instance )
+                  * translation( Vec3{ bounds.min[ 0 ], bounds.min[ 1 ], bounds.min[ 2 ] } )
+                  * scaling( Vec3{ bounds.max[ 0 ] - bounds.min[ 0 ],
+                                   bounds.max[ 1 ] - bounds.min[ 1 ],
+                                   bounds.max[ 2 ] - bounds.min[ 2 ] } );
+            DrawParams& drawParams = pDrawParams[ uiDraw ];
+            std::memcpy( drawParams.objectToClip, objectToClip.m, sizeof( drawParams.objectToClip ) );
+            // the shelves only translate and scale so quantised to world is a scale and an offset
+            const Mat4 objectToWorld = m_pScene->getModelMatrix( instance )
+                                       * translation( Vec3{ bounds.min[ 0 ], bounds.min[ 1 ], bounds.min[ 2 ] } )
+                                       * scaling( Vec3{ bounds.max[ 0 ] - bounds.min[ 0 ],
+                                                        bounds.max[ 1 ] - bounds.min[ 1 ],
+                                                        bounds.max[ 2 ] - bounds.min[ 2 ] } );
+            for ( std::uint32_t c = 0; c != 3U; ++c )
+            {
+                drawParams.positionScale[ c ]  = objectToWorld.m[ c * 5U ];
+                drawParams.positionOffset[ c ] = objectToWorld.m[ 12U + c ];
+            }
+            drawParams.positionScale[ 3 ]  = 0.0f;
+            drawParams.positionOffset[ 3 ] = 0.0f;
+            const std::uint32_t uiHash = uiInstance * 0x9E3779B9U;
+            for ( std::uint32_t c = 0; c != 3U; ++c )
+            {
+                const std::uint32_t uiByte = ( uiHash >> ( 8U + c * 8U ) ) & 0xFFU;
+                drawParams.tint[ c ]       = 0.6f + 0.4f * static_cast< float >( uiByte ) / 255.0f;
+            }
+            drawParams.tint[ 3 ] = static_cast< float >( uiLevel ); // read by the lod debug shading mode
+
+            if ( pCandidates )
+            {
+                const Aabb&                 worldBounds = m_instanceBounds[ uiInstance ];
+                OcclusionCuller::Candidate& candidate   = pCandidates[ uiDraw ];
+                candidate = OcclusionCuller::Candidate{ { worldBounds.min.x, worldBounds.min.y, worldBounds.min.z },
+                                                        lod.uiIndexCount,
+                                                        { worldBounds.max.x, worldBounds.max.y, worldBounds.max.z },
+                                                        lod.uiFirstIndex };
+            }
 
-            m_commandBuffer.draw( 3, 1, 0, 0 );
+            // submitted rather than drawn - occlusion culling decides on the GPU
+            m_lodStats.uiTriangles += lod.uiIndexCount / 3U;
+            m_hudStats.uiTriangles += lod.uiIndexCount / 3U;
+            ++m_lodStats.instancesPerLod[ uiLevel ];
         }
-        m_commandBuffer.endRenderPass();
+
+        if ( m_pOcclusionCuller )
+        {
+            // visible last frame, then whatever this frame's early depth fails to hide
+            const std::uint32_t uiCandidates = to_u32( m_sceneDraws.size() );
+            for ( OcclusionCuller::Phase phase : { OcclusionCuller::Phase::eEarly, OcclusionCuller::Phase::eLate } )
+            {
+                m_pOcclusionCuller->recordTest(
+                    dispatch, commandBuffer, i, uiFrameSlot, phase, candidateAllocation.uiOffset, uiCandidates );
+                recordSceneDraws( commandBuffer, i, uiFrameSlot, phase );
+                m_pOcclusionCuller->recordPyramid( dispatch, commandBuffer, i, uiFrameSlot, viewProjection );
+            }
+        }
+        else
+        {
+            recordSceneDraws( commandBuffer, i, uiFrameSlot, OcclusionCuller::Phase::eEarly );
+        }
+    }
+}
+
+void Demo::recordSceneDraws( vk::CommandBuffer      commandBuffer,
+                             std::uint32_t          uiWindow,
+                             std::uint32_t          uiFrameSlot,
+                             OcclusionCuller::Phase phase )
+{
+    const DeviceDispatch& dispatch        = *m_pDispatch;
+    const vk::Extent2D&   swapchainExtent = m_swapchains[ uiWindow ]->getExtent();
+    const vk::RenderPass  renderPass      = phase == OcclusionCuller::Phase::eLate ? m_lateRenderPass : m_renderPass;
+    const vk::Framebuffer framebuffer     = m_pPostChain->getSceneFramebuffer( uiWindow, uiFrameSlot );
+
+    // the late pass loads what the early pass left
+    const std::array< vk::ClearValue, 2 > clearValues{
+        vk::ClearValue{ vk::ClearColorValue{ std::array< float, 4 >{ 0.0f, 0.0f, 0.5f, 1.0f } } },
+        vk::ClearValue{ vk::ClearDepthStencilValue{ 1.0f, 0U } } };
+    const vk::RenderPassBeginInfo renderPassBeginInfo
+        = { renderPass, framebuffer, vk::Rect2D{ { 0, 0 }, swapchainExtent }, clearValues };
+    m_hudStats.uiDraws += to_u32( m_sceneDraws.size() );
+    ++m_hudStats.uiPipelineBinds;
+    if ( m_pParticles && isLastScenePass( phase ) )
+    {
+        ++m_hudStats.uiDraws;
+        ++m_hudStats.uiPipelineBinds;
+    }
+
+    if ( !m_pSceneCommands )
+    {
+        dispatch.cmdBeginRenderPass( commandBuffer, renderPassBeginInfo, vk::SubpassContents::eInline );
+        recordSceneContents( commandBuffer, uiWindow, uiFrameSlot, phase );
+        dispatch.cmdEndRenderPass( commandBuffer );
+        return;
     }
-    m_commandBuffer.end();
 
-    const vk::PipelineStageFlags flags{ vk::PipelineStageFlagBits::eColorAttachmentOutput };
-    vk::SubmitInfo submitInfo = { m_imageAvailableSemaphore, flags, m_commandBuffer, m_renderFinishedSemaphore };
-    m_queue.submit( submitInfo, m_inFlightFence );
+    // everything the contents are recorded from - per draw parameters are read from the uniform
+    // ring and the occlusion test writes the indirect commands so neither is part of the key.  A
+    // static scene repeats its draws and, as the ring is reset per slot, its dynamic offsets
+    const VkPipeline pipeline = static_cast< VkPipeline >( m_pMeshPipelines->get( m_meshPipeline ) );
+    const VkBuffer   indirect
+        = static_cast< VkBuffer >( m_pOcclusionCuller ? m_pOcclusionCuller->getCommandBuffer() : vk::Buffer{} );
+    const VkFramebuffer   rawFramebuffer     = static_cast< VkFramebuffer >( framebuffer );
+    const VkDescriptorSet frameDescriptorSet = static_cast< VkDescriptorSet >( m_frameDescriptorSet );
+    const std::uint32_t   uiParticleList     = m_pParticles ? m_pParticles->getDrawList() : 0U;
+    m_sceneState.clear();
+    CommandCache::appendState( m_sceneState, &pipeline, 1U );
+    CommandCache::appendState( m_sceneState, &indirect, 1U );
+    CommandCache::appendState( m_sceneState, &rawFramebuffer, 1U );
+    CommandCache::appendState( m_sceneState, &frameDescriptorSet, 1U );
+    CommandCache::appendState( m_sceneState, &swapchainExtent, 1U );
+    CommandCache::appendState( m_sceneState, m_frameDynamicOffsets.data(), m_frameDynamicOffsets.size() );
+    CommandCache::appendState( m_sceneState, m_sceneDraws.data(), m_sceneDraws.size() );
+    CommandCache::appendState( m_sceneState, &uiParticleList, 1U );
+
+    const std::uint32_t uiEntry
+        = ( uiWindow * kFramesInFlight + uiFrameSlot ) * 2U + ( phase == OcclusionCuller::Phase::eLate ? 1U : 0U );
+    const vk::CommandBuffer sceneCommandBuffer = m_pSceneCommands->get(
+        uiEntry,
+        m_sceneState,
+        vk::CommandBufferInheritanceInfo{ renderPass, 0U, framebuffer },
+        [ & ]( vk::CommandBuffer secondaryCommandBuffer )
+        { recordSceneContents( secondaryCommandBuffer, uiWindow, uiFrameSlot, phase ); } );
+
+    dispatch.cmdBeginRenderPass( commandBuffer, renderPassBeginInfo, vk::SubpassContents::eSecondaryCommandBuffers );
+    dispatch.cmdExecuteCommands( commandBuffer, sceneCommandBuffer );
+    dispatch.cmdEndRenderPass( commandBuffer );
+}
+
+void Demo::recordSceneContents( vk::CommandBuffer      commandBuffer,
+                                std::uint32_t          uiWindow,
+                                std::uint32_t          uiFrameSlot,
+                                OcclusionCuller::Phase phase )
+{
+    const DeviceDispatch& dispatch        = *m_pDispatch;
+    const vk::Extent2D&   swapchainExtent = m_swapchains[ uiWindow ]->getExtent();
+
+    dispatch.cmdBindPipeline(
+        commandBuffer, vk::PipelineBindPoint::eGraphics, m_pMeshPipelines->get( m_meshPipeline ) );
+
+    const vk::Viewport viewport = { 0.0f,
+                                    0.0f,
+                                    static_cast< float >( swapchainExtent.width ),
+                                    static_cast< float >( swapchainExtent.height ),
+                                    0.0f,
+                                    1.0f };
+    dispatch.cmdSetViewport( commandBuffer, viewport );
+    dispatch.cmdSetScissor( commandBuffer, vk::Rect2D{ { 0, 0 }, swapchainExtent } );
+    dispatch.cmdBindDescriptorSet( commandBuffer,
+                                   vk::PipelineBindPoint::eGraphics,
+                                   m_pipelineLayout,
+                                   1,
+                                   m_frameDescriptorSet,
+                                   to_u32( m_frameDynamicOffsets.size() ),
+                                   m_frameDynamicOffsets.data() );
+    dispatch.cmdBindDescriptorSet( commandBuffer,
+                                   vk::PipelineBindPoint::eGraphics,
+                                   m_pipelineLayout,
+                                   2,
+                                   m_pLightClusters->getSet( uiWindow, uiFrameSlot ) );
+
+    std::uint32_t uiBoundMesh = std::numeric_limits< std::uint32_t >::max();
+    for ( std::uint32_t uiDraw = 0; uiDraw != to_u32( m_sceneDraws.size() ); ++uiDraw )
+    {
+        const SceneDraw& draw = m_sceneDraws[ uiDraw ];
+        if ( draw.uiMesh != uiBoundMesh )
+        {
+            const Mesh& mesh = *m_meshes[ draw.uiMesh ];
+            dispatch.cmdBindDescriptorSet( commandBuffer,
+                                           vk::PipelineBindPoint::eGraphics,
+                                           m_pipelineLayout,
+                                           0,
+                                           m_meshDescriptorSets[ draw.uiMesh ] );
+            dispatch.cmdBindIndexBuffer( commandBuffer, mesh.getIndexBuffer().get(), 0, mesh.getIndexType() );
+            uiBoundMesh = draw.uiMesh;
+        }
 
-    // const std::array< std::uint32_t, 1 > imageIndices{ uiImageIndex };
-    const vk::PresentInfoKHR presentInfo = { m_renderFinishedSemaphore, m_swapchain, uiImageIndex };
+        const MeshPushConstants pushConstants{ uiDraw };
+        dispatch.cmdPushConstants( commandBuffer,
+                                   m_pipelineLayout,
+                                   vk::ShaderStageFlagBits::eVertex,
+                                   0,
+                                   sizeof( MeshPushConstants ),
+                                   &pushConstants );
+        if ( m_pOcclusionCuller )
+        {
+            // an instance count of zero when the test rejected it
+            dispatch.cmdDrawIndexedIndirect(
+                commandBuffer,
+                m_pOcclusionCuller->getCommandBuffer(),
+                m_pOcclusionCuller->getCommandOffset( uiWindow, uiFrameSlot, phase, uiDraw ) );
+        }
+        else
+        {
+            dispatch.cmdDrawIndexed( commandBuffer, draw.uiIndexCount, 1, draw.uiFirstIndex, 0, 0 );
+        }
+    }
 
-    vk::Result result = m_queue.presentKHR( presentInfo );
+    // blended over everything opaque so only in the window's last pass
+    if ( m_pParticles && isLastScenePass( phase ) )
+        m_pParticles->recordDraw( dispatch, commandBuffer, uiWindow, uiFrameSlot );
+}
+
+void Demo::recordComposite( vk::CommandBuffer commandBuffer, std::uint32_t uiPostFrameSlot )
+{
+    const DeviceDispatch& dispatch = *m_pDispatch;
+
+    // the swapchain contents are replaced entirely so the previous layout is discarded
+    std::array< vk::ImageMemoryBarrier, 1 > barriers;
+    for ( std::size_t i = 0; i != m_swapchains.size(); ++i )
+    {
+        const Swapchain&    swapchain = *m_swapchains[ i ];
+        const vk::Extent2D& extent    = swapchain.getExtent();
+        const vk::Image     image     = swapchain.getImage( m_frameImageIndices[ i ] );
+
+        barriers[ 0 ] = vk::ImageMemoryBarrier{
+            vk::AccessFlags{},
+            vk::AccessFlagBits::eTransferWrite,
+            vk::ImageLayout::eUndefined,
+            vk::ImageLayout::eTransferDstOptimal,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            image,
+            vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, 0U, 1U, 0U, 1U } };
+        dispatch.cmdPipelineBarrier( commandBuffer,
+                                     vk::PipelineStageFlagBits::eTransfer,
+                                     vk::PipelineStageFlagBits::eTransfer,
+                                     0U,
+                                     nullptr,
+                                     to_u32( barriers.size() ),
+                                     barriers.data() );
+
+        // same extent so the blit only converts to the swapchain format
+        const vk::ImageSubresourceLayers subresource{ vk::ImageAspectFlagBits::eColor, 0U, 0U, 1U };
+        const std::array< vk::Offset3D, 2 > offsets{ vk::Offset3D{ 0, 0, 0 },
+                                                     vk::Offset3D{ static_cast< std::int32_t >( extent.width ),
+                                                                   static_cast< std::int32_t >( extent.height ),
+                                                                   1 } };
+        dispatch.cmdBlitImage( commandBuffer,
+                               m_pPostChain->getOutput( static_cast< std::uint32_t >( i ), uiPostFrameSlot ),
+                               vk::ImageLayout::eGeneral,
+                               image,
+                               vk::ImageLayout::eTransferDstOptimal,
+                               vk::ImageBlit{ subresource, offsets, subresource, offsets },
+                               vk::Filter::eNearest );
+
+        const vk::RenderPassBeginInfo renderPassBeginInfo = { m_uiRenderPass,
+                                                              swapchain.getFramebuffer( m_frameImageIndices[ i ] ),
+                                                              vk::Rect2D{ { 0, 0 }, extent },
+                                                              nullptr };
+        dispatch.cmdBeginRenderPass( commandBuffer, renderPassBeginInfo, vk::SubpassContents::eInline );
+        m_pSpriteBatch->record( dispatch, commandBuffer, extent );
+        m_pHud->record( dispatch, commandBuffer, extent );
+        dispatch.cmdEndRenderPass( commandBuffer );
+    }
+}
+
+void Demo::present( std::uint32_t uiFrameSlot )
+{
+    const auto            startTime = std::chrono::steady_clock::now();
+    const DeviceDispatch& dispatch  = *m_pDispatch;
+    const FrameSlot&      frameSlot = m_frameSlots[ uiFrameSlot ];
+
+    // present every swapchain in a single call
+    m_framePresentResults.resize( m_frameSwapchains.size() );
+    vk::PresentInfoKHR presentInfo
+        = { frameSlot.renderFinishedSemaphore, m_frameSwapchains, m_frameImageIndices, m_framePresentResults };
+
+    // frames carrying input are tagged so the latency tracker can wait for them to reach the screen
+    vk::PresentIdKHR presentIdInfo;
+    if ( const std::uint64_t uiPresentId = m_pLatencyTracker->getPresentId() )
+    {
+        m_framePresentIds.assign( m_frameSwapchains.size(), uiPresentId );
+        presentIdInfo = vk::PresentIdKHR{ m_framePresentIds };
+        presentInfo.setPNext( &presentIdInfo );
+    }
+
+    std::unique_lock< std::mutex > swapchainLock( m_pLatencyTracker->getSwapchainMutex(), std::defer_lock );
+    if ( m_bPresentWait )
+        swapchainLock.lock();
+    const vk::Result result = static_cast< vk::Result >( dispatch.queuePresent( m_queue, presentInfo ) );
+    if ( m_bPresentWait )
+        swapchainLock.unlock();
+    m_pLatencyTracker->onPresented();
     switch ( result )
     {
         case vk::Result::eSuccess:
@@ -619,54 +1583,634 @@ void Demo::frame()
             VK_CHECK( result );
             break;
     }
+    for ( std::size_t i = 0; i != m_framePresentResults.size(); ++i )
+    {
+        if ( m_framePresentResults[ i ] == vk::Result::eSuboptimalKHR )
+        {
+            SPDLOG_INFO( "present returned vk::Result::eSuboptimalKHR for window: {}",
+                         m_swapchains[ i ]->getWindow().getID() );
+        }
+    }
+    m_frameBlocked += std::chrono::steady_clock::now() - startTime;
+    m_hitchRecorder.mark( HitchRecorder::Stage::ePresent );
 }
 
-Demo::~Demo()
+void Demo::frame()
 {
-    if ( m_imageAvailableSemaphore )
+    const std::uint32_t uiFrameSlot = static_cast< std::uint32_t >( m_uiFrame % kFramesInFlight );
+    FrameSlot&          frameSlot   = m_frameSlots[ uiFrameSlot ];
+
+    // input polled since the previous frame affects this one
+    const std::optional< LatencyTracker::TimePoint > input = consumeInput();
+
+    // the slot is free once the GPU passes the value its last submit signalled - this only
+    // blocks when the CPU is a full kFramesInFlight frames ahead.  With async compute the last
+    // submit is the composite which waited for the slot's post processing
+    m_pGraphicsTimeline->wait( frameSlot.uiTimelineValue );
+    m_pUploader->collect();
+    m_pDeletionQueue->collect();
+    m_pUniformRing->begin( uiFrameSlot );
+    m_pPostChain->collectTimings( uiFrameSlot );
+    if ( m_pOcclusionCuller )
+        m_pOcclusionCuller->collectStats( uiFrameSlot );
+    if ( m_pParticles )
+        m_pParticles->collectStats( uiFrameSlot );
+    m_pLightClusters->collectStats( uiFrameSlot );
+    // the slot's previous frame - kFramesInFlight behind the CPU time it is graphed with
+    const double fSceneMS = m_pHud->collectTimer( uiFrameSlot );
+    if ( m_lightingBenchmark.uiFrames )
+        stepLightingBenchmark( fSceneMS );
+    m_hudStats.fGpuMS     = fSceneMS >= 0.0 ? fSceneMS + m_pPostChain->getLastFrameMS() : -1.0;
+    m_hitchRecorder.mark( HitchRecorder::Stage::eWait );
+    const auto cpuStartTime = std::chrono::steady_clock::now();
+
+    const DeviceDispatch& dispatch      = *m_pDispatch;
+    vk::CommandBuffer     commandBuffer = frameSlot.commandBuffer;
+
+    const float fTime = getTime();
+    m_fDeltaSeconds   = std::clamp( fTime - m_fLastTime, 0.0f, kMaxParticleStep );
+    m_fLastTime       = fTime;
+    m_pScene->update( fTime, m_pWorkers.get() );
+    addPriceTags( uiFrameSlot, fTime );
+    m_pHud->update( uiFrameSlot, m_swapchains.front()->getExtent() );
+    m_hitchRecorder.mark( HitchRecorder::Stage::eUpdate );
+
+    const vk::CommandBufferBeginInfo commandBufferBeginInfo
+        = { vk::CommandBufferUsageFlagBits::eOneTimeSubmit, nullptr };
+    if ( m_pComputeTimeline )
     {
-        m_logical_device.destroySemaphore( m_imageAvailableSemaphore );
+        // this frame's scene renders and its post processing is queued on the compute queue, then the
+        // previous frame is composited and presented.  The compute work overlaps the next frame's scene
+        // at the cost of one frame of latency
+        VK_CHECK( static_cast< vk::Result >( dispatch.resetCommandBuffer( commandBuffer ) ) );
+        VK_CHECK( static_cast< vk::Result >( dispatch.beginCommandBuffer( commandBuffer, commandBufferBeginInfo ) ) );
+        m_pHud->beginTimer( dispatch, commandBuffer, uiFrameSlot );
+        recordScene( commandBuffer, uiFrameSlot );
+        m_pHud->endTimer( dispatch, commandBuffer, uiFrameSlot );
+        VK_CHECK( static_cast< vk::Result >( dispatch.endCommandBuffer( commandBuffer ) ) );
+
+        const vk::CommandBuffer postCommandBuffer = frameSlot.postCommandBuffer;
+        VK_CHECK( static_cast< vk::Result >( dispatch.resetCommandBuffer( postCommandBuffer ) ) );
+        VK_CHECK(
+            static_cast< vk::Result >( dispatch.beginCommandBuffer( postCommandBuffer, commandBufferBeginInfo ) ) );
+        m_pPostChain->record( dispatch, postCommandBuffer, uiFrameSlot );
+        VK_CHECK( static_cast< vk::Result >( dispatch.endCommandBuffer( postCommandBuffer ) ) );
+        m_pUniformRing->flush();
+        m_hitchRecorder.mark( HitchRecorder::Stage::eRecord );
+
+        frameSlot.uiTimelineValue = m_pGraphicsTimeline->submit( commandBuffer, nullptr, nullptr );
+        frameSlot.uiPostValue     = m_pComputeTimeline->submit(
+            postCommandBuffer,
+            m_pGraphicsTimeline->waitFor( frameSlot.uiTimelineValue, vk::PipelineStageFlagBits::eComputeShader ),
+            nullptr );
+        m_hitchRecorder.mark( HitchRecorder::Stage::eSubmit );
+
+        if ( m_pendingComposite )
+        {
+            const PendingComposite pending     = m_pendingComposite.value();
+            FrameSlot&             pendingSlot = m_frameSlots[ pending.uiFrameSlot ];
+
+            acquireImages( uiFrameSlot );
+            const vk::CommandBuffer compositeCommandBuffer = frameSlot.compositeCommandBuffer;
+            VK_CHECK( static_cast< vk::Result >( dispatch.resetCommandBuffer( compositeCommandBuffer ) ) );
+            VK_CHECK( static_cast< vk::Result >(
+                dispatch.beginCommandBuffer( compositeCommandBuffer, commandBufferBeginInfo ) ) );
+            recordComposite( compositeCommandBuffer, pending.uiFrameSlot );
+            VK_CHECK( static_cast< vk::Result >( dispatch.endCommandBuffer( compositeCommandBuffer ) ) );
+            m_hitchRecorder.mark( HitchRecorder::Stage::eRecord );
+
+            // the pending slot is reused once its composite completes
+            m_frameWaits.push_back(
+                m_pComputeTimeline->waitFor( pendingSlot.uiPostValue, vk::PipelineStageFlagBits::eTransfer ) );
+            pendingSlot.uiTimelineValue = m_pGraphicsTimeline->submit(
+                compositeCommandBuffer, m_frameWaits, frameSlot.renderFinishedSemaphore );
+            m_pLatencyTracker->onSubmitted( pending.input, pendingSlot.uiTimelineValue );
+            m_hitchRecorder.mark( HitchRecorder::Stage::eSubmit );
+
+            present( uiFrameSlot );
+        }
+        m_pendingComposite = PendingComposite{ uiFrameSlot, input };
     }
-    if ( m_renderFinishedSemaphore )
+    else
     {
-        m_logical_device.destroySemaphore( m_renderFinishedSemaphore );
+        acquireImages( uiFrameSlot );
+
+        VK_CHECK( static_cast< vk::Result >( dispatch.resetCommandBuffer( commandBuffer ) ) );
+        VK_CHECK( static_cast< vk::Result >( dispatch.beginCommandBuffer( commandBuffer, commandBufferBeginInfo ) ) );
+        m_pHud->beginTimer( dispatch, commandBuffer, uiFrameSlot );
+        recordScene( commandBuffer, uiFrameSlot );
+        m_pHud->endTimer( dispatch, commandBuffer, uiFrameSlot );
+        m_pPostChain->record( dispatch, commandBuffer, uiFrameSlot );
+        {
+            const vk::MemoryBarrier barrier{ vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eTransferRead };
+            dispatch.cmdPipelineBarrier( commandBuffer,
+                                         vk::PipelineStageFlagBits::eComputeShader,
+                                         vk::PipelineStageFlagBits::eTransfer,
+                                         1U,
+                                         &barrier,
+                                         0U,
+                                         nullptr );
+        }
+        recordComposite( commandBuffer, uiFrameSlot );
+        VK_CHECK( static_cast< vk::Result >( dispatch.endCommandBuffer( commandBuffer ) ) );
+        m_pUniformRing->flush();
+        m_hitchRecorder.mark( HitchRecorder::Stage::eRecord );
+
+        frameSlot.uiTimelineValue
+            = m_pGraphicsTimeline->submit( commandBuffer, m_frameWaits, frameSlot.renderFinishedSemaphore );
+        m_pLatencyTracker->onSubmitted( input, frameSlot.uiTimelineValue );
+        m_hitchRecorder.mark( HitchRecorder::Stage::eSubmit );
+
+        present( uiFrameSlot );
     }
-    if ( m_inFlightFence )
+
     {
-        m_logical_device.destroyFence( m_inFlightFence );
+        const SpriteBatch::Stats& spriteStats = m_pSpriteBatch->getStats();
+        m_hudStats.uiDraws += spriteStats.uiDraws;
+        m_hudStats.uiPipelineBinds += spriteStats.uiPipelineBinds;
+        m_hudStats.fCpuMS = std::chrono::duration< double, std::milli >( std::chrono::steady_clock::now()
+                                                                          - cpuStartTime - m_frameBlocked )
+                                .count();
+        m_pHud->addFrame( m_hudStats );
+        observe( Histogram::eFrameCpu,
+                 std::chrono::duration_cast< std::chrono::microseconds >(
+                     std::chrono::duration< double, std::milli >( m_hudStats.fCpuMS ) ) );
+        if ( m_hudStats.fGpuMS >= 0.0 )
+        {
+            observe( Histogram::eFrameGpu,
+                     std::chrono::duration_cast< std::chrono::microseconds >(
+                         std::chrono::duration< double, std::milli >( m_hudStats.fGpuMS ) ) );
+        }
+        m_hudStats     = PerfHud::FrameStats{};
+        m_frameBlocked = {};
     }
-    if ( m_commandPool )
+
+    ++m_uiFrame;
+
+    if ( m_uiFrame % kStatsFrames == 0U )
     {
-        m_logical_device.destroyCommandPool( m_commandPool );
+        std::string strHistogram;
+        for ( std::uint64_t uiCount : m_lodStats.instancesPerLod )
+            strHistogram += std::to_string( uiCount / kStatsFrames ) + " ";
+        SPDLOG_INFO( "Frame: {} triangles per frame: {} instances per lod: {}",
+                     m_uiFrame,
+                     m_lodStats.uiTriangles / kStatsFrames,
+                     strHistogram );
+        SPDLOG_INFO( "Culling per frame visible: {} culled: {} CPU: {:.3f}ms",
+                     m_cullStats.uiVisible / kStatsFrames,
+                     m_cullStats.uiCulled / kStatsFrames,
+                     std::chrono::duration< double, std::milli >( m_cullStats.time ).count() / kStatsFrames );
+        if ( m_pOcclusionCuller && m_pOcclusionCuller->getStats().uiFrames )
+        {
+            // read back from the GPU so the frames trail the CPU culling by up to kFramesInFlight
+            const OcclusionCuller::Stats& occlusionStats = m_pOcclusionCuller->getStats();
+            const std::uint64_t           uiDrawn        = occlusionStats.uiEarly + occlusionStats.uiLate;
+            const std::uint64_t           uiOccluded     = occlusionStats.uiTested - uiDrawn;
+            const std::uint64_t           uiInstances
+                = occlusionStats.uiFrames * m_pScene->getInstances().size() * m_swapchains.size();
+            SPDLOG_INFO( "Occlusion per frame tested: {} early: {} late: {} occluded: {} ({:.1f}%) - all culling "
+                         "removes {:.1f}% of instances",
+                         occlusionStats.uiTested / occlusionStats.uiFrames,
+                         occlusionStats.uiEarly / occlusionStats.uiFrames,
+                         occlusionStats.uiLate / occlusionStats.uiFrames,
+                         uiOccluded / occlusionStats.uiFrames,
+                         occlusionStats.uiTested ? 100.0 * uiOccluded / occlusionStats.uiTested : 0.0,
+                         uiInstances ? 100.0 * ( uiInstances - uiDrawn ) / uiInstances : 0.0 );
+            m_pOcclusionCuller->resetStats();
+        }
+        if ( m_pParticles && m_pParticles->getStats().uiFrames )
+        {
+            const ParticleSystem::Stats& particleStats = m_pParticles->getStats();
+            SPDLOG_INFO( "Particles alive per frame: {} most: {} of: {}",
+                         particleStats.uiAlive / particleStats.uiFrames,
+                         particleStats.uiMaxAlive,
+                         m_pParticles->getMaxParticles() );
+            m_pParticles->resetStats();
+        }
+        if ( m_pLightClusters->getStats().uiFrames )
+        {
+            const LightClusters::Stats& lightStats = m_pLightClusters->getStats();
+            SPDLOG_INFO( "Light clusters per frame lights: {} indices: {} of: {} per window overflows: {}",
+                         m_pLightClusters->getLightCount(),
+                         lightStats.uiIndices / lightStats.uiFrames,
+                         m_pLightClusters->getIndexCapacity(),
+                         lightStats.uiOverflows );
+            m_pLightClusters->resetStats();
+        }
+
+        const SpriteBatch::Stats& spriteStats = m_pSpriteBatch->getStats();
+        SPDLOG_INFO( "Sprites: {} dropped: {} batches: {} draws: {} pipeline binds: {} texture binds: {} bytes "
+                     "streamed: {}",
+                     spriteStats.uiSprites,
+                     spriteStats.uiDropped,
+                     spriteStats.uiBatches,
+                     spriteStats.uiDraws,
+                     spriteStats.uiPipelineBinds,
+                     spriteStats.uiTextureBinds,
+                     spriteStats.bytesStreamed );
+        SPDLOG_INFO( "Uniform ring: {} of {} bytes used high water mark: {}",
+                     m_pUniformRing->getFrameUsed(),
+                     m_pUniformRing->getFrameSize(),
+                     m_pUniformRing->getHighWaterMark() );
+        if ( m_pSceneCommands )
+        {
+            const CommandCache::Stats& commandStats = m_pSceneCommands->getStats();
+            SPDLOG_INFO( "Scene command buffers replayed: {} recorded: {}",
+                         commandStats.uiReplays,
+                         commandStats.uiRecords );
+            m_pSceneCommands->resetStats();
+        }
+
+        const std::array< const char*, LatencyTracker::kStageCount > stageNames
+            = { "submit", m_bPresentWait ? "present" : "gpu complete", "next acquire" };
+        for ( std::uint32_t i = 0; i != LatencyTracker::kStageCount; ++i )
+        {
+            const LatencyHistogram histogram
+                = m_pLatencyTracker->getHistogram( static_cast< LatencyTracker::Stage >( i ) );
+            if ( histogram.getCount() == 0U )
+                continue;
+            SPDLOG_INFO( "Input to {} latency over: {} frames p50: {}us p90: {}us p99: {}us max: {}us",
+                         stageNames[ i ],
+                         histogram.getCount(),
+                         histogram.getPercentileUS( 50.0f ),
+                         histogram.getPercentileUS( 90.0f ),
+                         histogram.getPercentileUS( 99.0f ),
+                         histogram.getMaxUS() );
+        }
+
+        const std::array< double, PostChain::kPassCount > postTimings = m_pPostChain->getTimingsMS();
+        SPDLOG_INFO( "Post processing GPU ms bloom down: {:.3f} bloom up: {:.3f} tonemap: {:.3f} sharpen: {:.3f}",
+                     postTimings[ static_cast< std::uint32_t >( PostChain::Pass::eBloomDownsample ) ],
+                     postTimings[ static_cast< std::uint32_t >( PostChain::Pass::eBloomUpsample ) ],
+                     postTimings[ static_cast< std::uint32_t >( PostChain::Pass::eTonemap ) ],
+                     postTimings[ static_cast< std::uint32_t >( PostChain::Pass::eSharpen ) ] );
+        m_pPostChain->resetTimings();
+
+        if ( m_bMemoryBudget )
+        {
+            const DeviceMemoryBudget deviceMemory = readDeviceMemoryBudget( m_physical_device );
+            setGauge( Gauge::eDeviceMemoryUsage, static_cast< std::int64_t >( deviceMemory.uiUsage ) );
+            setGauge( Gauge::eDeviceMemoryBudget, static_cast< std::int64_t >( deviceMemory.uiBudget ) );
+        }
+        m_lodStats  = LodStats{};
+        m_cullStats = CullStats{};
     }
-    for ( vk::Framebuffer& frameBuffer : m_frameBuffers )
+}
+
+void Demo::onKey( const SDL_KeyboardEvent& key )
+{
+    if ( key.keysym.sym == SDLK_F1 )
+    {
+        m_pHud->toggle();
+        SPDLOG_INFO( "Performance HUD {}", m_pHud->isVisible() ? "shown" : "hidden" );
+    }
+    else if ( key.keysym.sym == SDLK_F2 && !m_lightingBenchmark.uiFrames )
+    {
+        setClusteredLighting( !m_bClusteredLighting );
+        SPDLOG_INFO( "Lighting {}", m_bClusteredLighting ? "clustered" : "brute force" );
+    }
+}
+
+void Demo::setClusteredLighting( bool bClustered )
+{
+    // the variant is built the first time it is seen so switching back and forth is free
+    m_bClusteredLighting              = bClustered;
+    m_meshVariant.specialisation[ 1 ] = bClustered ? kLightingClustered : kLightingBruteForce;
+    m_meshPipeline                    = m_pMeshPipelines->request( m_meshVariant );
+}
+
+void Demo::stepLightingBenchmark( double fSceneMS )
+{
+    LightingBenchmark&  benchmark  = m_lightingBenchmark;
+    const bool          bClustered = benchmark.uiStep % 2U == 0U;
+    const std::uint32_t uiLights   = kBenchmarkLightCounts[ benchmark.uiStep / 2U ];
+    if ( benchmark.uiFrame == 0U )
+    {
+        m_pLightClusters->setLightCount( uiLights );
+        setClusteredLighting( bClustered );
+    }
+    else if ( benchmark.uiFrame > kBenchmarkWarmupFrames && fSceneMS >= 0.0 )
     {
-        m_logical_device.destroyFramebuffer( frameBuffer );
+        benchmark.fTotalMS += fSceneMS;
+        ++benchmark.uiSamples;
     }
-    for ( vk::ImageView& imageView : m_swapChainImageViews )
+    if ( ++benchmark.uiFrame <= kBenchmarkWarmupFrames + benchmark.uiFrames )
+        return;
+
+    benchmark.resultsMS.push_back( benchmark.uiSamples ? benchmark.fTotalMS / benchmark.uiSamples : -1.0 );
+    benchmark.uiFrame   = 0U;
+    benchmark.fTotalMS  = 0.0;
+    benchmark.uiSamples = 0U;
+    if ( ++benchmark.uiStep != kBenchmarkLightCounts.size() * 2U )
+        return;
+
+    // the scene time includes everything drawn and, when clustered, the cull
+    SPDLOG_INFO( "Lighting benchmark: GPU scene ms averaged over {} frames", benchmark.uiFrames );
+    for ( std::uint32_t i = 0; i != to_u32( kBenchmarkLightCounts.size() ); ++i )
     {
-        m_logical_device.destroyImageView( imageView );
+        const double fClusteredMS  = benchmark.resultsMS[ i * 2U ];
+        const double fBruteForceMS = benchmark.resultsMS[ i * 2U + 1U ];
+        if ( fClusteredMS < 0.0 || fBruteForceMS < 0.0 )
+        {
+            SPDLOG_WARN( "Lighting benchmark: no GPU timestamps for {} lights", kBenchmarkLightCounts[ i ] );
+            continue;
+        }
+        SPDLOG_INFO( "Lights: {} clustered: {:.3f}ms brute force: {:.3f}ms speedup: {:.2f}x",
+                     kBenchmarkLightCounts[ i ],
+                     fClusteredMS,
+                     fBruteForceMS,
+                     fBruteForceMS / std::max( fClusteredMS, 1e-6 ) );
     }
-    if ( m_pipeline )
+    quit();
+}
+
+void Demo::addPriceTags( std::uint32_t uiFrameSlot, float fTime )
+{
+    constexpr float fTagWidth  = 88.0f;
+    constexpr float fTagHeight = 32.0f;
+    constexpr float fSpacingX  = 96.0f;
+    constexpr float fSpacingY  = 40.0f;
+    constexpr float fGlyphUV   = 1.0f / kGlyphCells;
+
+    // laid out against the first window - the same sprites are recorded into every window
+    const vk::Extent2D& extent    = m_swapchains.front()->getExtent();
+    const std::uint32_t uiColumns = std::max( static_cast< std::uint32_t >( extent.width / fSpacingX ), 1U );
+
+    // emitted one tag at a time as a UI would so consecutive sprites alternate state
+    m_pSpriteBatch->begin( uiFrameSlot );
+    for ( std::uint32_t i = 0; i != m_uiPriceTags; ++i )
     {
-        m_logical_device.destroyPipeline( m_pipeline );
+        const float fX = 4.0f + static_cast< float >( i % uiColumns ) * fSpacingX;
+        const float fY = 4.0f + static_cast< float >( i / uiColumns ) * fSpacingY
+                         + 2.0f * std::sin( fTime * 2.0f + static_cast< float >( i ) );
+
+        SpriteBatch::Sprite panel{ { fX, fY }, { fTagWidth, fTagHeight }, { 0.0f, 0.0f, 1.0f, 1.0f } };
+        panel.uiColour   = 0xE0000000U | ( ( i * 0x9E3779B9U ) & 0x003F3F3FU ) | 0x00A0A0A0U;
+        panel.uiLayer    = 0U;
+        panel.uiPipeline = m_uiSpriteAlphaPipeline;
+        panel.uiTexture  = m_uiPanelTexture;
+        m_pSpriteBatch->draw( panel );
+
+        // the digits make room for the product image
+        float fDigitX = fX + 10.0f, fDigitY = fY + 8.0f, fDigitStep = 18.0f, fDigitSize = 16.0f;
+        if ( !m_productTextures.empty() )
+        {
+            SpriteBatch::Sprite product{ { fX + 4.0f, fY + 6.0f }, { 24.0f, 24.0f }, { 0.0f, 0.0f, 1.0f, 1.0f } };
+            product.uiLayer    = 1U;
+            product.uiPipeline = m_uiSpriteAlphaPipeline;
+            product.uiTexture  = m_productTextures[ i % m_productTextures.size() ];
+            m_pSpriteBatch->draw( product );
+
+            fDigitX    = fX + 32.0f;
+            fDigitY    = fY + 10.0f;
+            fDigitStep = 13.0f;
+            fDigitSize = 12.0f;
+        }
+
+        // price digits cycle slowly
+        const std::uint32_t uiPrice = i * 7919U + static_cast< std::uint32_t >( fTime );
+        for ( std::uint32_t uiDigit = 0; uiDigit != 4U; ++uiDigit )
+        {
+            const std::uint32_t uiGlyph = ( uiPrice >> ( uiDigit * 4U ) ) % ( kGlyphCells * kGlyphCells );
+            const float         fU      = static_cast< float >( uiGlyph % kGlyphCells ) * fGlyphUV;
+            const float         fV      = static_cast< float >( uiGlyph / kGlyphCells ) * fGlyphUV;
+
+            SpriteBatch::Sprite glyph{ { fDigitX + static_cast< float >( uiDigit ) * fDigitStep, fDigitY },
+                                       { fDigitSize, fDigitSize },
+                                       { fU, fV, fU + fGlyphUV, fV + fGlyphUV } };
+            glyph.uiColour   = 0xFF202020U;
+            glyph.uiLayer    = 1U;
+            glyph.uiPipeline = m_uiSpriteAlphaPipeline;
+            glyph.uiTexture  = m_uiGlyphTexture;
+            m_pSpriteBatch->draw( glyph );
+        }
+
+        SpriteBatch::Sprite stripe{
+            { fX + 4.0f, fY + 2.0f }, { fTagWidth - 8.0f, 4.0f }, { 0.25f, 0.25f, 0.75f, 0.75f } };
+        stripe.uiColour   = 0x6000C0FFU;
+        stripe.uiLayer    = 1U;
+        stripe.uiPipeline = m_uiSpriteAdditivePipeline;
+        stripe.uiTexture  = m_uiPanelTexture;
+        m_pSpriteBatch->draw( stripe );
     }
-    if ( m_renderPass )
+    m_pSpriteBatch->end();
+}
+
+void Demo::benchmarkDispatch( std::uint32_t uiDraws, std::uint32_t uiRepeats )
+{
+    // records the same draw heavy stream through Vulkan-Hpp and through the direct table, then the
+    // frame's own recorders - the command buffer is never submitted so only the CPU cost of recording
+    // is measured.  The recorders' per frame state is left dirty as the process exits afterwards
+    const vk::CommandBufferAllocateInfo allocateInfo{ m_commandPool, vk::CommandBufferLevel::ePrimary, 1 };
+    const vk::CommandBuffer commandBuffer = m_logical_device.allocateCommandBuffers( allocateInfo ).front();
+
+    const DeviceDispatch&            dispatch  = *m_pDispatch;
+    const Mesh&                      mesh      = *m_meshes.front();
+    const vk::Pipeline               pipeline  = m_pMeshPipelines->get( m_meshPipeline );
+    const vk::CommandBufferBeginInfo beginInfo{ vk::CommandBufferUsageFlagBits::eOneTimeSubmit, nullptr };
+    const std::array< vk::ClearValue, 2 > clearValues{
+        vk::ClearValue{ vk::ClearColorValue{ std::array< float, 4 >{ 0.0f, 0.0f, 0.0f, 1.0f } } },
+        vk::ClearValue{ vk::ClearDepthStencilValue{ 1.0f, 0U } } };
+    const vk::RenderPassBeginInfo renderPassBeginInfo{ m_renderPass,
+                                                       m_pPostChain->getSceneFramebuffer( 0U, 0U ),
+                                                       vk::Rect2D{ { 0, 0 }, m_pPostChain->getExtent( 0U ) },
+                                                       clearValues };
+    const std::array< std::uint32_t, 2 > dynamicOffsets{ 0U, 0U };
+
+    auto recordHpp = [ & ]()
+    {
+        commandBuffer.reset( vk::CommandBufferResetFlags{} );
+        commandBuffer.begin( beginInfo );
+        commandBuffer.beginRenderPass( renderPassBeginInfo, vk::SubpassContents::eInline );
+        commandBuffer.bindPipeline( vk::PipelineBindPoint::eGraphics, pipeline );
+        commandBuffer.bindDescriptorSets(
+            vk::PipelineBindPoint::eGraphics, m_pipelineLayout, 1, m_frameDescriptorSet, dynamicOffsets );
+        commandBuffer.bindDescriptorSets(
+            vk::PipelineBindPoint::eGraphics, m_pipelineLayout, 2, m_pLightClusters->getSet( 0U, 0U ), nullptr );
+        commandBuffer.bindIndexBuffer( mesh.getIndexBuffer().get(), 0, mesh.getIndexType() );
+        for ( std::uint32_t i = 0; i != uiDraws; ++i )
+        {
+            const MeshPushConstants pushConstants{ i };
+            commandBuffer.bindDescriptorSets(
+                vk::PipelineBindPoint::eGraphics, m_pipelineLayout, 0, m_meshDescriptorSets.front(), nullptr );
+            commandBuffer.pushConstants(
+                m_pipelineLayout, vk::ShaderStageFlagBits::eVertex, 0, sizeof( MeshPushConstants ), &pushConstants );
+            commandBuffer.drawIndexed( mesh.getIndexCount(), 1, 0, 0, 0 );
+        }
+        commandBuffer.endRenderPass();
+        commandBuffer.end();
+    };
+    auto recordDirect = [ & ]()
+    {
+        dispatch.resetCommandBuffer( commandBuffer );
+        dispatch.beginCommandBuffer( commandBuffer, beginInfo );
+        dispatch.cmdBeginRenderPass( commandBuffer, renderPassBeginInfo, vk::SubpassContents::eInline );
+        dispatch.cmdBindPipeline( commandBuffer, vk::PipelineBindPoint::eGraphics, pipeline );
+        dispatch.cmdBindDescriptorSet( commandBuffer,
+                                       vk::PipelineBindPoint::eGraphics,
+                                       m_pipelineLayout,
+                                       1,
+                                       m_frameDescriptorSet,
+                                       to_u32( dynamicOffsets.size() ),
+                                       dynamicOffsets.data() );
+        dispatch.cmdBindDescriptorSet( commandBuffer,
+                                       vk::PipelineBindPoint::eGraphics,
+                                       m_pipelineLayout,
+                                       2,
+                                       m_pLightClusters->getSet( 0U, 0U ) );
+        dispatch.cmdBindIndexBuffer( commandBuffer, mesh.getIndexBuffer().get(), 0, mesh.getIndexType() );
+        for ( std::uint32_t i = 0; i != uiDraws; ++i )
+        {
+            const MeshPushConstants pushConstants{ i };
+            dispatch.cmdBindDescriptorSet(
+                commandBuffer, vk::PipelineBindPoint::eGraphics, m_pipelineLayout, 0, m_meshDescriptorSets.front() );
+            dispatch.cmdPushConstants( commandBuffer,
+                                       m_pipelineLayout,
+                                       vk::ShaderStageFlagBits::eVertex,
+                                       0,
+                                       sizeof( MeshPushConstants ),
+                                       &pushConstants );
+            dispatch.cmdDrawIndexed( commandBuffer, mesh.getIndexCount(), 1, 0, 0, 0 );
+        }
+        dispatch.cmdEndRenderPass( commandBuffer );
+        dispatch.endCommandBuffer( commandBuffer );
+    };
+    // the compute passes and the scene pass as recordScene issues them without the command cache,
+    // then post processing - indirect draws are limited to the occlusion culler's candidates
+    const std::uint32_t uiFrameDraws
+        = m_pOcclusionCuller ? std::min( uiDraws, m_pOcclusionCuller->getMaxCandidates() ) : uiDraws;
+    std::vector< SceneDraw > sceneDraws = std::move( m_sceneDraws );
+    m_sceneDraws.assign( uiFrameDraws, SceneDraw{ 0U, mesh.getIndexCount(), 0U } );
+    auto recordFrame = [ & ]()
+    {
+        dispatch.resetCommandBuffer( commandBuffer );
+        dispatch.beginCommandBuffer( commandBuffer, beginInfo );
+        if ( m_pParticles )
+            m_pParticles->recordUpdate( dispatch, commandBuffer, 0U, 0.0f );
+        m_pLightClusters->recordCull( dispatch, commandBuffer, 0U, 0U );
+        if ( m_pOcclusionCuller )
+        {
+            m_pOcclusionCuller->recordTest(
+                dispatch, commandBuffer, 0U, 0U, OcclusionCuller::Phase::eEarly, 0U, uiFrameDraws );
+        }
+        dispatch.cmdBeginRenderPass( commandBuffer, renderPassBeginInfo, vk::SubpassContents::eInline );
+        recordSceneContents( commandBuffer, 0U, 0U, OcclusionCuller::Phase::eEarly );
+        dispatch.cmdEndRenderPass( commandBuffer );
+        if ( m_pOcclusionCuller )
+            m_pOcclusionCuller->recordPyramid( dispatch, commandBuffer, 0U, 0U, Mat4{} );
+        m_pPostChain->record( dispatch, commandBuffer, 0U );
+        dispatch.endCommandBuffer( commandBuffer );
+    };
+    auto timeRecord = []( auto&& record )
+    {
+        const auto startTime = std::chrono::steady_clock::now();
+        record();
+        return std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - startTime );
+    };
+
+    // warm up every path then alternate so none benefits from running last
+    recordHpp();
+    recordDirect();
+    recordFrame();
+    std::chrono::nanoseconds hppTime    = std::chrono::nanoseconds::max();
+    std::chrono::nanoseconds directTime = std::chrono::nanoseconds::max();
+    std::chrono::nanoseconds frameTime  = std::chrono::nanoseconds::max();
+    for ( std::uint32_t i = 0; i != uiRepeats; ++i )
     {
-        m_logical_device.destroyRenderPass( m_renderPass );
+        hppTime    = std::min( hppTime, timeRecord( recordHpp ) );
+        directTime = std::min( directTime, timeRecord( recordDirect ) );
+        frameTime  = std::min( frameTime, timeRecord( recordFrame ) );
     }
-    if ( m_pipelineLayout )
+    m_sceneDraws = std::move( sceneDraws );
+
+    // three calls per draw - bind, push and draw
+    const double fHppPerDraw    = static_cast< double >( hppTime.count() ) / uiDraws;
+    const double fDirectPerDraw = static_cast< double >( directTime.count() ) / uiDraws;
+    SPDLOG_INFO( "Dispatch benchmark: {} draws best of {} Vulkan-Hpp: {:.1f}ns per draw direct: {:.1f}ns per draw "
+                 "saving: {:.1f}ns per call",
+                 uiDraws,
+                 uiRepeats,
+                 fHppPerDraw,
+                 fDirectPerDraw,
+                 ( fHppPerDraw - fDirectPerDraw ) / 3.0 );
+    SPDLOG_INFO( "Dispatch benchmark: frame path {} draws with {}compute and post processing: {:.3f}ms "
+                 "{:.1f}ns per draw",
+                 uiFrameDraws,
+                 m_pOcclusionCuller ? "occlusion culling, " : "",
+                 static_cast< double >( frameTime.count() ) / 1000000.0,
+                 static_cast< double >( frameTime.count() ) / std::max( uiFrameDraws, 1U ) );
+
+    m_logical_device.freeCommandBuffers( m_commandPool, commandBuffer );
+}
+
+Demo::~Demo()
+{
+    // no reads may complete into the meshes' staging memory once they are retired
+    m_pFileReader.reset();
+    if ( m_pDeletionQueue )
     {
-        m_logical_device.destroyPipelineLayout( m_pipelineLayout );
+        // everything below may still be referenced by submitted work so it is retired in the order it
+        // was destroyed in and the drain waits for each timeline's last submit rather than the device
+        DeletionQueue& deletionQueue = *m_pDeletionQueue;
+
+        // no timeline covers presentation, which waits on the render finished semaphores and still uses
+        // the swapchain images, so the present queue is idled before either is retired
+        if ( m_queue )
+            m_queue.waitIdle();
+        for ( FrameSlot& frameSlot : m_frameSlots )
+            deletionQueue.retire( frameSlot.renderFinishedSemaphore );
+        deletionQueue.retire( m_commandPool );
+        deletionQueue.retire( m_computeCommandPool );
+        deletionQueue.retire( std::move( m_pSceneCommands ) );
+        deletionQueue.retire( std::move( m_pLatencyTracker ) );
+        deletionQueue.retire( std::move( m_pOcclusionCuller ) );
+        deletionQueue.retire( std::move( m_pParticles ) );
+        deletionQueue.retire( std::move( m_pLightClusters ) );
+        deletionQueue.retire( std::move( m_pPostChain ) );
+        for ( std::unique_ptr< Swapchain >& pSwapchain : m_swapchains )
+            deletionQueue.retire( std::move( pSwapchain ) );
+        deletionQueue.retire( std::move( m_pHud ) );
+        deletionQueue.retire( std::move( m_pSpriteBatch ) );
+        deletionQueue.retire( std::move( m_pMeshPipelines ) );
+        deletionQueue.retire( m_meshVertexShader );
+        deletionQueue.retire( m_meshFragmentShader );
+        deletionQueue.retire( m_pipelineCache );
+        deletionQueue.retire( m_renderPass );
+        deletionQueue.retire( m_lateRenderPass );
+        deletionQueue.retire( m_uiRenderPass );
+        deletionQueue.retire( m_pipelineLayout );
+        deletionQueue.retire( m_descriptorPool );
+        deletionQueue.retire( m_frameDescriptorPool );
+        deletionQueue.retire( m_frameDescriptorSetLayout );
+        deletionQueue.retire( m_meshDescriptorSetLayout );
+        deletionQueue.retire( std::move( m_pUniformRing ) );
+        for ( std::unique_ptr< Texture >& pTexture : m_textures )
+            deletionQueue.retire( std::move( pTexture ) );
+        for ( MeshPtr& pMesh : m_meshes )
+            deletionQueue.retire( std::move( pMesh ) );
+        deletionQueue.drain();
+
+        const DeletionQueue::Stats& stats = deletionQueue.getStats();
+        SPDLOG_INFO( "Deletion queue retired: {} destroyed: {} most pending: {}",
+                     stats.uiRetired,
+                     stats.uiDestroyed,
+                     stats.uiMaxPending );
+        m_pDeletionQueue.reset();
     }
+    m_swapchains.clear();
+    m_textures.clear();
+    m_meshes.clear();
+    m_pUploader.reset();
+    m_pComputeTimeline.reset();
+    m_pGraphicsTimeline.reset();
 
     if ( m_logical_device )
     {
         m_logical_device.destroy();
     }
-    if ( m_surface )
+    for ( vk::SurfaceKHR& surface : m_surfaces )
     {
-        m_instance->destroySurfaceKHR( m_surface );
+        m_instance->destroySurfaceKHR( surface );
     }
 
     m_pDebugCallback.reset();
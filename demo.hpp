@@ -1,13 +1,40 @@
-
 #ifndef DEMO_25_APRIL_2022
 #define DEMO_25_APRIL_2022
 
 #include "application.hpp"
+#include "asset_pack.hpp"
+#include "async_file_reader.hpp"
+#include "bvh_culler.hpp"
+#include "command_cache.hpp"
 #include "debug.hpp"
+#include "deletion_queue.hpp"
+#include "device_dispatch.hpp"
+#include "latency_tracker.hpp"
+#include "light_clusters.hpp"
+#include "lod.hpp"
+#include "mesh.hpp"
+#include "occlusion_culler.hpp"
+#include "particle_system.hpp"
+#include "perf_hud.hpp"
+#include "pipeline_variants.hpp"
+#include "post_chain.hpp"
+#include "scene.hpp"
+#include "sprite_batch.hpp"
+#include "swapchain.hpp"
+#include "timeline.hpp"
+#include "uniform_ring.hpp"
+#include "texture.hpp"
+#include "uploader.hpp"
+#include "worker_pool.hpp"
+
+#include <boost/filesystem/path.hpp>
 
 #include <vulkan/vulkan.hpp>
 
+#include <array>
+#include <chrono>
 #include <optional>
+#include <vector>
 #include <vulkan/vulkan_handles.hpp>
 
 namespace retail
@@ -16,36 +43,219 @@ namespace retail
 class Demo : public Application
 {
 public:
-    Demo();
+    struct Config : public Application::Config
+    {
+        boost::filesystem::path meshFile;
+        boost::filesystem::path shaderPack = "shaders.pack";
+        std::vector< boost::filesystem::path > textureFiles; // product images shown on the price tags
+        std::uint32_t           uiInstances    = 1024U;
+        float                   fLodPixelError = 1.5f;
+        std::uint32_t           uiPriceTags    = 256U;
+        bool                    bLodDebug      = false;
+        bool                    bAsyncCompute  = true; // post process on a separate compute queue when there is one
+        bool                    bCulling       = true; // frustum cull instances on the CPU before drawing
+        bool                    bOcclusion     = true; // occlusion cull the frustum's instances on the GPU
+        bool                    bIoUring       = true; // read assets through io_uring rather than a thread pool
+        bool                    bCommandCache  = true; // replay scene draws recorded by an earlier frame
+        std::uint32_t           uiParticles    = 1U << 20; // GPU simulated particles - zero for none
+        std::uint32_t           uiLights       = 512U;     // point lights scattered through the shelves
+        bool                    bLightClusters = true; // light fragments from their cluster's lights, not every light
+        std::uint32_t           uiBenchmarkLightingFrames = 0U; // time every light count and mode then quit
+        PerfHud::Config         hud;
+    };
+
+    Demo( const Config& config );
     ~Demo();
 
     virtual void frame();
+    virtual void onKey( const SDL_KeyboardEvent& key );
+
+    // CPU cost of recording uiDraws draws through Vulkan-Hpp against the direct dispatch table
+    void benchmarkDispatch( std::uint32_t uiDraws, std::uint32_t uiRepeats );
 
 private:
+    void loadMeshes( const boost::filesystem::path& meshFilePath );
+    void createMeshDescriptorSets();
+    void createFrameDescriptorSet();
+    void addPriceTags( std::uint32_t uiFrameSlot, float fTime );
+    void setClusteredLighting( bool bClustered );
+    // advances the lighting benchmark by a frame given the slot's previous scene time
+    void stepLightingBenchmark( double fSceneMS );
+    void acquireImages( std::uint32_t uiFrameSlot );
+    void recordScene( vk::CommandBuffer commandBuffer, std::uint32_t uiFrameSlot );
+    // one scene render pass over m_sceneDraws - the phase selects the pass and its indirect commands
+    void recordSceneDraws( vk::CommandBuffer      commandBuffer,
+                           std::uint32_t          uiWindow,
+                           std::uint32_t          uiFrameSlot,
+                           OcclusionCuller::Phase phase );
+    // the scene render pass contents - inline or into a cached secondary command buffer
+    void recordSceneContents( vk::CommandBuffer      commandBuffer,
+                              std::uint32_t          uiWindow,
+                              std::uint32_t          uiFrameSlot,
+                              OcclusionCuller::Phase phase );
+    // the phase draws over everything else in the window's scene
+    bool isLastScenePass( OcclusionCuller::Phase phase ) const
+    {
+        return !m_pOcclusionCuller || phase == OcclusionCuller::Phase::eLate;
+    }
+    void recordComposite( vk::CommandBuffer commandBuffer, std::uint32_t uiPostFrameSlot );
+    void present( std::uint32_t uiFrameSlot );
+
+    using SwapchainPtr    = std::unique_ptr< Swapchain >;
+    using SwapchainVector = std::vector< SwapchainPtr >;
+    using MeshPtr         = std::unique_ptr< Mesh >;
+    using MeshVector      = std::vector< MeshPtr >;
+
+    // the CPU runs ahead of the GPU by up to kFramesInFlight frames
+    static constexpr std::uint32_t kFramesInFlight = 2U;
+    // asset reads in flight at once and the pool size when io_uring is unavailable
+    static constexpr std::uint32_t kFileReadQueueDepth = 64U;
+    static constexpr std::uint32_t kFileReadThreads    = 4U;
+
+    struct FrameSlot
+    {
+        vk::CommandBuffer commandBuffer;
+        vk::CommandBuffer postCommandBuffer;      // compute queue - async compute only
+        vk::CommandBuffer compositeCommandBuffer; // graphics queue - async compute only
+        vk::Semaphore     renderFinishedSemaphore;
+        std::uint64_t     uiTimelineValue = 0U; // graphics timeline value signalled by the slot's last submit
+        std::uint64_t     uiPostValue     = 0U; // compute timeline value signalled by the slot's post processing
+    };
+
+    // a frame whose post processing is in flight on the compute queue waiting to be composited
+    struct PendingComposite
+    {
+        std::uint32_t                              uiFrameSlot;
+        std::optional< LatencyTracker::TimePoint > input;
+    };
+
     vk::DynamicLoader              m_dynamic_loader;
     vk::UniqueInstance             m_instance;
-    vk::SurfaceKHR                 m_surface;
+    std::vector< vk::SurfaceKHR >  m_surfaces;
     vk::PhysicalDevice             m_physical_device;
     vk::Device                     m_logical_device;
     vk::Queue                      m_queue;
-    vk::SwapchainKHR               m_swapchain;
-    std::vector< vk::Image >       m_swapChainImages;
-    std::vector< vk::ImageView >   m_swapChainImageViews;
+    std::unique_ptr< DeviceDispatch > m_pDispatch;
+    SwapchainVector                m_swapchains;
+    vk::DescriptorSetLayout        m_meshDescriptorSetLayout;
     vk::PipelineLayout             m_pipelineLayout;
-    vk::RenderPass                 m_renderPass;
-    vk::Pipeline                   m_pipeline;
-    std::vector< vk::Framebuffer > m_frameBuffers;
+    vk::RenderPass                 m_renderPass;   // scene into the post chain's HDR target
+    vk::RenderPass                 m_lateRenderPass; // occlusion culling's late draws over the scene
+    vk::RenderPass                 m_uiRenderPass; // UI over the post processed swapchain image
+    vk::PipelineCache              m_pipelineCache;
+    std::unique_ptr< AssetPack >   m_pShaderPack;
+    vk::ShaderModule               m_meshVertexShader;
+    vk::ShaderModule               m_meshFragmentShader;
+    std::unique_ptr< PipelineVariants > m_pMeshPipelines;
+    PipelineVariants::Variant      m_meshVariant;
+    PipelineVariants::Handle       m_meshPipeline = 0U;
     vk::CommandPool                m_commandPool;
-    vk::CommandBuffer              m_commandBuffer;
-    vk::Semaphore                  m_imageAvailableSemaphore;
-    vk::Semaphore                  m_renderFinishedSemaphore;
-    vk::Fence                      m_inFlightFence;
+    std::unique_ptr< Timeline >    m_pGraphicsTimeline;
+    std::array< FrameSlot, kFramesInFlight > m_frameSlots;
+    std::uint64_t                  m_uiFrame = 0U;
+    std::unique_ptr< Uploader >    m_pUploader;
+    std::unique_ptr< AsyncFileReader > m_pFileReader; // asset reads into the uploader's staging memory
+    std::unique_ptr< MeshFile >    m_pMeshFile;
+    MeshVector                     m_meshes;
+    vk::DescriptorPool             m_descriptorPool;
+    std::vector< vk::DescriptorSet > m_meshDescriptorSets; // vertex pulling storage buffer per mesh
+    std::unique_ptr< WorkerPool >  m_pWorkers; // data parallel frame work such as transform updates
+    std::unique_ptr< Scene >       m_pScene;
+    std::vector< LodSelector >     m_lodSelectors; // per window as each has its own projection
+    std::unique_ptr< BvhCuller >   m_pCuller;      // null when culling is disabled
+    std::vector< std::uint32_t >   m_visibleInstances; // the window being recorded
+    std::vector< Aabb >            m_instanceBounds;   // world space - the shelves never move
+    std::unique_ptr< OcclusionCuller > m_pOcclusionCuller; // null when occlusion culling is disabled
+    std::unique_ptr< ParticleSystem > m_pParticles;        // null without particles
+    float                          m_fLastTime     = 0.0f; // scene time of the previous frame
+    float                          m_fDeltaSeconds = 0.0f; // the particles' step this frame
+    std::unique_ptr< LightClusters > m_pLightClusters;
+    bool                           m_bClusteredLighting = true; // the cull runs and the scene reads its clusters
+
+    // GPU scene time with clustered then brute force lighting for each of kBenchmarkLightCounts
+    struct LightingBenchmark
+    {
+        std::uint32_t         uiFrames  = 0U; // timed per step - zero when not benchmarking
+        std::uint32_t         uiStep    = 0U; // light count index * 2 + brute force
+        std::uint32_t         uiFrame   = 0U; // within the step
+        double                fTotalMS  = 0.0;
+        std::uint32_t         uiSamples = 0U;
+        std::vector< double > resultsMS; // per step - negative without timestamps
+    };
+    LightingBenchmark m_lightingBenchmark;
+
+    // the visible instances' draws in the window being recorded - recorded again for the late pass
+    struct SceneDraw
+    {
+        std::uint32_t uiMesh;
+        std::uint32_t uiIndexCount;
+        std::uint32_t uiFirstIndex;
+    };
+    std::vector< SceneDraw > m_sceneDraws;
+
+    // scene render pass contents per window, frame slot and phase - null when caching is disabled
+    std::unique_ptr< CommandCache > m_pSceneCommands;
+    std::vector< std::uint8_t >     m_sceneState; // scratch state key
+
+    struct CullStats
+    {
+        std::uint64_t            uiVisible = 0U;
+        std::uint64_t            uiCulled  = 0U;
+        std::chrono::nanoseconds time{ 0 };
+    };
+    CullStats m_cullStats;
+
+    struct LodStats
+    {
+        std::uint64_t uiTriangles = 0U;
+        std::array< std::uint64_t, mesh::kMaxLods > instancesPerLod{};
+    };
+    LodStats m_lodStats;
+
+    std::unique_ptr< UniformRing >          m_pUniformRing;
+    vk::DescriptorSetLayout                 m_frameDescriptorSetLayout;
+    vk::DescriptorPool                      m_frameDescriptorPool;
+    vk::DescriptorSet                       m_frameDescriptorSet;
+
+    std::unique_ptr< SpriteBatch >          m_pSpriteBatch;
+    std::vector< std::unique_ptr< Texture > > m_textures;
+    std::uint32_t                           m_uiPriceTags              = 0U;
+    std::uint16_t                           m_uiSpriteAlphaPipeline    = 0U;
+    std::uint16_t                           m_uiSpriteAdditivePipeline = 0U;
+    std::uint32_t                           m_uiPanelTexture           = 0U;
+    std::uint32_t                           m_uiGlyphTexture           = 0U;
+    std::vector< std::uint32_t >            m_productTextures; // sprite batch textures from the texture files
+
+    // toggled with F1 - draws into the UI pass after the price tags
+    std::unique_ptr< PerfHud >              m_pHud;
+    PerfHud::FrameStats                     m_hudStats;       // the frame being recorded
+    std::chrono::steady_clock::duration     m_frameBlocked{}; // acquire and present - not CPU work
+    bool                                    m_bMemoryBudget = false; // VK_EXT_memory_budget enabled
+    bool                                    m_bTextureCompressionBC = false; // BC block formats enabled
+
+    bool                              m_bPresentWait = false; // VK_KHR_present_id and VK_KHR_present_wait enabled
+    std::unique_ptr< LatencyTracker > m_pLatencyTracker;
+
+    std::unique_ptr< PostChain >      m_pPostChain;
+    vk::Queue                         m_computeQueue;
+    std::unique_ptr< Timeline >       m_pComputeTimeline; // null without async compute
+    vk::CommandPool                   m_computeCommandPool;
+    std::unique_ptr< DeletionQueue >  m_pDeletionQueue; // objects retired until both timelines pass their last use
+    std::optional< PendingComposite > m_pendingComposite;
 
-    vk::Extent2D                     m_swapchainExtent;
     std::optional< uint32_t >        m_graphics_queue_index;
+    std::optional< uint32_t >        m_compute_queue_index; // a compute only family used for async compute
     std::unique_ptr< DebugCallback > m_pDebugCallback;
     std::set< std::string >          m_required_instance_extensions;
     std::set< std::string >          m_supportedValidationLayers;
+
+    // per frame scratch reused to avoid allocating in frame()
+    std::vector< Timeline::Wait >         m_frameWaits;
+    std::vector< vk::SwapchainKHR >       m_frameSwapchains;
+    std::vector< std::uint32_t >          m_frameImageIndices;
+    std::vector< vk::Result >             m_framePresentResults;
+    std::vector< std::uint64_t >          m_framePresentIds;
+    std::array< std::uint32_t, 2 >        m_frameDynamicOffsets{};
 };
 
 } // namespace retail
@@ -0,0 +1,71 @@
+#include "device_dispatch.hpp"
+
+#include "common/assert_verify.hpp"
+
+namespace retail
+{
+
+namespace
+{
+template < typename TFunction >
+void loadDeviceFunction( vk::Device              device,
+                         PFN_vkGetDeviceProcAddr pfnGetDeviceProcAddr,
+                         const char*             pszName,
+                         TFunction&              pfnFunction )
+{
+    pfnFunction = reinterpret_cast< TFunction >( pfnGetDeviceProcAddr( static_cast< VkDevice >( device ), pszName ) );
+    VERIFY_RTE_MSG( pfnFunction, "Failed to load device function: " << pszName );
+}
+} // namespace
+
+DeviceDispatch::DeviceDispatch( vk::Device device, PFN_vkGetDeviceProcAddr pfnGetDeviceProcAddr )
+    : m_device( device )
+{
+    VERIFY_RTE( device );
+    VERIFY_RTE( pfnGetDeviceProcAddr );
+
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkBeginCommandBuffer", m_pfnBeginCommandBuffer );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkEndCommandBuffer", m_pfnEndCommandBuffer );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkResetCommandBuffer", m_pfnResetCommandBuffer );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkCmdBeginRenderPass", m_pfnCmdBeginRenderPass );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkCmdEndRenderPass", m_pfnCmdEndRenderPass );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkCmdBindPipeline", m_pfnCmdBindPipeline );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkCmdSetViewport", m_pfnCmdSetViewport );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkCmdSetScissor", m_pfnCmdSetScissor );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkCmdBindDescriptorSets", m_pfnCmdBindDescriptorSets );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkCmdBindVertexBuffers", m_pfnCmdBindVertexBuffers );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkCmdBindIndexBuffer", m_pfnCmdBindIndexBuffer );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkCmdPushConstants", m_pfnCmdPushConstants );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkCmdDrawIndexed", m_pfnCmdDrawIndexed );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkCmdDrawIndexedIndirect", m_pfnCmdDrawIndexedIndirect );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkCmdDrawIndirect", m_pfnCmdDrawIndirect );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkCmdDispatch", m_pfnCmdDispatch );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkCmdDispatchIndirect", m_pfnCmdDispatchIndirect );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkCmdUpdateBuffer", m_pfnCmdUpdateBuffer );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkCmdCopyBuffer", m_pfnCmdCopyBuffer );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkCmdPipelineBarrier", m_pfnCmdPipelineBarrier );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkCmdResetQueryPool", m_pfnCmdResetQueryPool );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkCmdWriteTimestamp", m_pfnCmdWriteTimestamp );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkCmdBlitImage", m_pfnCmdBlitImage );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkCmdExecuteCommands", m_pfnCmdExecuteCommands );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkQueueSubmit", m_pfnQueueSubmit );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkQueuePresentKHR", m_pfnQueuePresentKHR );
+    loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkAcquireNextImageKHR", m_pfnAcquireNextImageKHR );
+
+    // core in 1.2 - fall back to the extension name on 1.1 devices exposing VK_KHR_timeline_semaphore
+    m_pfnGetSemaphoreCounterValue = reinterpret_cast< PFN_vkGetSemaphoreCounterValue >(
+        pfnGetDeviceProcAddr( static_cast< VkDevice >( device ), "vkGetSemaphoreCounterValue" ) );
+    if ( !m_pfnGetSemaphoreCounterValue )
+    {
+        loadDeviceFunction(
+            device, pfnGetDeviceProcAddr, "vkGetSemaphoreCounterValueKHR", m_pfnGetSemaphoreCounterValue );
+    }
+    m_pfnWaitSemaphores = reinterpret_cast< PFN_vkWaitSemaphores >(
+        pfnGetDeviceProcAddr( static_cast< VkDevice >( device ), "vkWaitSemaphores" ) );
+    if ( !m_pfnWaitSemaphores )
+    {
+        loadDeviceFunction( device, pfnGetDeviceProcAddr, "vkWaitSemaphoresKHR", m_pfnWaitSemaphores );
+    }
+}
+
+} // namespace retail
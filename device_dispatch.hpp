@@ -0,0 +1,324 @@
+#ifndef DEVICE_DISPATCH_17_OCTOBER_2022
+#define DEVICE_DISPATCH_17_OCTOBER_2022
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include <cstdint>
+
+namespace retail
+{
+
+// Device level entry points loaded once through vkGetDeviceProcAddr for the per frame path.
+//
+// Calls go straight to the driver without the loader trampoline, the global dispatcher lookup or
+// the Vulkan-Hpp result checking and ArrayProxy conversions.  Each wrapper is a single inlined
+// indirect call so callers check VkResult themselves where one is returned.
+class DeviceDispatch
+{
+public:
+    DeviceDispatch( vk::Device device, PFN_vkGetDeviceProcAddr pfnGetDeviceProcAddr );
+
+    DeviceDispatch( const DeviceDispatch& )            = delete;
+    DeviceDispatch& operator=( const DeviceDispatch& ) = delete;
+
+    vk::Device getDevice() const { return m_device; }
+
+    // command buffers
+    VkResult beginCommandBuffer( vk::CommandBuffer commandBuffer, const vk::CommandBufferBeginInfo& beginInfo ) const
+    {
+        return m_pfnBeginCommandBuffer( static_cast< VkCommandBuffer >( commandBuffer ),
+                                        reinterpret_cast< const VkCommandBufferBeginInfo* >( &beginInfo ) );
+    }
+    VkResult endCommandBuffer( vk::CommandBuffer commandBuffer ) const
+    {
+        return m_pfnEndCommandBuffer( static_cast< VkCommandBuffer >( commandBuffer ) );
+    }
+    VkResult resetCommandBuffer( vk::CommandBuffer commandBuffer ) const
+    {
+        return m_pfnResetCommandBuffer( static_cast< VkCommandBuffer >( commandBuffer ), 0 );
+    }
+
+    // recording
+    void cmdBeginRenderPass( vk::CommandBuffer              commandBuffer,
+                             const vk::RenderPassBeginInfo& beginInfo,
+                             vk::SubpassContents            contents ) const
+    {
+        m_pfnCmdBeginRenderPass( static_cast< VkCommandBuffer >( commandBuffer ),
+                                 reinterpret_cast< const VkRenderPassBeginInfo* >( &beginInfo ),
+                                 static_cast< VkSubpassContents >( contents ) );
+    }
+    void cmdEndRenderPass( vk::CommandBuffer commandBuffer ) const
+    {
+        m_pfnCmdEndRenderPass( static_cast< VkCommandBuffer >( commandBuffer ) );
+    }
+    void cmdBindPipeline( vk::CommandBuffer     commandBuffer,
+                          vk::PipelineBindPoint bindPoint,
+                          vk::Pipeline          pipeline ) const
+    {
+        m_pfnCmdBindPipeline( static_cast< VkCommandBuffer >( commandBuffer ),
+                              static_cast< VkPipelineBindPoint >( bindPoint ),
+                              static_cast< VkPipeline >( pipeline ) );
+    }
+    void cmdSetViewport( vk::CommandBuffer commandBuffer, const vk::Viewport& viewport ) const
+    {
+        m_pfnCmdSetViewport( static_cast< VkCommandBuffer >( commandBuffer ),
+                             0U,
+                             1U,
+                             reinterpret_cast< const VkViewport* >( &viewport ) );
+    }
+    void cmdSetScissor( vk::CommandBuffer commandBuffer, const vk::Rect2D& scissor ) const
+    {
+        m_pfnCmdSetScissor(
+            static_cast< VkCommandBuffer >( commandBuffer ), 0U, 1U, reinterpret_cast< const VkRect2D* >( &scissor ) );
+    }
+    void cmdBindDescriptorSet( vk::CommandBuffer     commandBuffer,
+                               vk::PipelineBindPoint bindPoint,
+                               vk::PipelineLayout    layout,
+                               std::uint32_t         uiSet,
+                               vk::DescriptorSet     descriptorSet,
+                               std::uint32_t         uiDynamicOffsetCount = 0U,
+                               const std::uint32_t*  pDynamicOffsets      = nullptr ) const
+    {
+        const VkDescriptorSet rawDescriptorSet = static_cast< VkDescriptorSet >( descriptorSet );
+        m_pfnCmdBindDescriptorSets( static_cast< VkCommandBuffer >( commandBuffer ),
+                                    static_cast< VkPipelineBindPoint >( bindPoint ),
+                                    static_cast< VkPipelineLayout >( layout ),
+                                    uiSet,
+                                    1U,
+                                    &rawDescriptorSet,
+                                    uiDynamicOffsetCount,
+                                    pDynamicOffsets );
+    }
+    void cmdBindVertexBuffer( vk::CommandBuffer commandBuffer,
+                              std::uint32_t     uiBinding,
+                              vk::Buffer        buffer,
+                              vk::DeviceSize    offset ) const
+    {
+        const VkBuffer rawBuffer = static_cast< VkBuffer >( buffer );
+        m_pfnCmdBindVertexBuffers(
+            static_cast< VkCommandBuffer >( commandBuffer ), uiBinding, 1U, &rawBuffer, &offset );
+    }
+    void cmdBindIndexBuffer( vk::CommandBuffer commandBuffer,
+                             vk::Buffer        buffer,
+                             vk::DeviceSize    offset,
+                             vk::IndexType     indexType ) const
+    {
+        m_pfnCmdBindIndexBuffer( static_cast< VkCommandBuffer >( commandBuffer ),
+                                 static_cast< VkBuffer >( buffer ),
+                                 offset,
+                                 static_cast< VkIndexType >( indexType ) );
+    }
+    void cmdPushConstants( vk::CommandBuffer    commandBuffer,
+                           vk::PipelineLayout   layout,
+                           vk::ShaderStageFlags stages,
+                           std::uint32_t        uiOffset,
+                           std::uint32_t        uiSize,
+                           const void*          pValues ) const
+    {
+        m_pfnCmdPushConstants( static_cast< VkCommandBuffer >( commandBuffer ),
+                               static_cast< VkPipelineLayout >( layout ),
+                               static_cast< VkShaderStageFlags >( stages ),
+                               uiOffset,
+                               uiSize,
+                               pValues );
+    }
+    void cmdDrawIndexed( vk::CommandBuffer commandBuffer,
+                         std::uint32_t     uiIndexCount,
+                         std::uint32_t     uiInstanceCount,
+                         std::uint32_t     uiFirstIndex,
+                         std::int32_t      iVertexOffset,
+                         std::uint32_t     uiFirstInstance ) const
+    {
+        m_pfnCmdDrawIndexed( static_cast< VkCommandBuffer >( commandBuffer ),
+                             uiIndexCount,
+                             uiInstanceCount,
+                             uiFirstIndex,
+                             iVertexOffset,
+                             uiFirstInstance );
+    }
+    void cmdDrawIndexedIndirect( vk::CommandBuffer commandBuffer, vk::Buffer buffer, vk::DeviceSize offset ) const
+    {
+        m_pfnCmdDrawIndexedIndirect( static_cast< VkCommandBuffer >( commandBuffer ),
+                                     static_cast< VkBuffer >( buffer ),
+                                     offset,
+                                     1U,
+                                     sizeof( VkDrawIndexedIndirectCommand ) );
+    }
+    void cmdDrawIndirect( vk::CommandBuffer commandBuffer, vk::Buffer buffer, vk::DeviceSize offset ) const
+    {
+        m_pfnCmdDrawIndirect( static_cast< VkCommandBuffer >( commandBuffer ),
+                              static_cast< VkBuffer >( buffer ),
+                              offset,
+                              1U,
+                              sizeof( VkDrawIndirectCommand ) );
+    }
+    void cmdDispatch( vk::CommandBuffer commandBuffer,
+                      std::uint32_t     uiGroupsX,
+                      std::uint32_t     uiGroupsY,
+                      std::uint32_t     uiGroupsZ ) const
+    {
+        m_pfnCmdDispatch( static_cast< VkCommandBuffer >( commandBuffer ), uiGroupsX, uiGroupsY, uiGroupsZ );
+    }
+    void cmdDispatchIndirect( vk::CommandBuffer commandBuffer, vk::Buffer buffer, vk::DeviceSize offset ) const
+    {
+        m_pfnCmdDispatchIndirect(
+            static_cast< VkCommandBuffer >( commandBuffer ), static_cast< VkBuffer >( buffer ), offset );
+    }
+    void cmdUpdateBuffer( vk::CommandBuffer commandBuffer,
+                          vk::Buffer        buffer,
+                          vk::DeviceSize    offset,
+                          vk::DeviceSize    size,
+                          const void*       pData ) const
+    {
+        m_pfnCmdUpdateBuffer(
+            static_cast< VkCommandBuffer >( commandBuffer ), static_cast< VkBuffer >( buffer ), offset, size, pData );
+    }
+    void cmdCopyBuffer( vk::CommandBuffer     commandBuffer,
+                        vk::Buffer            srcBuffer,
+                        vk::Buffer            dstBuffer,
+                        const vk::BufferCopy& region ) const
+    {
+        m_pfnCmdCopyBuffer( static_cast< VkCommandBuffer >( commandBuffer ),
+                            static_cast< VkBuffer >( srcBuffer ),
+                            static_cast< VkBuffer >( dstBuffer ),
+                            1U,
+                            reinterpret_cast< const VkBufferCopy* >( &region ) );
+    }
+    // memory barriers, image barriers or both in one call
+    void cmdPipelineBarrier( vk::CommandBuffer             commandBuffer,
+                             vk::PipelineStageFlags        srcStages,
+                             vk::PipelineStageFlags        dstStages,
+                             std::uint32_t                 uiMemoryBarrierCount,
+                             const vk::MemoryBarrier*      pMemoryBarriers,
+                             std::uint32_t                 uiImageBarrierCount,
+                             const vk::ImageMemoryBarrier* pImageBarriers ) const
+    {
+        m_pfnCmdPipelineBarrier( static_cast< VkCommandBuffer >( commandBuffer ),
+                                 static_cast< VkPipelineStageFlags >( srcStages ),
+                                 static_cast< VkPipelineStageFlags >( dstStages ),
+                                 0,
+                                 uiMemoryBarrierCount,
+                                 reinterpret_cast< const VkMemoryBarrier* >( pMemoryBarriers ),
+                                 0U,
+                                 nullptr,
+                                 uiImageBarrierCount,
+                                 reinterpret_cast< const VkImageMemoryBarrier* >( pImageBarriers ) );
+    }
+    void cmdResetQueryPool( vk::CommandBuffer commandBuffer,
+                            vk::QueryPool     queryPool,
+                            std::uint32_t     uiFirstQuery,
+                            std::uint32_t     uiQueryCount ) const
+    {
+        m_pfnCmdResetQueryPool( static_cast< VkCommandBuffer >( commandBuffer ),
+                                static_cast< VkQueryPool >( queryPool ),
+                                uiFirstQuery,
+                                uiQueryCount );
+    }
+    void cmdWriteTimestamp( vk::CommandBuffer         commandBuffer,
+                            vk::PipelineStageFlagBits stage,
+                            vk::QueryPool             queryPool,
+                            std::uint32_t             uiQuery ) const
+    {
+        m_pfnCmdWriteTimestamp( static_cast< VkCommandBuffer >( commandBuffer ),
+                                static_cast< VkPipelineStageFlagBits >( stage ),
+                                static_cast< VkQueryPool >( queryPool ),
+                                uiQuery );
+    }
+    void cmdBlitImage( vk::CommandBuffer    commandBuffer,
+                       vk::Image            srcImage,
+                       vk::ImageLayout      srcLayout,
+                       vk::Image            dstImage,
+                       vk::ImageLayout      dstLayout,
+                       const vk::ImageBlit& region,
+                       vk::Filter           filter ) const
+    {
+        m_pfnCmdBlitImage( static_cast< VkCommandBuffer >( commandBuffer ),
+                           static_cast< VkImage >( srcImage ),
+                           static_cast< VkImageLayout >( srcLayout ),
+                           static_cast< VkImage >( dstImage ),
+                           static_cast< VkImageLayout >( dstLayout ),
+                           1U,
+                           reinterpret_cast< const VkImageBlit* >( &region ),
+                           static_cast< VkFilter >( filter ) );
+    }
+    void cmdExecuteCommands( vk::CommandBuffer commandBuffer, vk::CommandBuffer secondaryCommandBuffer ) const
+    {
+        const VkCommandBuffer rawSecondaryCommandBuffer = static_cast< VkCommandBuffer >( secondaryCommandBuffer );
+        m_pfnCmdExecuteCommands( static_cast< VkCommandBuffer >( commandBuffer ), 1U, &rawSecondaryCommandBuffer );
+    }
+
+    // queue and synchronisation
+    VkResult queueSubmit( vk::Queue queue, const vk::SubmitInfo& submitInfo, vk::Fence fence ) const
+    {
+        return m_pfnQueueSubmit( static_cast< VkQueue >( queue ),
+                                 1U,
+                                 reinterpret_cast< const VkSubmitInfo* >( &submitInfo ),
+                                 static_cast< VkFence >( fence ) );
+    }
+    VkResult queuePresent( vk::Queue queue, const vk::PresentInfoKHR& presentInfo ) const
+    {
+        return m_pfnQueuePresentKHR( static_cast< VkQueue >( queue ),
+                                     reinterpret_cast< const VkPresentInfoKHR* >( &presentInfo ) );
+    }
+    VkResult acquireNextImage( vk::SwapchainKHR swapchain,
+                               std::uint64_t    uiTimeoutNS,
+                               vk::Semaphore    semaphore,
+                               std::uint32_t&   uiImageIndex ) const
+    {
+        return m_pfnAcquireNextImageKHR( static_cast< VkDevice >( m_device ),
+                                         static_cast< VkSwapchainKHR >( swapchain ),
+                                         uiTimeoutNS,
+                                         static_cast< VkSemaphore >( semaphore ),
+                                         VK_NULL_HANDLE,
+                                         &uiImageIndex );
+    }
+    VkResult getSemaphoreCounterValue( vk::Semaphore semaphore, std::uint64_t& uiValue ) const
+    {
+        return m_pfnGetSemaphoreCounterValue(
+            static_cast< VkDevice >( m_device ), static_cast< VkSemaphore >( semaphore ), &uiValue );
+    }
+    VkResult waitSemaphores( const vk::SemaphoreWaitInfo& waitInfo, std::uint64_t uiTimeoutNS ) const
+    {
+        return m_pfnWaitSemaphores( static_cast< VkDevice >( m_device ),
+                                    reinterpret_cast< const VkSemaphoreWaitInfo* >( &waitInfo ),
+                                    uiTimeoutNS );
+    }
+
+private:
+    vk::Device m_device;
+
+    PFN_vkBeginCommandBuffer       m_pfnBeginCommandBuffer       = nullptr;
+    PFN_vkEndCommandBuffer         m_pfnEndCommandBuffer         = nullptr;
+    PFN_vkResetCommandBuffer       m_pfnResetCommandBuffer       = nullptr;
+    PFN_vkCmdBeginRenderPass       m_pfnCmdBeginRenderPass       = nullptr;
+    PFN_vkCmdEndRenderPass         m_pfnCmdEndRenderPass         = nullptr;
+    PFN_vkCmdBindPipeline          m_pfnCmdBindPipeline          = nullptr;
+    PFN_vkCmdSetViewport           m_pfnCmdSetViewport           = nullptr;
+    PFN_vkCmdSetScissor            m_pfnCmdSetScissor            = nullptr;
+    PFN_vkCmdBindDescriptorSets    m_pfnCmdBindDescriptorSets    = nullptr;
+    PFN_vkCmdBindVertexBuffers     m_pfnCmdBindVertexBuffers     = nullptr;
+    PFN_vkCmdBindIndexBuffer       m_pfnCmdBindIndexBuffer       = nullptr;
+    PFN_vkCmdPushConstants         m_pfnCmdPushConstants         = nullptr;
+    PFN_vkCmdDrawIndexed           m_pfnCmdDrawIndexed           = nullptr;
+    PFN_vkCmdDrawIndexedIndirect   m_pfnCmdDrawIndexedIndirect   = nullptr;
+    PFN_vkCmdDrawIndirect          m_pfnCmdDrawIndirect          = nullptr;
+    PFN_vkCmdDispatch              m_pfnCmdDispatch              = nullptr;
+    PFN_vkCmdDispatchIndirect      m_pfnCmdDispatchIndirect      = nullptr;
+    PFN_vkCmdUpdateBuffer          m_pfnCmdUpdateBuffer          = nullptr;
+    PFN_vkCmdCopyBuffer            m_pfnCmdCopyBuffer            = nullptr;
+    PFN_vkCmdPipelineBarrier       m_pfnCmdPipelineBarrier       = nullptr;
+    PFN_vkCmdResetQueryPool        m_pfnCmdResetQueryPool        = nullptr;
+    PFN_vkCmdWriteTimestamp        m_pfnCmdWriteTimestamp        = nullptr;
+    PFN_vkCmdBlitImage             m_pfnCmdBlitImage             = nullptr;
+    PFN_vkCmdExecuteCommands       m_pfnCmdExecuteCommands       = nullptr;
+    PFN_vkQueueSubmit              m_pfnQueueSubmit              = nullptr;
+    PFN_vkQueuePresentKHR          m_pfnQueuePresentKHR          = nullptr;
+    PFN_vkAcquireNextImageKHR      m_pfnAcquireNextImageKHR      = nullptr;
+    PFN_vkGetSemaphoreCounterValue m_pfnGetSemaphoreCounterValue = nullptr;
+    PFN_vkWaitSemaphores           m_pfnWaitSemaphores           = nullptr;
+};
+
+} // namespace retail
+
+#endif // DEVICE_DISPATCH_17_OCTOBER_2022
@@ -0,0 +1,37 @@
+#ifndef HASH_7_OCTOBER_2022
+#define HASH_7_OCTOBER_2022
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+namespace retail
+{
+
+// 64 bit FNV-1a - stable across builds so it can be persisted in asset files
+inline constexpr std::uint64_t fnv1a64( const void* pData, std::size_t szSize,
+                                        std::uint64_t uiHash = 0xcbf29ce484222325ULL )
+{
+    const unsigned char* p = static_cast< const unsigned char* >( pData );
+    for ( std::size_t i = 0; i != szSize; ++i )
+    {
+        uiHash ^= p[ i ];
+        uiHash *= 0x100000001b3ULL;
+    }
+    return uiHash;
+}
+
+inline constexpr std::uint64_t fnv1a64( std::string_view str )
+{
+    std::uint64_t uiHash = 0xcbf29ce484222325ULL;
+    for ( char c : str )
+    {
+        uiHash ^= static_cast< unsigned char >( c );
+        uiHash *= 0x100000001b3ULL;
+    }
+    return uiHash;
+}
+
+} // namespace retail
+
+#endif // HASH_7_OCTOBER_2022
@@ -0,0 +1,78 @@
+#ifndef HISTOGRAM_19_OCTOBER_2022
+#define HISTOGRAM_19_OCTOBER_2022
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace retail
+{
+
+// Latency histogram over fixed buckets growing by root two from half a millisecond to a second.
+//
+// Fixed bounds make histograms from different runs and windows directly comparable and adding a
+// sample is a short search over a constant table.  Percentiles resolve to a bucket's upper bound.
+class LatencyHistogram
+{
+public:
+    // inclusive upper bounds - samples above the last bound land in the overflow bucket
+    static constexpr std::array< std::uint32_t, 23 > kBoundsUS
+        = { 500U,    707U,    1000U,   1414U,   2000U,   2828U,   4000U,   5657U,
+            8000U,   11314U,  16000U,  22627U,  32000U,  45255U,  64000U,  90510U,
+            128000U, 181019U, 256000U, 362039U, 512000U, 724077U, 1024000U };
+    static constexpr std::uint32_t kBucketCount = static_cast< std::uint32_t >( kBoundsUS.size() ) + 1U;
+
+    static std::uint32_t findBucket( std::uint64_t uiUS )
+    {
+        const auto iBound
+            = std::lower_bound( kBoundsUS.begin(),
+                                kBoundsUS.end(),
+                                uiUS,
+                                []( std::uint32_t uiBound, std::uint64_t uiValue ) { return uiBound < uiValue; } );
+        return static_cast< std::uint32_t >( iBound - kBoundsUS.begin() );
+    }
+
+    void add( std::chrono::microseconds latency )
+    {
+        const std::uint64_t uiUS = static_cast< std::uint64_t >( std::max< std::int64_t >( latency.count(), 0 ) );
+        ++m_buckets[ findBucket( uiUS ) ];
+        ++m_uiCount;
+        m_uiSumUS += uiUS;
+        m_uiMaxUS = std::max( m_uiMaxUS, uiUS );
+    }
+
+    std::uint64_t getCount() const { return m_uiCount; }
+    std::uint64_t getSumUS() const { return m_uiSumUS; }
+    std::uint64_t getMaxUS() const { return m_uiMaxUS; }
+    std::uint64_t getBucket( std::uint32_t uiBucket ) const { return m_buckets[ uiBucket ]; }
+
+    // upper bound of the bucket holding the percentile - the maximum for the overflow bucket
+    std::uint64_t getPercentileUS( float fPercentile ) const
+    {
+        if ( m_uiCount == 0U )
+            return 0U;
+        const std::uint64_t uiRank = std::max< std::uint64_t >(
+            static_cast< std::uint64_t >( static_cast< double >( m_uiCount ) * fPercentile / 100.0 + 0.5 ), 1U );
+        std::uint64_t uiSeen = 0U;
+        for ( std::uint32_t i = 0; i != kBoundsUS.size(); ++i )
+        {
+            uiSeen += m_buckets[ i ];
+            if ( uiSeen >= uiRank )
+                return std::min< std::uint64_t >( kBoundsUS[ i ], m_uiMaxUS );
+        }
+        return m_uiMaxUS;
+    }
+
+    void reset() { *this = LatencyHistogram{}; }
+
+private:
+    std::array< std::uint64_t, kBucketCount > m_buckets{};
+    std::uint64_t                             m_uiCount = 0U;
+    std::uint64_t                             m_uiSumUS = 0U;
+    std::uint64_t                             m_uiMaxUS = 0U;
+};
+
+} // namespace retail
+
+#endif // HISTOGRAM_19_OCTOBER_2022
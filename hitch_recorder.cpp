@@ -0,0 +1,225 @@
+#include "hitch_recorder.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <boost/filesystem/operations.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+
+namespace retail
+{
+
+namespace
+{
+std::uint32_t toMicroseconds( std::chrono::steady_clock::duration duration )
+{
+    const auto us = std::chrono::duration_cast< std::chrono::microseconds >( duration ).count();
+    return static_cast< std::uint32_t >(
+        std::min< std::int64_t >( us, std::numeric_limits< std::uint32_t >::max() ) );
+}
+
+const char* toString( HitchRecorder::Stage stage )
+{
+    switch ( stage )
+    {
+        case HitchRecorder::Stage::eWait:
+            return "wait_us";
+        case HitchRecorder::Stage::eUpdate:
+            return "update_us";
+        case HitchRecorder::Stage::eAcquire:
+            return "acquire_us";
+        case HitchRecorder::Stage::eRecord:
+            return "record_us";
+        case HitchRecorder::Stage::eSubmit:
+            return "submit_us";
+        case HitchRecorder::Stage::ePresent:
+            return "present_us";
+        case HitchRecorder::Stage::eFrame:
+            return "frame_us";
+        case HitchRecorder::Stage::eEvents:
+            return "events_us";
+        case HitchRecorder::Stage::eSleep:
+            return "sleep_us";
+    }
+    return "unknown";
+}
+} // namespace
+
+HitchRecorder::HitchRecorder( const Config& config )
+    : m_config( config )
+    , m_uiMask( config.uiCapacity - 1U )
+    , m_threshold( std::chrono::duration_cast< Clock::duration >(
+          std::chrono::duration< float, std::milli >( config.fThresholdMS ) ) )
+    , m_startTime( Clock::now() )
+    , m_records( config.uiCapacity )
+{
+    VERIFY_RTE_MSG( config.uiCapacity && ( config.uiCapacity & m_uiMask ) == 0U,
+                    "Hitch recorder capacity must be a power of two: " << config.uiCapacity );
+    VERIFY_RTE_MSG( config.uiTrailingFrames < config.uiCapacity,
+                    "Hitch recorder trailing frames must be less than the capacity" );
+
+    if ( m_config.fThresholdMS > 0.0f )
+    {
+        m_writer = std::thread( [ this ]() { writerThread(); } );
+        SPDLOG_INFO( "Recording hitches over: {}ms to: {}", m_config.fThresholdMS, m_config.dumpDirectory.string() );
+    }
+}
+
+HitchRecorder::~HitchRecorder()
+{
+    if ( m_writer.joinable() )
+    {
+        {
+            std::lock_guard< std::mutex > lock( m_mutex );
+            m_bStop = true;
+        }
+        m_condition.notify_one();
+        m_writer.join();
+    }
+}
+
+void HitchRecorder::beginFrame()
+{
+    m_frameStart = Clock::now();
+    m_lastMark   = m_frameStart;
+
+    m_pCurrent            = &m_records[ m_uiFrame & m_uiMask ];
+    *m_pCurrent           = FrameRecord{};
+    m_pCurrent->uiFrame   = m_uiFrame;
+    m_pCurrent->uiStartUS
+        = std::chrono::duration_cast< std::chrono::microseconds >( m_frameStart - m_startTime ).count();
+
+    for ( std::uint32_t i = 0; i != kCounterCount; ++i )
+    {
+        m_frameCounters[ i ] = readCounter( static_cast< Counter >( i ) );
+    }
+}
+
+void HitchRecorder::mark( Stage stage )
+{
+    const Clock::time_point now = Clock::now();
+    m_pCurrent->stagesUS[ static_cast< std::uint32_t >( stage ) ] += toMicroseconds( now - m_lastMark );
+    m_lastMark = now;
+}
+
+void HitchRecorder::endFrame()
+{
+    const Clock::duration frameTime = Clock::now() - m_frameStart;
+    m_pCurrent->uiTotalUS           = toMicroseconds( frameTime );
+    for ( std::uint32_t i = 0; i != kCounterCount; ++i )
+    {
+        m_pCurrent->counters[ i ]
+            = static_cast< std::uint32_t >( readCounter( static_cast< Counter >( i ) ) - m_frameCounters[ i ] );
+    }
+    ++m_uiFrame;
+
+    if ( m_config.fThresholdMS <= 0.0f )
+        return;
+
+    if ( frameTime > m_threshold )
+    {
+        ++m_uiHitches;
+        SPDLOG_WARN( "Hitch on frame: {} took: {}us", m_pCurrent->uiFrame, m_pCurrent->uiTotalUS );
+        if ( m_uiDumpFrame )
+        {
+            ++m_uiDumpHitches;
+        }
+        else if ( m_uiFrame >= m_uiCooldownFrame )
+        {
+            m_uiHitchFrame  = m_pCurrent->uiFrame;
+            m_uiDumpFrame   = m_uiFrame + m_config.uiTrailingFrames;
+            m_uiDumpHitches = 1U;
+        }
+    }
+
+    if ( m_uiDumpFrame && m_uiFrame >= m_uiDumpFrame )
+    {
+        scheduleDump();
+        m_uiDumpFrame     = 0U;
+        m_uiCooldownFrame = m_uiFrame + m_config.uiCooldownFrames;
+    }
+}
+
+void HitchRecorder::scheduleDump()
+{
+    Dump dump{ m_uiHitchFrame, m_uiDumpHitches, {} };
+
+    // oldest first - the ring wraps at the frame index modulo the capacity
+    const std::uint64_t uiCount = std::min< std::uint64_t >( m_uiFrame, m_config.uiCapacity );
+    dump.records.reserve( uiCount );
+    for ( std::uint64_t uiFrame = m_uiFrame - uiCount; uiFrame != m_uiFrame; ++uiFrame )
+    {
+        dump.records.push_back( m_records[ uiFrame & m_uiMask ] );
+    }
+
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+        m_dumps.push_back( std::move( dump ) );
+    }
+    m_condition.notify_one();
+}
+
+void HitchRecorder::writerThread()
+{
+    std::unique_lock< std::mutex > lock( m_mutex );
+    while ( true )
+    {
+        m_condition.wait( lock, [ this ]() { return m_bStop || !m_dumps.empty(); } );
+        if ( m_dumps.empty() )
+            return;
+
+        const Dump dump = std::move( m_dumps.front() );
+        m_dumps.pop_front();
+        lock.unlock();
+        try
+        {
+            write( dump );
+        }
+        catch ( std::exception& ex )
+        {
+            SPDLOG_ERROR( "Failed to write hitch dump: {}", ex.what() );
+        }
+        lock.lock();
+    }
+}
+
+void HitchRecorder::write( const Dump& dump ) const
+{
+    boost::filesystem::create_directories( m_config.dumpDirectory );
+    const boost::filesystem::path filePath
+        = m_config.dumpDirectory / ( "hitch_" + std::to_string( dump.uiHitchFrame ) + ".csv" );
+
+    std::ofstream os( filePath.native().c_str(), std::ios::out | std::ios::trunc );
+    if ( !os.good() )
+    {
+        THROW_RTE( "Failed to open file: " << filePath.string() );
+    }
+
+    os << "# hitch frame: " << dump.uiHitchFrame << " hitches: " << dump.uiHitches
+       << " threshold_ms: " << m_config.fThresholdMS << "\n";
+    os << "frame,start_us,total_us";
+    for ( std::uint32_t i = 0; i != kStageCount; ++i )
+        os << ',' << toString( static_cast< Stage >( i ) );
+    for ( std::uint32_t i = 0; i != kCounterCount; ++i )
+        os << ',' << toString( static_cast< Counter >( i ) );
+    os << '\n';
+
+    for ( const FrameRecord& record : dump.records )
+    {
+        os << record.uiFrame << ',' << record.uiStartUS << ',' << record.uiTotalUS;
+        for ( std::uint32_t uiStage : record.stagesUS )
+            os << ',' << uiStage;
+        for ( std::uint32_t uiCounter : record.counters )
+            os << ',' << uiCounter;
+        os << '\n';
+    }
+    VERIFY_RTE_MSG( os.good(), "Failed writing file: " << filePath.string() );
+
+    SPDLOG_INFO( "Wrote hitch dump: {} with: {} frames", filePath.string(), dump.records.size() );
+}
+
+} // namespace retail
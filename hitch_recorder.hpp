@@ -0,0 +1,119 @@
+#ifndef HITCH_RECORDER_19_OCTOBER_2022
+#define HITCH_RECORDER_19_OCTOBER_2022
+
+#include "counters.hpp"
+
+#include <boost/filesystem/path.hpp>
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace retail
+{
+
+// Keeps the last few thousand frames of stage timings and counters so a stall can be diagnosed
+// after the fact.
+//
+// The frame thread is the only writer and the ring is never locked - recording a frame is a
+// handful of clock reads and stores into a preallocated slot.  When a frame takes longer than the
+// threshold a dump is scheduled a few frames later so the recovery after the stall is captured
+// too.  The ring is then copied and handed to a writer thread so the file write never lands on the
+// frame thread.  Further hitches inside the cooldown are counted but do not dump again.
+class HitchRecorder
+{
+public:
+    enum class Stage : std::uint32_t
+    {
+        eWait,    // waiting for the frame slot to be free
+        eUpdate,  // scene and ui
+        eAcquire, // swapchain images
+        eRecord,  // command buffer
+        eSubmit,
+        ePresent,
+        eFrame, // rest of frame() not covered by a finer stage
+        eEvents,
+        eSleep,
+    };
+    static constexpr std::uint32_t kStageCount = static_cast< std::uint32_t >( Stage::eSleep ) + 1U;
+
+    struct FrameRecord
+    {
+        std::uint64_t                              uiFrame;
+        std::uint64_t                              uiStartUS; // since the recorder was created
+        std::uint32_t                              uiTotalUS;
+        std::array< std::uint32_t, kStageCount >   stagesUS;
+        std::array< std::uint32_t, kCounterCount > counters; // deltas over the frame
+    };
+
+    struct Config
+    {
+        float                   fThresholdMS     = 50.0f; // zero disables dumps
+        boost::filesystem::path dumpDirectory    = ".";
+        std::uint32_t           uiCapacity       = 4096U; // frames - power of two
+        std::uint32_t           uiTrailingFrames = 60U;   // recorded after a hitch before dumping
+        std::uint32_t           uiCooldownFrames = 1024U; // after a dump before another hitch may dump
+    };
+
+    HitchRecorder( const Config& config );
+    ~HitchRecorder();
+
+    HitchRecorder( const HitchRecorder& )            = delete;
+    HitchRecorder& operator=( const HitchRecorder& ) = delete;
+
+    void beginFrame();
+    // attributes the time since the previous mark to the stage
+    void mark( Stage stage );
+    void endFrame();
+
+    std::uint64_t getFrameCount() const { return m_uiFrame; }
+    std::uint64_t getHitchCount() const { return m_uiHitches; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Dump
+    {
+        std::uint64_t              uiHitchFrame;
+        std::uint32_t              uiHitches; // inside the dump window
+        std::vector< FrameRecord > records;   // oldest first
+    };
+
+    void scheduleDump();
+    void writerThread();
+    void write( const Dump& dump ) const;
+
+    const Config               m_config;
+    const std::uint32_t        m_uiMask;
+    const Clock::duration      m_threshold;
+    const Clock::time_point    m_startTime;
+    std::vector< FrameRecord > m_records;
+
+    // frame thread only
+    std::uint64_t                              m_uiFrame = 0U;
+    Clock::time_point                          m_frameStart;
+    Clock::time_point                          m_lastMark;
+    FrameRecord*                               m_pCurrent = nullptr;
+    std::array< std::uint64_t, kCounterCount > m_frameCounters{};
+    std::uint64_t                              m_uiHitches       = 0U;
+    std::uint64_t                              m_uiDumpFrame     = 0U; // zero when no dump is pending
+    std::uint64_t                              m_uiHitchFrame    = 0U;
+    std::uint32_t                              m_uiDumpHitches   = 0U;
+    std::uint64_t                              m_uiCooldownFrame = 0U;
+
+    // hand off to the writer thread
+    std::mutex              m_mutex;
+    std::condition_variable m_condition;
+    std::deque< Dump >      m_dumps;
+    bool                    m_bStop = false;
+    std::thread             m_writer;
+};
+
+} // namespace retail
+
+#endif // HITCH_RECORDER_19_OCTOBER_2022
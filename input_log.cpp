@@ -0,0 +1,232 @@
+#include "input_log.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <SDL2/SDL.h>
+
+#include <cstddef>
+#include <cstring>
+
+namespace retail
+{
+namespace input_log
+{
+std::uint32_t getRecordedSize( std::uint32_t uiType )
+{
+    switch ( uiType )
+    {
+        case SDL_QUIT:
+            return sizeof( SDL_QuitEvent );
+        case SDL_APP_TERMINATING:
+        case SDL_APP_LOWMEMORY:
+        case SDL_APP_WILLENTERBACKGROUND:
+        case SDL_APP_DIDENTERBACKGROUND:
+        case SDL_APP_WILLENTERFOREGROUND:
+        case SDL_APP_DIDENTERFOREGROUND:
+        case SDL_KEYMAPCHANGED:
+        case SDL_CLIPBOARDUPDATE:
+            return sizeof( SDL_CommonEvent );
+        case SDL_WINDOWEVENT:
+            return sizeof( SDL_WindowEvent );
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            return sizeof( SDL_KeyboardEvent );
+        case SDL_TEXTEDITING:
+            return sizeof( SDL_TextEditingEvent );
+        case SDL_TEXTINPUT:
+            return sizeof( SDL_TextInputEvent );
+        case SDL_MOUSEMOTION:
+            return sizeof( SDL_MouseMotionEvent );
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            return sizeof( SDL_MouseButtonEvent );
+        case SDL_MOUSEWHEEL:
+            return sizeof( SDL_MouseWheelEvent );
+        case SDL_JOYAXISMOTION:
+            return sizeof( SDL_JoyAxisEvent );
+        case SDL_JOYBALLMOTION:
+            return sizeof( SDL_JoyBallEvent );
+        case SDL_JOYHATMOTION:
+            return sizeof( SDL_JoyHatEvent );
+        case SDL_JOYBUTTONDOWN:
+        case SDL_JOYBUTTONUP:
+            return sizeof( SDL_JoyButtonEvent );
+        case SDL_JOYDEVICEADDED:
+        case SDL_JOYDEVICEREMOVED:
+            return sizeof( SDL_JoyDeviceEvent );
+        case SDL_CONTROLLERAXISMOTION:
+            return sizeof( SDL_ControllerAxisEvent );
+        case SDL_CONTROLLERBUTTONDOWN:
+        case SDL_CONTROLLERBUTTONUP:
+            return sizeof( SDL_ControllerButtonEvent );
+        case SDL_CONTROLLERDEVICEADDED:
+        case SDL_CONTROLLERDEVICEREMOVED:
+        case SDL_CONTROLLERDEVICEREMAPPED:
+            return sizeof( SDL_ControllerDeviceEvent );
+        case SDL_FINGERDOWN:
+        case SDL_FINGERUP:
+        case SDL_FINGERMOTION:
+            return sizeof( SDL_TouchFingerEvent );
+        case SDL_DOLLARGESTURE:
+        case SDL_DOLLARRECORD:
+            return sizeof( SDL_DollarGestureEvent );
+        case SDL_MULTIGESTURE:
+            return sizeof( SDL_MultiGestureEvent );
+        default:
+            // drop, system window manager and user events carry pointers
+            return 0U;
+    }
+}
+} // namespace input_log
+
+InputRecorder::InputRecorder( const boost::filesystem::path& filePath, std::uint32_t uiWindowCount )
+    : m_filePath( filePath )
+    , m_os( filePath.native().c_str(), std::ios::out | std::ios::binary | std::ios::trunc )
+    , m_uiStartTicks( SDL_GetTicks() )
+{
+    if ( !m_os.good() )
+    {
+        THROW_RTE( "Failed to open file: " << filePath.string() );
+    }
+    const input_log::FileHeader header{
+        input_log::kMagic, input_log::kVersion, sizeof( SDL_Event ), uiWindowCount, 0U };
+    m_os.write( reinterpret_cast< const char* >( &header ), sizeof( header ) );
+    SPDLOG_INFO( "Recording input to: {}", filePath.string() );
+}
+
+InputRecorder::~InputRecorder()
+{
+    // the frame count marks the log as complete
+    m_os.seekp( offsetof( input_log::FileHeader, uiFrameCount ) );
+    m_os.write( reinterpret_cast< const char* >( &m_uiFrames ), sizeof( m_uiFrames ) );
+    m_os.close();
+    if ( m_os.fail() )
+    {
+        SPDLOG_ERROR( "Failed writing input log: {}", m_filePath.string() );
+        return;
+    }
+    SPDLOG_INFO( "Recorded {} frames and {} events to: {} skipped: {} unrecordable events",
+                 m_uiFrames,
+                 m_uiEvents,
+                 m_filePath.string(),
+                 m_uiSkipped );
+}
+
+void InputRecorder::beginFrame( std::uint64_t uiFrame, std::chrono::microseconds time )
+{
+    m_frame = input_log::FrameRecord{ uiFrame, static_cast< std::uint64_t >( time.count() ), 0U, 0U };
+    m_events.clear();
+}
+
+void InputRecorder::record( const SDL_Event& ev )
+{
+    const std::uint32_t uiSize = input_log::getRecordedSize( ev.type );
+    if ( uiSize == 0U )
+    {
+        ++m_uiSkipped;
+        return;
+    }
+
+    const input_log::EventRecord record{ ev.common.timestamp - m_uiStartTicks, uiSize };
+    const std::size_t            szOffset = m_events.size();
+    m_events.resize( szOffset + sizeof( record ) + uiSize );
+    std::memcpy( m_events.data() + szOffset, &record, sizeof( record ) );
+    std::memcpy( m_events.data() + szOffset + sizeof( record ), &ev, uiSize );
+    ++m_frame.uiEventCount;
+    ++m_uiEvents;
+}
+
+void InputRecorder::endFrame()
+{
+    m_os.write( reinterpret_cast< const char* >( &m_frame ), sizeof( m_frame ) );
+    m_os.write( reinterpret_cast< const char* >( m_events.data() ), static_cast< std::streamsize >( m_events.size() ) );
+    ++m_uiFrames;
+}
+
+template < typename T >
+T InputReplay::read( std::size_t szOffset ) const
+{
+    T result;
+    std::memcpy( &result, m_file.data() + szOffset, sizeof( T ) );
+    return result;
+}
+
+InputReplay::InputReplay( const boost::filesystem::path& filePath, std::uint32_t uiWindowCount )
+    : m_file( filePath )
+    , m_szEnd( sizeof( input_log::FileHeader ) )
+{
+    VERIFY_RTE_MSG( m_file.size() >= sizeof( input_log::FileHeader ), "Input log too small: " << filePath.string() );
+    const input_log::FileHeader header = read< input_log::FileHeader >( 0U );
+    VERIFY_RTE_MSG( header.uiMagic == input_log::kMagic, "Not an input log: " << filePath.string() );
+    VERIFY_RTE_MSG( header.uiVersion == input_log::kVersion,
+                    "Unsupported input log version: " << header.uiVersion << " in: " << filePath.string() );
+    VERIFY_RTE_MSG( header.uiEventSize == sizeof( SDL_Event ),
+                    "Input log: " << filePath.string() << " was recorded with a different SDL_Event layout" );
+    VERIFY_RTE_MSG( header.uiWindowCount == uiWindowCount,
+                    "Input log: " << filePath.string() << " was recorded with: " << header.uiWindowCount
+                                  << " windows not: " << uiWindowCount );
+
+    // validate every record up front so replay never reads past the mapping
+    std::uint64_t uiEvents = 0U;
+    std::size_t   szOffset = sizeof( input_log::FileHeader );
+    while ( m_file.size() - szOffset >= sizeof( input_log::FrameRecord ) )
+    {
+        const input_log::FrameRecord frame = read< input_log::FrameRecord >( szOffset );
+        std::size_t                  szNext = szOffset + sizeof( input_log::FrameRecord );
+        bool                         bValid = true;
+        for ( std::uint32_t i = 0; bValid && i != frame.uiEventCount; ++i )
+        {
+            bValid = m_file.size() - szNext >= sizeof( input_log::EventRecord );
+            if ( bValid )
+            {
+                const input_log::EventRecord event = read< input_log::EventRecord >( szNext );
+                szNext += sizeof( input_log::EventRecord );
+                bValid = event.uiSize <= sizeof( SDL_Event ) && m_file.size() - szNext >= event.uiSize;
+                szNext += bValid ? event.uiSize : 0U;
+            }
+        }
+        if ( !bValid )
+            break;
+        szOffset = szNext;
+        uiEvents += frame.uiEventCount;
+        ++m_uiFrameCount;
+    }
+    m_szEnd = szOffset;
+
+    if ( header.uiFrameCount != m_uiFrameCount )
+    {
+        SPDLOG_WARN( "Input log: {} is truncated - replaying the first: {} frames", filePath.string(), m_uiFrameCount );
+    }
+    SPDLOG_INFO( "Replaying {} frames and {} events from: {}", m_uiFrameCount, uiEvents, filePath.string() );
+}
+
+std::chrono::microseconds InputReplay::getFrameTime() const
+{
+    VERIFY_RTE( !isFinished() );
+    return std::chrono::microseconds( read< input_log::FrameRecord >( m_szOffset ).uiTimeUS );
+}
+
+const std::vector< SDL_Event >& InputReplay::nextFrame()
+{
+    VERIFY_RTE( !isFinished() );
+    const input_log::FrameRecord frame = read< input_log::FrameRecord >( m_szOffset );
+    m_szOffset += sizeof( input_log::FrameRecord );
+
+    // stamped as if raised now so input latency is measured from the injection
+    const std::uint32_t uiTicks = SDL_GetTicks();
+    m_events.resize( frame.uiEventCount );
+    for ( SDL_Event& ev : m_events )
+    {
+        const input_log::EventRecord event = read< input_log::EventRecord >( m_szOffset );
+        m_szOffset += sizeof( input_log::EventRecord );
+        std::memset( &ev, 0, sizeof( SDL_Event ) );
+        std::memcpy( &ev, m_file.data() + m_szOffset, event.uiSize );
+        m_szOffset += event.uiSize;
+        ev.common.timestamp = uiTicks;
+    }
+    return m_events;
+}
+
+} // namespace retail
@@ -0,0 +1,116 @@
+#ifndef INPUT_LOG_19_OCTOBER_2022
+#define INPUT_LOG_19_OCTOBER_2022
+
+#include "mapped_file.hpp"
+
+#include "SDL2/SDL_events.h"
+
+#include <boost/filesystem/path.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+namespace retail
+{
+namespace input_log
+{
+    // Binary input log layout
+    //
+    // FileHeader
+    // per frame:   FrameRecord followed by uiEventCount events
+    // per event:   EventRecord followed by the first uiSize bytes of the SDL_Event
+    //
+    // Every frame is written even without events so replay reproduces the frame times the scene
+    // was animated with.  Events are truncated to the union member for their type and event types
+    // carrying pointers are not recorded.
+    static constexpr std::uint32_t kMagic   = 0x504E4952U; // "RINP"
+    static constexpr std::uint32_t kVersion = 1U;
+
+    struct FileHeader
+    {
+        std::uint32_t uiMagic;
+        std::uint32_t uiVersion;
+        std::uint32_t uiEventSize; // sizeof( SDL_Event ) of the recording build
+        std::uint32_t uiWindowCount;
+        std::uint64_t uiFrameCount; // zero if the recording was not closed cleanly
+    };
+
+    struct FrameRecord
+    {
+        std::uint64_t uiFrame;
+        std::uint64_t uiTimeUS; // since the recording started - the time the frame animated with
+        std::uint32_t uiEventCount;
+        std::uint32_t uiReserved;
+    };
+
+    struct EventRecord
+    {
+        std::uint32_t uiTimeMS; // SDL timestamp since the recording started
+        std::uint32_t uiSize;
+    };
+
+    // bytes of SDL_Event recorded for the event type - zero when the type cannot be recorded
+    std::uint32_t getRecordedSize( std::uint32_t uiType );
+} // namespace input_log
+
+// Writes every recordable SDL event polled after each frame to an input log.
+class InputRecorder
+{
+public:
+    InputRecorder( const boost::filesystem::path& filePath, std::uint32_t uiWindowCount );
+    ~InputRecorder();
+
+    InputRecorder( const InputRecorder& )            = delete;
+    InputRecorder& operator=( const InputRecorder& ) = delete;
+
+    void beginFrame( std::uint64_t uiFrame, std::chrono::microseconds time );
+    void record( const SDL_Event& ev );
+    void endFrame();
+
+private:
+    boost::filesystem::path     m_filePath;
+    std::ofstream               m_os;
+    std::uint32_t               m_uiStartTicks;
+    input_log::FrameRecord      m_frame{};
+    std::vector< std::uint8_t > m_events; // the current frame's event records
+    std::uint64_t               m_uiFrames  = 0U;
+    std::uint64_t               m_uiEvents  = 0U;
+    std::uint64_t               m_uiSkipped = 0U;
+};
+
+// Reads an input log back one frame at a time.
+class InputReplay
+{
+public:
+    InputReplay( const boost::filesystem::path& filePath, std::uint32_t uiWindowCount );
+
+    InputReplay( const InputReplay& )            = delete;
+    InputReplay& operator=( const InputReplay& ) = delete;
+
+    bool isFinished() const { return m_szOffset == m_szEnd; }
+
+    // time the next frame animated with when recorded
+    std::chrono::microseconds getFrameTime() const;
+
+    // the next frame's events stamped with the current SDL time - invalidated by the next call
+    const std::vector< SDL_Event >& nextFrame();
+
+    std::uint64_t getFrameCount() const { return m_uiFrameCount; }
+
+private:
+    // records are packed so are copied out of the mapping rather than referenced
+    template < typename T >
+    T read( std::size_t szOffset ) const;
+
+    MappedFile               m_file;
+    std::size_t              m_szOffset = sizeof( input_log::FileHeader );
+    std::size_t              m_szEnd;
+    std::uint64_t            m_uiFrameCount = 0U;
+    std::vector< SDL_Event > m_events;
+};
+
+} // namespace retail
+
+#endif // INPUT_LOG_19_OCTOBER_2022
@@ -0,0 +1,157 @@
+#include "latency_tracker.hpp"
+#include "debug.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include "spdlog/spdlog.h"
+
+namespace retail
+{
+
+namespace
+{
+// bounds how long the waiter takes to notice shutdown
+constexpr std::uint64_t kWaitTimeoutNS = 100'000'000U;
+// interval between non-blocking present id polls - the resolution of present complete
+constexpr std::chrono::microseconds kPresentPollInterval{ 250 };
+} // namespace
+
+LatencyTracker::LatencyTracker( const DeviceDispatch&           dispatch,
+                                vk::Semaphore                   timelineSemaphore,
+                                std::vector< vk::SwapchainKHR > swapchains,
+                                bool                            bPresentWait )
+    : m_dispatch( dispatch )
+    , m_timelineSemaphore( timelineSemaphore )
+    , m_swapchains( std::move( swapchains ) )
+    , m_bPresentWait( bPresentWait )
+{
+    VERIFY_RTE( m_timelineSemaphore );
+    m_waiter = std::thread( [ this ]() { waiterThread(); } );
+    SPDLOG_INFO( "Tracking input latency to {}", m_bPresentWait ? "present complete" : "GPU complete" );
+}
+
+LatencyTracker::~LatencyTracker()
+{
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+        m_bStop = true;
+    }
+    m_condition.notify_one();
+    m_waiter.join();
+}
+
+void LatencyTracker::onAcquired()
+{
+    if ( m_awaitingAcquire )
+    {
+        add( Stage::eAcquire, m_awaitingAcquire->input, Clock::now() );
+        m_awaitingAcquire.reset();
+    }
+}
+
+void LatencyTracker::onSubmitted( std::optional< TimePoint > input, std::uint64_t uiTimelineValue )
+{
+    if ( !input )
+    {
+        m_current.reset();
+        return;
+    }
+    add( Stage::eSubmit, input.value(), Clock::now() );
+    m_current = Frame{ input.value(), uiTimelineValue, m_bPresentWait ? m_uiNextPresentId++ : 0U };
+}
+
+void LatencyTracker::onPresented()
+{
+    if ( !m_current )
+        return;
+
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+        m_pending.push_back( m_current.value() );
+    }
+    m_condition.notify_one();
+    m_awaitingAcquire = m_current;
+    m_current.reset();
+}
+
+LatencyHistogram LatencyTracker::getHistogram( Stage stage ) const
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    return m_histograms[ static_cast< std::uint32_t >( stage ) ];
+}
+
+void LatencyTracker::add( Stage stage, const TimePoint& input, const TimePoint& reached )
+{
+    const auto latency = std::chrono::duration_cast< std::chrono::microseconds >( reached - input );
+
+    std::lock_guard< std::mutex > lock( m_mutex );
+    m_histograms[ static_cast< std::uint32_t >( stage ) ].add( latency );
+}
+
+void LatencyTracker::waiterThread()
+{
+    std::unique_lock< std::mutex > lock( m_mutex );
+    while ( true )
+    {
+        m_condition.wait( lock, [ this ]() { return m_bStop || !m_pending.empty(); } );
+        if ( m_bStop )
+            return;
+
+        const Frame frame = m_pending.front();
+        m_pending.pop_front();
+        lock.unlock();
+        try
+        {
+            if ( m_bPresentWait )
+                waitForPresent( frame );
+            else
+                waitForGPU( frame );
+        }
+        catch ( std::exception& ex )
+        {
+            SPDLOG_ERROR(
+                "Latency tracking failed for timeline value: {} error: {}", frame.uiTimelineValue, ex.what() );
+        }
+        lock.lock();
+    }
+}
+
+void LatencyTracker::waitForGPU( const Frame& frame )
+{
+    const vk::SemaphoreWaitInfo waitInfo{ vk::SemaphoreWaitFlags{}, m_timelineSemaphore, frame.uiTimelineValue };
+    while ( true )
+    {
+        const vk::Result result = static_cast< vk::Result >( m_dispatch.waitSemaphores( waitInfo, kWaitTimeoutNS ) );
+        if ( result == vk::Result::eSuccess )
+            break;
+        if ( result != vk::Result::eTimeout )
+            VK_CHECK( result );
+        if ( m_bStop )
+            return;
+    }
+    add( Stage::ePresent, frame.input, Clock::now() );
+}
+
+void LatencyTracker::waitForPresent( const Frame& frame )
+{
+    const vk::Device device = m_dispatch.getDevice();
+    for ( vk::SwapchainKHR swapchain : m_swapchains )
+    {
+        while ( true )
+        {
+            vk::Result result;
+            {
+                std::lock_guard< std::mutex > lock( m_swapchainMutex );
+                result = device.waitForPresentKHR( swapchain, frame.uiPresentId, 0U );
+            }
+            if ( result == vk::Result::eSuccess || result == vk::Result::eSuboptimalKHR )
+                break;
+            if ( m_bStop )
+                return;
+            std::this_thread::sleep_for( kPresentPollInterval );
+        }
+    }
+    add( Stage::ePresent, frame.input, Clock::now() );
+}
+
+} // namespace retail
@@ -0,0 +1,102 @@
+#ifndef LATENCY_TRACKER_19_OCTOBER_2022
+#define LATENCY_TRACKER_19_OCTOBER_2022
+
+#include "device_dispatch.hpp"
+#include "histogram.hpp"
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace retail
+{
+
+// Measures how long the oldest input event consumed by a frame takes to reach the screen.
+//
+// Only frames that consumed input are tracked.  Latency to submit and to the next acquire is taken
+// on the frame thread.  Presentation is observed on a waiter thread: with VK_KHR_present_wait it
+// polls each swapchain's present id, otherwise it waits for the frame's graphics timeline value
+// and takes GPU completion as the nearest available stand-in.  The swapchains must be externally
+// synchronised for present waits, so the frame thread holds getSwapchainMutex() around acquire and
+// present and the waiter only takes it for non-blocking polls.
+class LatencyTracker
+{
+public:
+    using Clock     = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+
+    enum class Stage : std::uint32_t
+    {
+        eSubmit,
+        ePresent, // present complete or GPU complete without VK_KHR_present_wait
+        eAcquire, // the first acquire after the frame was presented
+    };
+    static constexpr std::uint32_t kStageCount = static_cast< std::uint32_t >( Stage::eAcquire ) + 1U;
+
+    LatencyTracker( const DeviceDispatch&           dispatch,
+                    vk::Semaphore                   timelineSemaphore,
+                    std::vector< vk::SwapchainKHR > swapchains,
+                    bool                            bPresentWait );
+    ~LatencyTracker();
+
+    LatencyTracker( const LatencyTracker& )            = delete;
+    LatencyTracker& operator=( const LatencyTracker& ) = delete;
+
+    bool        hasPresentWait() const { return m_bPresentWait; }
+    std::mutex& getSwapchainMutex() { return m_swapchainMutex; }
+
+    // frame thread - in frame order
+    void onAcquired();
+    void onSubmitted( std::optional< TimePoint > input, std::uint64_t uiTimelineValue );
+    // present id to chain into the frame's present - zero when the frame is not tracked
+    std::uint64_t getPresentId() const { return m_current ? m_current->uiPresentId : 0U; }
+    void          onPresented();
+
+    LatencyHistogram getHistogram( Stage stage ) const;
+
+private:
+    struct Frame
+    {
+        TimePoint     input;
+        std::uint64_t uiTimelineValue;
+        std::uint64_t uiPresentId; // zero without VK_KHR_present_wait
+    };
+
+    void add( Stage stage, const TimePoint& input, const TimePoint& reached );
+    void waiterThread();
+    void waitForGPU( const Frame& frame );
+    void waitForPresent( const Frame& frame );
+
+    const DeviceDispatch&                 m_dispatch;
+    const vk::Semaphore                   m_timelineSemaphore;
+    const std::vector< vk::SwapchainKHR > m_swapchains;
+    const bool                            m_bPresentWait;
+
+    // frame thread only
+    std::uint64_t          m_uiNextPresentId = 1U;
+    std::optional< Frame > m_current;
+    std::optional< Frame > m_awaitingAcquire;
+
+    std::mutex m_swapchainMutex;
+
+    mutable std::mutex                          m_mutex;
+    std::condition_variable                     m_condition;
+    std::deque< Frame >                         m_pending;
+    std::array< LatencyHistogram, kStageCount > m_histograms;
+    std::atomic< bool >                         m_bStop{ false };
+    std::thread                                 m_waiter;
+};
+
+} // namespace retail
+
+#endif // LATENCY_TRACKER_19_OCTOBER_2022
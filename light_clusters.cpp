@@ -0,0 +1,287 @@
+#include "light_clusters.hpp"
+#include "shader.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace retail
+{
+
+namespace
+{
+// must match LightingParams in light_cull.comp and shader.frag
+struct LightingParams
+{
+    float         view[ 16 ];
+    float         projection[ 4 ]; // view space x and y per unit depth at the frustum edge, near and far
+    float         slices[ 4 ];     // log( depth ) * x + y is the slice
+    std::uint32_t grid[ 4 ];       // tiles across, tiles down, slices and lights
+    std::uint32_t screen[ 4 ];     // width, height, index capacity and the region counted into
+};
+
+constexpr std::uint32_t kCullGroupSize = 64U; // local_size_x of light_cull.comp
+
+vk::DeviceSize alignUp( vk::DeviceSize size, vk::DeviceSize alignment )
+{
+    return ( size + alignment - 1U ) / alignment * alignment;
+}
+} // namespace
+
+LightClusters::LightClusters( vk::PhysicalDevice                 physicalDevice,
+                              vk::Device                         device,
+                              vk::PipelineCache                  pipelineCache,
+                              const AssetPack&                   shaders,
+                              std::uint32_t                      uiMaxLights,
+                              std::uint32_t                      uiFramesInFlight,
+                              const std::vector< vk::Extent2D >& extents )
+    : m_device( device )
+    , m_uiMaxLights( uiMaxLights )
+    , m_uiFramesInFlight( uiFramesInFlight )
+    , m_pendingCounts( uiFramesInFlight, 0U )
+{
+    VERIFY_RTE( uiMaxLights > 0U );
+    VERIFY_RTE( !extents.empty() );
+
+    for ( const vk::Extent2D& extent : extents )
+    {
+        Window window;
+        window.extent   = extent;
+        window.uiTilesX = ( extent.width + kTileSize - 1U ) / kTileSize;
+        window.uiTilesY = ( extent.height + kTileSize - 1U ) / kTileSize;
+        m_uiMaxClusters = std::max( m_uiMaxClusters, window.uiTilesX * window.uiTilesY * kSlices );
+        m_windows.push_back( window );
+    }
+    m_uiIndexCapacity = m_uiMaxClusters * kAverageLightsPerCluster;
+
+    const vk::PhysicalDeviceLimits limits = physicalDevice.getProperties().limits;
+    m_paramsStride  = alignUp( sizeof( LightingParams ), limits.minUniformBufferOffsetAlignment );
+    m_clusterStride = alignUp( m_uiMaxClusters * 2U * sizeof( std::uint32_t ), limits.minStorageBufferOffsetAlignment );
+    m_indexStride   = alignUp( m_uiIndexCapacity * sizeof( std::uint32_t ), limits.minStorageBufferOffsetAlignment );
+
+    {
+        const vk::ShaderStageFlags stages = vk::ShaderStageFlagBits::eCompute | vk::ShaderStageFlagBits::eFragment;
+        const std::array< vk::DescriptorSetLayoutBinding, 5 > bindings
+            = { vk::DescriptorSetLayoutBinding{ 0, vk::DescriptorType::eUniformBuffer, 1, stages, nullptr },
+                vk::DescriptorSetLayoutBinding{ 1, vk::DescriptorType::eStorageBuffer, 1, stages, nullptr },
+                vk::DescriptorSetLayoutBinding{ 2, vk::DescriptorType::eStorageBuffer, 1, stages, nullptr },
+                vk::DescriptorSetLayoutBinding{ 3, vk::DescriptorType::eStorageBuffer, 1, stages, nullptr },
+                vk::DescriptorSetLayoutBinding{
+                    4, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr } };
+        m_setLayout = m_device.createDescriptorSetLayout(
+            vk::DescriptorSetLayoutCreateInfo{ vk::DescriptorSetLayoutCreateFlags{}, bindings } );
+        m_pipelineLayout = m_device.createPipelineLayout(
+            vk::PipelineLayoutCreateInfo{ vk::PipelineLayoutCreateFlags{}, m_setLayout, nullptr } );
+    }
+
+    m_cullShader   = createShaderModule( m_device, shaders, "light_cull.spv" );
+    m_cullPipeline = createComputePipeline( m_device, pipelineCache, m_pipelineLayout, m_cullShader );
+
+    const std::uint32_t uiRegions = static_cast< std::uint32_t >( m_windows.size() ) * m_uiFramesInFlight;
+    {
+        const std::array< vk::DescriptorPoolSize, 2 > poolSizes
+            = { vk::DescriptorPoolSize{ vk::DescriptorType::eUniformBuffer, uiRegions },
+                vk::DescriptorPoolSize{ vk::DescriptorType::eStorageBuffer, 4U * uiRegions } };
+        m_descriptorPool = m_device.createDescriptorPool(
+            vk::DescriptorPoolCreateInfo{ vk::DescriptorPoolCreateFlags{}, uiRegions, poolSizes } );
+    }
+
+    m_pParams   = std::make_unique< Buffer >( physicalDevice,
+                                            m_device,
+                                            m_paramsStride * uiRegions,
+                                            vk::BufferUsageFlagBits::eUniformBuffer,
+                                            vk::MemoryPropertyFlagBits::eHostVisible
+                                                | vk::MemoryPropertyFlagBits::eHostCoherent );
+    m_pLights   = std::make_unique< Buffer >( physicalDevice,
+                                            m_device,
+                                            m_uiMaxLights * sizeof( Light ),
+                                            vk::BufferUsageFlagBits::eStorageBuffer
+                                                | vk::BufferUsageFlagBits::eTransferDst,
+                                            vk::MemoryPropertyFlagBits::eDeviceLocal );
+    m_pClusters = std::make_unique< Buffer >( physicalDevice,
+                                              m_device,
+                                              m_clusterStride * uiRegions,
+                                              vk::BufferUsageFlagBits::eStorageBuffer,
+                                              vk::MemoryPropertyFlagBits::eDeviceLocal );
+    m_pIndices  = std::make_unique< Buffer >( physicalDevice,
+                                             m_device,
+                                             m_indexStride * uiRegions,
+                                             vk::BufferUsageFlagBits::eStorageBuffer,
+                                             vk::MemoryPropertyFlagBits::eDeviceLocal );
+    m_pCounts   = std::make_unique< Buffer >( physicalDevice,
+                                            m_device,
+                                            uiRegions * sizeof( std::uint32_t ),
+                                            vk::BufferUsageFlagBits::eStorageBuffer,
+                                            vk::MemoryPropertyFlagBits::eHostVisible
+                                                | vk::MemoryPropertyFlagBits::eHostCoherent );
+    std::memset( m_pParams->getMapped(), 0, m_pParams->getSize() );
+    std::memset( m_pCounts->getMapped(), 0, m_pCounts->getSize() );
+
+    for ( std::uint32_t uiRegion = 0; uiRegion != uiRegions; ++uiRegion )
+    {
+        const vk::DescriptorSet set
+            = m_device.allocateDescriptorSets( vk::DescriptorSetAllocateInfo{ m_descriptorPool, m_setLayout } ).front();
+        m_sets.push_back( set );
+
+        const vk::DescriptorBufferInfo paramsInfo{
+            m_pParams->get(), uiRegion * m_paramsStride, sizeof( LightingParams ) };
+        const vk::DescriptorBufferInfo lightInfo{ m_pLights->get(), 0U, VK_WHOLE_SIZE };
+        const vk::DescriptorBufferInfo clusterInfo{ m_pClusters->get(), uiRegion * m_clusterStride, m_clusterStride };
+        const vk::DescriptorBufferInfo indexInfo{ m_pIndices->get(), uiRegion * m_indexStride, m_indexStride };
+        const vk::DescriptorBufferInfo countInfo{ m_pCounts->get(), 0U, VK_WHOLE_SIZE };
+        const std::array< vk::WriteDescriptorSet, 5 > writes
+            = { vk::WriteDescriptorSet{ set, 0, 0, vk::DescriptorType::eUniformBuffer, nullptr, paramsInfo },
+                vk::WriteDescriptorSet{ set, 1, 0, vk::DescriptorType::eStorageBuffer, nullptr, lightInfo },
+                vk::WriteDescriptorSet{ set, 2, 0, vk::DescriptorType::eStorageBuffer, nullptr, clusterInfo },
+                vk::WriteDescriptorSet{ set, 3, 0, vk::DescriptorType::eStorageBuffer, nullptr, indexInfo },
+                vk::WriteDescriptorSet{ set, 4, 0, vk::DescriptorType::eStorageBuffer, nullptr, countInfo } };
+        m_device.updateDescriptorSets( writes, nullptr );
+    }
+
+    SPDLOG_INFO( "Created light clusters for: {} windows with up to: {} clusters of {}px tiles by {} slices and {} "
+                 "light indices each",
+                 m_windows.size(),
+                 m_uiMaxClusters,
+                 kTileSize,
+                 kSlices,
+                 m_uiIndexCapacity );
+}
+
+LightClusters::~LightClusters()
+{
+    m_pCounts.reset();
+    m_pIndices.reset();
+    m_pClusters.reset();
+    m_pLights.reset();
+    m_pParams.reset();
+    if ( m_cullPipeline )
+    {
+        m_device.destroyPipeline( m_cullPipeline );
+    }
+    if ( m_cullShader )
+    {
+        m_device.destroyShaderModule( m_cullShader );
+    }
+    if ( m_descriptorPool )
+    {
+        m_device.destroyDescriptorPool( m_descriptorPool );
+    }
+    if ( m_pipelineLayout )
+    {
+        m_device.destroyPipelineLayout( m_pipelineLayout );
+    }
+    if ( m_setLayout )
+    {
+        m_device.destroyDescriptorSetLayout( m_setLayout );
+    }
+}
+
+void LightClusters::setLights( Uploader& uploader, const std::vector< Light >& lights )
+{
+    VERIFY_RTE_MSG( lights.size() <= m_uiMaxLights,
+                    "Too many lights: " << lights.size() << " maximum: " << m_uiMaxLights );
+    if ( lights.empty() )
+        return;
+    std::memcpy( uploader.stage( *m_pLights, 0U, lights.size() * sizeof( Light ) ),
+                 lights.data(),
+                 lights.size() * sizeof( Light ) );
+    m_uiLights = static_cast< std::uint32_t >( lights.size() );
+}
+
+void LightClusters::setLightCount( std::uint32_t uiLights )
+{
+    VERIFY_RTE_MSG( uiLights <= m_uiMaxLights, "Too many lights: " << uiLights << " maximum: " << m_uiMaxLights );
+    m_uiLights = uiLights;
+}
+
+void LightClusters::setCamera( std::uint32_t uiWindow,
+                               std::uint32_t uiFrameSlot,
+                               const Mat4&   view,
+                               float         fFovY,
+                               float         fNear,
+                               float         fFar )
+{
+    const Window&       window   = m_windows[ uiWindow ];
+    const std::uint32_t uiRegion = getRegion( uiWindow, uiFrameSlot );
+
+    // the slot's previous frame has completed so its parameters are free to overwrite
+    const float fAspect = static_cast< float >( window.extent.width )
+                          / static_cast< float >( std::max( window.extent.height, 1U ) );
+    const float fTanHalfFovY = std::tan( fFovY * 0.5f );
+    const float fSliceScale  = static_cast< float >( kSlices ) / std::log( fFar / fNear );
+
+    LightingParams params;
+    std::memcpy( params.view, view.m, sizeof( params.view ) );
+    params.projection[ 0 ] = fTanHalfFovY * fAspect;
+    params.projection[ 1 ] = fTanHalfFovY;
+    params.projection[ 2 ] = fNear;
+    params.projection[ 3 ] = fFar;
+    params.slices[ 0 ]     = fSliceScale;
+    params.slices[ 1 ]     = -std::log( fNear ) * fSliceScale;
+    params.slices[ 2 ]     = 0.0f;
+    params.slices[ 3 ]     = 0.0f;
+    params.grid[ 0 ]       = window.uiTilesX;
+    params.grid[ 1 ]       = window.uiTilesY;
+    params.grid[ 2 ]       = kSlices;
+    params.grid[ 3 ]       = m_uiLights;
+    params.screen[ 0 ]     = window.extent.width;
+    params.screen[ 1 ]     = window.extent.height;
+    params.screen[ 2 ]     = m_uiIndexCapacity;
+    params.screen[ 3 ]     = uiRegion;
+    std::memcpy( m_pParams->getMapped() + uiRegion * m_paramsStride, &params, sizeof( params ) );
+}
+
+void LightClusters::recordCull( const DeviceDispatch& dispatch,
+                                vk::CommandBuffer     commandBuffer,
+                                std::uint32_t         uiWindow,
+                                std::uint32_t         uiFrameSlot )
+{
+    const Window&       window   = m_windows[ uiWindow ];
+    const std::uint32_t uiRegion = getRegion( uiWindow, uiFrameSlot );
+
+    const std::uint32_t uiClusters = window.uiTilesX * window.uiTilesY * kSlices;
+    dispatch.cmdBindPipeline( commandBuffer, vk::PipelineBindPoint::eCompute, m_cullPipeline );
+    dispatch.cmdBindDescriptorSet(
+        commandBuffer, vk::PipelineBindPoint::eCompute, m_pipelineLayout, 0U, m_sets[ uiRegion ] );
+    dispatch.cmdDispatch( commandBuffer, ( uiClusters + kCullGroupSize - 1U ) / kCullGroupSize, 1U, 1U );
+
+    // the clusters are read by the scene's fragment shaders and the count by collectStats
+    const vk::MemoryBarrier barrier{ vk::AccessFlagBits::eShaderWrite,
+                                     vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eHostRead };
+    dispatch.cmdPipelineBarrier( commandBuffer,
+                                 vk::PipelineStageFlagBits::eComputeShader,
+                                 vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eHost,
+                                 1U,
+                                 &barrier,
+                                 0U,
+                                 nullptr );
+
+    m_pendingCounts[ uiFrameSlot ] = 1U;
+}
+
+void LightClusters::collectStats( std::uint32_t uiFrameSlot )
+{
+    if ( !m_pendingCounts[ uiFrameSlot ] )
+        return;
+
+    std::uint32_t* pCounts = reinterpret_cast< std::uint32_t* >( m_pCounts->getMapped() );
+    for ( std::uint32_t i = 0; i != m_windows.size(); ++i )
+    {
+        // indices past the capacity were counted but never written
+        std::uint32_t& uiCount = pCounts[ getRegion( i, uiFrameSlot ) ];
+        m_stats.uiIndices += std::min( uiCount, m_uiIndexCapacity );
+        if ( uiCount > m_uiIndexCapacity )
+            ++m_stats.uiOverflows;
+        // the next frame in the slot counts from zero
+        uiCount = 0U;
+    }
+    ++m_stats.uiFrames;
+    m_pendingCounts[ uiFrameSlot ] = 0U;
+}
+
+} // namespace retail
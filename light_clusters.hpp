@@ -0,0 +1,153 @@
+#ifndef LIGHT_CLUSTERS_19_OCTOBER_2022
+#define LIGHT_CLUSTERS_19_OCTOBER_2022
+
+#include "asset_pack.hpp"
+#include "buffer.hpp"
+#include "device_dispatch.hpp"
+#include "math.hpp"
+#include "uploader.hpp"
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace retail
+{
+
+// Clustered forward lighting - point lights assigned to screen tiles by depth slices on the GPU.
+//
+// Each window's view frustum is cut into kTileSize pixel tiles and kSlices exponentially spaced depth
+// slices.  After setCamera, recordCull runs one compute invocation per cluster that tests every
+// light's sphere against the cluster's view space box, then appends the indices of the lights
+// touching it to one compact list and writes the cluster's offset and count.  The fragment shader
+// finds its cluster from gl_FragCoord and its view depth and iterates only those lights.
+//
+// getSetLayout() is the lighting descriptor set both the cull and the scene's fragment shader use:
+//
+//   0  uniform  LightingParams for the window and frame slot
+//   1  storage  the lights in world space
+//   2  storage  offset and count per cluster
+//   3  storage  light indices
+//   4  storage  indices written - compute only, read back by collectStats
+//
+// getLightCount() lights are always bound so the same set serves a brute force loop over every light.
+class LightClusters
+{
+public:
+    static constexpr std::uint32_t kTileSize = 64U; // pixels - must match light_cull.comp and shader.frag
+    static constexpr std::uint32_t kSlices   = 24U;
+    // indices allocated per cluster on average - a frame needing more drops the excess lights
+    static constexpr std::uint32_t kAverageLightsPerCluster = 64U;
+
+    // must match Light in light_cull.comp and shader.frag
+    struct Light
+    {
+        float position[ 3 ];
+        float fRadius; // the light reaches zero here
+        float colour[ 3 ];
+        float fPadding = 0.0f;
+    };
+
+    // totals over the frames collected since the last reset
+    struct Stats
+    {
+        std::uint64_t uiFrames    = 0U;
+        std::uint64_t uiIndices   = 0U; // light and cluster pairs over every window
+        std::uint64_t uiOverflows = 0U; // windows that ran out of indices
+    };
+
+    LightClusters( vk::PhysicalDevice                 physicalDevice,
+                   vk::Device                         device,
+                   vk::PipelineCache                  pipelineCache,
+                   const AssetPack&                   shaders,
+                   std::uint32_t                      uiMaxLights,
+                   std::uint32_t                      uiFramesInFlight,
+                   const std::vector< vk::Extent2D >& extents );
+    ~LightClusters();
+
+    LightClusters( const LightClusters& )            = delete;
+    LightClusters& operator=( const LightClusters& ) = delete;
+
+    vk::DescriptorSetLayout getSetLayout() const { return m_setLayout; }
+    vk::DescriptorSet       getSet( std::uint32_t uiWindow, std::uint32_t uiFrameSlot ) const
+    {
+        return m_sets[ uiWindow * m_uiFramesInFlight + uiFrameSlot ];
+    }
+
+    // stages up to the maximum lights through the uploader which the caller flushes - the first
+    // setLightCount() of them are lit
+    void          setLights( Uploader& uploader, const std::vector< Light >& lights );
+    void          setLightCount( std::uint32_t uiLights );
+    std::uint32_t getLightCount() const { return m_uiLights; }
+
+    // the window's camera and the light count for this frame slot - read by the cull and the brute
+    // force loop alike.  Depths beyond fFar fall in the last slice.
+    void setCamera( std::uint32_t uiWindow,
+                    std::uint32_t uiFrameSlot,
+                    const Mat4&   view,
+                    float         fFovY,
+                    float         fNear,
+                    float         fFar );
+    // builds the window's clusters for this frame slot from its setCamera outside a render pass - the
+    // scene's fragment shaders may read them once this has executed
+    void recordCull( const DeviceDispatch& dispatch,
+                     vk::CommandBuffer     commandBuffer,
+                     std::uint32_t         uiWindow,
+                     std::uint32_t         uiFrameSlot );
+
+    // reads the slot's counts - the slot's previous frame must have completed
+    void         collectStats( std::uint32_t uiFrameSlot );
+    const Stats& getStats() const { return m_stats; }
+    void         resetStats() { m_stats = Stats{}; }
+
+    std::uint32_t getIndexCapacity() const { return m_uiIndexCapacity; }
+
+private:
+    struct Window
+    {
+        vk::Extent2D  extent;
+        std::uint32_t uiTilesX = 0U;
+        std::uint32_t uiTilesY = 0U;
+    };
+
+    std::uint32_t getRegion( std::uint32_t uiWindow, std::uint32_t uiFrameSlot ) const
+    {
+        return uiWindow * m_uiFramesInFlight + uiFrameSlot;
+    }
+
+    vk::Device    m_device;
+    std::uint32_t m_uiMaxLights;
+    std::uint32_t m_uiFramesInFlight;
+    std::uint32_t m_uiMaxClusters   = 0U; // per region - the largest window's
+    std::uint32_t m_uiIndexCapacity = 0U; // per region
+    std::uint32_t m_uiLights        = 0U;
+
+    // one region per window and frame slot in each buffer
+    vk::DeviceSize m_paramsStride  = 0U;
+    vk::DeviceSize m_clusterStride = 0U;
+    vk::DeviceSize m_indexStride   = 0U;
+
+    vk::DescriptorSetLayout m_setLayout;
+    vk::PipelineLayout      m_pipelineLayout;
+    vk::DescriptorPool      m_descriptorPool;
+    vk::ShaderModule        m_cullShader;
+    vk::Pipeline            m_cullPipeline;
+
+    std::unique_ptr< Buffer > m_pParams; // host visible
+    std::unique_ptr< Buffer > m_pLights;
+    std::unique_ptr< Buffer > m_pClusters;
+    std::unique_ptr< Buffer > m_pIndices;
+    std::unique_ptr< Buffer > m_pCounts; // host visible indices written per region
+
+    std::vector< Window >            m_windows;
+    std::vector< vk::DescriptorSet > m_sets; // per region
+    std::vector< std::uint8_t >      m_pendingCounts; // per frame slot - a cull was recorded
+    Stats                            m_stats;
+};
+
+} // namespace retail
+
+#endif // LIGHT_CLUSTERS_19_OCTOBER_2022
@@ -0,0 +1,44 @@
+
+#include "lod.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include <algorithm>
+
+namespace retail
+{
+
+LodSelector::LodSelector( float fPixelError, float fHysteresis )
+    : m_fPixelError( fPixelError )
+    , m_fHysteresis( fHysteresis )
+{
+    VERIFY_RTE( m_fPixelError > 0.0f );
+    VERIFY_RTE( m_fHysteresis >= 0.0f && m_fHysteresis < 1.0f );
+}
+
+void LodSelector::resize( std::size_t szInstances )
+{
+    m_levels.resize( szInstances, 0U );
+}
+
+std::uint32_t LodSelector::select( std::size_t          szInstance,
+                                   const mesh::MeshLod* pLods,
+                                   std::uint32_t        uiLodCount,
+                                   float                fObjectScale,
+                                   float                fDistance,
+                                   float                fProjectionScale )
+{
+    const float fPixelsPerUnit = fObjectScale * fProjectionScale / std::max( fDistance, 1e-3f );
+    auto        projected      = [ & ]( std::uint32_t uiLevel ) { return pLods[ uiLevel ].fError * fPixelsPerUnit; };
+
+    std::uint32_t uiLevel = std::min< std::uint32_t >( m_levels[ szInstance ], uiLodCount - 1U );
+    while ( uiLevel + 1U < uiLodCount && projected( uiLevel + 1U ) <= m_fPixelError * ( 1.0f - m_fHysteresis ) )
+        ++uiLevel;
+    while ( uiLevel > 0U && projected( uiLevel ) > m_fPixelError * ( 1.0f + m_fHysteresis ) )
+        --uiLevel;
+
+    m_levels[ szInstance ] = static_cast< std::uint8_t >( uiLevel );
+    return uiLevel;
+}
+
+} // namespace retail
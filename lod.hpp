@@ -0,0 +1,43 @@
+#ifndef LOD_14_OCTOBER_2022
+#define LOD_14_OCTOBER_2022
+
+#include "mesh_file.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace retail
+{
+
+// Per instance level of detail selection from the projected size of each level's error.
+//
+// The coarsest level whose error projects to less than the pixel threshold is chosen.  Moving to a
+// coarser level requires the error to be below the threshold by the hysteresis fraction and moving
+// back requires it to exceed the threshold by the same fraction so an instance near a boundary does
+// not flicker between levels.
+class LodSelector
+{
+public:
+    LodSelector( float fPixelError = 1.5f, float fHysteresis = 0.25f );
+
+    void resize( std::size_t szInstances );
+
+    // fProjectionScale is the viewport height over 2 * tan( fovY / 2 ) - pixels per unit at distance one
+    std::uint32_t select( std::size_t          szInstance,
+                          const mesh::MeshLod* pLods,
+                          std::uint32_t        uiLodCount,
+                          float                fObjectScale,
+                          float                fDistance,
+                          float                fProjectionScale );
+
+    std::uint32_t getLevel( std::size_t szInstance ) const { return m_levels[ szInstance ]; }
+
+private:
+    float                       m_fPixelError;
+    float                       m_fHysteresis;
+    std::vector< std::uint8_t > m_levels;
+};
+
+} // namespace retail
+
+#endif // LOD_14_OCTOBER_2022
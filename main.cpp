@@ -1,14 +1,216 @@
 
-
 #include "demo.hpp"
 
 #include "spdlog/spdlog.h"
 
+#include <boost/program_options.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
 int main( int argc, const char* argv[] )
 {
+    namespace po = boost::program_options;
+
     try
     {
-        retail::Demo demo;
+        int         iWindows = 1;
+        std::string strMeshFile;
+        std::string strShaderPack = "shaders.pack";
+        int         iInstances     = 1024;
+        float       fLodPixelError = 1.5f;
+        int         iPriceTags     = 256;
+        int         iParticles     = 1 << 20;
+        int         iLights        = 512;
+        bool        bLodDebug      = false;
+        int         iBenchmarkDispatch = 0;
+        int         iBenchmarkLighting = 0;
+        bool        bBruteForceLighting = false;
+        float       fHitchMS           = 50.0f;
+        std::string strHitchDirectory  = ".";
+        bool        bNoAsyncCompute    = false;
+        bool        bNoCulling         = false;
+        bool        bNoOcclusion       = false;
+        bool        bNoIoUring         = false;
+        bool        bNoCommandCache    = false;
+        bool        bHud               = false;
+        float       fHudBudgetMS       = 0.25f;
+        std::string strRecordInput;
+        std::string strReplayInput;
+        bool        bReplayFast = false;
+        std::string strMetrics;
+        std::vector< std::string > textureFiles;
+
+        po::options_description options( "retail_test options" );
+        // clang-format off
+        options.add_options()
+            ( "help",       "Produce help message" )
+            ( "windows",    po::value< int >( &iWindows )->default_value( iWindows ),
+                            "Number of windows - each is placed on the next display and shares the one device" )
+            ( "meshes",     po::value< std::string >( &strMeshFile ),
+                            "Binary mesh catalogue to load" )
+            ( "shader_pack", po::value< std::string >( &strShaderPack )->default_value( strShaderPack ),
+                            "Asset pack holding the compiled shaders - built by asset_packer" )
+            ( "instances",  po::value< int >( &iInstances )->default_value( iInstances ),
+                            "Number of mesh instances placed on the shelves" )
+            ( "lod_pixel_error", po::value< float >( &fLodPixelError )->default_value( fLodPixelError ),
+                            "Projected simplification error in pixels tolerated before refining a level of detail" )
+            ( "price_tags", po::value< int >( &iPriceTags )->default_value( iPriceTags ),
+                            "Number of price tags drawn through the sprite batch" )
+            ( "textures",   po::value< std::vector< std::string > >( &textureFiles )->multitoken(),
+                            "Block compressed product textures shown on the price tags - built by texture_compressor" )
+            ( "particles",  po::value< int >( &iParticles )->default_value( iParticles ),
+                            "Number of particles simulated on the GPU - zero disables them" )
+            ( "lights",     po::value< int >( &iLights )->default_value( iLights ),
+                            "Number of point lights scattered through the shelves" )
+            ( "brute_force_lighting", po::bool_switch( &bBruteForceLighting ),
+                            "Light every fragment from every light instead of its cluster's lights - F2 toggles it" )
+            ( "lod_debug",  po::bool_switch( &bLodDebug ),
+                            "Colour meshes by their selected level of detail" )
+            ( "benchmark_dispatch", po::value< int >( &iBenchmarkDispatch ),
+                            "Time recording this many draws through Vulkan-Hpp, the table and the frame then exit" )
+            ( "benchmark_lighting", po::value< int >( &iBenchmarkLighting ),
+                            "Time this many frames of clustered and brute force lighting per light count then exit" )
+            ( "hitch_ms",   po::value< float >( &fHitchMS )->default_value( fHitchMS ),
+                            "Frame time in milliseconds that dumps the recent frame history - zero disables" )
+            ( "hitch_dir",  po::value< std::string >( &strHitchDirectory )->default_value( strHitchDirectory ),
+                            "Directory hitch dumps are written to" )
+            ( "no_async_compute", po::bool_switch( &bNoAsyncCompute ),
+                            "Run post processing on the graphics queue even when a separate compute queue exists" )
+            ( "no_culling", po::bool_switch( &bNoCulling ),
+                            "Draw every instance instead of frustum culling on the CPU" )
+            ( "no_occlusion", po::bool_switch( &bNoOcclusion ),
+                            "Draw every instance in the frustum instead of occlusion culling on the GPU" )
+            ( "no_io_uring", po::bool_switch( &bNoIoUring ),
+                            "Read assets through a pool of threads instead of io_uring" )
+            ( "no_command_cache", po::bool_switch( &bNoCommandCache ),
+                            "Record the scene draws every frame instead of replaying unchanged recordings" )
+            ( "hud",        po::bool_switch( &bHud ),
+                            "Show the performance HUD from the start - F1 toggles it" )
+            ( "hud_budget", po::value< float >( &fHudBudgetMS )->default_value( fHudBudgetMS ),
+                            "CPU milliseconds per frame the performance HUD may take before it refreshes less often" )
+            ( "record_input", po::value< std::string >( &strRecordInput ),
+                            "Record every input event and frame time to this input log" )
+            ( "metrics",    po::value< std::string >( &strMetrics ),
+                            "Serve Prometheus metrics on this localhost port or unix domain socket path" )
+            ( "replay_input", po::value< std::string >( &strReplayInput ),
+                            "Replay an input log in place of live input then exit" )
+            ( "replay_fast", po::bool_switch( &bReplayFast ),
+                            "Replay frames back to back instead of at the recorded pace" )
+            ;
+        // clang-format on
+
+        po::variables_map vm;
+        po::store( po::parse_command_line( argc, argv, options ), vm );
+        po::notify( vm );
+
+        if ( vm.count( "help" ) )
+        {
+            std::cout << options << std::endl;
+            return 0;
+        }
+
+        retail::Demo::Config config;
+        {
+            config.meshFile   = strMeshFile;
+            config.shaderPack = strShaderPack;
+            config.textureFiles.assign( textureFiles.begin(), textureFiles.end() );
+
+            if ( iInstances < 1 )
+            {
+                SPDLOG_ERROR( "Invalid instance count: {}", iInstances );
+                return 1;
+            }
+            config.uiInstances    = static_cast< std::uint32_t >( iInstances );
+            config.fLodPixelError = fLodPixelError;
+
+            if ( iPriceTags < 0 )
+            {
+                SPDLOG_ERROR( "Invalid price tag count: {}", iPriceTags );
+                return 1;
+            }
+            config.uiPriceTags = static_cast< std::uint32_t >( iPriceTags );
+            config.bLodDebug   = bLodDebug;
+
+            if ( iParticles < 0 )
+            {
+                SPDLOG_ERROR( "Invalid particle count: {}", iParticles );
+                return 1;
+            }
+            config.uiParticles = static_cast< std::uint32_t >( iParticles );
+
+            if ( iLights < 0 )
+            {
+                SPDLOG_ERROR( "Invalid light count: {}", iLights );
+                return 1;
+            }
+            config.uiLights       = static_cast< std::uint32_t >( iLights );
+            config.bLightClusters = !bBruteForceLighting;
+            if ( iBenchmarkLighting < 0 )
+            {
+                SPDLOG_ERROR( "Invalid lighting benchmark frame count: {}", iBenchmarkLighting );
+                return 1;
+            }
+            config.uiBenchmarkLightingFrames = static_cast< std::uint32_t >( iBenchmarkLighting );
+
+            if ( fHitchMS < 0.0f )
+            {
+                SPDLOG_ERROR( "Invalid hitch threshold: {}", fHitchMS );
+                return 1;
+            }
+            config.hitch.fThresholdMS  = fHitchMS;
+            config.hitch.dumpDirectory = strHitchDirectory;
+            config.bAsyncCompute       = !bNoAsyncCompute;
+            config.bCulling            = !bNoCulling;
+            config.bOcclusion          = !bNoOcclusion;
+            config.bIoUring            = !bNoIoUring;
+            config.bCommandCache       = !bNoCommandCache;
+            if ( fHudBudgetMS <= 0.0f )
+            {
+                SPDLOG_ERROR( "Invalid HUD budget: {}", fHudBudgetMS );
+                return 1;
+            }
+            config.hud.bVisible    = bHud;
+            config.hud.fBudgetMS   = fHudBudgetMS;
+            config.metricsEndpoint = strMetrics;
+
+            if ( !strRecordInput.empty() && !strReplayInput.empty() )
+            {
+                SPDLOG_ERROR( "Cannot record and replay input at the same time" );
+                return 1;
+            }
+            config.recordInput     = strRecordInput;
+            config.replayInput     = strReplayInput;
+            config.bReplayRealTime = !bReplayFast;
+
+            if ( iWindows < 1 )
+            {
+                SPDLOG_ERROR( "Invalid window count: {}", iWindows );
+                return 1;
+            }
+            config.windows.clear();
+            for ( int i = 0; i != iWindows; ++i )
+            {
+                retail::Window::Config windowConfig;
+                windowConfig.strName  = "retail test " + std::to_string( i );
+                windowConfig.iDisplay = i;
+                config.windows.push_back( windowConfig );
+            }
+
+            if ( iBenchmarkDispatch < 0 )
+            {
+                SPDLOG_ERROR( "Invalid dispatch benchmark draw count: {}", iBenchmarkDispatch );
+                return 1;
+            }
+        }
+
+        retail::Demo demo( config );
+        if ( iBenchmarkDispatch > 0 )
+        {
+            demo.benchmarkDispatch( static_cast< std::uint32_t >( iBenchmarkDispatch ), 10U );
+            return 0;
+        }
         demo.run();
     }
     catch ( std::exception& ex )
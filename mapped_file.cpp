@@ -0,0 +1,70 @@
+
+#include "mapped_file.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace retail
+{
+
+MappedFile::MappedFile( const boost::filesystem::path& filePath )
+{
+    const int iFile = ::open( filePath.native().c_str(), O_RDONLY | O_CLOEXEC );
+    if ( iFile < 0 )
+    {
+        THROW_RTE( "Failed to open file: " << filePath.string() << " Error: " << strerror( errno ) );
+    }
+
+    struct stat fileStat;
+    if ( ::fstat( iFile, &fileStat ) != 0 )
+    {
+        ::close( iFile );
+        THROW_RTE( "Failed to stat file: " << filePath.string() << " Error: " << strerror( errno ) );
+    }
+    m_szSize = static_cast< std::size_t >( fileStat.st_size );
+
+    if ( m_szSize > 0U )
+    {
+        void* pMapping = ::mmap( nullptr, m_szSize, PROT_READ, MAP_PRIVATE, iFile, 0 );
+        if ( pMapping == MAP_FAILED )
+        {
+            ::close( iFile );
+            THROW_RTE( "Failed to map file: " << filePath.string() << " Error: " << strerror( errno ) );
+        }
+        // access is by table lookup so disable the default read ahead
+        ::madvise( pMapping, m_szSize, MADV_RANDOM );
+        m_pData = static_cast< const std::uint8_t* >( pMapping );
+    }
+
+    // the mapping keeps the file referenced
+    ::close( iFile );
+}
+
+MappedFile::~MappedFile()
+{
+    if ( m_pData )
+    {
+        ::munmap( const_cast< std::uint8_t* >( m_pData ), m_szSize );
+    }
+}
+
+void MappedFile::willNeed( std::size_t szOffset, std::size_t szSize ) const
+{
+    VERIFY_RTE( szOffset + szSize <= m_szSize );
+    if ( szSize == 0U )
+        return;
+
+    // madvise requires a page aligned address
+    static const std::size_t szPageSize = static_cast< std::size_t >( ::sysconf( _SC_PAGESIZE ) );
+    const std::size_t        szStart    = szOffset - ( szOffset % szPageSize );
+    ::madvise( const_cast< std::uint8_t* >( m_pData ) + szStart, szSize + ( szOffset - szStart ), MADV_WILLNEED );
+}
+
+} // namespace retail
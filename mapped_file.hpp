@@ -0,0 +1,36 @@
+#ifndef MAPPED_FILE_7_OCTOBER_2022
+#define MAPPED_FILE_7_OCTOBER_2022
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace retail
+{
+
+// Read only memory mapping of an entire file.  Nothing is read until a page is touched
+// so the cost of opening is independent of the file size.
+class MappedFile
+{
+public:
+    MappedFile( const boost::filesystem::path& filePath );
+    ~MappedFile();
+
+    MappedFile( const MappedFile& )            = delete;
+    MappedFile& operator=( const MappedFile& ) = delete;
+
+    const std::uint8_t* data() const { return m_pData; }
+    std::size_t         size() const { return m_szSize; }
+
+    // hint that a range is about to be read so the kernel can start paging it in
+    void willNeed( std::size_t szOffset, std::size_t szSize ) const;
+
+private:
+    const std::uint8_t* m_pData  = nullptr;
+    std::size_t         m_szSize = 0U;
+};
+
+} // namespace retail
+
+#endif // MAPPED_FILE_7_OCTOBER_2022
@@ -0,0 +1,138 @@
+#ifndef MATH_14_OCTOBER_2022
+#define MATH_14_OCTOBER_2022
+
+#include <cmath>
+
+namespace retail
+{
+
+struct Vec3
+{
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+};
+
+inline Vec3 operator+( const Vec3& a, const Vec3& b ) { return Vec3{ a.x + b.x, a.y + b.y, a.z + b.z }; }
+inline Vec3 operator-( const Vec3& a, const Vec3& b ) { return Vec3{ a.x - b.x, a.y - b.y, a.z - b.z }; }
+inline Vec3 operator*( const Vec3& a, float f ) { return Vec3{ a.x * f, a.y * f, a.z * f }; }
+inline float dot( const Vec3& a, const Vec3& b ) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline Vec3 cross( const Vec3& a, const Vec3& b )
+{
+    return Vec3{ a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+inline float length( const Vec3& a ) { return std::sqrt( dot( a, a ) ); }
+inline Vec3  normalise( const Vec3& a )
+{
+    const float fLength = length( a );
+    return fLength > 0.0f ? a * ( 1.0f / fLength ) : a;
+}
+
+struct Aabb
+{
+    Vec3 min, max;
+};
+
+// column major to match glsl
+struct Mat4
+{
+    float m[ 16 ] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+};
+
+inline Mat4 operator*( const Mat4& a, const Mat4& b )
+{
+    Mat4 result;
+    for ( int c = 0; c != 4; ++c )
+    {
+        for ( int r = 0; r != 4; ++r )
+        {
+            result.m[ c * 4 + r ] = a.m[ r ] * b.m[ c * 4 ] + a.m[ 4 + r ] * b.m[ c * 4 + 1 ]
+                                    + a.m[ 8 + r ] * b.m[ c * 4 + 2 ] + a.m[ 12 + r ] * b.m[ c * 4 + 3 ];
+        }
+    }
+    return result;
+}
+
+inline Mat4 translation( const Vec3& v )
+{
+    Mat4 result;
+    result.m[ 12 ] = v.x;
+    result.m[ 13 ] = v.y;
+    result.m[ 14 ] = v.z;
+    return result;
+}
+
+inline Mat4 scaling( const Vec3& v )
+{
+    Mat4 result;
+    result.m[ 0 ]  = v.x;
+    result.m[ 5 ]  = v.y;
+    result.m[ 10 ] = v.z;
+    return result;
+}
+
+// right handed view looking down -z
+inline Mat4 lookAt( const Vec3& eye, const Vec3& target, const Vec3& up )
+{
+    const Vec3 f = normalise( target - eye );
+    const Vec3 s = normalise( cross( f, up ) );
+    const Vec3 u = cross( s, f );
+
+    Mat4 result;
+    result.m[ 0 ]  = s.x;
+    result.m[ 4 ]  = s.y;
+    result.m[ 8 ]  = s.z;
+    result.m[ 1 ]  = u.x;
+    result.m[ 5 ]  = u.y;
+    result.m[ 9 ]  = u.z;
+    result.m[ 2 ]  = -f.x;
+    result.m[ 6 ]  = -f.y;
+    result.m[ 10 ] = -f.z;
+    result.m[ 12 ] = -dot( s, eye );
+    result.m[ 13 ] = -dot( u, eye );
+    result.m[ 14 ] = dot( f, eye );
+    return result;
+}
+
+// vulkan clip space - y down and depth in [0,1]
+inline Mat4 perspective( float fFovY, float fAspect, float fNear, float fFar )
+{
+    const float f = 1.0f / std::tan( fFovY * 0.5f );
+
+    Mat4 result;
+    result.m[ 0 ]  = f / fAspect;
+    result.m[ 5 ]  = -f;
+    result.m[ 10 ] = fFar / ( fNear - fFar );
+    result.m[ 11 ] = -1.0f;
+    result.m[ 14 ] = fNear * fFar / ( fNear - fFar );
+    result.m[ 15 ] = 0.0f;
+    return result;
+}
+
+// bounds of the transformed box - the centre is transformed and the extent is projected onto each
+// axis through the absolute values of the linear part
+inline Aabb transform( const Mat4& matrix, const Aabb& bounds )
+{
+    const float centre[ 3 ] = { ( bounds.min.x + bounds.max.x ) * 0.5f,
+                                ( bounds.min.y + bounds.max.y ) * 0.5f,
+                                ( bounds.min.z + bounds.max.z ) * 0.5f };
+    const float extent[ 3 ] = { ( bounds.max.x - bounds.min.x ) * 0.5f,
+                                ( bounds.max.y - bounds.min.y ) * 0.5f,
+                                ( bounds.max.z - bounds.min.z ) * 0.5f };
+    float       newCentre[ 3 ], newExtent[ 3 ];
+    for ( int r = 0; r != 3; ++r )
+    {
+        newCentre[ r ] = matrix.m[ 12 + r ];
+        newExtent[ r ] = 0.0f;
+        for ( int c = 0; c != 3; ++c )
+        {
+            newCentre[ r ] += matrix.m[ c * 4 + r ] * centre[ c ];
+            newExtent[ r ] += std::abs( matrix.m[ c * 4 + r ] ) * extent[ c ];
+        }
+    }
+    const Vec3 c{ newCentre[ 0 ], newCentre[ 1 ], newCentre[ 2 ] };
+    const Vec3 e{ newExtent[ 0 ], newExtent[ 1 ], newExtent[ 2 ] };
+    return Aabb{ c - e, c + e };
+}
+
+} // namespace retail
+
+#endif // MATH_14_OCTOBER_2022
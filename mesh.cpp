@@ -0,0 +1,85 @@
+
+#include "mesh.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include <cstring>
+
+namespace retail
+{
+
+Mesh::Mesh( vk::PhysicalDevice               physicalDevice,
+            vk::Device                       device,
+            const MeshFile&                  meshFile,
+            const mesh::MeshRecord&          record,
+            Uploader&                        uploader,
+            AsyncFileReader&                 reader,
+            AsyncFileReader::File            file,
+            const AsyncFileReader::Callback& fnLoaded )
+    : m_strName( meshFile.getName( record ) )
+    , m_bounds( record.bounds )
+    , m_vertexFormat( record.vertexFormat )
+    , m_lods( record.lods, record.lods + record.uiLodCount )
+    , m_indexType( record.indexFormat == mesh::IndexFormat::eUInt16 ? vk::IndexType::eUint16 : vk::IndexType::eUint32 )
+    , m_uiVertexCount( record.uiVertexCount )
+    , m_uiIndexCount( record.uiIndexCount )
+{
+    createBuffers( physicalDevice, device, record.uiVertexSize, record.uiIndexSize );
+
+    // the file is read straight into staging memory placed so the whole pages of each stream can
+    // bypass the page cache - there is no CPU copy
+    auto readStream = [ & ]( const Buffer& buffer, std::uint64_t uiOffset, std::uint64_t uiSize )
+    {
+        std::uint8_t* pStaging = uploader.stage(
+            buffer, 0U, uiSize, AsyncFileReader::kDirectAlignment, uiOffset % AsyncFileReader::kDirectAlignment );
+        AsyncFileReader::Callback fnCallback = fnLoaded;
+        reader.read( file, uiOffset, uiSize, pStaging, std::move( fnCallback ) );
+    };
+    readStream( *m_pVertexBuffer, record.uiVertexOffset, record.uiVertexSize );
+    readStream( *m_pIndexBuffer, record.uiIndexOffset, record.uiIndexSize );
+}
+
+Mesh::Mesh( vk::PhysicalDevice    physicalDevice,
+            vk::Device            device,
+            const mesh::MeshData& meshData,
+            Uploader&             uploader )
+    : m_strName( meshData.strName )
+    , m_bounds( meshData.bounds )
+    , m_vertexFormat( meshData.vertexFormat )
+    , m_indexType( meshData.indexFormat == mesh::IndexFormat::eUInt16 ? vk::IndexType::eUint16 : vk::IndexType::eUint32 )
+    , m_uiVertexCount( meshData.uiVertexCount )
+    , m_uiIndexCount( meshData.uiIndexCount )
+{
+    if ( meshData.lods.empty() )
+        m_lods.push_back( mesh::MeshLod{ 0U, meshData.uiIndexCount, 0.0f, 0U } );
+    else
+        m_lods = meshData.lods;
+
+    createBuffers( physicalDevice, device, meshData.vertices.size(), meshData.indices.size() );
+
+    std::memcpy( uploader.stage( *m_pVertexBuffer, 0U, meshData.vertices.size() ), meshData.vertices.data(),
+                 meshData.vertices.size() );
+    std::memcpy( uploader.stage( *m_pIndexBuffer, 0U, meshData.indices.size() ), meshData.indices.data(),
+                 meshData.indices.size() );
+}
+
+void Mesh::createBuffers( vk::PhysicalDevice physicalDevice,
+                          vk::Device         device,
+                          vk::DeviceSize     vertexSize,
+                          vk::DeviceSize     indexSize )
+{
+    VERIFY_RTE_MSG( vertexSize > 0U && indexSize > 0U, "Empty mesh: " << m_strName );
+
+    m_pVertexBuffer = std::make_unique< Buffer >(
+        physicalDevice, device, vertexSize,
+        vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eStorageBuffer
+            | vk::BufferUsageFlagBits::eTransferDst,
+        vk::MemoryPropertyFlagBits::eDeviceLocal );
+    m_pIndexBuffer = std::make_unique< Buffer >(
+        physicalDevice, device, indexSize,
+        vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eStorageBuffer
+            | vk::BufferUsageFlagBits::eTransferDst,
+        vk::MemoryPropertyFlagBits::eDeviceLocal );
+}
+
+} // namespace retail
@@ -0,0 +1,71 @@
+#ifndef MESH_10_OCTOBER_2022
+#define MESH_10_OCTOBER_2022
+
+#include "async_file_reader.hpp"
+#include "buffer.hpp"
+#include "mesh_file.hpp"
+#include "uploader.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace retail
+{
+
+// Device local vertex and index buffers for one mesh of a MeshFile
+class Mesh
+{
+public:
+    // queues reads of the mesh's streams straight into staging memory - file is meshFile opened on
+    // the reader.  fnLoaded is called once per stream and the uploader must not be flushed until
+    // both have completed.
+    Mesh( vk::PhysicalDevice               physicalDevice,
+          vk::Device                       device,
+          const MeshFile&                  meshFile,
+          const mesh::MeshRecord&          record,
+          Uploader&                        uploader,
+          AsyncFileReader&                 reader,
+          AsyncFileReader::File            file,
+          const AsyncFileReader::Callback& fnLoaded );
+
+    Mesh( vk::PhysicalDevice    physicalDevice,
+          vk::Device            device,
+          const mesh::MeshData& meshData,
+          Uploader&             uploader );
+
+    const std::string&  getName() const { return m_strName; }
+    const mesh::Bounds& getBounds() const { return m_bounds; }
+    mesh::VertexFormat  getVertexFormat() const { return m_vertexFormat; }
+
+    // finest first - always at least one
+    const std::vector< mesh::MeshLod >& getLods() const { return m_lods; }
+
+    const Buffer& getVertexBuffer() const { return *m_pVertexBuffer; }
+    const Buffer& getIndexBuffer() const { return *m_pIndexBuffer; }
+    vk::IndexType getIndexType() const { return m_indexType; }
+    std::uint32_t getVertexCount() const { return m_uiVertexCount; }
+    std::uint32_t getIndexCount() const { return m_uiIndexCount; }
+
+private:
+    void createBuffers( vk::PhysicalDevice physicalDevice,
+                        vk::Device         device,
+                        vk::DeviceSize     vertexSize,
+                        vk::DeviceSize     indexSize );
+
+    std::string               m_strName;
+    mesh::Bounds              m_bounds;
+    mesh::VertexFormat        m_vertexFormat;
+    std::vector< mesh::MeshLod > m_lods;
+    std::unique_ptr< Buffer > m_pVertexBuffer;
+    std::unique_ptr< Buffer > m_pIndexBuffer;
+    vk::IndexType             m_indexType;
+    std::uint32_t             m_uiVertexCount;
+    std::uint32_t             m_uiIndexCount;
+};
+
+} // namespace retail
+
+#endif // MESH_10_OCTOBER_2022
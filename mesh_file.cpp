@@ -0,0 +1,202 @@
+
+#include "mesh_file.hpp"
+#include "hash.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace retail
+{
+namespace mesh
+{
+namespace
+{
+std::uint64_t alignUp( std::uint64_t uiValue, std::uint64_t uiAlignment )
+{
+    return ( uiValue + uiAlignment - 1U ) & ~( uiAlignment - 1U );
+}
+
+void pad( std::ofstream& os, std::uint64_t uiTo )
+{
+    static const char zeros[ kStreamAlignment ] = {};
+    std::uint64_t     uiPos                     = static_cast< std::uint64_t >( os.tellp() );
+    VERIFY_RTE( uiPos <= uiTo );
+    while ( uiPos != uiTo )
+    {
+        const std::uint64_t uiCount = std::min< std::uint64_t >( uiTo - uiPos, kStreamAlignment );
+        os.write( zeros, static_cast< std::streamsize >( uiCount ) );
+        uiPos += uiCount;
+    }
+}
+} // namespace
+
+void writeMeshFile( const boost::filesystem::path& filePath, const std::vector< MeshData >& meshes )
+{
+    // sort by name hash so the reader can binary search
+    std::vector< const MeshData* > sorted;
+    for ( const MeshData& meshData : meshes )
+        sorted.push_back( &meshData );
+    std::sort( sorted.begin(), sorted.end(),
+               []( const MeshData* pLeft, const MeshData* pRight )
+               { return fnv1a64( pLeft->strName ) < fnv1a64( pRight->strName ); } );
+
+    FileHeader header{};
+    header.uiMagic             = kMagic;
+    header.uiVersion           = kVersion;
+    header.uiMeshCount         = static_cast< std::uint32_t >( sorted.size() );
+    header.uiMeshTableOffset   = sizeof( FileHeader );
+    header.uiStringTableOffset = header.uiMeshTableOffset + sizeof( MeshRecord ) * sorted.size();
+
+    std::string             strings;
+    std::vector< MeshRecord > records;
+    for ( const MeshData* pMesh : sorted )
+    {
+        VERIFY_RTE_MSG( pMesh->vertices.size() == static_cast< std::size_t >( pMesh->uiVertexStride ) * pMesh->uiVertexCount,
+                        "Vertex data size mismatch for mesh: " << pMesh->strName );
+        const std::size_t szIndexSize = pMesh->indexFormat == IndexFormat::eUInt16 ? 2U : 4U;
+        VERIFY_RTE_MSG( pMesh->indices.size() == szIndexSize * pMesh->uiIndexCount,
+                        "Index data size mismatch for mesh: " << pMesh->strName );
+
+        MeshRecord record{};
+        record.uiNameHash     = fnv1a64( pMesh->strName );
+        record.uiNameOffset   = static_cast< std::uint32_t >( strings.size() );
+        record.uiNameLength   = static_cast< std::uint32_t >( pMesh->strName.size() );
+        record.bounds         = pMesh->bounds;
+        record.vertexFormat   = pMesh->vertexFormat;
+        record.uiVertexStride = pMesh->uiVertexStride;
+        record.uiVertexCount  = pMesh->uiVertexCount;
+        record.indexFormat    = pMesh->indexFormat;
+        record.uiIndexCount   = pMesh->uiIndexCount;
+        if ( pMesh->lods.empty() )
+        {
+            record.uiLodCount = 1U;
+            record.lods[ 0 ]  = MeshLod{ 0U, pMesh->uiIndexCount, 0.0f, 0U };
+        }
+        else
+        {
+            VERIFY_RTE_MSG( pMesh->lods.size() <= kMaxLods, "Too many lods for mesh: " << pMesh->strName );
+            record.uiLodCount = static_cast< std::uint32_t >( pMesh->lods.size() );
+            std::copy( pMesh->lods.begin(), pMesh->lods.end(), record.lods );
+        }
+        records.push_back( record );
+        strings += pMesh->strName;
+
+        VERIFY_RTE_MSG( records.size() == 1U || records[ records.size() - 2U ].uiNameHash != record.uiNameHash,
+                        "Duplicate mesh name hash for mesh: " << pMesh->strName );
+    }
+    header.uiStringTableSize = strings.size();
+    header.uiPayloadOffset   = alignUp( header.uiStringTableOffset + header.uiStringTableSize, kStreamAlignment );
+
+    std::uint64_t uiOffset = header.uiPayloadOffset;
+    for ( std::size_t i = 0; i != records.size(); ++i )
+    {
+        MeshRecord& record    = records[ i ];
+        record.uiVertexOffset = uiOffset;
+        record.uiVertexSize   = sorted[ i ]->vertices.size();
+        uiOffset              = alignUp( uiOffset + record.uiVertexSize, kStreamAlignment );
+        record.uiIndexOffset  = uiOffset;
+        record.uiIndexSize    = sorted[ i ]->indices.size();
+        uiOffset              = alignUp( uiOffset + record.uiIndexSize, kStreamAlignment );
+    }
+    header.uiPayloadSize = uiOffset - header.uiPayloadOffset;
+
+    std::ofstream os( filePath.native().c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+    if ( !os.good() )
+    {
+        THROW_RTE( "Failed to open file: " << filePath.string() );
+    }
+    os.write( reinterpret_cast< const char* >( &header ), sizeof( FileHeader ) );
+    os.write( reinterpret_cast< const char* >( records.data() ),
+              static_cast< std::streamsize >( records.size() * sizeof( MeshRecord ) ) );
+    os.write( strings.data(), static_cast< std::streamsize >( strings.size() ) );
+    for ( std::size_t i = 0; i != records.size(); ++i )
+    {
+        pad( os, records[ i ].uiVertexOffset );
+        os.write( reinterpret_cast< const char* >( sorted[ i ]->vertices.data() ),
+                  static_cast< std::streamsize >( sorted[ i ]->vertices.size() ) );
+        pad( os, records[ i ].uiIndexOffset );
+        os.write( reinterpret_cast< const char* >( sorted[ i ]->indices.data() ),
+                  static_cast< std::streamsize >( sorted[ i ]->indices.size() ) );
+    }
+    pad( os, header.uiPayloadOffset + header.uiPayloadSize );
+    VERIFY_RTE_MSG( os.good(), "Failed writing file: " << filePath.string() );
+}
+
+} // namespace mesh
+
+MeshFile::MeshFile( const boost::filesystem::path& filePath )
+    : m_file( filePath )
+{
+    const std::uint64_t uiFileSize = m_file.size();
+    VERIFY_RTE_MSG( uiFileSize >= sizeof( mesh::FileHeader ), "Mesh file too small: " << filePath.string() );
+
+    m_pHeader = reinterpret_cast< const mesh::FileHeader* >( m_file.data() );
+    VERIFY_RTE_MSG( m_pHeader->uiMagic == mesh::kMagic, "Not a mesh file: " << filePath.string() );
+    VERIFY_RTE_MSG( m_pHeader->uiVersion == mesh::kVersion,
+                    "Unsupported mesh file version: " << m_pHeader->uiVersion << " in: " << filePath.string() );
+
+    const std::uint64_t uiTableSize = sizeof( mesh::MeshRecord ) * static_cast< std::uint64_t >( m_pHeader->uiMeshCount );
+    VERIFY_RTE_MSG( m_pHeader->uiMeshTableOffset % alignof( mesh::MeshRecord ) == 0U
+                        && m_pHeader->uiMeshTableOffset + uiTableSize <= uiFileSize
+                        && m_pHeader->uiStringTableOffset + m_pHeader->uiStringTableSize <= uiFileSize
+                        && m_pHeader->uiPayloadOffset + m_pHeader->uiPayloadSize <= uiFileSize,
+                    "Corrupt mesh file header: " << filePath.string() );
+
+    m_pMeshes  = reinterpret_cast< const mesh::MeshRecord* >( m_file.data() + m_pHeader->uiMeshTableOffset );
+    m_pStrings = reinterpret_cast< const char* >( m_file.data() + m_pHeader->uiStringTableOffset );
+
+    // only the table is validated - the payload pages are not touched
+    for ( std::uint32_t i = 0; i != m_pHeader->uiMeshCount; ++i )
+    {
+        const mesh::MeshRecord& record = m_pMeshes[ i ];
+        VERIFY_RTE_MSG( record.uiNameOffset + static_cast< std::uint64_t >( record.uiNameLength )
+                                <= m_pHeader->uiStringTableSize
+                            && record.uiVertexOffset % mesh::kStreamAlignment == 0U
+                            && record.uiIndexOffset % mesh::kStreamAlignment == 0U
+                            && record.uiVertexOffset + record.uiVertexSize <= uiFileSize
+                            && record.uiIndexOffset + record.uiIndexSize <= uiFileSize
+                            && ( i == 0U || m_pMeshes[ i - 1U ].uiNameHash < record.uiNameHash )
+                            && record.uiLodCount >= 1U && record.uiLodCount <= mesh::kMaxLods,
+                        "Corrupt mesh record: " << i << " in: " << filePath.string() );
+        for ( std::uint32_t j = 0; j != record.uiLodCount; ++j )
+        {
+            VERIFY_RTE_MSG( static_cast< std::uint64_t >( record.lods[ j ].uiFirstIndex ) + record.lods[ j ].uiIndexCount
+                                <= record.uiIndexCount,
+                            "Corrupt mesh lod: " << j << " of mesh: " << i << " in: " << filePath.string() );
+        }
+    }
+}
+
+const mesh::MeshRecord& MeshFile::getMesh( std::uint32_t uiIndex ) const
+{
+    VERIFY_RTE( uiIndex < m_pHeader->uiMeshCount );
+    return m_pMeshes[ uiIndex ];
+}
+
+const mesh::MeshRecord* MeshFile::findMesh( std::string_view strName ) const
+{
+    const std::uint64_t     uiHash = fnv1a64( strName );
+    const mesh::MeshRecord* pEnd   = m_pMeshes + m_pHeader->uiMeshCount;
+    const mesh::MeshRecord* pFound = std::lower_bound( m_pMeshes, pEnd, uiHash,
+                                                       []( const mesh::MeshRecord& record, std::uint64_t uiValue )
+                                                       { return record.uiNameHash < uiValue; } );
+    if ( pFound != pEnd && pFound->uiNameHash == uiHash && getName( *pFound ) == strName )
+        return pFound;
+    return nullptr;
+}
+
+std::string_view MeshFile::getName( const mesh::MeshRecord& mesh ) const
+{
+    return std::string_view( m_pStrings + mesh.uiNameOffset, mesh.uiNameLength );
+}
+
+void MeshFile::willNeed( const mesh::MeshRecord& mesh ) const
+{
+    m_file.willNeed( mesh.uiVertexOffset, mesh.uiVertexSize );
+    m_file.willNeed( mesh.uiIndexOffset, mesh.uiIndexSize );
+}
+
+} // namespace retail
@@ -0,0 +1,140 @@
+#ifndef MESH_FILE_7_OCTOBER_2022
+#define MESH_FILE_7_OCTOBER_2022
+
+#include "mapped_file.hpp"
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace retail
+{
+namespace mesh
+{
+    // Binary mesh catalogue layout
+    //
+    // FileHeader
+    // MeshRecord[ uiMeshCount ]    - sorted by uiNameHash
+    // char[ uiStringTableSize ]    - mesh names
+    // payload                      - vertex and index streams each aligned to kStreamAlignment
+    //
+    // All offsets are from the start of the file so a stream can be used directly from the mapping.
+    static constexpr std::uint32_t kMagic           = 0x48534D52U; // "RMSH"
+    static constexpr std::uint32_t kVersion         = 2U;
+    static constexpr std::uint64_t kStreamAlignment = 64U;
+    static constexpr std::uint32_t kMaxLods         = 8U;
+
+    enum class VertexFormat : std::uint32_t
+    {
+        eFloat32   = 0, // float position[ 3 ], normal[ 3 ], uv[ 2 ]
+        eQuantised = 1  // QuantisedVertex - see quantise.hpp
+    };
+
+    enum class IndexFormat : std::uint32_t
+    {
+        eUInt16 = 0,
+        eUInt32 = 1
+    };
+
+    struct Bounds
+    {
+        float min[ 3 ];
+        float max[ 3 ];
+    };
+
+    // a level of detail is a range of the index stream - every level shares the vertex stream.
+    // fError bounds the object space distance any vertex moved from the full detail surface.
+    struct MeshLod
+    {
+        std::uint32_t uiFirstIndex;
+        std::uint32_t uiIndexCount;
+        float         fError;
+        std::uint32_t uiReserved;
+    };
+
+    struct FileHeader
+    {
+        std::uint32_t uiMagic;
+        std::uint32_t uiVersion;
+        std::uint32_t uiMeshCount;
+        std::uint32_t uiReserved;
+        std::uint64_t uiMeshTableOffset;
+        std::uint64_t uiStringTableOffset;
+        std::uint64_t uiStringTableSize;
+        std::uint64_t uiPayloadOffset;
+        std::uint64_t uiPayloadSize;
+    };
+
+    struct MeshRecord
+    {
+        std::uint64_t uiNameHash;
+        std::uint32_t uiNameOffset;
+        std::uint32_t uiNameLength;
+        Bounds        bounds;
+        VertexFormat  vertexFormat;
+        std::uint32_t uiVertexStride;
+        std::uint32_t uiVertexCount;
+        IndexFormat   indexFormat;
+        std::uint32_t uiIndexCount;
+        std::uint32_t uiLodCount;
+        std::uint64_t uiVertexOffset;
+        std::uint64_t uiVertexSize;
+        std::uint64_t uiIndexOffset;
+        std::uint64_t uiIndexSize;
+        MeshLod       lods[ kMaxLods ]; // finest first
+    };
+
+    static_assert( std::is_trivially_copyable< FileHeader >::value && sizeof( FileHeader ) == 56U );
+    static_assert( std::is_trivially_copyable< MeshRecord >::value && sizeof( MeshRecord ) == 224U );
+
+    // in memory mesh used to write a catalogue
+    struct MeshData
+    {
+        std::string                 strName;
+        Bounds                      bounds;
+        VertexFormat                vertexFormat   = VertexFormat::eFloat32;
+        std::uint32_t               uiVertexStride = 0U;
+        std::uint32_t               uiVertexCount  = 0U;
+        std::vector< std::uint8_t > vertices;
+        IndexFormat                 indexFormat  = IndexFormat::eUInt32;
+        std::uint32_t               uiIndexCount = 0U;
+        std::vector< std::uint8_t > indices;
+        std::vector< MeshLod >      lods; // empty means a single level covering all indices
+    };
+
+    void writeMeshFile( const boost::filesystem::path& filePath, const std::vector< MeshData >& meshes );
+
+} // namespace mesh
+
+// Memory mapped mesh catalogue.  Opening validates the header and mesh table only; stream data
+// is referenced in place so loading a mesh costs only the pages of the streams actually used.
+class MeshFile
+{
+public:
+    MeshFile( const boost::filesystem::path& filePath );
+
+    std::uint32_t            getMeshCount() const { return m_pHeader->uiMeshCount; }
+    const mesh::MeshRecord&  getMesh( std::uint32_t uiIndex ) const;
+    const mesh::MeshRecord*  findMesh( std::string_view strName ) const;
+    std::string_view         getName( const mesh::MeshRecord& mesh ) const;
+
+    const std::uint8_t* getVertexData( const mesh::MeshRecord& mesh ) const { return m_file.data() + mesh.uiVertexOffset; }
+    const std::uint8_t* getIndexData( const mesh::MeshRecord& mesh ) const { return m_file.data() + mesh.uiIndexOffset; }
+
+    // start paging in the streams of a mesh ahead of the copy
+    void willNeed( const mesh::MeshRecord& mesh ) const;
+
+private:
+    MappedFile               m_file;
+    const mesh::FileHeader*  m_pHeader   = nullptr;
+    const mesh::MeshRecord*  m_pMeshes   = nullptr;
+    const char*              m_pStrings  = nullptr;
+};
+
+} // namespace retail
+
+#endif // MESH_FILE_7_OCTOBER_2022
@@ -0,0 +1,167 @@
+#include "metrics.hpp"
+#include "counters.hpp"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+
+namespace retail
+{
+
+namespace
+{
+    constexpr const char* kPrefix = "retail_";
+
+    const char* getHelp( Counter counter )
+    {
+        switch ( counter )
+        {
+            case Counter::ePipelineBuilds:
+                return "Graphics and compute pipelines created";
+            case Counter::eAllocations:
+                return "vkAllocateMemory calls";
+            case Counter::eSwapchainBuilds:
+                return "Swapchains created or recreated";
+            case Counter::eEvents:
+                return "SDL events polled";
+            case Counter::eValidationWarnings:
+                return "Validation layer warnings reported";
+            case Counter::eValidationErrors:
+                return "Validation layer errors reported";
+        }
+        return "";
+    }
+
+    const char* getHelp( Gauge gauge )
+    {
+        switch ( gauge )
+        {
+            case Gauge::ePresentMode:
+                return "VkPresentModeKHR of the last swapchain built - 0 immediate 1 mailbox 2 fifo 3 fifo relaxed";
+            case Gauge::eDeviceMemoryUsage:
+                return "Bytes used in device local heaps";
+            case Gauge::eDeviceMemoryBudget:
+                return "Bytes the process may use in device local heaps";
+        }
+        return "";
+    }
+
+    const char* getHelp( Histogram histogram )
+    {
+        switch ( histogram )
+        {
+            case Histogram::eFrameInterval:
+                return "Seconds from the start of one frame to the start of the next";
+            case Histogram::eFrameCpu:
+                return "Seconds of frame work on the CPU excluding waits for the GPU, acquire and present";
+            case Histogram::eFrameGpu:
+                return "Seconds of GPU time for the scene and post processing";
+        }
+        return "";
+    }
+
+    void appendHeader( std::string& strOut, const std::string& strName, const char* pszHelp, const char* pszType )
+    {
+        strOut += "# HELP " + strName + " " + pszHelp + "\n";
+        strOut += "# TYPE " + strName + " " + pszType + "\n";
+    }
+
+    void appendSeconds( std::string& strOut, std::uint64_t uiUS )
+    {
+        std::array< char, 32 > buffer;
+        std::snprintf( buffer.data(), buffer.size(), "%.6f", static_cast< double >( uiUS ) / 1000000.0 );
+        strOut += buffer.data();
+    }
+} // namespace
+
+const char* toString( Gauge gauge )
+{
+    switch ( gauge )
+    {
+        case Gauge::ePresentMode:
+            return "present_mode";
+        case Gauge::eDeviceMemoryUsage:
+            return "device_memory_usage_bytes";
+        case Gauge::eDeviceMemoryBudget:
+            return "device_memory_budget_bytes";
+    }
+    return "unknown";
+}
+
+const char* toString( Histogram histogram )
+{
+    switch ( histogram )
+    {
+        case Histogram::eFrameInterval:
+            return "frame_interval_seconds";
+        case Histogram::eFrameCpu:
+            return "frame_cpu_seconds";
+        case Histogram::eFrameGpu:
+            return "frame_gpu_seconds";
+    }
+    return "unknown";
+}
+
+std::uint64_t readResidentBytes()
+{
+    // resident pages are the second field
+    std::ifstream statm( "/proc/self/statm" );
+    std::uint64_t uiSize = 0U, uiResident = 0U;
+    if ( !( statm >> uiSize >> uiResident ) )
+        return 0U;
+    return uiResident * static_cast< std::uint64_t >( ::sysconf( _SC_PAGESIZE ) );
+}
+
+std::string formatMetrics()
+{
+    std::string strOut;
+    strOut.reserve( 8192U );
+
+    for ( std::uint32_t i = 0; i != kCounterCount; ++i )
+    {
+        const Counter     counter = static_cast< Counter >( i );
+        const std::string strName = std::string( kPrefix ) + toString( counter ) + "_total";
+        appendHeader( strOut, strName, getHelp( counter ), "counter" );
+        strOut += strName + " " + std::to_string( readCounter( counter ) ) + "\n";
+    }
+
+    for ( std::uint32_t i = 0; i != kGaugeCount; ++i )
+    {
+        const Gauge       gauge   = static_cast< Gauge >( i );
+        const std::string strName = std::string( kPrefix ) + toString( gauge );
+        appendHeader( strOut, strName, getHelp( gauge ), "gauge" );
+        strOut += strName + " " + std::to_string( readGauge( gauge ) ) + "\n";
+    }
+
+    for ( std::uint32_t i = 0; i != kHistogramCount; ++i )
+    {
+        const Histogram                histogram = static_cast< Histogram >( i );
+        const detail::AtomicHistogram& source    = detail::g_histograms[ i ];
+        const std::string              strName   = std::string( kPrefix ) + toString( histogram );
+        appendHeader( strOut, strName, getHelp( histogram ), "histogram" );
+
+        // cumulative with the overflow bucket only in +Inf
+        std::uint64_t uiCumulative = 0U;
+        for ( std::uint32_t uiBucket = 0; uiBucket != LatencyHistogram::kBoundsUS.size(); ++uiBucket )
+        {
+            uiCumulative += source.buckets[ uiBucket ].load( std::memory_order_relaxed );
+            strOut += strName + "_bucket{le=\"";
+            appendSeconds( strOut, LatencyHistogram::kBoundsUS[ uiBucket ] );
+            strOut += "\"} " + std::to_string( uiCumulative ) + "\n";
+        }
+        uiCumulative += source.buckets.back().load( std::memory_order_relaxed );
+        strOut += strName + "_bucket{le=\"+Inf\"} " + std::to_string( uiCumulative ) + "\n";
+        strOut += strName + "_sum ";
+        appendSeconds( strOut, source.uiSumUS.load( std::memory_order_relaxed ) );
+        // the buckets as read so the count matches +Inf
+        strOut += "\n" + strName + "_count " + std::to_string( uiCumulative ) + "\n";
+    }
+
+    // the standard process metric name so existing dashboards pick it up
+    appendHeader( strOut, "process_resident_memory_bytes", "Resident memory size in bytes", "gauge" );
+    strOut += "process_resident_memory_bytes " + std::to_string( readResidentBytes() ) + "\n";
+    return strOut;
+}
+
+} // namespace retail
@@ -0,0 +1,81 @@
+#ifndef METRICS_19_OCTOBER_2022
+#define METRICS_19_OCTOBER_2022
+
+#include "histogram.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace retail
+{
+
+// Process wide gauges and histograms alongside the event counters in counters.hpp.
+//
+// Like the counters every access is a relaxed atomic so the frame loop only ever pays for a store
+// or an add and a reader on another thread never blocks it.  A reader may see a histogram's
+// buckets and sum from slightly different moments - the count is the sum of the buckets read.
+enum class Gauge : std::uint32_t
+{
+    ePresentMode,       // VkPresentModeKHR of the last swapchain built
+    eDeviceMemoryUsage, // bytes in device local heaps - VK_EXT_memory_budget only
+    eDeviceMemoryBudget,
+};
+
+static constexpr std::uint32_t kGaugeCount = static_cast< std::uint32_t >( Gauge::eDeviceMemoryBudget ) + 1U;
+
+// over the LatencyHistogram buckets
+enum class Histogram : std::uint32_t
+{
+    eFrameInterval, // start of one frame to the start of the next
+    eFrameCpu,      // frame work excluding waits for the GPU, acquire and present
+    eFrameGpu,      // scene and post processing
+};
+
+static constexpr std::uint32_t kHistogramCount = static_cast< std::uint32_t >( Histogram::eFrameGpu ) + 1U;
+
+namespace detail
+{
+struct AtomicHistogram
+{
+    std::array< std::atomic< std::uint64_t >, LatencyHistogram::kBucketCount > buckets{};
+    std::atomic< std::uint64_t >                                            uiSumUS{ 0U };
+};
+
+inline std::array< std::atomic< std::int64_t >, kGaugeCount > g_gauges{};
+inline std::array< AtomicHistogram, kHistogramCount >        g_histograms{};
+} // namespace detail
+
+inline void setGauge( Gauge gauge, std::int64_t iValue )
+{
+    detail::g_gauges[ static_cast< std::uint32_t >( gauge ) ].store( iValue, std::memory_order_relaxed );
+}
+
+inline std::int64_t readGauge( Gauge gauge )
+{
+    return detail::g_gauges[ static_cast< std::uint32_t >( gauge ) ].load( std::memory_order_relaxed );
+}
+
+inline void observe( Histogram histogram, std::chrono::microseconds duration )
+{
+    const std::uint64_t      uiUS   = static_cast< std::uint64_t >( std::max< std::int64_t >( duration.count(), 0 ) );
+    detail::AtomicHistogram& target = detail::g_histograms[ static_cast< std::uint32_t >( histogram ) ];
+    target.buckets[ LatencyHistogram::findBucket( uiUS ) ].fetch_add( 1U, std::memory_order_relaxed );
+    target.uiSumUS.fetch_add( uiUS, std::memory_order_relaxed );
+}
+
+const char* toString( Gauge gauge );
+const char* toString( Histogram histogram );
+
+// resident set size of the process in bytes - zero when it cannot be read
+std::uint64_t readResidentBytes();
+
+// every counter, gauge and histogram plus the resident set size in the Prometheus text exposition
+// format, version 0.0.4
+std::string formatMetrics();
+
+} // namespace retail
+
+#endif // METRICS_19_OCTOBER_2022
@@ -0,0 +1,193 @@
+#include "metrics_server.hpp"
+#include "metrics.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+namespace retail
+{
+
+namespace
+{
+    // bounds a stalled client rather than the request size
+    constexpr int         kTimeoutMS       = 1000;
+    constexpr std::size_t kMaxRequestBytes = 8192U;
+
+    bool isPort( const std::string& strEndpoint )
+    {
+        return !strEndpoint.empty() && strEndpoint.size() <= 5U
+               && std::all_of( strEndpoint.begin(), strEndpoint.end(), []( char c ) { return c >= '0' && c <= '9'; } );
+    }
+
+    void sendAll( int iConnection, const std::string& strData )
+    {
+        std::size_t szSent = 0U;
+        while ( szSent != strData.size() )
+        {
+            const ssize_t iSent = ::send( iConnection, strData.data() + szSent, strData.size() - szSent, MSG_NOSIGNAL );
+            if ( iSent < 0 && errno == EINTR )
+                continue;
+            if ( iSent <= 0 )
+                return;
+            szSent += static_cast< std::size_t >( iSent );
+        }
+    }
+} // namespace
+
+MetricsServer::MetricsServer( const std::string& strEndpoint )
+{
+    if ( isPort( strEndpoint ) )
+    {
+        const int iPort = std::stoi( strEndpoint );
+        VERIFY_RTE_MSG( iPort > 0 && iPort < 65536, "Invalid metrics port: " << strEndpoint );
+
+        m_iListen = ::socket( AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+        VERIFY_RTE_MSG( m_iListen >= 0, "Failed to create metrics socket: " << strerror( errno ) );
+        const int iReuse = 1;
+        ::setsockopt( m_iListen, SOL_SOCKET, SO_REUSEADDR, &iReuse, sizeof( iReuse ) );
+
+        sockaddr_in address{};
+        address.sin_family      = AF_INET;
+        address.sin_port        = htons( static_cast< std::uint16_t >( iPort ) );
+        address.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+        if ( ::bind( m_iListen, reinterpret_cast< const sockaddr* >( &address ), sizeof( address ) ) != 0 )
+        {
+            const int iError = errno;
+            ::close( m_iListen );
+            THROW_RTE( "Failed to bind metrics port: " << iPort << " Error: " << strerror( iError ) );
+        }
+    }
+    else
+    {
+        sockaddr_un address{};
+        VERIFY_RTE_MSG( !strEndpoint.empty() && strEndpoint.size() < sizeof( address.sun_path ),
+                        "Invalid metrics socket path: " << strEndpoint );
+        address.sun_family = AF_UNIX;
+        std::memcpy( address.sun_path, strEndpoint.data(), strEndpoint.size() );
+
+        m_iListen = ::socket( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+        VERIFY_RTE_MSG( m_iListen >= 0, "Failed to create metrics socket: " << strerror( errno ) );
+        // a socket left by a process that did not exit cleanly - anything else at the path is not ours to remove
+        struct stat status{};
+        if ( ::lstat( strEndpoint.c_str(), &status ) == 0 )
+        {
+            if ( !S_ISSOCK( status.st_mode ) )
+            {
+                ::close( m_iListen );
+                THROW_RTE( "Metrics socket path exists and is not a socket: " << strEndpoint );
+            }
+            ::unlink( strEndpoint.c_str() );
+        }
+        if ( ::bind( m_iListen, reinterpret_cast< const sockaddr* >( &address ), sizeof( address ) ) != 0 )
+        {
+            const int iError = errno;
+            ::close( m_iListen );
+            THROW_RTE( "Failed to bind metrics socket: " << strEndpoint << " Error: " << strerror( iError ) );
+        }
+        m_strSocketPath = strEndpoint;
+    }
+
+    if ( ::listen( m_iListen, 4 ) != 0 )
+    {
+        const int iError = errno;
+        ::close( m_iListen );
+        THROW_RTE( "Failed to listen for metrics requests Error: " << strerror( iError ) );
+    }
+    m_iWake = ::eventfd( 0U, EFD_CLOEXEC );
+    if ( m_iWake < 0 )
+    {
+        const int iError = errno;
+        ::close( m_iListen );
+        THROW_RTE( "Failed to create metrics eventfd Error: " << strerror( iError ) );
+    }
+
+    m_thread = std::thread( [ this ]() { serve(); } );
+    SPDLOG_INFO( "Serving metrics on: {}", m_strSocketPath.empty() ? "127.0.0.1:" + strEndpoint : m_strSocketPath );
+}
+
+MetricsServer::~MetricsServer()
+{
+    const std::uint64_t uiWake = 1U;
+    if ( ::write( m_iWake, &uiWake, sizeof( uiWake ) ) != sizeof( uiWake ) )
+    {
+        SPDLOG_ERROR( "Failed to stop the metrics thread: {}", strerror( errno ) );
+    }
+    m_thread.join();
+
+    ::close( m_iWake );
+    ::close( m_iListen );
+    if ( !m_strSocketPath.empty() )
+        ::unlink( m_strSocketPath.c_str() );
+}
+
+void MetricsServer::serve()
+{
+    std::array< pollfd, 2 > fds{ pollfd{ m_iListen, POLLIN, 0 }, pollfd{ m_iWake, POLLIN, 0 } };
+    while ( true )
+    {
+        if ( ::poll( fds.data(), fds.size(), -1 ) < 0 )
+        {
+            if ( errno == EINTR )
+                continue;
+            SPDLOG_ERROR( "Metrics poll failed: {} - no longer serving metrics", strerror( errno ) );
+            return;
+        }
+        if ( fds[ 1 ].revents )
+            return;
+        if ( !( fds[ 0 ].revents & POLLIN ) )
+            continue;
+
+        const int iConnection = ::accept4( m_iListen, nullptr, nullptr, SOCK_CLOEXEC );
+        if ( iConnection < 0 )
+        {
+            SPDLOG_WARN( "Failed to accept metrics connection: {}", strerror( errno ) );
+            continue;
+        }
+        respond( iConnection );
+        ::close( iConnection );
+    }
+}
+
+void MetricsServer::respond( int iConnection ) const
+{
+    // only the end of the request headers matters - whatever is asked for gets the metrics
+    std::string              strRequest;
+    std::array< char, 1024 > buffer;
+    std::array< pollfd, 1 >  fds{ pollfd{ iConnection, POLLIN, 0 } };
+    while ( strRequest.find( "\r\n\r\n" ) == std::string::npos && strRequest.size() < kMaxRequestBytes )
+    {
+        const int iReady = ::poll( fds.data(), fds.size(), kTimeoutMS );
+        if ( iReady < 0 && errno == EINTR )
+            continue;
+        if ( iReady <= 0 )
+            return;
+        const ssize_t iRead = ::recv( iConnection, buffer.data(), buffer.size(), 0 );
+        if ( iRead < 0 && errno == EINTR )
+            continue;
+        if ( iRead <= 0 )
+            return;
+        strRequest.append( buffer.data(), static_cast< std::size_t >( iRead ) );
+    }
+
+    const std::string strBody = formatMetrics();
+    sendAll( iConnection,
+             "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: "
+                 + std::to_string( strBody.size() ) + "\r\nConnection: close\r\n\r\n" + strBody );
+}
+
+} // namespace retail
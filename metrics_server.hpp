@@ -0,0 +1,37 @@
+#ifndef METRICS_SERVER_19_OCTOBER_2022
+#define METRICS_SERVER_19_OCTOBER_2022
+
+#include <string>
+#include <thread>
+
+namespace retail
+{
+
+// Serves formatMetrics() over HTTP to a Prometheus scraper from a background thread.
+//
+// The endpoint is either a port number, bound to 127.0.0.1 only, or the path of a Unix domain
+// socket.  The thread sleeps in poll() between requests and only reads the metric atomics while
+// answering one, so the frame loop never waits on it.  Every request is answered with the full
+// metrics and the connection closed.
+class MetricsServer
+{
+public:
+    explicit MetricsServer( const std::string& strEndpoint );
+    ~MetricsServer();
+
+    MetricsServer( const MetricsServer& )            = delete;
+    MetricsServer& operator=( const MetricsServer& ) = delete;
+
+private:
+    void serve();
+    void respond( int iConnection ) const;
+
+    std::string m_strSocketPath; // unlinked on destruction - empty for a port
+    int         m_iListen = -1;
+    int         m_iWake   = -1; // eventfd signalled to stop the thread
+    std::thread m_thread;
+};
+
+} // namespace retail
+
+#endif // METRICS_SERVER_19_OCTOBER_2022
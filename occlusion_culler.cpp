@@ -0,0 +1,449 @@
+#include "occlusion_culler.hpp"
+#include "counters.hpp"
+#include "shader.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace retail
+{
+
+namespace
+{
+// must match CullParams in occlusion_cull.comp
+struct TestPushConstants
+{
+    float         viewProjection[ 16 ]; // the pyramid was built with
+    std::uint32_t depthSize[ 2 ];
+    std::uint32_t uiCandidateCount;
+    std::uint32_t uiFirstCommand; // this phase's
+    std::uint32_t uiEarlyCommand; // read by the late phase to skip what the early pass drew
+    std::uint32_t uiCountIndex;
+    std::uint32_t uiPhase;
+    std::uint32_t uiLevels; // zero without a pyramid so every candidate is visible
+};
+static_assert( sizeof( TestPushConstants ) <= 128U, "Push constants beyond the guaranteed minimum" );
+
+constexpr std::uint32_t kReduceGroupSize = 8U;  // local_size_x and local_size_y of hiz_reduce.comp
+constexpr std::uint32_t kTestGroupSize   = 64U; // local_size_x of occlusion_cull.comp
+constexpr std::uint32_t kCountStride     = 4U;  // uvec4 of early and late counts per frame slot
+
+vk::Extent2D levelExtent( vk::Extent2D extent, std::uint32_t uiLevel )
+{
+    return vk::Extent2D{ std::max( extent.width >> uiLevel, 1U ), std::max( extent.height >> uiLevel, 1U ) };
+}
+
+std::uint32_t levelCount( vk::Extent2D extent )
+{
+    std::uint32_t uiLevels = 1U;
+    while ( ( extent.width >> uiLevels ) != 0U || ( extent.height >> uiLevels ) != 0U )
+        ++uiLevels;
+    return uiLevels;
+}
+} // namespace
+
+OcclusionCuller::OcclusionCuller( vk::PhysicalDevice                  physicalDevice,
+                                  vk::Device                          device,
+                                  vk::PipelineCache                   pipelineCache,
+                                  const AssetPack&                    shaders,
+                                  vk::Buffer                          candidateBuffer,
+                                  std::uint32_t                       uiMaxCandidates,
+                                  std::uint32_t                       uiFramesInFlight,
+                                  const std::vector< vk::Extent2D >&  extents,
+                                  const std::vector< vk::ImageView >& depthViews )
+    : m_physicalDevice( physicalDevice )
+    , m_device( device )
+    , m_uiMaxCandidates( uiMaxCandidates )
+    , m_uiFramesInFlight( uiFramesInFlight )
+    , m_pendingTested( uiFramesInFlight, 0U )
+{
+    VERIFY_RTE( candidateBuffer );
+    VERIFY_RTE( uiMaxCandidates > 0U );
+    VERIFY_RTE( !extents.empty() );
+    VERIFY_RTE( depthViews.size() == extents.size() * uiFramesInFlight );
+    {
+        const vk::FormatFeatureFlags required
+            = vk::FormatFeatureFlagBits::eStorageImage | vk::FormatFeatureFlagBits::eSampledImage;
+        VERIFY_RTE_MSG(
+            ( physicalDevice.getFormatProperties( kPyramidFormat ).optimalTilingFeatures & required ) == required,
+            "Depth pyramid format does not support storage: " << vk::to_string( kPyramidFormat ) );
+    }
+
+    {
+        // the depth or the next larger level and the level written
+        const std::array< vk::DescriptorSetLayoutBinding, 2 > reduceBindings
+            = { vk::DescriptorSetLayoutBinding{
+                    0, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eCompute, nullptr },
+                vk::DescriptorSetLayoutBinding{
+                    1, vk::DescriptorType::eStorageImage, 1, vk::ShaderStageFlagBits::eCompute, nullptr } };
+        m_reduceSetLayout = m_device.createDescriptorSetLayout(
+            vk::DescriptorSetLayoutCreateInfo{ vk::DescriptorSetLayoutCreateFlags{}, reduceBindings } );
+        m_reduceLayout = m_device.createPipelineLayout(
+            vk::PipelineLayoutCreateInfo{ vk::PipelineLayoutCreateFlags{}, m_reduceSetLayout, nullptr } );
+
+        // candidates from the caller's ring, the commands, the counts and the pyramid
+        const std::array< vk::DescriptorSetLayoutBinding, 4 > testBindings
+            = { vk::DescriptorSetLayoutBinding{
+                    0, vk::DescriptorType::eStorageBufferDynamic, 1, vk::ShaderStageFlagBits::eCompute, nullptr },
+                vk::DescriptorSetLayoutBinding{
+                    1, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr },
+                vk::DescriptorSetLayoutBinding{
+                    2, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr },
+                vk::DescriptorSetLayoutBinding{
+                    3, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eCompute, nullptr } };
+        m_testSetLayout = m_device.createDescriptorSetLayout(
+            vk::DescriptorSetLayoutCreateInfo{ vk::DescriptorSetLayoutCreateFlags{}, testBindings } );
+        const vk::PushConstantRange pushConstantRange{
+            vk::ShaderStageFlagBits::eCompute, 0, sizeof( TestPushConstants ) };
+        m_testLayout = m_device.createPipelineLayout(
+            vk::PipelineLayoutCreateInfo{ vk::PipelineLayoutCreateFlags{}, m_testSetLayout, pushConstantRange } );
+    }
+
+    {
+        // texels are fetched so filtering never mixes depths
+        const vk::SamplerCreateInfo samplerCreateInfo{ vk::SamplerCreateFlags{},
+                                                       vk::Filter::eNearest,
+                                                       vk::Filter::eNearest,
+                                                       vk::SamplerMipmapMode::eNearest,
+                                                       vk::SamplerAddressMode::eClampToEdge,
+                                                       vk::SamplerAddressMode::eClampToEdge,
+                                                       vk::SamplerAddressMode::eClampToEdge };
+        m_sampler = m_device.createSampler( samplerCreateInfo );
+    }
+
+    m_reduceShader   = createShaderModule( m_device, shaders, "hiz_reduce.spv" );
+    m_testShader     = createShaderModule( m_device, shaders, "occlusion_cull.spv" );
+    m_reducePipeline = createComputePipeline( m_device, pipelineCache, m_reduceLayout, m_reduceShader );
+    m_testPipeline   = createComputePipeline( m_device, pipelineCache, m_testLayout, m_testShader );
+
+    {
+        // per window: a reduce set per frame slot's depth and per level but the first, and the test
+        std::uint32_t uiReduceSets = 0U;
+        for ( const vk::Extent2D& extent : extents )
+            uiReduceSets += m_uiFramesInFlight + levelCount( levelExtent( extent, 1U ) ) - 1U;
+        const std::uint32_t uiTestSets = static_cast< std::uint32_t >( extents.size() );
+        const std::array< vk::DescriptorPoolSize, 4 > poolSizes
+            = { vk::DescriptorPoolSize{ vk::DescriptorType::eCombinedImageSampler, uiReduceSets + uiTestSets },
+                vk::DescriptorPoolSize{ vk::DescriptorType::eStorageImage, uiReduceSets },
+                vk::DescriptorPoolSize{ vk::DescriptorType::eStorageBufferDynamic, uiTestSets },
+                vk::DescriptorPoolSize{ vk::DescriptorType::eStorageBuffer, 2U * uiTestSets } };
+        m_descriptorPool = m_device.createDescriptorPool(
+            vk::DescriptorPoolCreateInfo{ vk::DescriptorPoolCreateFlags{}, uiReduceSets + uiTestSets, poolSizes } );
+    }
+
+    const vk::DeviceSize commandsSize = static_cast< vk::DeviceSize >( extents.size() ) * m_uiFramesInFlight * 2U
+                                        * m_uiMaxCandidates * sizeof( VkDrawIndexedIndirectCommand );
+    m_pCommands = std::make_unique< Buffer >( m_physicalDevice,
+                                              m_device,
+                                              commandsSize,
+                                              vk::BufferUsageFlagBits::eStorageBuffer
+                                                  | vk::BufferUsageFlagBits::eIndirectBuffer,
+                                              vk::MemoryPropertyFlagBits::eDeviceLocal );
+    m_pCounts   = std::make_unique< Buffer >( m_physicalDevice,
+                                            m_device,
+                                            m_uiFramesInFlight * kCountStride * sizeof( std::uint32_t ),
+                                            vk::BufferUsageFlagBits::eStorageBuffer,
+                                            vk::MemoryPropertyFlagBits::eHostVisible
+                                                | vk::MemoryPropertyFlagBits::eHostCoherent );
+    std::memset( m_pCounts->getMapped(), 0, m_pCounts->getSize() );
+
+    m_windows.resize( extents.size() );
+    for ( std::uint32_t i = 0; i != m_windows.size(); ++i )
+    {
+        createWindow( m_windows[ i ], i, extents[ i ], depthViews );
+
+        // written once - the candidates are selected per test by the dynamic offset
+        const vk::DescriptorBufferInfo candidateInfo{
+            candidateBuffer, 0U, static_cast< vk::DeviceSize >( m_uiMaxCandidates ) * sizeof( Candidate ) };
+        const vk::DescriptorBufferInfo commandInfo{ m_pCommands->get(), 0U, VK_WHOLE_SIZE };
+        const vk::DescriptorBufferInfo countInfo{ m_pCounts->get(), 0U, VK_WHOLE_SIZE };
+        const vk::DescriptorImageInfo  pyramidInfo{ m_sampler, m_windows[ i ].view, vk::ImageLayout::eGeneral };
+        const vk::DescriptorSet        set = m_windows[ i ].testSet;
+        const std::array< vk::WriteDescriptorSet, 4 > writes
+            = { vk::WriteDescriptorSet{
+                    set, 0, 0, vk::DescriptorType::eStorageBufferDynamic, nullptr, candidateInfo },
+                vk::WriteDescriptorSet{ set, 1, 0, vk::DescriptorType::eStorageBuffer, nullptr, commandInfo },
+                vk::WriteDescriptorSet{ set, 2, 0, vk::DescriptorType::eStorageBuffer, nullptr, countInfo },
+                vk::WriteDescriptorSet{ set, 3, 0, vk::DescriptorType::eCombinedImageSampler, pyramidInfo } };
+        m_device.updateDescriptorSets( writes, nullptr );
+    }
+
+    SPDLOG_INFO( "Created occlusion culler for: {} windows with: {} candidates and a {}x{} pyramid of {} levels",
+                 m_windows.size(),
+                 m_uiMaxCandidates,
+                 m_windows.front().pyramidExtent.width,
+                 m_windows.front().pyramidExtent.height,
+                 m_windows.front().uiLevels );
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+    for ( Window& window : m_windows )
+    {
+        for ( vk::ImageView view : window.levelViews )
+        {
+            m_device.destroyImageView( view );
+        }
+        if ( window.view )
+        {
+            m_device.destroyImageView( window.view );
+        }
+        if ( window.pyramid )
+        {
+            m_device.destroyImage( window.pyramid );
+        }
+        if ( window.memory )
+        {
+            m_device.freeMemory( window.memory );
+        }
+    }
+    m_pCounts.reset();
+    m_pCommands.reset();
+    for ( vk::Pipeline pipeline : { m_reducePipeline, m_testPipeline } )
+    {
+        if ( pipeline )
+        {
+            m_device.destroyPipeline( pipeline );
+        }
+    }
+    for ( vk::ShaderModule shader : { m_reduceShader, m_testShader } )
+    {
+        if ( shader )
+        {
+            m_device.destroyShaderModule( shader );
+        }
+    }
+    if ( m_sampler )
+    {
+        m_device.destroySampler( m_sampler );
+    }
+    if ( m_descriptorPool )
+    {
+        m_device.destroyDescriptorPool( m_descriptorPool );
+    }
+    for ( vk::PipelineLayout layout : { m_reduceLayout, m_testLayout } )
+    {
+        if ( layout )
+        {
+            m_device.destroyPipelineLayout( layout );
+        }
+    }
+    for ( vk::DescriptorSetLayout layout : { m_reduceSetLayout, m_testSetLayout } )
+    {
+        if ( layout )
+        {
+            m_device.destroyDescriptorSetLayout( layout );
+        }
+    }
+}
+
+void OcclusionCuller::createWindow( Window&                             window,
+                                    std::uint32_t                       uiWindow,
+                                    vk::Extent2D                        extent,
+                                    const std::vector< vk::ImageView >& depthViews )
+{
+    window.extent        = extent;
+    window.pyramidExtent = levelExtent( extent, 1U );
+    window.uiLevels      = levelCount( window.pyramidExtent );
+
+    // only the queue recording the scene touches the pyramid
+    const vk::ImageCreateInfo imageCreateInfo{
+        vk::ImageCreateFlags{},
+        vk::ImageType::e2D,
+        kPyramidFormat,
+        vk::Extent3D{ window.pyramidExtent.width, window.pyramidExtent.height, 1U },
+        window.uiLevels,
+        1U,
+        vk::SampleCountFlagBits::e1,
+        vk::ImageTiling::eOptimal,
+        vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled,
+        vk::SharingMode::eExclusive,
+        nullptr,
+        vk::ImageLayout::eUndefined };
+    window.pyramid = m_device.createImage( imageCreateInfo );
+
+    const vk::MemoryRequirements requirements = m_device.getImageMemoryRequirements( window.pyramid );
+    const vk::MemoryAllocateInfo allocateInfo{
+        requirements.size,
+        findMemoryType( m_physicalDevice, requirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal ) };
+    window.memory = m_device.allocateMemory( allocateInfo );
+    count( Counter::eAllocations );
+    m_device.bindImageMemory( window.pyramid, window.memory, 0U );
+
+    auto createView = [ & ]( std::uint32_t uiFirstLevel, std::uint32_t uiLevels )
+    {
+        return m_device.createImageView( vk::ImageViewCreateInfo{
+            vk::ImageViewCreateFlags{},
+            window.pyramid,
+            vk::ImageViewType::e2D,
+            kPyramidFormat,
+            vk::ComponentMapping{},
+            vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, uiFirstLevel, uiLevels, 0U, 1U } } );
+    };
+    window.view = createView( 0U, window.uiLevels );
+    for ( std::uint32_t uiLevel = 0; uiLevel != window.uiLevels; ++uiLevel )
+        window.levelViews.push_back( createView( uiLevel, 1U ) );
+
+    for ( std::uint32_t uiFrameSlot = 0; uiFrameSlot != m_uiFramesInFlight; ++uiFrameSlot )
+    {
+        window.depthSets.push_back( createReduceSet( depthViews[ uiWindow * m_uiFramesInFlight + uiFrameSlot ],
+                                                     vk::ImageLayout::eDepthStencilReadOnlyOptimal,
+                                                     window.levelViews[ 0 ] ) );
+    }
+    for ( std::uint32_t uiLevel = 1; uiLevel < window.uiLevels; ++uiLevel )
+    {
+        window.levelSets.push_back( createReduceSet(
+            window.levelViews[ uiLevel - 1U ], vk::ImageLayout::eGeneral, window.levelViews[ uiLevel ] ) );
+    }
+
+    window.testSet
+        = m_device.allocateDescriptorSets( vk::DescriptorSetAllocateInfo{ m_descriptorPool, m_testSetLayout } ).front();
+}
+
+vk::DescriptorSet OcclusionCuller::createReduceSet( vk::ImageView   source,
+                                                    vk::ImageLayout sourceLayout,
+                                                    vk::ImageView   destination )
+{
+    const vk::DescriptorSet set
+        = m_device.allocateDescriptorSets( vk::DescriptorSetAllocateInfo{ m_descriptorPool, m_reduceSetLayout } )
+              .front();
+
+    const vk::DescriptorImageInfo sourceInfo{ m_sampler, source, sourceLayout };
+    const vk::DescriptorImageInfo destinationInfo{ vk::Sampler{}, destination, vk::ImageLayout::eGeneral };
+    const std::array< vk::WriteDescriptorSet, 2 > writes
+        = { vk::WriteDescriptorSet{ set, 0, 0, vk::DescriptorType::eCombinedImageSampler, sourceInfo },
+            vk::WriteDescriptorSet{ set, 1, 0, vk::DescriptorType::eStorageImage, destinationInfo } };
+    m_device.updateDescriptorSets( writes, nullptr );
+    return set;
+}
+
+void OcclusionCuller::recordTest( const DeviceDispatch& dispatch,
+                                  vk::CommandBuffer     commandBuffer,
+                                  std::uint32_t         uiWindow,
+                                  std::uint32_t         uiFrameSlot,
+                                  Phase                 phase,
+                                  std::uint32_t         uiCandidateOffset,
+                                  std::uint32_t         uiCandidateCount )
+{
+    VERIFY_RTE( uiCandidateCount <= m_uiMaxCandidates );
+    Window& window = m_windows[ uiWindow ];
+
+    if ( !window.bInitialised )
+    {
+        // the pyramid stays in general layout for its whole life
+        const vk::ImageMemoryBarrier barrier{
+            vk::AccessFlags{},
+            vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite,
+            vk::ImageLayout::eUndefined,
+            vk::ImageLayout::eGeneral,
+            VK_QUEUE_FAMILY_IGNORED,
+            VK_QUEUE_FAMILY_IGNORED,
+            window.pyramid,
+            vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, 0U, VK_REMAINING_MIP_LEVELS, 0U, 1U } };
+        dispatch.cmdPipelineBarrier( commandBuffer,
+                                     vk::PipelineStageFlagBits::eTopOfPipe,
+                                     vk::PipelineStageFlagBits::eComputeShader,
+                                     0U,
+                                     nullptr,
+                                     1U,
+                                     &barrier );
+        window.bInitialised = true;
+    }
+
+    // the pyramid and in the late phase the early commands were written by earlier dispatches -
+    // including the previous frame's final pyramid
+    computeBarrier( dispatch, commandBuffer );
+
+    TestPushConstants pushConstants;
+    std::memcpy( pushConstants.viewProjection, window.viewProjection.m, sizeof( pushConstants.viewProjection ) );
+    pushConstants.depthSize[ 0 ]   = window.extent.width;
+    pushConstants.depthSize[ 1 ]   = window.extent.height;
+    pushConstants.uiCandidateCount = uiCandidateCount;
+    pushConstants.uiFirstCommand   = getFirstCommand( uiWindow, uiFrameSlot, phase );
+    pushConstants.uiEarlyCommand   = getFirstCommand( uiWindow, uiFrameSlot, Phase::eEarly );
+    pushConstants.uiCountIndex     = uiFrameSlot;
+    pushConstants.uiPhase          = static_cast< std::uint32_t >( phase );
+    pushConstants.uiLevels         = window.bPyramidValid ? window.uiLevels : 0U;
+
+    dispatch.cmdBindPipeline( commandBuffer, vk::PipelineBindPoint::eCompute, m_testPipeline );
+    dispatch.cmdBindDescriptorSet(
+        commandBuffer, vk::PipelineBindPoint::eCompute, m_testLayout, 0U, window.testSet, 1U, &uiCandidateOffset );
+    dispatch.cmdPushConstants( commandBuffer,
+                               m_testLayout,
+                               vk::ShaderStageFlagBits::eCompute,
+                               0U,
+                               sizeof( TestPushConstants ),
+                               &pushConstants );
+    if ( uiCandidateCount )
+        dispatch.cmdDispatch( commandBuffer, ( uiCandidateCount + kTestGroupSize - 1U ) / kTestGroupSize, 1U, 1U );
+
+    // the commands are consumed by the scene pass and the counts by collectStats
+    const vk::MemoryBarrier barrier{ vk::AccessFlagBits::eShaderWrite,
+                                     vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eHostRead };
+    dispatch.cmdPipelineBarrier( commandBuffer,
+                                 vk::PipelineStageFlagBits::eComputeShader,
+                                 vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eHost,
+                                 1U,
+                                 &barrier,
+                                 0U,
+                                 nullptr );
+
+    if ( phase == Phase::eEarly )
+        m_pendingTested[ uiFrameSlot ] += uiCandidateCount;
+}
+
+void OcclusionCuller::recordPyramid( const DeviceDispatch& dispatch,
+                                     vk::CommandBuffer     commandBuffer,
+                                     std::uint32_t         uiWindow,
+                                     std::uint32_t         uiFrameSlot,
+                                     const Mat4&           viewProjection )
+{
+    Window& window = m_windows[ uiWindow ];
+    VERIFY_RTE( window.bInitialised );
+
+    // the previous test's reads of the pyramid complete before it is overwritten - the scene pass
+    // dependency covers the depth
+    computeBarrier( dispatch, commandBuffer );
+
+    dispatch.cmdBindPipeline( commandBuffer, vk::PipelineBindPoint::eCompute, m_reducePipeline );
+    for ( std::uint32_t uiLevel = 0; uiLevel != window.uiLevels; ++uiLevel )
+    {
+        const vk::DescriptorSet set
+            = uiLevel == 0U ? window.depthSets[ uiFrameSlot ] : window.levelSets[ uiLevel - 1U ];
+        const vk::Extent2D extent = levelExtent( window.pyramidExtent, uiLevel );
+        dispatch.cmdBindDescriptorSet( commandBuffer, vk::PipelineBindPoint::eCompute, m_reduceLayout, 0U, set );
+        dispatch.cmdDispatch( commandBuffer,
+                              ( extent.width + kReduceGroupSize - 1U ) / kReduceGroupSize,
+                              ( extent.height + kReduceGroupSize - 1U ) / kReduceGroupSize,
+                              1U );
+        if ( uiLevel + 1U != window.uiLevels )
+            computeBarrier( dispatch, commandBuffer );
+    }
+
+    window.viewProjection = viewProjection;
+    window.bPyramidValid  = true;
+}
+
+void OcclusionCuller::collectStats( std::uint32_t uiFrameSlot )
+{
+    if ( m_pendingTested[ uiFrameSlot ] == 0U )
+        return;
+
+    std::uint32_t* pCounts = reinterpret_cast< std::uint32_t* >( m_pCounts->getMapped() ) + uiFrameSlot * kCountStride;
+    m_stats.uiTested += m_pendingTested[ uiFrameSlot ];
+    m_stats.uiEarly += pCounts[ 0 ];
+    m_stats.uiLate += pCounts[ 1 ];
+    ++m_stats.uiFrames;
+
+    // the next frame in the slot counts from zero
+    pCounts[ 0 ]                   = 0U;
+    pCounts[ 1 ]                   = 0U;
+    m_pendingTested[ uiFrameSlot ] = 0U;
+}
+
+} // namespace retail
@@ -0,0 +1,170 @@
+#ifndef OCCLUSION_CULLER_19_OCTOBER_2022
+#define OCCLUSION_CULLER_19_OCTOBER_2022
+
+#include "asset_pack.hpp"
+#include "buffer.hpp"
+#include "device_dispatch.hpp"
+#include "math.hpp"
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace retail
+{
+
+// Two phase GPU occlusion culling against a hierarchical depth pyramid.
+//
+// Each window keeps a max reduced depth pyramid built by compute from the scene depth.  A frame
+// records:
+//
+//   recordTest( eEarly )  candidates against the previous frame's pyramid
+//   early scene pass      draws the early commands and fills the depth
+//   recordPyramid         reduces the early depth
+//   recordTest( eLate )   candidates the early test rejected against the new pyramid
+//   late scene pass       draws the late commands over the early pass
+//   recordPyramid         reduces the complete depth for the next frame
+//
+// The tests write one VkDrawIndexedIndirectCommand per candidate with an instance count of zero or
+// one, so the CPU records every candidate's draw and the GPU decides whether it reaches the raster
+// stage.  Anything rejected by the stale early test and visible in this frame's depth is drawn by the
+// late pass so there is no popping.  Everything runs on the queue the scene is recorded on.
+class OcclusionCuller
+{
+public:
+    enum class Phase : std::uint32_t
+    {
+        eEarly,
+        eLate
+    };
+
+    static constexpr vk::Format kPyramidFormat = vk::Format::eR32Sfloat;
+
+    // a world space bounding box and the draw it culls - must match Candidate in occlusion_cull.comp
+    struct Candidate
+    {
+        float         boundsMin[ 3 ];
+        std::uint32_t uiIndexCount;
+        float         boundsMax[ 3 ];
+        std::uint32_t uiFirstIndex;
+    };
+
+    // totals over the frames collected since the last reset
+    struct Stats
+    {
+        std::uint64_t uiFrames = 0U;
+        std::uint64_t uiTested = 0U;
+        std::uint64_t uiEarly  = 0U; // drawn by the early pass
+        std::uint64_t uiLate   = 0U; // drawn by the late pass
+    };
+
+    // candidates are read from candidateBuffer at the offset given to recordTest.  depthViews are the
+    // scene depth attachments window major with one per frame slot, in depth stencil read only layout
+    // whenever a pyramid is recorded.
+    OcclusionCuller( vk::PhysicalDevice                  physicalDevice,
+                     vk::Device                          device,
+                     vk::PipelineCache                   pipelineCache,
+                     const AssetPack&                    shaders,
+                     vk::Buffer                          candidateBuffer,
+                     std::uint32_t                       uiMaxCandidates,
+                     std::uint32_t                       uiFramesInFlight,
+                     const std::vector< vk::Extent2D >&  extents,
+                     const std::vector< vk::ImageView >& depthViews );
+    ~OcclusionCuller();
+
+    OcclusionCuller( const OcclusionCuller& )            = delete;
+    OcclusionCuller& operator=( const OcclusionCuller& ) = delete;
+
+    // the phase's commands are ready for drawIndexedIndirect once this has executed
+    void recordTest( const DeviceDispatch& dispatch,
+                     vk::CommandBuffer     commandBuffer,
+                     std::uint32_t         uiWindow,
+                     std::uint32_t         uiFrameSlot,
+                     Phase                 phase,
+                     std::uint32_t         uiCandidateOffset,
+                     std::uint32_t         uiCandidateCount );
+    // the scene depth must have been rendered with viewProjection
+    void recordPyramid( const DeviceDispatch& dispatch,
+                        vk::CommandBuffer     commandBuffer,
+                        std::uint32_t         uiWindow,
+                        std::uint32_t         uiFrameSlot,
+                        const Mat4&           viewProjection );
+
+    std::uint32_t getMaxCandidates() const { return m_uiMaxCandidates; }
+
+    // the command for candidate uiCandidate in the phase
+    vk::Buffer     getCommandBuffer() const { return m_pCommands->get(); }
+    vk::DeviceSize getCommandOffset( std::uint32_t uiWindow,
+                                     std::uint32_t uiFrameSlot,
+                                     Phase         phase,
+                                     std::uint32_t uiCandidate ) const
+    {
+        return static_cast< vk::DeviceSize >( getFirstCommand( uiWindow, uiFrameSlot, phase ) + uiCandidate )
+               * sizeof( VkDrawIndexedIndirectCommand );
+    }
+
+    // reads the slot's counts - the slot's previous frame must have completed
+    void         collectStats( std::uint32_t uiFrameSlot );
+    const Stats& getStats() const { return m_stats; }
+    void         resetStats() { m_stats = Stats{}; }
+
+private:
+    struct Window
+    {
+        vk::Extent2D                     extent;
+        vk::Extent2D                     pyramidExtent; // level 0 is half the depth
+        std::uint32_t                    uiLevels = 0U;
+        vk::Image                        pyramid;
+        vk::DeviceMemory                 memory;
+        vk::ImageView                    view;           // every level
+        std::vector< vk::ImageView >     levelViews;     // one per level
+        std::vector< vk::DescriptorSet > depthSets;      // reduce each frame slot's depth into level 0
+        std::vector< vk::DescriptorSet > levelSets;      // reduce level i into level i + 1
+        vk::DescriptorSet                testSet;
+        Mat4                             viewProjection; // the pyramid was built with
+        bool                             bInitialised  = false;
+        bool                             bPyramidValid = false;
+    };
+
+    std::uint32_t getFirstCommand( std::uint32_t uiWindow, std::uint32_t uiFrameSlot, Phase phase ) const
+    {
+        return ( ( uiWindow * m_uiFramesInFlight + uiFrameSlot ) * 2U + static_cast< std::uint32_t >( phase ) )
+               * m_uiMaxCandidates;
+    }
+
+    void createWindow( Window&                             window,
+                       std::uint32_t                       uiWindow,
+                       vk::Extent2D                        extent,
+                       const std::vector< vk::ImageView >& depthViews );
+    vk::DescriptorSet createReduceSet( vk::ImageView source, vk::ImageLayout sourceLayout, vk::ImageView destination );
+
+    vk::PhysicalDevice m_physicalDevice;
+    vk::Device         m_device;
+    std::uint32_t      m_uiMaxCandidates;
+    std::uint32_t      m_uiFramesInFlight;
+
+    vk::DescriptorSetLayout m_reduceSetLayout;
+    vk::DescriptorSetLayout m_testSetLayout;
+    vk::PipelineLayout      m_reduceLayout;
+    vk::PipelineLayout      m_testLayout;
+    vk::DescriptorPool      m_descriptorPool;
+    vk::Sampler             m_sampler;
+    vk::ShaderModule        m_reduceShader;
+    vk::ShaderModule        m_testShader;
+    vk::Pipeline            m_reducePipeline;
+    vk::Pipeline            m_testPipeline;
+
+    std::unique_ptr< Buffer > m_pCommands; // early then late commands per window and frame slot
+    std::unique_ptr< Buffer > m_pCounts;   // host visible drawn counts per frame slot
+
+    std::vector< Window >        m_windows;
+    std::vector< std::uint64_t > m_pendingTested; // candidates recorded per frame slot
+    Stats                        m_stats;
+};
+
+} // namespace retail
+
+#endif // OCCLUSION_CULLER_19_OCTOBER_2022
@@ -0,0 +1,440 @@
+#include "particle_system.hpp"
+#include "shader.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+namespace retail
+{
+
+namespace
+{
+// must match EmitParams in particle_emit.comp
+struct EmitPushConstants
+{
+    float         position[ 3 ];
+    std::uint32_t uiCount;
+    float         velocity[ 3 ];
+    float         fSpread;
+    float         fLifetime;
+    std::uint32_t uiColour;
+    std::uint32_t uiSeed;
+};
+// must match SimulateParams in particle_simulate.comp
+struct SimulatePushConstants
+{
+    float fDeltaSeconds;
+    float fGravity;
+    float fDrag;   // fraction of the velocity lost per second
+    float fBounce; // fraction of the vertical velocity kept off the floor at y = 0
+};
+static_assert( sizeof( EmitPushConstants ) <= 128U, "Push constants beyond the guaranteed minimum" );
+
+// must match Camera in particle.vert
+struct CameraParams
+{
+    float viewProjection[ 16 ];
+    float right[ 4 ]; // w is the half size of a quad in world units
+    float up[ 4 ];
+};
+
+constexpr std::uint32_t kGroupSize    = 64U; // local_size_x of the particle compute shaders
+constexpr std::uint32_t kParticleSize = 32U; // Particle in the shaders
+constexpr std::uint32_t kQuadVertices = 6U;  // two triangles from gl_VertexIndex
+constexpr float         kQuadHalfSize = 0.03f;
+
+// VkDrawIndirectCommand then VkDispatchIndirectCommand - both empty
+constexpr std::array< std::uint32_t, 8 > kEmptyHeader = { kQuadVertices, 0U, 0U, 0U, 0U, 1U, 1U, 0U };
+constexpr vk::DeviceSize kHeaderSize     = sizeof( kEmptyHeader );
+constexpr vk::DeviceSize kDispatchOffset = sizeof( VkDrawIndirectCommand );
+constexpr vk::DeviceSize kDeadHeaderSize = 4U * sizeof( std::uint32_t ); // count and padding
+} // namespace
+
+ParticleSystem::ParticleSystem( vk::PhysicalDevice physicalDevice,
+                                vk::Device         device,
+                                vk::PipelineCache  pipelineCache,
+                                const AssetPack&   shaders,
+                                Uploader&          uploader,
+                                vk::RenderPass     renderPass,
+                                std::uint32_t      uiMaxParticles,
+                                std::uint32_t      uiFramesInFlight,
+                                std::uint32_t      uiWindows )
+    : m_device( device )
+    , m_uiMaxParticles( uiMaxParticles )
+    , m_uiFramesInFlight( uiFramesInFlight )
+    , m_pendingCounts( uiFramesInFlight, 0U )
+{
+    VERIFY_RTE( uiMaxParticles > 0U );
+    VERIFY_RTE( uiWindows > 0U );
+    {
+        const vk::DeviceSize alignment
+            = std::max< vk::DeviceSize >( physicalDevice.getProperties().limits.minUniformBufferOffsetAlignment, 16U );
+        m_cameraStride = ( sizeof( CameraParams ) + alignment - 1U ) / alignment * alignment;
+    }
+
+    {
+        // the particles, the list simulated, the list compacted into and the dead list
+        const std::array< vk::DescriptorSetLayoutBinding, 4 > computeBindings
+            = { vk::DescriptorSetLayoutBinding{
+                    0, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr },
+                vk::DescriptorSetLayoutBinding{
+                    1, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr },
+                vk::DescriptorSetLayoutBinding{
+                    2, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr },
+                vk::DescriptorSetLayoutBinding{
+                    3, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr } };
+        m_computeSetLayout = m_device.createDescriptorSetLayout(
+            vk::DescriptorSetLayoutCreateInfo{ vk::DescriptorSetLayoutCreateFlags{}, computeBindings } );
+        // every pass shares the layout so the range covers the largest push constants
+        const vk::PushConstantRange pushConstantRange{
+            vk::ShaderStageFlagBits::eCompute,
+            0,
+            static_cast< std::uint32_t >( std::max( sizeof( EmitPushConstants ), sizeof( SimulatePushConstants ) ) ) };
+        m_computeLayout = m_device.createPipelineLayout(
+            vk::PipelineLayoutCreateInfo{ vk::PipelineLayoutCreateFlags{}, m_computeSetLayout, pushConstantRange } );
+
+        // the particles, the list drawn and the camera selected per window and frame slot
+        const std::array< vk::DescriptorSetLayoutBinding, 3 > drawBindings
+            = { vk::DescriptorSetLayoutBinding{
+                    0, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eVertex, nullptr },
+                vk::DescriptorSetLayoutBinding{
+                    1, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eVertex, nullptr },
+                vk::DescriptorSetLayoutBinding{
+                    2, vk::DescriptorType::eUniformBufferDynamic, 1, vk::ShaderStageFlagBits::eVertex, nullptr } };
+        m_drawSetLayout = m_device.createDescriptorSetLayout(
+            vk::DescriptorSetLayoutCreateInfo{ vk::DescriptorSetLayoutCreateFlags{}, drawBindings } );
+        m_drawLayout = m_device.createPipelineLayout(
+            vk::PipelineLayoutCreateInfo{ vk::PipelineLayoutCreateFlags{}, m_drawSetLayout, nullptr } );
+    }
+
+    m_emitShader       = createShaderModule( m_device, shaders, "particle_emit.spv" );
+    m_simulateShader   = createShaderModule( m_device, shaders, "particle_simulate.spv" );
+    m_compactShader    = createShaderModule( m_device, shaders, "particle_compact.spv" );
+    m_vertexShader     = createShaderModule( m_device, shaders, "particle_vert.spv" );
+    m_fragmentShader   = createShaderModule( m_device, shaders, "particle_frag.spv" );
+    m_emitPipeline     = createComputePipeline( m_device, pipelineCache, m_computeLayout, m_emitShader );
+    m_simulatePipeline = createComputePipeline( m_device, pipelineCache, m_computeLayout, m_simulateShader );
+    m_compactPipeline  = createComputePipeline( m_device, pipelineCache, m_computeLayout, m_compactShader );
+
+    {
+        // tested against the scene depth but never written so overlapping particles all add up
+        PipelineVariants::Program program;
+        program.vertexShader   = m_vertexShader;
+        program.fragmentShader = m_fragmentShader;
+        program.layout         = m_drawLayout;
+        program.renderPass     = renderPass;
+        program.bDepth         = true;
+        program.bDepthWrite    = false;
+        m_pDrawPipelines       = std::make_unique< PipelineVariants >( m_device, pipelineCache, program );
+
+        PipelineVariants::Variant variant;
+        variant.blend  = PipelineVariants::Blend::eAdditive;
+        variant.cull   = PipelineVariants::Cull::eNone;
+        m_drawPipeline = m_pDrawPipelines->request( variant );
+    }
+
+    {
+        const std::array< vk::DescriptorPoolSize, 2 > poolSizes
+            = { vk::DescriptorPoolSize{ vk::DescriptorType::eStorageBuffer, 2U * ( 4U + 2U ) },
+                vk::DescriptorPoolSize{ vk::DescriptorType::eUniformBufferDynamic, 2U } };
+        m_descriptorPool = m_device.createDescriptorPool(
+            vk::DescriptorPoolCreateInfo{ vk::DescriptorPoolCreateFlags{}, 4U, poolSizes } );
+    }
+
+    const vk::BufferUsageFlags storageUsage
+        = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst;
+    const vk::DeviceSize indicesSize = static_cast< vk::DeviceSize >( m_uiMaxParticles ) * sizeof( std::uint32_t );
+    m_pParticles = std::make_unique< Buffer >( physicalDevice,
+                                               m_device,
+                                               static_cast< vk::DeviceSize >( m_uiMaxParticles ) * kParticleSize,
+                                               vk::BufferUsageFlagBits::eStorageBuffer,
+                                               vk::MemoryPropertyFlagBits::eDeviceLocal );
+    for ( std::unique_ptr< Buffer >& pAlive : m_alive )
+    {
+        pAlive = std::make_unique< Buffer >( physicalDevice,
+                                             m_device,
+                                             kHeaderSize + indicesSize,
+                                             storageUsage | vk::BufferUsageFlagBits::eIndirectBuffer
+                                                 | vk::BufferUsageFlagBits::eTransferSrc,
+                                             vk::MemoryPropertyFlagBits::eDeviceLocal );
+    }
+    m_pDead    = std::make_unique< Buffer >( physicalDevice,
+                                          m_device,
+                                          kDeadHeaderSize + indicesSize,
+                                          storageUsage,
+                                          vk::MemoryPropertyFlagBits::eDeviceLocal );
+    m_pCameras = std::make_unique< Buffer >( physicalDevice,
+                                             m_device,
+                                             m_cameraStride * uiWindows * m_uiFramesInFlight,
+                                             vk::BufferUsageFlagBits::eUniformBuffer,
+                                             vk::MemoryPropertyFlagBits::eHostVisible
+                                                 | vk::MemoryPropertyFlagBits::eHostCoherent );
+    m_pCounts  = std::make_unique< Buffer >( physicalDevice,
+                                            m_device,
+                                            m_uiFramesInFlight * sizeof( std::uint32_t ),
+                                            vk::BufferUsageFlagBits::eTransferDst,
+                                            vk::MemoryPropertyFlagBits::eHostVisible
+                                                | vk::MemoryPropertyFlagBits::eHostCoherent );
+    std::memset( m_pCameras->getMapped(), 0, m_pCameras->getSize() );
+    std::memset( m_pCounts->getMapped(), 0, m_pCounts->getSize() );
+
+    // every particle starts dead and both lists empty - the particles themselves are written on emission
+    {
+        std::uint8_t*       pDead       = uploader.stage( *m_pDead, 0U, m_pDead->getSize() );
+        const std::uint32_t header[ 4 ] = { m_uiMaxParticles, 0U, 0U, 0U };
+        std::memcpy( pDead, header, sizeof( header ) );
+        std::uint32_t* pIndices = reinterpret_cast< std::uint32_t* >( pDead + kDeadHeaderSize );
+        for ( std::uint32_t i = 0; i != m_uiMaxParticles; ++i )
+            pIndices[ i ] = i;
+    }
+    for ( const std::unique_ptr< Buffer >& pAlive : m_alive )
+        std::memcpy( uploader.stage( *pAlive, 0U, kHeaderSize ), kEmptyHeader.data(), kHeaderSize );
+
+    for ( std::uint32_t uiList = 0; uiList != 2U; ++uiList )
+    {
+        const std::array< vk::DescriptorSetLayout, 2 > setLayouts = { m_computeSetLayout, m_drawSetLayout };
+        const std::vector< vk::DescriptorSet >         sets
+            = m_device.allocateDescriptorSets( vk::DescriptorSetAllocateInfo{ m_descriptorPool, setLayouts } );
+        m_computeSets[ uiList ] = sets[ 0 ];
+        m_drawSets[ uiList ]    = sets[ 1 ];
+
+        const vk::DescriptorBufferInfo particleInfo{ m_pParticles->get(), 0U, VK_WHOLE_SIZE };
+        const vk::DescriptorBufferInfo currentInfo{ m_alive[ uiList ]->get(), 0U, VK_WHOLE_SIZE };
+        const vk::DescriptorBufferInfo nextInfo{ m_alive[ 1U - uiList ]->get(), 0U, VK_WHOLE_SIZE };
+        const vk::DescriptorBufferInfo deadInfo{ m_pDead->get(), 0U, VK_WHOLE_SIZE };
+        const vk::DescriptorBufferInfo cameraInfo{ m_pCameras->get(), 0U, sizeof( CameraParams ) };
+        const std::array< vk::WriteDescriptorSet, 7 > writes
+            = { vk::WriteDescriptorSet{ sets[ 0 ], 0, 0, vk::DescriptorType::eStorageBuffer, nullptr, particleInfo },
+                vk::WriteDescriptorSet{ sets[ 0 ], 1, 0, vk::DescriptorType::eStorageBuffer, nullptr, currentInfo },
+                vk::WriteDescriptorSet{ sets[ 0 ], 2, 0, vk::DescriptorType::eStorageBuffer, nullptr, nextInfo },
+                vk::WriteDescriptorSet{ sets[ 0 ], 3, 0, vk::DescriptorType::eStorageBuffer, nullptr, deadInfo },
+                vk::WriteDescriptorSet{ sets[ 1 ], 0, 0, vk::DescriptorType::eStorageBuffer, nullptr, particleInfo },
+                vk::WriteDescriptorSet{ sets[ 1 ], 1, 0, vk::DescriptorType::eStorageBuffer, nullptr, currentInfo },
+                vk::WriteDescriptorSet{
+                    sets[ 1 ], 2, 0, vk::DescriptorType::eUniformBufferDynamic, nullptr, cameraInfo } };
+        m_device.updateDescriptorSets( writes, nullptr );
+    }
+
+    SPDLOG_INFO( "Created particle system for: {} particles using: {}MB of device memory",
+                 m_uiMaxParticles,
+                 ( m_pParticles->getSize() + 2U * m_alive[ 0 ]->getSize() + m_pDead->getSize() ) / ( 1024U * 1024U ) );
+}
+
+ParticleSystem::~ParticleSystem()
+{
+    m_pDrawPipelines.reset();
+    m_pCounts.reset();
+    m_pCameras.reset();
+    m_pDead.reset();
+    for ( std::unique_ptr< Buffer >& pAlive : m_alive )
+        pAlive.reset();
+    m_pParticles.reset();
+    for ( vk::Pipeline pipeline : { m_emitPipeline, m_simulatePipeline, m_compactPipeline } )
+    {
+        if ( pipeline )
+        {
+            m_device.destroyPipeline( pipeline );
+        }
+    }
+    for ( vk::ShaderModule shader :
+          { m_emitShader, m_simulateShader, m_compactShader, m_vertexShader, m_fragmentShader } )
+    {
+        if ( shader )
+        {
+            m_device.destroyShaderModule( shader );
+        }
+    }
+    if ( m_descriptorPool )
+    {
+        m_device.destroyDescriptorPool( m_descriptorPool );
+    }
+    for ( vk::PipelineLayout layout : { m_computeLayout, m_drawLayout } )
+    {
+        if ( layout )
+        {
+            m_device.destroyPipelineLayout( layout );
+        }
+    }
+    for ( vk::DescriptorSetLayout layout : { m_computeSetLayout, m_drawSetLayout } )
+    {
+        if ( layout )
+        {
+            m_device.destroyDescriptorSetLayout( layout );
+        }
+    }
+}
+
+void ParticleSystem::recordUpdate( const DeviceDispatch& dispatch,
+                                   vk::CommandBuffer     commandBuffer,
+                                   std::uint32_t         uiFrameSlot,
+                                   float                 fDeltaSeconds )
+{
+    const std::uint32_t uiNext = 1U - m_uiCurrent;
+
+    // the previous frame compacted into the current list and drew it - both finish before emission
+    // appends to it and before the next list, last drawn two frames ago, is emptied
+    {
+        const vk::MemoryBarrier barrier{ vk::AccessFlagBits::eShaderWrite | vk::AccessFlagBits::eTransferWrite,
+                                         vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite
+                                             | vk::AccessFlagBits::eTransferWrite };
+        dispatch.cmdPipelineBarrier( commandBuffer,
+                                     vk::PipelineStageFlagBits::eComputeShader
+                                         | vk::PipelineStageFlagBits::eDrawIndirect
+                                         | vk::PipelineStageFlagBits::eVertexShader
+                                         | vk::PipelineStageFlagBits::eTransfer,
+                                     vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eTransfer,
+                                     1U,
+                                     &barrier,
+                                     0U,
+                                     nullptr );
+    }
+    dispatch.cmdUpdateBuffer( commandBuffer, m_alive[ uiNext ]->get(), 0U, kHeaderSize, kEmptyHeader.data() );
+    {
+        const vk::MemoryBarrier barrier{ vk::AccessFlagBits::eTransferWrite,
+                                         vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite };
+        dispatch.cmdPipelineBarrier( commandBuffer,
+                                     vk::PipelineStageFlagBits::eTransfer,
+                                     vk::PipelineStageFlagBits::eComputeShader,
+                                     1U,
+                                     &barrier,
+                                     0U,
+                                     nullptr );
+    }
+
+    dispatch.cmdBindDescriptorSet(
+        commandBuffer, vk::PipelineBindPoint::eCompute, m_computeLayout, 0U, m_computeSets[ m_uiCurrent ] );
+
+    // emitters that run dry of dead particles simply emit fewer - a full system stays full
+    dispatch.cmdBindPipeline( commandBuffer, vk::PipelineBindPoint::eCompute, m_emitPipeline );
+    for ( Emitter& emitter : m_emitters )
+    {
+        const float         fEmit   = emitter.fAccumulated + emitter.fRate * fDeltaSeconds;
+        const std::uint32_t uiCount = static_cast< std::uint32_t >( std::min( fEmit, float( m_uiMaxParticles ) ) );
+        emitter.fAccumulated        = fEmit - std::floor( fEmit );
+        if ( uiCount == 0U )
+            continue;
+
+        const EmitPushConstants pushConstants{ { emitter.position.x, emitter.position.y, emitter.position.z },
+                                               uiCount,
+                                               { emitter.velocity.x, emitter.velocity.y, emitter.velocity.z },
+                                               emitter.fSpread,
+                                               emitter.fLifetime,
+                                               emitter.uiColour,
+                                               ++m_uiSeed };
+        dispatch.cmdPushConstants( commandBuffer,
+                                   m_computeLayout,
+                                   vk::ShaderStageFlagBits::eCompute,
+                                   0U,
+                                   sizeof( EmitPushConstants ),
+                                   &pushConstants );
+        dispatch.cmdDispatch( commandBuffer, ( uiCount + kGroupSize - 1U ) / kGroupSize, 1U, 1U );
+    }
+
+    // each pass reads what the last one wrote - including the list lengths as indirect arguments
+    computeBarrier(
+        dispatch, commandBuffer, vk::PipelineStageFlagBits::eDrawIndirect, vk::AccessFlagBits::eIndirectCommandRead );
+    const SimulatePushConstants simulatePushConstants{ fDeltaSeconds, 9.81f, 0.2f, 0.4f };
+    dispatch.cmdBindPipeline( commandBuffer, vk::PipelineBindPoint::eCompute, m_simulatePipeline );
+    dispatch.cmdPushConstants( commandBuffer,
+                               m_computeLayout,
+                               vk::ShaderStageFlagBits::eCompute,
+                               0U,
+                               sizeof( SimulatePushConstants ),
+                               &simulatePushConstants );
+    dispatch.cmdDispatchIndirect( commandBuffer, m_alive[ m_uiCurrent ]->get(), kDispatchOffset );
+
+    computeBarrier(
+        dispatch, commandBuffer, vk::PipelineStageFlagBits::eDrawIndirect, vk::AccessFlagBits::eIndirectCommandRead );
+    dispatch.cmdBindPipeline( commandBuffer, vk::PipelineBindPoint::eCompute, m_compactPipeline );
+    dispatch.cmdDispatchIndirect( commandBuffer, m_alive[ m_uiCurrent ]->get(), kDispatchOffset );
+
+    // the survivors are drawn this frame and their count read back by collectStats
+    {
+        const vk::MemoryBarrier barrier{ vk::AccessFlagBits::eShaderWrite,
+                                         vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eShaderRead
+                                             | vk::AccessFlagBits::eTransferRead };
+        dispatch.cmdPipelineBarrier( commandBuffer,
+                                     vk::PipelineStageFlagBits::eComputeShader,
+                                     vk::PipelineStageFlagBits::eDrawIndirect
+                                         | vk::PipelineStageFlagBits::eVertexShader
+                                         | vk::PipelineStageFlagBits::eTransfer,
+                                     1U,
+                                     &barrier,
+                                     0U,
+                                     nullptr );
+    }
+    dispatch.cmdCopyBuffer(
+        commandBuffer,
+        m_alive[ uiNext ]->get(),
+        m_pCounts->get(),
+        vk::BufferCopy{ offsetof( VkDrawIndirectCommand, instanceCount ), uiFrameSlot * sizeof( std::uint32_t ), 4U } );
+    {
+        const vk::MemoryBarrier barrier{ vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead };
+        dispatch.cmdPipelineBarrier( commandBuffer,
+                                     vk::PipelineStageFlagBits::eTransfer,
+                                     vk::PipelineStageFlagBits::eHost,
+                                     1U,
+                                     &barrier,
+                                     0U,
+                                     nullptr );
+    }
+
+    m_pendingCounts[ uiFrameSlot ] = 1U;
+    m_uiCurrent                    = uiNext;
+}
+
+void ParticleSystem::setCamera( std::uint32_t uiWindow,
+                                std::uint32_t uiFrameSlot,
+                                const Mat4&   view,
+                                const Mat4&   viewProjection )
+{
+    // the first two rows of the view are the camera's right and up in world space
+    CameraParams camera;
+    std::memcpy( camera.viewProjection, viewProjection.m, sizeof( camera.viewProjection ) );
+    for ( std::uint32_t i = 0; i != 3U; ++i )
+    {
+        camera.right[ i ] = view.m[ i * 4U ];
+        camera.up[ i ]    = view.m[ i * 4U + 1U ];
+    }
+    camera.right[ 3 ] = kQuadHalfSize;
+    camera.up[ 3 ]    = 0.0f;
+    std::memcpy( m_pCameras->getMapped() + getCameraOffset( uiWindow, uiFrameSlot ), &camera, sizeof( camera ) );
+}
+
+void ParticleSystem::recordDraw( const DeviceDispatch& dispatch,
+                                 vk::CommandBuffer     commandBuffer,
+                                 std::uint32_t         uiWindow,
+                                 std::uint32_t         uiFrameSlot ) const
+{
+    const std::uint32_t uiCameraOffset = static_cast< std::uint32_t >( getCameraOffset( uiWindow, uiFrameSlot ) );
+    dispatch.cmdBindPipeline(
+        commandBuffer, vk::PipelineBindPoint::eGraphics, m_pDrawPipelines->get( m_drawPipeline ) );
+    dispatch.cmdBindDescriptorSet( commandBuffer,
+                                   vk::PipelineBindPoint::eGraphics,
+                                   m_drawLayout,
+                                   0U,
+                                   m_drawSets[ m_uiCurrent ],
+                                   1U,
+                                   &uiCameraOffset );
+    dispatch.cmdDrawIndirect( commandBuffer, m_alive[ m_uiCurrent ]->get(), 0U );
+}
+
+void ParticleSystem::collectStats( std::uint32_t uiFrameSlot )
+{
+    if ( !m_pendingCounts[ uiFrameSlot ] )
+        return;
+
+    const std::uint32_t uiAlive = reinterpret_cast< const std::uint32_t* >( m_pCounts->getMapped() )[ uiFrameSlot ];
+    m_stats.uiAlive += uiAlive;
+    m_stats.uiMaxAlive = std::max( m_stats.uiMaxAlive, uiAlive );
+    ++m_stats.uiFrames;
+    m_pendingCounts[ uiFrameSlot ] = 0U;
+}
+
+} // namespace retail
@@ -0,0 +1,149 @@
+#ifndef PARTICLE_SYSTEM_19_OCTOBER_2022
+#define PARTICLE_SYSTEM_19_OCTOBER_2022
+
+#include "asset_pack.hpp"
+#include "buffer.hpp"
+#include "device_dispatch.hpp"
+#include "math.hpp"
+#include "pipeline_variants.hpp"
+#include "uploader.hpp"
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace retail
+{
+
+// Particles simulated and drawn entirely on the GPU.
+//
+// The particles live in one storage buffer with a dead list of free indices and two alive lists of
+// indices used in turn.  recordUpdate runs three compute passes outside any render pass:
+//
+//   emit      pops indices from the dead list and appends the new particles to the current list
+//   simulate  integrates every particle on the current list in place
+//   compact   appends survivors to the other list and pushes the expired back on the dead list
+//
+// Each alive list starts with a VkDrawIndirectCommand and a VkDispatchIndirectCommand that the
+// appends keep in step with its length, so simulate and compact are dispatched indirectly and
+// recordDraw issues one indirect draw of a camera facing quad per particle.  The CPU only ever
+// records commands - it never sees a particle or a count until collectStats reads one back.
+class ParticleSystem
+{
+public:
+    // a fountain - particles per second leave position with velocity plus a random offset of up to
+    // fSpread on each axis
+    struct Emitter
+    {
+        Vec3          position;
+        Vec3          velocity;
+        float         fSpread      = 1.0f;
+        float         fRate        = 0.0f;
+        float         fLifetime    = 4.0f;        // seconds - each particle lives 75% to 125% of it
+        std::uint32_t uiColour     = 0xFFFFFFFFU; // rgba8 with red in the low byte
+        float         fAccumulated = 0.0f;        // fractional particles carried to the next frame
+    };
+
+    // totals over the frames collected since the last reset
+    struct Stats
+    {
+        std::uint64_t uiFrames   = 0U;
+        std::uint64_t uiAlive    = 0U;
+        std::uint32_t uiMaxAlive = 0U;
+    };
+
+    // draws in renderPass, which must have a kSceneFormat colour and a depth attachment.  Uploads the
+    // initial lists through the uploader which the caller flushes.
+    ParticleSystem( vk::PhysicalDevice physicalDevice,
+                    vk::Device         device,
+                    vk::PipelineCache  pipelineCache,
+                    const AssetPack&   shaders,
+                    Uploader&          uploader,
+                    vk::RenderPass     renderPass,
+                    std::uint32_t      uiMaxParticles,
+                    std::uint32_t      uiFramesInFlight,
+                    std::uint32_t      uiWindows );
+    ~ParticleSystem();
+
+    ParticleSystem( const ParticleSystem& )            = delete;
+    ParticleSystem& operator=( const ParticleSystem& ) = delete;
+
+    void addEmitter( const Emitter& emitter ) { m_emitters.push_back( emitter ); }
+
+    // emits, simulates and compacts - recorded once per frame outside a render pass before any
+    // recordDraw in the frame
+    void recordUpdate( const DeviceDispatch& dispatch,
+                       vk::CommandBuffer     commandBuffer,
+                       std::uint32_t         uiFrameSlot,
+                       float                 fDeltaSeconds );
+
+    // the window's camera for this frame slot - the quads face the view plane
+    void setCamera( std::uint32_t uiWindow, std::uint32_t uiFrameSlot, const Mat4& view, const Mat4& viewProjection );
+    // draws the particles recordUpdate left alive inside a render pass compatible with the one given
+    // to the constructor - may be recorded into a secondary command buffer and replayed as long as
+    // getDrawList is unchanged
+    void recordDraw( const DeviceDispatch& dispatch,
+                     vk::CommandBuffer     commandBuffer,
+                     std::uint32_t         uiWindow,
+                     std::uint32_t         uiFrameSlot ) const;
+
+    std::uint32_t getDrawList() const { return m_uiCurrent; }
+    std::uint32_t getMaxParticles() const { return m_uiMaxParticles; }
+
+    // reads the slot's count - the slot's previous frame must have completed
+    void         collectStats( std::uint32_t uiFrameSlot );
+    const Stats& getStats() const { return m_stats; }
+    void         resetStats() { m_stats = Stats{}; }
+
+private:
+    vk::DeviceSize getCameraOffset( std::uint32_t uiWindow, std::uint32_t uiFrameSlot ) const
+    {
+        return ( static_cast< vk::DeviceSize >( uiWindow ) * m_uiFramesInFlight + uiFrameSlot ) * m_cameraStride;
+    }
+
+    vk::Device     m_device;
+    std::uint32_t  m_uiMaxParticles;
+    std::uint32_t  m_uiFramesInFlight;
+    vk::DeviceSize m_cameraStride;
+
+    vk::DescriptorSetLayout m_computeSetLayout;
+    vk::DescriptorSetLayout m_drawSetLayout;
+    vk::PipelineLayout      m_computeLayout;
+    vk::PipelineLayout      m_drawLayout;
+    vk::DescriptorPool      m_descriptorPool;
+    vk::ShaderModule        m_emitShader;
+    vk::ShaderModule        m_simulateShader;
+    vk::ShaderModule        m_compactShader;
+    vk::ShaderModule        m_vertexShader;
+    vk::ShaderModule        m_fragmentShader;
+    vk::Pipeline            m_emitPipeline;
+    vk::Pipeline            m_simulatePipeline;
+    vk::Pipeline            m_compactPipeline;
+
+    std::unique_ptr< PipelineVariants > m_pDrawPipelines;
+    PipelineVariants::Handle            m_drawPipeline = 0U;
+
+    std::unique_ptr< Buffer >                  m_pParticles;
+    std::array< std::unique_ptr< Buffer >, 2 > m_alive;    // header then indices
+    std::unique_ptr< Buffer >                  m_pDead;    // count then indices
+    std::unique_ptr< Buffer >                  m_pCameras; // host visible per window and frame slot
+    std::unique_ptr< Buffer >                  m_pCounts;  // host visible alive count per frame slot
+
+    // indexed by the current list - compute reads it and writes the other, draw reads it
+    std::array< vk::DescriptorSet, 2 > m_computeSets;
+    std::array< vk::DescriptorSet, 2 > m_drawSets;
+
+    std::vector< Emitter >      m_emitters;
+    std::uint32_t               m_uiCurrent = 0U; // the list the next update simulates
+    std::uint32_t               m_uiSeed    = 0U;
+    std::vector< std::uint8_t > m_pendingCounts; // per frame slot - a count was copied
+    Stats                       m_stats;
+};
+
+} // namespace retail
+
+#endif // PARTICLE_SYSTEM_19_OCTOBER_2022
@@ -0,0 +1,457 @@
+#include "perf_hud.hpp"
+#include "buffer.hpp"
+#include "metrics.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace retail
+{
+
+namespace
+{
+    // printable ASCII from the space - five columns per glyph with the top row in bit zero
+    constexpr char          kFirstChar   = ' ';
+    constexpr std::uint32_t kGlyphCount  = 95U;
+    constexpr std::uint32_t kSolidGlyph  = kGlyphCount; // a filled cell for panels and bars
+    constexpr std::uint32_t kAtlasCells  = 16U;         // glyphs per atlas row
+    constexpr std::uint32_t kCellSize    = 8U;          // each glyph sits in a blank border
+    constexpr std::uint32_t kAtlasWidth  = kAtlasCells * kCellSize;
+    constexpr std::uint32_t kAtlasHeight = ( ( kGlyphCount + 1U + kAtlasCells - 1U ) / kAtlasCells ) * kCellSize;
+
+    // clang-format off
+    constexpr std::uint8_t kFont[ kGlyphCount ][ 5 ] = {
+        { 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x5F, 0x00, 0x00 }, { 0x00, 0x07, 0x00, 0x07, 0x00 },
+        { 0x14, 0x7F, 0x14, 0x7F, 0x14 }, { 0x24, 0x2A, 0x7F, 0x2A, 0x12 }, { 0x23, 0x13, 0x08, 0x64, 0x62 },
+        { 0x36, 0x49, 0x55, 0x22, 0x50 }, { 0x00, 0x05, 0x03, 0x00, 0x00 }, { 0x00, 0x1C, 0x22, 0x41, 0x00 },
+        { 0x00, 0x41, 0x22, 0x1C, 0x00 }, { 0x14, 0x08, 0x3E, 0x08, 0x14 }, { 0x08, 0x08, 0x3E, 0x08, 0x08 },
+        { 0x00, 0x50, 0x30, 0x00, 0x00 }, { 0x08, 0x08, 0x08, 0x08, 0x08 }, { 0x00, 0x60, 0x60, 0x00, 0x00 },
+        { 0x20, 0x10, 0x08, 0x04, 0x02 }, { 0x3E, 0x51, 0x49, 0x45, 0x3E }, { 0x00, 0x42, 0x7F, 0x40, 0x00 },
+        { 0x42, 0x61, 0x51, 0x49, 0x46 }, { 0x21, 0x41, 0x45, 0x4B, 0x31 }, { 0x18, 0x14, 0x12, 0x7F, 0x10 },
+        { 0x27, 0x45, 0x45, 0x45, 0x39 }, { 0x3C, 0x4A, 0x49, 0x49, 0x30 }, { 0x01, 0x71, 0x09, 0x05, 0x03 },
+        { 0x36, 0x49, 0x49, 0x49, 0x36 }, { 0x06, 0x49, 0x49, 0x29, 0x1E }, { 0x00, 0x36, 0x36, 0x00, 0x00 },
+        { 0x00, 0x56, 0x36, 0x00, 0x00 }, { 0x08, 0x14, 0x22, 0x41, 0x00 }, { 0x14, 0x14, 0x14, 0x14, 0x14 },
+        { 0x00, 0x41, 0x22, 0x14, 0x08 }, { 0x02, 0x01, 0x51, 0x09, 0x06 }, { 0x32, 0x49, 0x79, 0x41, 0x3E },
+        { 0x7E, 0x11, 0x11, 0x11, 0x7E }, { 0x7F, 0x49, 0x49, 0x49, 0x36 }, { 0x3E, 0x41, 0x41, 0x41, 0x22 },
+        { 0x7F, 0x41, 0x41, 0x22, 0x1C }, { 0x7F, 0x49, 0x49, 0x49, 0x41 }, { 0x7F, 0x09, 0x09, 0x09, 0x01 },
+        { 0x3E, 0x41, 0x49, 0x49, 0x7A }, { 0x7F, 0x08, 0x08, 0x08, 0x7F }, { 0x00, 0x41, 0x7F, 0x41, 0x00 },
+        { 0x20, 0x40, 0x41, 0x3F, 0x01 }, { 0x7F, 0x08, 0x14, 0x22, 0x41 }, { 0x7F, 0x40, 0x40, 0x40, 0x40 },
+        { 0x7F, 0x02, 0x0C, 0x02, 0x7F }, { 0x7F, 0x04, 0x08, 0x10, 0x7F }, { 0x3E, 0x41, 0x41, 0x41, 0x3E },
+        { 0x7F, 0x09, 0x09, 0x09, 0x06 }, { 0x3E, 0x41, 0x51, 0x21, 0x5E }, { 0x7F, 0x09, 0x19, 0x29, 0x46 },
+        { 0x46, 0x49, 0x49, 0x49, 0x31 }, { 0x01, 0x01, 0x7F, 0x01, 0x01 }, { 0x3F, 0x40, 0x40, 0x40, 0x3F },
+        { 0x1F, 0x20, 0x40, 0x20, 0x1F }, { 0x3F, 0x40, 0x38, 0x40, 0x3F }, { 0x63, 0x14, 0x08, 0x14, 0x63 },
+        { 0x07, 0x08, 0x70, 0x08, 0x07 }, { 0x61, 0x51, 0x49, 0x45, 0x43 }, { 0x00, 0x7F, 0x41, 0x41, 0x00 },
+        { 0x02, 0x04, 0x08, 0x10, 0x20 }, { 0x00, 0x41, 0x41, 0x7F, 0x00 }, { 0x04, 0x02, 0x01, 0x02, 0x04 },
+        { 0x40, 0x40, 0x40, 0x40, 0x40 }, { 0x00, 0x01, 0x02, 0x04, 0x00 }, { 0x20, 0x54, 0x54, 0x54, 0x78 },
+        { 0x7F, 0x48, 0x44, 0x44, 0x38 }, { 0x38, 0x44, 0x44, 0x44, 0x20 }, { 0x38, 0x44, 0x44, 0x48, 0x7F },
+        { 0x38, 0x54, 0x54, 0x54, 0x18 }, { 0x08, 0x7E, 0x09, 0x01, 0x02 }, { 0x08, 0x14, 0x54, 0x54, 0x3C },
+        { 0x7F, 0x08, 0x04, 0x04, 0x78 }, { 0x00, 0x44, 0x7D, 0x40, 0x00 }, { 0x20, 0x40, 0x44, 0x3D, 0x00 },
+        { 0x00, 0x7F, 0x10, 0x28, 0x44 }, { 0x00, 0x41, 0x7F, 0x40, 0x00 }, { 0x7C, 0x04, 0x18, 0x04, 0x78 },
+        { 0x7C, 0x08, 0x04, 0x04, 0x78 }, { 0x38, 0x44, 0x44, 0x44, 0x38 }, { 0x7C, 0x14, 0x14, 0x14, 0x08 },
+        { 0x08, 0x14, 0x14, 0x18, 0x7C }, { 0x7C, 0x08, 0x04, 0x04, 0x08 }, { 0x48, 0x54, 0x54, 0x54, 0x20 },
+        { 0x04, 0x3F, 0x44, 0x40, 0x20 }, { 0x3C, 0x40, 0x40, 0x20, 0x7C }, { 0x1C, 0x20, 0x40, 0x20, 0x1C },
+        { 0x3C, 0x40, 0x30, 0x40, 0x3C }, { 0x44, 0x28, 0x10, 0x28, 0x44 }, { 0x0C, 0x50, 0x50, 0x50, 0x3C },
+        { 0x44, 0x64, 0x54, 0x4C, 0x44 }, { 0x00, 0x08, 0x36, 0x41, 0x00 }, { 0x00, 0x00, 0x7F, 0x00, 0x00 },
+        { 0x00, 0x41, 0x36, 0x08, 0x00 }, { 0x10, 0x08, 0x08, 0x10, 0x08 } };
+    // clang-format on
+
+    // glyphs are drawn at twice the atlas size
+    constexpr float fGlyphScale = 2.0f;
+    constexpr float fAdvance    = 6.0f * fGlyphScale;
+    constexpr float fLineHeight = 9.0f * fGlyphScale;
+    constexpr float fMargin     = 8.0f;
+    constexpr float fBarWidth   = 3.0f;
+    constexpr float fGraphHeight = 96.0f;
+    constexpr float fGraphMS     = 33.3f; // full graph height unless a frame takes longer
+
+    // rgba8 with red in the low byte
+    constexpr std::uint32_t kPanelColour  = 0xC0181818U;
+    constexpr std::uint32_t kTextColour   = 0xFFFFFFFFU;
+    constexpr std::uint32_t kCpuColour    = 0xFF20B0FFU;
+    constexpr std::uint32_t kGpuColour    = 0xFFFFD040U;
+    constexpr std::uint32_t kTargetColour = 0x80FFFFFFU; // 60Hz line
+    constexpr std::uint32_t kWarnColour   = 0xFF4040FFU;
+
+    std::unique_ptr< Texture > createFontTexture( vk::PhysicalDevice physicalDevice,
+                                                  vk::Device         device,
+                                                  Uploader&          uploader )
+    {
+        auto pTexture = std::make_unique< Texture >(
+            physicalDevice, device, vk::Format::eR8G8B8A8Unorm, vk::Extent2D{ kAtlasWidth, kAtlasHeight } );
+        std::uint8_t* pTexels = uploader.stage( *pTexture, 0U, kAtlasWidth * kAtlasHeight * 4U );
+        for ( std::uint32_t y = 0; y != kAtlasHeight; ++y )
+        {
+            for ( std::uint32_t x = 0; x != kAtlasWidth; ++x )
+            {
+                const std::uint32_t uiGlyph = ( y / kCellSize ) * kAtlasCells + ( x / kCellSize );
+                const std::uint32_t uiX     = x % kCellSize;
+                const std::uint32_t uiY     = y % kCellSize;
+                bool                bSet    = uiGlyph == kSolidGlyph;
+                if ( uiGlyph < kGlyphCount && uiX >= 1U && uiX <= 5U && uiY >= 1U )
+                    bSet = ( kFont[ uiGlyph ][ uiX - 1U ] >> ( uiY - 1U ) ) & 1U;
+                *pTexels++ = 0xFFU;
+                *pTexels++ = 0xFFU;
+                *pTexels++ = 0xFFU;
+                *pTexels++ = bSet ? 0xFFU : 0x00U;
+            }
+        }
+        return pTexture;
+    }
+
+    // sorts values
+    double percentile( std::vector< double >& values, double fPercentile )
+    {
+        if ( values.empty() )
+            return 0.0;
+        std::sort( values.begin(), values.end() );
+        const std::size_t szRank = static_cast< std::size_t >( fPercentile / 100.0 * ( values.size() - 1U ) + 0.5 );
+        return values[ std::min( szRank, values.size() - 1U ) ];
+    }
+} // namespace
+
+PerfHud::PerfHud( vk::PhysicalDevice physicalDevice,
+                  vk::Device         device,
+                  vk::RenderPass     renderPass,
+                  vk::PipelineCache  pipelineCache,
+                  const AssetPack&   shaders,
+                  Uploader&          uploader,
+                  std::uint32_t      uiFramesInFlight,
+                  std::uint32_t      uiTimestampValidBits,
+                  bool               bMemoryBudget,
+                  const Config&      config )
+    : m_physicalDevice( physicalDevice )
+    , m_device( device )
+    , m_bMemoryBudget( bMemoryBudget )
+    , m_bVisible( config.bVisible )
+    , m_fBudgetMS( config.fBudgetMS )
+    , m_refresh( std::chrono::milliseconds( config.uiRefreshMS ) )
+    , m_timestampPeriodNS( physicalDevice.getProperties().limits.timestampPeriod )
+    , m_uiTimestampMask( uiTimestampValidBits >= 64U ? ~0ULL : ( 1ULL << uiTimestampValidBits ) - 1ULL )
+{
+    VERIFY_RTE( config.fBudgetMS > 0.0f );
+    VERIFY_RTE( config.uiRefreshMS > 0U );
+
+    m_pSprites = std::make_unique< SpriteBatch >(
+        physicalDevice, device, renderPass, pipelineCache, shaders, uploader, uiFramesInFlight, kMaxSprites );
+    m_uiPipeline    = m_pSprites->createPipeline( PipelineVariants::Blend::eAlpha );
+    m_pFont         = createFontTexture( physicalDevice, device, uploader );
+    m_uiFontTexture = m_pSprites->addTexture( *m_pFont );
+
+    if ( uiTimestampValidBits > 0U )
+    {
+        for ( std::uint32_t i = 0; i != uiFramesInFlight; ++i )
+        {
+            m_queryPools.push_back( m_device.createQueryPool(
+                vk::QueryPoolCreateInfo{ vk::QueryPoolCreateFlags{}, vk::QueryType::eTimestamp, 2U } ) );
+        }
+        m_queriesPending.resize( uiFramesInFlight, false );
+    }
+    m_layout.reserve( kMaxSprites );
+}
+
+PerfHud::~PerfHud()
+{
+    for ( vk::QueryPool queryPool : m_queryPools )
+    {
+        m_device.destroyQueryPool( queryPool );
+    }
+}
+
+void PerfHud::toggle()
+{
+    m_bVisible = !m_bVisible;
+    // lay out straight away rather than showing the last layout
+    m_nextLayout          = Clock::time_point{};
+    m_uiFramesSinceLayout = 0U;
+}
+
+void PerfHud::beginTimer( const DeviceDispatch& dispatch, vk::CommandBuffer commandBuffer, std::uint32_t uiFrameSlot )
+{
+    if ( m_queryPools.empty() )
+        return;
+    dispatch.cmdResetQueryPool( commandBuffer, m_queryPools[ uiFrameSlot ], 0U, 2U );
+    dispatch.cmdWriteTimestamp(
+        commandBuffer, vk::PipelineStageFlagBits::eTopOfPipe, m_queryPools[ uiFrameSlot ], 0U );
+}
+
+void PerfHud::endTimer( const DeviceDispatch& dispatch, vk::CommandBuffer commandBuffer, std::uint32_t uiFrameSlot )
+{
+    if ( m_queryPools.empty() )
+        return;
+    dispatch.cmdWriteTimestamp(
+        commandBuffer, vk::PipelineStageFlagBits::eBottomOfPipe, m_queryPools[ uiFrameSlot ], 1U );
+    m_queriesPending[ uiFrameSlot ] = true;
+}
+
+double PerfHud::collectTimer( std::uint32_t uiFrameSlot )
+{
+    if ( m_queryPools.empty() || !m_queriesPending[ uiFrameSlot ] )
+        return -1.0;
+
+    std::array< std::uint64_t, 2 > timestamps;
+    const vk::Result               result = m_device.getQueryPoolResults( m_queryPools[ uiFrameSlot ],
+                                                            0U,
+                                                            2U,
+                                                            sizeof( timestamps ),
+                                                            timestamps.data(),
+                                                            sizeof( std::uint64_t ),
+                                                            vk::QueryResultFlagBits::e64 );
+    m_queriesPending[ uiFrameSlot ] = false;
+    if ( result != vk::Result::eSuccess )
+        return -1.0;
+
+    const std::uint64_t uiTicks = ( timestamps[ 1 ] - timestamps[ 0 ] ) & m_uiTimestampMask;
+    return static_cast< double >( uiTicks ) * m_timestampPeriodNS / 1000000.0;
+}
+
+void PerfHud::addFrame( const FrameStats& frameStats )
+{
+    m_history[ m_uiFrames % kHistory ] = frameStats;
+    ++m_uiFrames;
+}
+
+void PerfHud::update( std::uint32_t uiFrameSlot, vk::Extent2D extent )
+{
+    if ( !m_bVisible )
+        return;
+
+    Clock::time_point replayTime = Clock::now();
+    if ( replayTime >= m_nextLayout )
+    {
+        const Clock::time_point startTime = replayTime;
+        readMemory();
+        layout( extent );
+        replayTime   = Clock::now();
+        m_nextLayout = startTime + m_refresh;
+        governLayout( std::chrono::duration< double, std::milli >( replayTime - startTime ).count() );
+    }
+
+    m_pSprites->begin( uiFrameSlot );
+    for ( const SpriteBatch::Sprite& sprite : m_layout )
+        m_pSprites->draw( sprite );
+    m_pSprites->end();
+    ++m_uiFramesSinceLayout;
+
+    const double fReplayMS = std::chrono::duration< double, std::milli >( Clock::now() - replayTime ).count();
+    m_fReplayCostMS        = m_fReplayCostMS * 0.95 + fReplayMS * 0.05;
+}
+
+void PerfHud::governLayout( double fLayoutMS )
+{
+    // nothing replayed a previous layout to spread this one's cost over
+    if ( m_uiFramesSinceLayout == 0U )
+        return;
+    const double fAmortisedMS = fLayoutMS / static_cast< double >( m_uiFramesSinceLayout );
+    m_uiFramesSinceLayout     = 0U;
+    m_fLayoutCostMS           = m_fLayoutCostMS * 0.75 + fAmortisedMS * 0.25;
+
+    // the replay runs every frame whatever the refresh interval so only the layouts are governed -
+    // they get the part of the budget the replay leaves
+    const double fLayoutBudgetMS = m_fBudgetMS - m_fReplayCostMS;
+    if ( fLayoutBudgetMS <= 0.0 )
+    {
+        if ( !m_bReplayOverBudget )
+        {
+            SPDLOG_WARN( "Performance HUD replay alone costs {:.3f}ms - over its {:.2f}ms budget",
+                         m_fReplayCostMS,
+                         m_fBudgetMS );
+        }
+        m_bReplayOverBudget = true;
+        return;
+    }
+    m_bReplayOverBudget = false;
+
+    if ( m_fLayoutCostMS > fLayoutBudgetMS && m_refresh < std::chrono::seconds( 4 ) )
+    {
+        m_refresh *= 2;
+        // twice as many frames share each layout from now on
+        m_fLayoutCostMS *= 0.5;
+        SPDLOG_WARN( "Performance HUD over its {:.2f}ms budget - refreshing every {}ms",
+                     m_fBudgetMS,
+                     std::chrono::duration_cast< std::chrono::milliseconds >( m_refresh ).count() );
+    }
+}
+
+void PerfHud::record( const DeviceDispatch& dispatch, vk::CommandBuffer commandBuffer, vk::Extent2D extent ) const
+{
+    if ( m_bVisible )
+        m_pSprites->record( dispatch, commandBuffer, extent );
+}
+
+void PerfHud::layout( vk::Extent2D extent )
+{
+    m_layout.clear();
+
+    const std::uint32_t uiSamples = static_cast< std::uint32_t >( std::min< std::uint64_t >( m_uiFrames, kHistory ) );
+    std::vector< double > cpuTimes;
+    std::vector< double > gpuTimes;
+    FrameStats            last;
+    double                fMaxMS = fGraphMS;
+    for ( std::uint32_t i = 0; i != uiSamples; ++i )
+    {
+        const FrameStats& frameStats = m_history[ ( m_uiFrames - uiSamples + i ) % kHistory ];
+        cpuTimes.push_back( frameStats.fCpuMS );
+        if ( frameStats.fGpuMS >= 0.0 )
+            gpuTimes.push_back( frameStats.fGpuMS );
+        fMaxMS = std::max( { fMaxMS, frameStats.fCpuMS, frameStats.fGpuMS } );
+        last   = frameStats;
+    }
+
+    std::vector< std::string > lines;
+    std::array< char, 128 >    buffer;
+    const auto                 addLine = [ & ]( const char* pszName, std::vector< double >& times )
+    {
+        if ( times.empty() )
+        {
+            std::snprintf( buffer.data(), buffer.size(), "%s  n/a", pszName );
+        }
+        else
+        {
+            const double fLast = times.back();
+            std::snprintf( buffer.data(),
+                           buffer.size(),
+                           "%s %6.2f ms  p50 %5.2f  p95 %5.2f  p99 %5.2f",
+                           pszName,
+                           fLast,
+                           percentile( times, 50.0 ),
+                           percentile( times, 95.0 ),
+                           percentile( times, 99.0 ) );
+        }
+        lines.emplace_back( buffer.data() );
+    };
+    addLine( "CPU", cpuTimes );
+    addLine( "GPU", gpuTimes );
+
+    std::snprintf( buffer.data(),
+                   buffer.size(),
+                   "Draws %u  Tris %.2fM  Pipeline binds %u",
+                   last.uiDraws,
+                   static_cast< double >( last.uiTriangles ) / 1000000.0,
+                   last.uiPipelineBinds );
+    lines.emplace_back( buffer.data() );
+
+    if ( m_bMemoryBudget )
+    {
+        std::snprintf( buffer.data(),
+                       buffer.size(),
+                       "VRAM %llu / %llu MB  RSS %llu MB",
+                       static_cast< unsigned long long >( m_uiDeviceUsage >> 20U ),
+                       static_cast< unsigned long long >( m_uiDeviceBudget >> 20U ),
+                       static_cast< unsigned long long >( m_uiResident >> 20U ) );
+    }
+    else
+    {
+        std::snprintf( buffer.data(),
+                       buffer.size(),
+                       "VRAM n/a  RSS %llu MB",
+                       static_cast< unsigned long long >( m_uiResident >> 20U ) );
+    }
+    lines.emplace_back( buffer.data() );
+
+    std::snprintf( buffer.data(),
+                   buffer.size(),
+                   "HUD %.3f ms  refresh %lld ms",
+                   getCostMS(),
+                   static_cast< long long >(
+                       std::chrono::duration_cast< std::chrono::milliseconds >( m_refresh ).count() ) );
+    lines.emplace_back( buffer.data() );
+
+    // panel sized to the text and graph and kept on screen
+    std::size_t szColumns = 0U;
+    for ( const std::string& strLine : lines )
+        szColumns = std::max( szColumns, strLine.size() );
+    const float fWidth  = std::max( static_cast< float >( szColumns ) * fAdvance, kHistory * fBarWidth );
+    const float fHeight = static_cast< float >( lines.size() ) * fLineHeight + fMargin + fGraphHeight;
+    const float fX      = fMargin;
+    const float fY      = fMargin;
+    if ( fWidth + 3.0f * fMargin > static_cast< float >( extent.width ) )
+        return;
+    addRect( fX, fY, fWidth + 2.0f * fMargin, fHeight + 2.0f * fMargin, kPanelColour, 0U );
+
+    for ( std::size_t i = 0; i != lines.size(); ++i )
+    {
+        // frames slower than the graph's full height stand out
+        const bool bSlow = i < 2U && fMaxMS > fGraphMS;
+        addText( fX + fMargin,
+                 fY + fMargin + static_cast< float >( i ) * fLineHeight,
+                 lines[ i ],
+                 bSlow ? kWarnColour : kTextColour );
+    }
+
+    // CPU bars with the GPU time as a narrower bar in front
+    const float fGraphX  = fX + fMargin;
+    const float fGraphY  = fY + fMargin + static_cast< float >( lines.size() ) * fLineHeight + fMargin;
+    const float fPerMS   = fGraphHeight / static_cast< float >( fMaxMS );
+    const float fTargetY = fGraphY + fGraphHeight - fPerMS * 16.7f;
+    for ( std::uint32_t i = 0; i != uiSamples; ++i )
+    {
+        const FrameStats& frameStats = m_history[ ( m_uiFrames - uiSamples + i ) % kHistory ];
+        const float       fBarX      = fGraphX + static_cast< float >( kHistory - uiSamples + i ) * fBarWidth;
+        const float       fCpu       = std::max( fPerMS * static_cast< float >( frameStats.fCpuMS ), 1.0f );
+        addRect( fBarX, fGraphY + fGraphHeight - fCpu, fBarWidth, fCpu, kCpuColour, 1U );
+        if ( frameStats.fGpuMS >= 0.0 )
+        {
+            const float fGpu = std::max( fPerMS * static_cast< float >( frameStats.fGpuMS ), 1.0f );
+            addRect( fBarX + 1.0f, fGraphY + fGraphHeight - fGpu, 1.0f, fGpu, kGpuColour, 2U );
+        }
+    }
+    addRect( fGraphX, fTargetY, kHistory * fBarWidth, 1.0f, kTargetColour, 3U );
+}
+
+void PerfHud::addText( float fX, float fY, const std::string& strText, std::uint32_t uiColour )
+{
+    constexpr float fCellU = static_cast< float >( kCellSize ) / kAtlasWidth;
+    constexpr float fCellV = static_cast< float >( kCellSize ) / kAtlasHeight;
+
+    for ( char c : strText )
+    {
+        const std::uint32_t uiGlyph = static_cast< std::uint32_t >( c - kFirstChar );
+        if ( c != kFirstChar && uiGlyph < kGlyphCount )
+        {
+            const float fU = static_cast< float >( uiGlyph % kAtlasCells ) * fCellU;
+            const float fV = static_cast< float >( uiGlyph / kAtlasCells ) * fCellV;
+
+            SpriteBatch::Sprite glyph{ { fX, fY },
+                                       { kCellSize * fGlyphScale, kCellSize * fGlyphScale },
+                                       { fU, fV, fU + fCellU, fV + fCellV } };
+            glyph.uiColour   = uiColour;
+            glyph.uiLayer    = 4U;
+            glyph.uiPipeline = m_uiPipeline;
+            glyph.uiTexture  = m_uiFontTexture;
+            m_layout.push_back( glyph );
+        }
+        fX += fAdvance;
+    }
+}
+
+void PerfHud::addRect( float fX, float fY, float fWidth, float fHeight, std::uint32_t uiColour, std::uint16_t uiLayer )
+{
+    // the middle of the solid cell so filtering never reaches a neighbouring glyph
+    const float fU = ( static_cast< float >( kSolidGlyph % kAtlasCells ) * kCellSize + kCellSize * 0.5f ) / kAtlasWidth;
+    const float fV
+        = ( static_cast< float >( kSolidGlyph / kAtlasCells ) * kCellSize + kCellSize * 0.5f ) / kAtlasHeight;
+
+    SpriteBatch::Sprite rect{ { fX, fY }, { fWidth, fHeight }, { fU, fV, fU, fV } };
+    rect.uiColour   = uiColour;
+    rect.uiLayer    = uiLayer;
+    rect.uiPipeline = m_uiPipeline;
+    rect.uiTexture  = m_uiFontTexture;
+    m_layout.push_back( rect );
+}
+
+void PerfHud::readMemory()
+{
+    if ( m_bMemoryBudget )
+    {
+        const DeviceMemoryBudget deviceMemory = readDeviceMemoryBudget( m_physicalDevice );
+        m_uiDeviceUsage                       = deviceMemory.uiUsage;
+        m_uiDeviceBudget                      = deviceMemory.uiBudget;
+    }
+    m_uiResident = readResidentBytes();
+}
+
+} // namespace retail
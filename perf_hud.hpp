@@ -0,0 +1,136 @@
+#ifndef PERF_HUD_19_OCTOBER_2022
+#define PERF_HUD_19_OCTOBER_2022
+
+#include "asset_pack.hpp"
+#include "device_dispatch.hpp"
+#include "sprite_batch.hpp"
+#include "texture.hpp"
+#include "uploader.hpp"
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace retail
+{
+
+// On screen performance overlay for reading a running installation without attaching tools.
+//
+// Shows a CPU and GPU frame time graph, percentiles over the graphed frames, draw, triangle and
+// pipeline counts and memory use in text from a built in 5x7 font.  The overlay is laid out only
+// every refresh interval and the cached sprites are replayed in between so a visible HUD costs a
+// few hundred sprite copies per frame.  The layouts and the replay are timed apart and when the
+// layouts' cost spread over the frames replaying them exceeds what the replay leaves of the budget
+// the refresh interval doubles.  A hidden HUD only records frame statistics.
+class PerfHud
+{
+public:
+    struct Config
+    {
+        bool          bVisible    = false;
+        float         fBudgetMS   = 0.25f; // mean CPU cost per frame
+        std::uint32_t uiRefreshMS = 250U;
+    };
+
+    // one frame's figures - draws and binds across every window and pass
+    struct FrameStats
+    {
+        double        fCpuMS          = 0.0; // frame work excluding waits and pacing
+        double        fGpuMS          = -1.0; // negative when not measured
+        std::uint32_t uiDraws         = 0U;
+        std::uint64_t uiTriangles     = 0U;
+        std::uint32_t uiPipelineBinds = 0U;
+    };
+
+    // uiTimestampValidBits is for the queue the timer is recorded on - zero disables GPU timing
+    PerfHud( vk::PhysicalDevice physicalDevice,
+             vk::Device         device,
+             vk::RenderPass     renderPass,
+             vk::PipelineCache  pipelineCache,
+             const AssetPack&   shaders,
+             Uploader&          uploader,
+             std::uint32_t      uiFramesInFlight,
+             std::uint32_t      uiTimestampValidBits,
+             bool               bMemoryBudget, // VK_EXT_memory_budget is enabled
+             const Config&      config );
+    ~PerfHud();
+
+    PerfHud( const PerfHud& )            = delete;
+    PerfHud& operator=( const PerfHud& ) = delete;
+
+    void toggle();
+    bool isVisible() const { return m_bVisible; }
+
+    // bracket the GPU work timed for the slot
+    void beginTimer( const DeviceDispatch& dispatch, vk::CommandBuffer commandBuffer, std::uint32_t uiFrameSlot );
+    void endTimer( const DeviceDispatch& dispatch, vk::CommandBuffer commandBuffer, std::uint32_t uiFrameSlot );
+    // GPU milliseconds between the slot's timestamps - its previous work must have completed.
+    // Negative when there is nothing to read
+    double collectTimer( std::uint32_t uiFrameSlot );
+
+    void addFrame( const FrameStats& frameStats );
+
+    // lays out the overlay against extent when due and streams it for the slot
+    void update( std::uint32_t uiFrameSlot, vk::Extent2D extent );
+    // inside a render pass compatible with renderPass
+    void record( const DeviceDispatch& dispatch, vk::CommandBuffer commandBuffer, vk::Extent2D extent ) const;
+
+    // mean CPU milliseconds per frame spent in update() - the replay and the layouts amortised over it
+    double getCostMS() const { return m_fReplayCostMS + m_fLayoutCostMS; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::uint32_t kHistory    = 120U; // graphed frames
+    static constexpr std::uint32_t kMaxSprites = 1024U;
+
+    void layout( vk::Extent2D extent );
+    // doubles the refresh interval when the layouts amortise over budget
+    void governLayout( double fLayoutMS );
+    void addText( float fX, float fY, const std::string& strText, std::uint32_t uiColour );
+    void addRect( float fX, float fY, float fWidth, float fHeight, std::uint32_t uiColour, std::uint16_t uiLayer );
+    void readMemory();
+
+    vk::PhysicalDevice m_physicalDevice;
+    vk::Device         m_device;
+    bool               m_bMemoryBudget;
+    bool               m_bVisible;
+    double             m_fBudgetMS;
+    Clock::duration    m_refresh;
+
+    std::unique_ptr< SpriteBatch > m_pSprites;
+    std::unique_ptr< Texture >     m_pFont;
+    std::uint16_t                  m_uiPipeline    = 0U;
+    std::uint32_t                  m_uiFontTexture = 0U;
+
+    double                       m_timestampPeriodNS;
+    std::uint64_t                m_uiTimestampMask;
+    std::vector< vk::QueryPool > m_queryPools; // per frame slot - empty without timestamps
+    std::vector< bool >          m_queriesPending;
+
+    // graphed frames - a ring indexed by m_uiFrames
+    std::array< FrameStats, kHistory > m_history{};
+    std::uint64_t                      m_uiFrames = 0U;
+
+    // memory read at each layout
+    std::uint64_t m_uiDeviceUsage  = 0U; // bytes in device local heaps
+    std::uint64_t m_uiDeviceBudget = 0U;
+    std::uint64_t m_uiResident     = 0U; // process resident set
+
+    std::vector< SpriteBatch::Sprite > m_layout; // replayed until the next layout
+    Clock::time_point                  m_nextLayout;
+    std::uint32_t                      m_uiFramesSinceLayout = 0U;
+    double                             m_fReplayCostMS       = 0.0; // mean per frame
+    double                             m_fLayoutCostMS       = 0.0; // mean per frame once amortised
+    bool                               m_bReplayOverBudget   = false;
+};
+
+} // namespace retail
+
+#endif // PERF_HUD_19_OCTOBER_2022
@@ -0,0 +1,232 @@
+#include "pipeline_variants.hpp"
+#include "counters.hpp"
+#include "hash.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <cstring>
+
+namespace retail
+{
+
+static_assert( sizeof( PipelineVariants::Variant )
+                   == 4U + sizeof( std::uint32_t ) * PipelineVariants::kMaxSpecialisationConstants,
+               "PipelineVariants::Variant must not contain padding" );
+
+namespace
+{
+vk::PipelineColorBlendAttachmentState toBlendState( PipelineVariants::Blend blend )
+{
+    vk::PipelineColorBlendAttachmentState blendState;
+    blendState.colorWriteMask = vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG
+                                | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA;
+    switch ( blend )
+    {
+        case PipelineVariants::Blend::eOpaque:
+            blendState.blendEnable = false;
+            break;
+        case PipelineVariants::Blend::eAlpha:
+            blendState.blendEnable         = true;
+            blendState.srcColorBlendFactor = vk::BlendFactor::eSrcAlpha;
+            blendState.dstColorBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha;
+            blendState.srcAlphaBlendFactor = vk::BlendFactor::eOne;
+            blendState.dstAlphaBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha;
+            break;
+        case PipelineVariants::Blend::eAdditive:
+            blendState.blendEnable         = true;
+            blendState.srcColorBlendFactor = vk::BlendFactor::eSrcAlpha;
+            blendState.dstColorBlendFactor = vk::BlendFactor::eOne;
+            blendState.srcAlphaBlendFactor = vk::BlendFactor::eZero;
+            blendState.dstAlphaBlendFactor = vk::BlendFactor::eOne;
+            break;
+    }
+    return blendState;
+}
+
+vk::CullModeFlags toCullMode( PipelineVariants::Cull cull )
+{
+    switch ( cull )
+    {
+        case PipelineVariants::Cull::eNone:
+            return vk::CullModeFlagBits::eNone;
+        case PipelineVariants::Cull::eBack:
+            return vk::CullModeFlagBits::eBack;
+        case PipelineVariants::Cull::eFront:
+            return vk::CullModeFlagBits::eFront;
+    }
+    THROW_RTE( "Unknown cull mode" );
+}
+
+vk::PrimitiveTopology toTopology( PipelineVariants::Topology topology )
+{
+    switch ( topology )
+    {
+        case PipelineVariants::Topology::eTriangleList:
+            return vk::PrimitiveTopology::eTriangleList;
+        case PipelineVariants::Topology::eTriangleStrip:
+            return vk::PrimitiveTopology::eTriangleStrip;
+        case PipelineVariants::Topology::eLineList:
+            return vk::PrimitiveTopology::eLineList;
+    }
+    THROW_RTE( "Unknown topology" );
+}
+} // namespace
+
+bool PipelineVariants::Variant::operator==( const Variant& other ) const
+{
+    return std::memcmp( this, &other, sizeof( Variant ) ) == 0;
+}
+
+PipelineVariants::PipelineVariants( vk::Device device, vk::PipelineCache pipelineCache, const Program& program )
+    : m_device( device )
+    , m_pipelineCache( pipelineCache )
+    , m_program( program )
+{
+    VERIFY_RTE( program.vertexShader && program.fragmentShader );
+    VERIFY_RTE( program.layout && program.renderPass );
+    VERIFY_RTE( program.uiSpecialisationCount <= kMaxSpecialisationConstants );
+}
+
+PipelineVariants::~PipelineVariants()
+{
+    for ( vk::Pipeline pipeline : m_pipelines )
+    {
+        m_device.destroyPipeline( pipeline );
+    }
+}
+
+PipelineVariants::Handle PipelineVariants::request( const Variant& variant )
+{
+    ++m_uiRequests;
+
+    const std::uint64_t uiHash = fnv1a64( &variant, sizeof( Variant ) );
+    const auto          iFind  = m_handles.find( uiHash );
+    if ( iFind != m_handles.end() )
+    {
+        VERIFY_RTE_MSG( m_variants[ iFind->second ] == variant, "Pipeline variant hash collision: " << uiHash );
+        return iFind->second;
+    }
+
+    const auto          startTime = std::chrono::steady_clock::now();
+    const vk::Pipeline  pipeline  = build( variant );
+    const auto          buildTime = std::chrono::duration_cast< std::chrono::microseconds >(
+        std::chrono::steady_clock::now() - startTime );
+    m_buildTime += buildTime;
+    count( Counter::ePipelineBuilds );
+
+    const Handle handle = static_cast< Handle >( m_pipelines.size() );
+    m_pipelines.push_back( pipeline );
+    m_variants.push_back( variant );
+    m_handles.insert( { uiHash, handle } );
+
+    SPDLOG_INFO( "Built pipeline variant: {} blend: {} cull: {} topology: {} in: {}us",
+                 handle,
+                 static_cast< int >( variant.blend ),
+                 static_cast< int >( variant.cull ),
+                 static_cast< int >( variant.topology ),
+                 buildTime.count() );
+    return handle;
+}
+
+vk::Pipeline PipelineVariants::build( const Variant& variant ) const
+{
+    // every constant is a uint32 so the map is just consecutive ids over the specialisation array
+    std::array< vk::SpecializationMapEntry, kMaxSpecialisationConstants > mapEntries;
+    for ( std::uint32_t i = 0; i != m_program.uiSpecialisationCount; ++i )
+    {
+        mapEntries[ i ] = vk::SpecializationMapEntry{ i, i * sizeof( std::uint32_t ), sizeof( std::uint32_t ) };
+    }
+    const vk::SpecializationInfo specialisationInfo{ m_program.uiSpecialisationCount,
+                                                     mapEntries.data(),
+                                                     m_program.uiSpecialisationCount * sizeof( std::uint32_t ),
+                                                     variant.specialisation.data() };
+    const vk::SpecializationInfo* pSpecialisationInfo
+        = m_program.uiSpecialisationCount ? &specialisationInfo : nullptr;
+
+    const std::array< vk::PipelineShaderStageCreateInfo, 2 > shaderStages
+        = { vk::PipelineShaderStageCreateInfo{ vk::PipelineShaderStageCreateFlags{},
+                                               vk::ShaderStageFlagBits::eVertex,
+                                               m_program.vertexShader,
+                                               "main",
+                                               pSpecialisationInfo },
+            vk::PipelineShaderStageCreateInfo{ vk::PipelineShaderStageCreateFlags{},
+                                               vk::ShaderStageFlagBits::eFragment,
+                                               m_program.fragmentShader,
+                                               "main",
+                                               pSpecialisationInfo } };
+
+    const vk::PipelineVertexInputStateCreateInfo vertexInputCreateInfo
+        = { vk::PipelineVertexInputStateCreateFlags{}, m_program.vertexBindings, m_program.vertexAttributes };
+
+    const vk::PipelineInputAssemblyStateCreateInfo inputAssemblyCreateInfo
+        = { vk::PipelineInputAssemblyStateCreateFlags{}, toTopology( variant.topology ), false };
+
+    // viewport and scissor are dynamic
+    const vk::PipelineViewportStateCreateInfo viewportCreateInfo
+        = { vk::PipelineViewportStateCreateFlags{}, 1, nullptr, 1, nullptr };
+
+    const vk::PipelineRasterizationStateCreateInfo rasterCreateInfo = {
+        vk::PipelineRasterizationStateCreateFlags{},
+        false, // depthClampEnable_
+        false, // rasterizerDiscardEnable_
+        vk::PolygonMode::eFill,
+        toCullMode( variant.cull ),
+        variant.bClockwise ? vk::FrontFace::eClockwise : vk::FrontFace::eCounterClockwise,
+        false, // depthBiasEnable_
+        0.0f,  // depthBiasConstantFactor_
+        0.0f,  // depthBiasClamp_
+        0.0f,  // depthBiasSlopeFactor_
+        1.0f   // lineWidth_
+    };
+
+    const vk::PipelineMultisampleStateCreateInfo multisamplingCreateInfo
+        = { vk::PipelineMultisampleStateCreateFlags{}, vk::SampleCountFlagBits::e1 };
+
+    // depth is cleared to the far plane at 1
+    const vk::PipelineDepthStencilStateCreateInfo depthStencilCreateInfo{ vk::PipelineDepthStencilStateCreateFlags{},
+                                                                          true, // depthTestEnable_
+                                                                          m_program.bDepthWrite, // depthWriteEnable_
+                                                                          vk::CompareOp::eLessOrEqual };
+
+    const vk::PipelineColorBlendAttachmentState blendState = toBlendState( variant.blend );
+    const vk::PipelineColorBlendStateCreateInfo colorBlendCreateInfo
+        = { vk::PipelineColorBlendStateCreateFlags{}, false, vk::LogicOp::eNoOp, blendState };
+
+    const std::array< vk::DynamicState, 2 > dynamicStates
+        = { vk::DynamicState::eViewport, vk::DynamicState::eScissor };
+    const vk::PipelineDynamicStateCreateInfo dynamicState{ vk::PipelineDynamicStateCreateFlags{}, dynamicStates };
+
+    // the first variant is the parent of the rest
+    const vk::PipelineCreateFlags flags
+        = m_pipelines.empty() ? vk::PipelineCreateFlags{ vk::PipelineCreateFlagBits::eAllowDerivatives }
+                              : vk::PipelineCreateFlags{ vk::PipelineCreateFlagBits::eDerivative };
+
+    const vk::GraphicsPipelineCreateInfo pipelineCreateInfo = {
+        flags,
+        shaderStages,
+        &vertexInputCreateInfo,
+        &inputAssemblyCreateInfo,
+        nullptr, // pTessellationState_
+        &viewportCreateInfo,
+        &rasterCreateInfo,
+        &multisamplingCreateInfo,
+        m_program.bDepth ? &depthStencilCreateInfo : nullptr,
+        &colorBlendCreateInfo,
+        &dynamicState,
+        m_program.layout,
+        m_program.renderPass,
+        0,
+        m_pipelines.empty() ? vk::Pipeline{} : m_pipelines.front(), // basePipelineHandle_
+        -1                                                          // basePipelineIndex_
+    };
+
+    const vk::ResultValue< vk::Pipeline > result
+        = m_device.createGraphicsPipeline( m_pipelineCache, pipelineCreateInfo );
+    VERIFY_RTE_MSG( result.result == vk::Result::eSuccess,
+                    "Failed to create pipeline variant: " << vk::to_string( result.result ) );
+    return result.value;
+}
+
+} // namespace retail
@@ -0,0 +1,109 @@
+#ifndef PIPELINE_VARIANTS_17_OCTOBER_2022
+#define PIPELINE_VARIANTS_17_OCTOBER_2022
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace retail
+{
+
+// Graphics pipelines for one shader program built on demand from a compact state key plus
+// specialization constant values.
+//
+// request() hashes the variant, returns the existing handle when it has been seen before and
+// otherwise builds it - as a derivative of the first variant where the driver can use that.
+// get() with a handle is a vector index so the hot path never hashes.  Viewport and scissor are
+// always dynamic.
+class PipelineVariants
+{
+public:
+    enum class Blend : std::uint8_t
+    {
+        eOpaque,
+        eAlpha,
+        eAdditive
+    };
+    enum class Cull : std::uint8_t
+    {
+        eNone,
+        eBack,
+        eFront
+    };
+    enum class Topology : std::uint8_t
+    {
+        eTriangleList,
+        eTriangleStrip,
+        eLineList
+    };
+
+    static constexpr std::uint32_t kMaxSpecialisationConstants = 4U;
+
+    // every field is a whole number of bytes with no padding so the key hashes as raw memory
+    struct Variant
+    {
+        Blend        blend      = Blend::eOpaque;
+        Cull         cull       = Cull::eBack;
+        Topology     topology   = Topology::eTriangleList;
+        std::uint8_t bClockwise = 0U; // front face winding
+
+        // values for constant_id 0 .. uiSpecialisationCount - 1 in every stage
+        std::array< std::uint32_t, kMaxSpecialisationConstants > specialisation{};
+
+        bool operator==( const Variant& other ) const;
+    };
+
+    struct Program
+    {
+        vk::ShaderModule                                   vertexShader;
+        vk::ShaderModule                                   fragmentShader;
+        std::vector< vk::VertexInputBindingDescription >   vertexBindings;
+        std::vector< vk::VertexInputAttributeDescription > vertexAttributes;
+        vk::PipelineLayout                                 layout;
+        vk::RenderPass                                     renderPass;
+        std::uint32_t                                      uiSpecialisationCount = 0U;
+        // the render pass has a depth attachment - every variant tests it and writes it unless
+        // bDepthWrite is cleared for blended geometry drawn over the opaque scene
+        bool                                               bDepth      = false;
+        bool                                               bDepthWrite = true;
+    };
+
+    using Handle = std::uint32_t;
+
+    // the program's shaders, layout and render pass must outlive this object
+    PipelineVariants( vk::Device device, vk::PipelineCache pipelineCache, const Program& program );
+    ~PipelineVariants();
+
+    PipelineVariants( const PipelineVariants& )            = delete;
+    PipelineVariants& operator=( const PipelineVariants& ) = delete;
+
+    Handle       request( const Variant& variant );
+    vk::Pipeline get( Handle handle ) const { return m_pipelines[ handle ]; }
+
+    std::uint32_t             getVariantCount() const { return static_cast< std::uint32_t >( m_pipelines.size() ); }
+    std::uint64_t             getRequestCount() const { return m_uiRequests; }
+    std::chrono::microseconds getBuildTime() const { return m_buildTime; }
+
+private:
+    vk::Pipeline build( const Variant& variant ) const;
+
+    vk::Device        m_device;
+    vk::PipelineCache m_pipelineCache;
+    Program           m_program;
+
+    std::unordered_map< std::uint64_t, Handle > m_handles;
+    std::vector< Variant >                      m_variants;
+    std::vector< vk::Pipeline >                 m_pipelines;
+
+    std::uint64_t             m_uiRequests = 0U;
+    std::chrono::microseconds m_buildTime{ 0 };
+};
+
+} // namespace retail
+
+#endif // PIPELINE_VARIANTS_17_OCTOBER_2022
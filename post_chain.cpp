@@ -0,0 +1,524 @@
+#include "post_chain.hpp"
+#include "buffer.hpp"
+#include "counters.hpp"
+#include "shader.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace retail
+{
+
+namespace
+{
+// must match PostParams in the post processing shaders
+struct PostPushConstants
+{
+    float         sourceTexelSize[ 2 ];
+    float         fBloomThreshold;
+    float         fBloomIntensity;
+    float         fExposure;
+    float         fSharpness;
+    std::uint32_t uiBrightPass;
+};
+
+constexpr std::uint32_t kGroupSize = 8U; // local_size_x and local_size_y of every post shader
+
+vk::Extent2D mipExtent( vk::Extent2D extent, std::uint32_t uiMip )
+{
+    return vk::Extent2D{ std::max( extent.width >> uiMip, 1U ), std::max( extent.height >> uiMip, 1U ) };
+}
+} // namespace
+
+PostChain::PostChain( vk::PhysicalDevice                  physicalDevice,
+                      vk::Device                          device,
+                      vk::PipelineCache                   pipelineCache,
+                      const AssetPack&                    shaders,
+                      vk::RenderPass                      sceneRenderPass,
+                      const std::vector< std::uint32_t >& queueFamilies,
+                      std::uint32_t                       uiTimestampValidBits,
+                      std::uint32_t                       uiFramesInFlight,
+                      const std::vector< vk::Extent2D >&  extents,
+                      const Settings&                     settings )
+    : m_physicalDevice( physicalDevice )
+    , m_device( device )
+    , m_queueFamilies( queueFamilies )
+    , m_uiFramesInFlight( uiFramesInFlight )
+    , m_settings( settings )
+    , m_bTimestamps( uiTimestampValidBits > 0U )
+    , m_timestampPeriodNS( physicalDevice.getProperties().limits.timestampPeriod )
+    , m_uiTimestampMask( uiTimestampValidBits >= 64U ? ~0ULL : ( 1ULL << uiTimestampValidBits ) - 1ULL )
+{
+    VERIFY_RTE( !queueFamilies.empty() );
+    VERIFY_RTE( !extents.empty() );
+    VERIFY_RTE( settings.uiBloomMips > 0U );
+
+    {
+        const vk::FormatFeatureFlags required
+            = vk::FormatFeatureFlagBits::eDepthStencilAttachment | vk::FormatFeatureFlagBits::eSampledImage;
+        VERIFY_RTE_MSG(
+            ( physicalDevice.getFormatProperties( kDepthFormat ).optimalTilingFeatures & required ) == required,
+            "Depth format does not support sampling: " << vk::to_string( kDepthFormat ) );
+    }
+
+    {
+        // two sampled sources - the tonemap reads the scene and the bloom - and the destination
+        const std::array< vk::DescriptorSetLayoutBinding, 3 > bindings
+            = { vk::DescriptorSetLayoutBinding{
+                    0, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eCompute, nullptr },
+                vk::DescriptorSetLayoutBinding{
+                    1, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eCompute, nullptr },
+                vk::DescriptorSetLayoutBinding{
+                    2, vk::DescriptorType::eStorageImage, 1, vk::ShaderStageFlagBits::eCompute, nullptr } };
+        m_descriptorSetLayout = m_device.createDescriptorSetLayout(
+            vk::DescriptorSetLayoutCreateInfo{ vk::DescriptorSetLayoutCreateFlags{}, bindings } );
+
+        const vk::PushConstantRange pushConstantRange{
+            vk::ShaderStageFlagBits::eCompute, 0, sizeof( PostPushConstants ) };
+        m_pipelineLayout = m_device.createPipelineLayout(
+            vk::PipelineLayoutCreateInfo{ vk::PipelineLayoutCreateFlags{}, m_descriptorSetLayout, pushConstantRange } );
+    }
+
+    {
+        const vk::SamplerCreateInfo samplerCreateInfo{ vk::SamplerCreateFlags{},
+                                                       vk::Filter::eLinear,
+                                                       vk::Filter::eLinear,
+                                                       vk::SamplerMipmapMode::eNearest,
+                                                       vk::SamplerAddressMode::eClampToEdge,
+                                                       vk::SamplerAddressMode::eClampToEdge,
+                                                       vk::SamplerAddressMode::eClampToEdge };
+        m_sampler = m_device.createSampler( samplerCreateInfo );
+    }
+
+    m_downsampleShader   = createShaderModule( m_device, shaders, "bloom_down.spv" );
+    m_upsampleShader     = createShaderModule( m_device, shaders, "bloom_up.spv" );
+    m_tonemapShader      = createShaderModule( m_device, shaders, "tonemap.spv" );
+    m_sharpenShader      = createShaderModule( m_device, shaders, "sharpen.spv" );
+    m_downsamplePipeline = createComputePipeline( m_device, pipelineCache, m_pipelineLayout, m_downsampleShader );
+    m_upsamplePipeline   = createComputePipeline( m_device, pipelineCache, m_pipelineLayout, m_upsampleShader );
+    m_tonemapPipeline    = createComputePipeline( m_device, pipelineCache, m_pipelineLayout, m_tonemapShader );
+    m_sharpenPipeline    = createComputePipeline( m_device, pipelineCache, m_pipelineLayout, m_sharpenShader );
+
+    {
+        // per target: a set per bloom mip down, one fewer up, the tonemap and the sharpen
+        const std::uint32_t uiTargets      = static_cast< std::uint32_t >( extents.size() ) * m_uiFramesInFlight;
+        const std::uint32_t uiSetsPerTarget = 2U * m_settings.uiBloomMips + 1U;
+        const std::uint32_t uiSets          = uiTargets * uiSetsPerTarget;
+        const std::array< vk::DescriptorPoolSize, 2 > poolSizes
+            = { vk::DescriptorPoolSize{ vk::DescriptorType::eCombinedImageSampler, 2U * uiSets },
+                vk::DescriptorPoolSize{ vk::DescriptorType::eStorageImage, uiSets } };
+        m_descriptorPool = m_device.createDescriptorPool(
+            vk::DescriptorPoolCreateInfo{ vk::DescriptorPoolCreateFlags{}, uiSets, poolSizes } );
+    }
+
+    m_targets.resize( extents.size() * m_uiFramesInFlight );
+    for ( std::size_t i = 0; i != extents.size(); ++i )
+    {
+        for ( std::uint32_t uiFrameSlot = 0; uiFrameSlot != m_uiFramesInFlight; ++uiFrameSlot )
+        {
+            createTarget( m_targets[ i * m_uiFramesInFlight + uiFrameSlot ], extents[ i ], sceneRenderPass );
+        }
+    }
+
+    if ( m_bTimestamps )
+    {
+        for ( std::uint32_t i = 0; i != m_uiFramesInFlight; ++i )
+        {
+            m_queryPools.push_back( m_device.createQueryPool(
+                vk::QueryPoolCreateInfo{ vk::QueryPoolCreateFlags{}, vk::QueryType::eTimestamp, kPassCount + 1U } ) );
+        }
+        m_queriesPending.resize( m_uiFramesInFlight, false );
+    }
+
+    SPDLOG_INFO( "Created post chain for: {} windows with: {} bloom mips timestamps: {} queue families: {}",
+                 extents.size(),
+                 m_settings.uiBloomMips,
+                 m_bTimestamps,
+                 m_queueFamilies.size() );
+}
+
+PostChain::~PostChain()
+{
+    for ( vk::QueryPool queryPool : m_queryPools )
+    {
+        m_device.destroyQueryPool( queryPool );
+    }
+    for ( Target& target : m_targets )
+    {
+        if ( target.sceneFramebuffer )
+        {
+            m_device.destroyFramebuffer( target.sceneFramebuffer );
+        }
+        destroyImage( target.scene );
+        destroyImage( target.depth );
+        destroyImage( target.bloom );
+        destroyImage( target.tonemapped );
+        destroyImage( target.output );
+    }
+    for ( vk::Pipeline pipeline : { m_downsamplePipeline, m_upsamplePipeline, m_tonemapPipeline, m_sharpenPipeline } )
+    {
+        if ( pipeline )
+        {
+            m_device.destroyPipeline( pipeline );
+        }
+    }
+    for ( vk::ShaderModule shader : { m_downsampleShader, m_upsampleShader, m_tonemapShader, m_sharpenShader } )
+    {
+        if ( shader )
+        {
+            m_device.destroyShaderModule( shader );
+        }
+    }
+    if ( m_sampler )
+    {
+        m_device.destroySampler( m_sampler );
+    }
+    if ( m_descriptorPool )
+    {
+        m_device.destroyDescriptorPool( m_descriptorPool );
+    }
+    if ( m_pipelineLayout )
+    {
+        m_device.destroyPipelineLayout( m_pipelineLayout );
+    }
+    if ( m_descriptorSetLayout )
+    {
+        m_device.destroyDescriptorSetLayout( m_descriptorSetLayout );
+    }
+}
+
+PostChain::Image PostChain::createImage( vk::Format          format,
+                                         vk::Extent2D        extent,
+                                         std::uint32_t       uiMips,
+                                         vk::ImageUsageFlags usage )
+{
+    Image result;
+
+    const bool                bConcurrent = m_queueFamilies.size() > 1U;
+    const vk::ImageCreateInfo imageCreateInfo{ vk::ImageCreateFlags{},
+                                               vk::ImageType::e2D,
+                                               format,
+                                               vk::Extent3D{ extent.width, extent.height, 1U },
+                                               uiMips,
+                                               1U,
+                                               vk::SampleCountFlagBits::e1,
+                                               vk::ImageTiling::eOptimal,
+                                               usage,
+                                               bConcurrent ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive,
+                                               m_queueFamilies,
+                                               vk::ImageLayout::eUndefined };
+    result.image = m_device.createImage( imageCreateInfo );
+
+    const vk::MemoryRequirements requirements = m_device.getImageMemoryRequirements( result.image );
+    const vk::MemoryAllocateInfo allocateInfo{
+        requirements.size,
+        findMemoryType( m_physicalDevice, requirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal ) };
+    result.memory = m_device.allocateMemory( allocateInfo );
+    count( Counter::eAllocations );
+    m_device.bindImageMemory( result.image, result.memory, 0U );
+
+    const vk::ImageAspectFlags aspect
+        = format == kDepthFormat ? vk::ImageAspectFlagBits::eDepth : vk::ImageAspectFlagBits::eColor;
+    result.view = m_device.createImageView(
+        vk::ImageViewCreateInfo{ vk::ImageViewCreateFlags{},
+                                 result.image,
+                                 vk::ImageViewType::e2D,
+                                 format,
+                                 vk::ComponentMapping{},
+                                 vk::ImageSubresourceRange{ aspect, 0U, uiMips, 0U, 1U } } );
+    if ( uiMips > 1U )
+    {
+        for ( std::uint32_t uiMip = 0; uiMip != uiMips; ++uiMip )
+        {
+            result.mipViews.push_back( m_device.createImageView( vk::ImageViewCreateInfo{
+                vk::ImageViewCreateFlags{},
+                result.image,
+                vk::ImageViewType::e2D,
+                format,
+                vk::ComponentMapping{},
+                vk::ImageSubresourceRange{ aspect, uiMip, 1U, 0U, 1U } } ) );
+        }
+    }
+    return result;
+}
+
+void PostChain::destroyImage( Image& image )
+{
+    for ( vk::ImageView view : image.mipViews )
+    {
+        m_device.destroyImageView( view );
+    }
+    if ( image.view )
+    {
+        m_device.destroyImageView( image.view );
+    }
+    if ( image.image )
+    {
+        m_device.destroyImage( image.image );
+    }
+    if ( image.memory )
+    {
+        m_device.freeMemory( image.memory );
+    }
+    image = Image{};
+}
+
+void PostChain::createTarget( Target& target, vk::Extent2D extent, vk::RenderPass sceneRenderPass )
+{
+    const vk::ImageUsageFlags storageUsage = vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled;
+
+    // every mip views the chain separately so a mip of one view is never both read and written
+    const vk::Extent2D  bloomExtent = mipExtent( extent, 1U );
+    const std::uint32_t uiMaxMips
+        = 1U + static_cast< std::uint32_t >( std::log2( std::max( bloomExtent.width, bloomExtent.height ) ) );
+    const std::uint32_t uiBloomMips = std::max( std::min( m_settings.uiBloomMips, uiMaxMips ), 2U );
+
+    target.extent = extent;
+    target.scene  = createImage(
+        kSceneFormat, extent, 1U, vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled );
+    target.depth  = createImage(
+        kDepthFormat, extent, 1U, vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eSampled );
+    target.bloom      = createImage( kSceneFormat, bloomExtent, uiBloomMips, storageUsage );
+    target.tonemapped = createImage( kSceneFormat, extent, 1U, storageUsage );
+    target.output     = createImage(
+        kSceneFormat, extent, 1U, vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eTransferSrc );
+
+    const std::array< vk::ImageView, 2 > attachments = { target.scene.view, target.depth.view };
+    target.sceneFramebuffer                          = m_device.createFramebuffer( vk::FramebufferCreateInfo{
+        vk::FramebufferCreateFlags{}, sceneRenderPass, attachments, extent.width, extent.height, 1 } );
+
+    for ( std::uint32_t uiMip = 0; uiMip != uiBloomMips; ++uiMip )
+    {
+        const bool          bFromScene = uiMip == 0U;
+        const vk::ImageView source     = bFromScene ? target.scene.view : target.bloom.mipViews[ uiMip - 1U ];
+        target.downsampleSets.push_back(
+            createSet( source,
+                       bFromScene ? vk::ImageLayout::eShaderReadOnlyOptimal : vk::ImageLayout::eGeneral,
+                       source,
+                       target.bloom.mipViews[ uiMip ] ) );
+    }
+    for ( std::uint32_t uiMip = 0; uiMip + 1U != uiBloomMips; ++uiMip )
+    {
+        const vk::ImageView source = target.bloom.mipViews[ uiMip + 1U ];
+        target.upsampleSets.push_back(
+            createSet( source, vk::ImageLayout::eGeneral, source, target.bloom.mipViews[ uiMip ] ) );
+    }
+    target.tonemapSet = createSet( target.scene.view,
+                                   vk::ImageLayout::eShaderReadOnlyOptimal,
+                                   target.bloom.mipViews[ 0 ],
+                                   target.tonemapped.view );
+    target.sharpenSet = createSet(
+        target.tonemapped.view, vk::ImageLayout::eGeneral, target.tonemapped.view, target.output.view );
+}
+
+vk::DescriptorSet PostChain::createSet( vk::ImageView   source,
+                                        vk::ImageLayout sourceLayout,
+                                        vk::ImageView   second,
+                                        vk::ImageView   destination )
+{
+    const vk::DescriptorSet set
+        = m_device.allocateDescriptorSets( vk::DescriptorSetAllocateInfo{ m_descriptorPool, m_descriptorSetLayout } )
+              .front();
+
+    // the second source is only read by the tonemap - the others repeat the first to keep every binding valid
+    const vk::DescriptorImageInfo sourceInfo{ m_sampler, source, sourceLayout };
+    const vk::DescriptorImageInfo secondInfo{
+        m_sampler, second, second == source ? sourceLayout : vk::ImageLayout::eGeneral };
+    const vk::DescriptorImageInfo destinationInfo{ vk::Sampler{}, destination, vk::ImageLayout::eGeneral };
+    const std::array< vk::WriteDescriptorSet, 3 > writes
+        = { vk::WriteDescriptorSet{ set, 0, 0, vk::DescriptorType::eCombinedImageSampler, sourceInfo },
+            vk::WriteDescriptorSet{ set, 1, 0, vk::DescriptorType::eCombinedImageSampler, secondInfo },
+            vk::WriteDescriptorSet{ set, 2, 0, vk::DescriptorType::eStorageImage, destinationInfo } };
+    m_device.updateDescriptorSets( writes, nullptr );
+    return set;
+}
+
+void PostChain::recordPass( const DeviceDispatch& dispatch,
+                            vk::CommandBuffer     commandBuffer,
+                            vk::Pipeline          pipeline,
+                            vk::DescriptorSet     set,
+                            vk::Extent2D          extent ) const
+{
+    dispatch.cmdBindPipeline( commandBuffer, vk::PipelineBindPoint::eCompute, pipeline );
+    dispatch.cmdBindDescriptorSet( commandBuffer, vk::PipelineBindPoint::eCompute, m_pipelineLayout, 0U, set );
+    dispatch.cmdDispatch( commandBuffer,
+                          ( extent.width + kGroupSize - 1U ) / kGroupSize,
+                          ( extent.height + kGroupSize - 1U ) / kGroupSize,
+                          1U );
+}
+
+void PostChain::record( const DeviceDispatch& dispatch, vk::CommandBuffer commandBuffer, std::uint32_t uiFrameSlot )
+{
+    const vk::QueryPool queryPool = m_bTimestamps ? m_queryPools[ uiFrameSlot ] : vk::QueryPool{};
+    std::uint32_t       uiQuery   = 0U;
+    const auto          timestamp = [ & ]()
+    {
+        if ( queryPool )
+            dispatch.cmdWriteTimestamp(
+                commandBuffer, vk::PipelineStageFlagBits::eBottomOfPipe, queryPool, uiQuery++ );
+    };
+    if ( queryPool )
+    {
+        dispatch.cmdResetQueryPool( commandBuffer, queryPool, 0U, kPassCount + 1U );
+        m_queriesPending[ uiFrameSlot ] = true;
+    }
+
+    // the intermediates are fully overwritten so their previous contents are discarded
+    std::vector< vk::ImageMemoryBarrier > barriers;
+    for ( std::uint32_t uiTarget = 0; uiTarget * m_uiFramesInFlight != m_targets.size(); ++uiTarget )
+    {
+        const Target& target = getTarget( uiTarget, uiFrameSlot );
+        for ( const Image* pImage : { &target.bloom, &target.tonemapped, &target.output } )
+        {
+            barriers.push_back( vk::ImageMemoryBarrier{
+                vk::AccessFlags{},
+                vk::AccessFlagBits::eShaderWrite,
+                vk::ImageLayout::eUndefined,
+                vk::ImageLayout::eGeneral,
+                VK_QUEUE_FAMILY_IGNORED,
+                VK_QUEUE_FAMILY_IGNORED,
+                pImage->image,
+                vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, 0U, VK_REMAINING_MIP_LEVELS, 0U, 1U } } );
+        }
+    }
+    dispatch.cmdPipelineBarrier( commandBuffer,
+                                 vk::PipelineStageFlagBits::eTopOfPipe,
+                                 vk::PipelineStageFlagBits::eComputeShader,
+                                 0U,
+                                 nullptr,
+                                 static_cast< std::uint32_t >( barriers.size() ),
+                                 barriers.data() );
+    timestamp();
+
+    PostPushConstants pushConstants{ { 0.0f, 0.0f },
+                                     m_settings.fBloomThreshold,
+                                     m_settings.fBloomIntensity,
+                                     m_settings.fExposure,
+                                     m_settings.fSharpness,
+                                     0U };
+    const auto push = [ & ]( vk::Extent2D sourceExtent, bool bBrightPass )
+    {
+        pushConstants.sourceTexelSize[ 0 ] = 1.0f / static_cast< float >( sourceExtent.width );
+        pushConstants.sourceTexelSize[ 1 ] = 1.0f / static_cast< float >( sourceExtent.height );
+        pushConstants.uiBrightPass         = bBrightPass ? 1U : 0U;
+        dispatch.cmdPushConstants( commandBuffer,
+                                   m_pipelineLayout,
+                                   vk::ShaderStageFlagBits::eCompute,
+                                   0U,
+                                   sizeof( PostPushConstants ),
+                                   &pushConstants );
+    };
+
+    // each step is issued for every window before the barrier so windows overlap on the GPU
+    const std::uint32_t uiTargets   = static_cast< std::uint32_t >( m_targets.size() ) / m_uiFramesInFlight;
+    std::uint32_t       uiBloomMips = 0U;
+    for ( std::uint32_t uiTarget = 0; uiTarget != uiTargets; ++uiTarget )
+    {
+        uiBloomMips = std::max(
+            uiBloomMips, static_cast< std::uint32_t >( getTarget( uiTarget, uiFrameSlot ).downsampleSets.size() ) );
+    }
+    for ( std::uint32_t uiMip = 0; uiMip != uiBloomMips; ++uiMip )
+    {
+        for ( std::uint32_t uiTarget = 0; uiTarget != uiTargets; ++uiTarget )
+        {
+            const Target& target = getTarget( uiTarget, uiFrameSlot );
+            if ( uiMip >= target.downsampleSets.size() )
+                continue;
+            push( mipExtent( target.extent, uiMip ), uiMip == 0U );
+            recordPass( dispatch,
+                        commandBuffer,
+                        m_downsamplePipeline,
+                        target.downsampleSets[ uiMip ],
+                        mipExtent( target.extent, uiMip + 1U ) );
+        }
+        computeBarrier( dispatch, commandBuffer );
+    }
+    timestamp();
+
+    for ( std::uint32_t uiMip = uiBloomMips - 1U; uiMip-- != 0U; )
+    {
+        for ( std::uint32_t uiTarget = 0; uiTarget != uiTargets; ++uiTarget )
+        {
+            const Target& target = getTarget( uiTarget, uiFrameSlot );
+            if ( uiMip >= target.upsampleSets.size() )
+                continue;
+            push( mipExtent( target.extent, uiMip + 2U ), false );
+            recordPass( dispatch,
+                        commandBuffer,
+                        m_upsamplePipeline,
+                        target.upsampleSets[ uiMip ],
+                        mipExtent( target.extent, uiMip + 1U ) );
+        }
+        computeBarrier( dispatch, commandBuffer );
+    }
+    timestamp();
+
+    for ( std::uint32_t uiTarget = 0; uiTarget != uiTargets; ++uiTarget )
+    {
+        const Target& target = getTarget( uiTarget, uiFrameSlot );
+        push( mipExtent( target.extent, 1U ), false );
+        recordPass( dispatch, commandBuffer, m_tonemapPipeline, target.tonemapSet, target.extent );
+    }
+    computeBarrier( dispatch, commandBuffer );
+    timestamp();
+
+    for ( std::uint32_t uiTarget = 0; uiTarget != uiTargets; ++uiTarget )
+    {
+        const Target& target = getTarget( uiTarget, uiFrameSlot );
+        push( target.extent, false );
+        recordPass( dispatch, commandBuffer, m_sharpenPipeline, target.sharpenSet, target.extent );
+    }
+    timestamp();
+}
+
+void PostChain::collectTimings( std::uint32_t uiFrameSlot )
+{
+    if ( !m_bTimestamps || !m_queriesPending[ uiFrameSlot ] )
+        return;
+
+    std::array< std::uint64_t, kPassCount + 1U > timestamps;
+    const vk::Result                             result
+        = m_device.getQueryPoolResults( m_queryPools[ uiFrameSlot ],
+                                        0U,
+                                        kPassCount + 1U,
+                                        sizeof( timestamps ),
+                                        timestamps.data(),
+                                        sizeof( std::uint64_t ),
+                                        vk::QueryResultFlagBits::e64 );
+    m_queriesPending[ uiFrameSlot ] = false;
+    if ( result != vk::Result::eSuccess )
+        return;
+
+    m_fLastFrameMS = 0.0;
+    for ( std::uint32_t i = 0; i != kPassCount; ++i )
+    {
+        const std::uint64_t uiTicks = ( timestamps[ i + 1U ] - timestamps[ i ] ) & m_uiTimestampMask;
+        const double        fMS     = static_cast< double >( uiTicks ) * m_timestampPeriodNS / 1000000.0;
+        m_timingSumsMS[ i ] += fMS;
+        m_fLastFrameMS += fMS;
+    }
+    ++m_uiTimedFrames;
+}
+
+std::array< double, PostChain::kPassCount > PostChain::getTimingsMS() const
+{
+    std::array< double, kPassCount > timings{};
+    if ( m_uiTimedFrames )
+    {
+        for ( std::uint32_t i = 0; i != kPassCount; ++i )
+            timings[ i ] = m_timingSumsMS[ i ] / m_uiTimedFrames;
+    }
+    return timings;
+}
+
+void PostChain::resetTimings()
+{
+    m_timingSumsMS  = {};
+    m_uiTimedFrames = 0U;
+}
+
+} // namespace retail
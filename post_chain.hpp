@@ -0,0 +1,170 @@
+#ifndef POST_CHAIN_19_OCTOBER_2022
+#define POST_CHAIN_19_OCTOBER_2022
+
+#include "asset_pack.hpp"
+#include "device_dispatch.hpp"
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace retail
+{
+
+// Compute post processing from an HDR scene target to a display ready image.
+//
+// Each window has a target set per frame in flight so post processing of one frame can run on an
+// async compute queue while the next frame's scene renders.  record() runs a bloom downsample chain
+// with a bright pass, the matching tent filtered upsample chain, tonemapping with the bloom added and
+// a sharpening pass.  Images shared by the graphics and compute queues are created concurrent so
+// no queue family ownership transfers are needed.  Every pass is bracketed by timestamps when the
+// queue supports them.
+class PostChain
+{
+public:
+    enum class Pass : std::uint32_t
+    {
+        eBloomDownsample,
+        eBloomUpsample,
+        eTonemap,
+        eSharpen,
+    };
+    static constexpr std::uint32_t kPassCount = static_cast< std::uint32_t >( Pass::eSharpen ) + 1U;
+
+    static constexpr vk::Format kSceneFormat = vk::Format::eR16G16B16A16Sfloat;
+    static constexpr vk::Format kDepthFormat = vk::Format::eD32Sfloat;
+
+    struct Settings
+    {
+        std::uint32_t uiBloomMips     = 5U;
+        float         fBloomThreshold = 1.0f;
+        float         fBloomIntensity = 0.15f;
+        float         fExposure       = 1.0f;
+        float         fSharpness      = 0.25f;
+    };
+
+    // sceneRenderPass renders kSceneFormat with a kDepthFormat depth attachment and leaves the colour in
+    // shader read only layout.  queueFamilies
+    // lists every family touching the images.  uiTimestampValidBits is for the queue record() runs on.
+    PostChain( vk::PhysicalDevice                  physicalDevice,
+               vk::Device                          device,
+               vk::PipelineCache                   pipelineCache,
+               const AssetPack&                    shaders,
+               vk::RenderPass                      sceneRenderPass,
+               const std::vector< std::uint32_t >& queueFamilies,
+               std::uint32_t                       uiTimestampValidBits,
+               std::uint32_t                       uiFramesInFlight,
+               const std::vector< vk::Extent2D >&  extents,
+               const Settings&                     settings );
+    ~PostChain();
+
+    PostChain( const PostChain& )            = delete;
+    PostChain& operator=( const PostChain& ) = delete;
+
+    vk::Framebuffer getSceneFramebuffer( std::uint32_t uiTarget, std::uint32_t uiFrameSlot ) const
+    {
+        return getTarget( uiTarget, uiFrameSlot ).sceneFramebuffer;
+    }
+    // sampled by occlusion culling after the scene render pass
+    vk::ImageView getSceneDepthView( std::uint32_t uiTarget, std::uint32_t uiFrameSlot ) const
+    {
+        return getTarget( uiTarget, uiFrameSlot ).depth.view;
+    }
+    // in general layout once the slot's record() has executed
+    vk::Image getOutput( std::uint32_t uiTarget, std::uint32_t uiFrameSlot ) const
+    {
+        return getTarget( uiTarget, uiFrameSlot ).output.image;
+    }
+    vk::Extent2D getExtent( std::uint32_t uiTarget ) const { return getTarget( uiTarget, 0U ).extent; }
+
+    // every target for the slot - the scene render pass for the slot must be recorded or waited on before
+    void record( const DeviceDispatch& dispatch, vk::CommandBuffer commandBuffer, std::uint32_t uiFrameSlot );
+
+    // reads the slot's timestamps - its previous record() must have completed
+    void collectTimings( std::uint32_t uiFrameSlot );
+    // mean GPU milliseconds per frame for each pass since the last reset
+    std::array< double, kPassCount > getTimingsMS() const;
+    void                             resetTimings();
+    // GPU milliseconds of every pass in the most recently collected frame - zero without timestamps
+    double getLastFrameMS() const { return m_fLastFrameMS; }
+
+private:
+    struct Image
+    {
+        vk::Image                    image;
+        vk::DeviceMemory             memory;
+        vk::ImageView                view;     // every mip
+        std::vector< vk::ImageView > mipViews; // one per mip of the bloom chain
+    };
+
+    // one window in one frame slot
+    struct Target
+    {
+        vk::Extent2D                     extent;
+        Image                            scene;
+        Image                            depth;
+        Image                            bloom; // half resolution down to uiBloomMips
+        Image                            tonemapped;
+        Image                            output;
+        vk::Framebuffer                  sceneFramebuffer;
+        std::vector< vk::DescriptorSet > downsampleSets; // writes each bloom mip
+        std::vector< vk::DescriptorSet > upsampleSets;   // writes each bloom mip but the smallest
+        vk::DescriptorSet                tonemapSet;
+        vk::DescriptorSet                sharpenSet;
+    };
+
+    const Target& getTarget( std::uint32_t uiTarget, std::uint32_t uiFrameSlot ) const
+    {
+        return m_targets[ uiTarget * m_uiFramesInFlight + uiFrameSlot ];
+    }
+
+    Image createImage( vk::Format format, vk::Extent2D extent, std::uint32_t uiMips, vk::ImageUsageFlags usage );
+    void  destroyImage( Image& image );
+    void  createTarget( Target& target, vk::Extent2D extent, vk::RenderPass sceneRenderPass );
+    vk::DescriptorSet createSet( vk::ImageView   source,
+                                 vk::ImageLayout sourceLayout,
+                                 vk::ImageView   second,
+                                 vk::ImageView   destination );
+    void              recordPass( const DeviceDispatch& dispatch,
+                                  vk::CommandBuffer     commandBuffer,
+                                  vk::Pipeline          pipeline,
+                                  vk::DescriptorSet     set,
+                                  vk::Extent2D          extent ) const;
+
+    vk::PhysicalDevice           m_physicalDevice;
+    vk::Device                   m_device;
+    std::vector< std::uint32_t > m_queueFamilies;
+    std::uint32_t                m_uiFramesInFlight;
+    Settings                     m_settings;
+
+    vk::DescriptorSetLayout m_descriptorSetLayout;
+    vk::PipelineLayout      m_pipelineLayout;
+    vk::DescriptorPool      m_descriptorPool;
+    vk::Sampler             m_sampler;
+    vk::ShaderModule        m_downsampleShader;
+    vk::ShaderModule        m_upsampleShader;
+    vk::ShaderModule        m_tonemapShader;
+    vk::ShaderModule        m_sharpenShader;
+    vk::Pipeline            m_downsamplePipeline;
+    vk::Pipeline            m_upsamplePipeline;
+    vk::Pipeline            m_tonemapPipeline;
+    vk::Pipeline            m_sharpenPipeline;
+
+    std::vector< Target > m_targets; // window major
+
+    bool                             m_bTimestamps;
+    double                           m_timestampPeriodNS;
+    std::uint64_t                    m_uiTimestampMask;
+    std::vector< vk::QueryPool >     m_queryPools; // per frame slot
+    std::vector< bool >              m_queriesPending;
+    std::array< double, kPassCount > m_timingSumsMS{};
+    std::uint32_t                    m_uiTimedFrames = 0U;
+    double                           m_fLastFrameMS  = 0.0;
+};
+
+} // namespace retail
+
+#endif // POST_CHAIN_19_OCTOBER_2022
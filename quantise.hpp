@@ -0,0 +1,102 @@
+#ifndef QUANTISE_12_OCTOBER_2022
+#define QUANTISE_12_OCTOBER_2022
+
+#include "mesh_file.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace retail
+{
+namespace mesh
+{
+    // mesh::VertexFormat::eQuantised - decoded by shaders/shader.vert
+    //
+    // position  unorm16 x 3 relative to the mesh bounds ( fourth component unused )
+    // normal    octahedral snorm16 x 2
+    // uv        half x 2
+    struct QuantisedVertex
+    {
+        std::uint16_t position[ 4 ];
+        std::int16_t  normal[ 2 ];
+        std::uint16_t uv[ 2 ];
+    };
+    static_assert( sizeof( QuantisedVertex ) == 16U );
+
+    inline std::uint16_t quantiseUnorm16( float fValue )
+    {
+        return static_cast< std::uint16_t >( std::lround( std::clamp( fValue, 0.0f, 1.0f ) * 65535.0f ) );
+    }
+
+    inline std::int16_t quantiseSnorm16( float fValue )
+    {
+        return static_cast< std::int16_t >( std::lround( std::clamp( fValue, -1.0f, 1.0f ) * 32767.0f ) );
+    }
+
+    // round to nearest even float to half - overflow saturates to infinity and subnormals flush to zero
+    inline std::uint16_t quantiseHalf( float fValue )
+    {
+        std::uint32_t uiBits = 0U;
+        std::memcpy( &uiBits, &fValue, sizeof( float ) );
+
+        const std::uint32_t uiSign     = ( uiBits >> 16U ) & 0x8000U;
+        const std::int32_t  iExponent  = static_cast< std::int32_t >( ( uiBits >> 23U ) & 0xFFU ) - 127 + 15;
+        std::uint32_t       uiMantissa = uiBits & 0x7FFFFFU;
+
+        if ( ( ( uiBits >> 23U ) & 0xFFU ) == 0xFFU )
+            return static_cast< std::uint16_t >( uiSign | 0x7C00U | ( uiMantissa ? 0x200U : 0U ) );
+        if ( iExponent <= 0 )
+            return static_cast< std::uint16_t >( uiSign );
+        if ( iExponent >= 31 )
+            return static_cast< std::uint16_t >( uiSign | 0x7C00U );
+
+        std::uint32_t uiHalf = ( static_cast< std::uint32_t >( iExponent ) << 10U ) | ( uiMantissa >> 13U );
+        const std::uint32_t uiRemainder = uiMantissa & 0x1FFFU;
+        if ( uiRemainder > 0x1000U || ( uiRemainder == 0x1000U && ( uiHalf & 1U ) ) )
+            ++uiHalf; // may carry into the exponent which is still correct
+        return static_cast< std::uint16_t >( uiSign | std::min( uiHalf, 0x7C00U ) );
+    }
+
+    // octahedral encoding of a unit vector into [-1,1]^2
+    inline void encodeOctahedral( const float normal[ 3 ], float result[ 2 ] )
+    {
+        const float fL1 = std::fabs( normal[ 0 ] ) + std::fabs( normal[ 1 ] ) + std::fabs( normal[ 2 ] );
+        float       x   = fL1 > 0.0f ? normal[ 0 ] / fL1 : 0.0f;
+        float       y   = fL1 > 0.0f ? normal[ 1 ] / fL1 : 0.0f;
+        if ( normal[ 2 ] < 0.0f )
+        {
+            const float fX = ( 1.0f - std::fabs( y ) ) * ( x >= 0.0f ? 1.0f : -1.0f );
+            const float fY = ( 1.0f - std::fabs( x ) ) * ( y >= 0.0f ? 1.0f : -1.0f );
+            x              = fX;
+            y              = fY;
+        }
+        result[ 0 ] = x;
+        result[ 1 ] = y;
+    }
+
+    inline QuantisedVertex quantiseVertex( const Bounds& bounds,
+                                           const float   position[ 3 ],
+                                           const float   normal[ 3 ],
+                                           const float   uv[ 2 ] )
+    {
+        QuantisedVertex vertex{};
+        for ( int i = 0; i != 3; ++i )
+        {
+            const float fExtent     = bounds.max[ i ] - bounds.min[ i ];
+            vertex.position[ i ]    = quantiseUnorm16( fExtent > 0.0f ? ( position[ i ] - bounds.min[ i ] ) / fExtent : 0.0f );
+        }
+        float oct[ 2 ];
+        encodeOctahedral( normal, oct );
+        vertex.normal[ 0 ] = quantiseSnorm16( oct[ 0 ] );
+        vertex.normal[ 1 ] = quantiseSnorm16( oct[ 1 ] );
+        vertex.uv[ 0 ]     = quantiseHalf( uv[ 0 ] );
+        vertex.uv[ 1 ]     = quantiseHalf( uv[ 1 ] );
+        return vertex;
+    }
+
+} // namespace mesh
+} // namespace retail
+
+#endif // QUANTISE_12_OCTOBER_2022
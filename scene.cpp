@@ -0,0 +1,93 @@
+
+#include "scene.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include <algorithm>
+
+namespace retail
+{
+namespace
+{
+constexpr std::uint32_t kShelfColumns = 16U;
+constexpr std::uint32_t kShelfLevels  = 3U;
+constexpr float         kSlotSize     = 1.0f;
+constexpr float         kRowSpacing   = 2.0f;
+
+Vec3 boundsCentre( const mesh::Bounds& bounds )
+{
+    return Vec3{ ( bounds.min[ 0 ] + bounds.max[ 0 ] ) * 0.5f,
+                 ( bounds.min[ 1 ] + bounds.max[ 1 ] ) * 0.5f,
+                 ( bounds.min[ 2 ] + bounds.max[ 2 ] ) * 0.5f };
+}
+
+float boundsRadius( const mesh::Bounds& bounds )
+{
+    return length( Vec3{ bounds.max[ 0 ] - bounds.min[ 0 ], bounds.max[ 1 ] - bounds.min[ 1 ],
+                         bounds.max[ 2 ] - bounds.min[ 2 ] } )
+           * 0.5f;
+}
+} // namespace
+
+Scene::Scene( const std::vector< mesh::Bounds >& meshBounds, std::uint32_t uiInstanceCount )
+    : m_meshBounds( meshBounds )
+{
+    VERIFY_RTE( !m_meshBounds.empty() );
+
+    m_instances.reserve( uiInstanceCount );
+    m_transforms.reserve( uiInstanceCount + ( uiInstanceCount / kShelfColumns + 1U ) * 2U );
+    TransformStore::Node row = TransformStore::kNoParent, shelf = TransformStore::kNoParent;
+    for ( std::uint32_t i = 0; i != uiInstanceCount; ++i )
+    {
+        const std::uint32_t uiColumn = i % kShelfColumns;
+        const std::uint32_t uiLevel  = ( i / kShelfColumns ) % kShelfLevels;
+        const std::uint32_t uiRow    = i / ( kShelfColumns * kShelfLevels );
+
+        const Vec3 rowPosition{ 0.0f, 0.0f, -static_cast< float >( uiRow ) * kRowSpacing };
+        const Vec3 shelfPosition{ 0.0f, ( static_cast< float >( uiLevel ) + 0.5f ) * kSlotSize, 0.0f };
+        const Vec3 slotPosition{
+            ( static_cast< float >( uiColumn ) - ( kShelfColumns - 1U ) * 0.5f ) * kSlotSize, 0.0f, 0.0f };
+        if ( uiColumn == 0U && uiLevel == 0U )
+            row = m_transforms.add( translation( rowPosition ) );
+        if ( uiColumn == 0U )
+            shelf = m_transforms.add( translation( shelfPosition ), row );
+
+        Instance instance;
+        instance.uiMesh         = i % static_cast< std::uint32_t >( m_meshBounds.size() );
+        instance.position       = rowPosition + shelfPosition + slotPosition;
+        const float fMeshRadius = boundsRadius( m_meshBounds[ instance.uiMesh ] );
+        instance.fScale         = fMeshRadius > 0.0f ? kSlotSize * 0.45f / fMeshRadius : 1.0f;
+        instance.fRadius        = fMeshRadius * instance.fScale;
+
+        // re-centre on the mesh bounds then scale into the slot
+        const Vec3 centre = boundsCentre( m_meshBounds[ instance.uiMesh ] );
+        const Mat4 local  = translation( slotPosition )
+                           * scaling( Vec3{ instance.fScale, instance.fScale, instance.fScale } )
+                           * translation( centre * -1.0f );
+        instance.transform = m_transforms.add( local, shelf );
+        m_instances.push_back( instance );
+    }
+    m_fAisleLength = static_cast< float >( uiInstanceCount / ( kShelfColumns * kShelfLevels ) ) * kRowSpacing;
+
+    update( 0.0f );
+}
+
+void Scene::update( float fTimeSeconds, WorkerPool* pWorkers )
+{
+    // dolly from the front of the aisle half way down and back
+    const float fTravel = ( 0.5f - 0.5f * std::cos( fTimeSeconds * 0.1f ) ) * m_fAisleLength * 0.5f;
+    m_camera.eye        = Vec3{ 0.0f, kShelfLevels * kSlotSize * 0.5f, 4.0f - fTravel };
+    m_camera.target     = m_camera.eye + Vec3{ 0.0f, -0.1f, -1.0f };
+
+    m_transforms.update( pWorkers );
+}
+
+Aabb Scene::getWorldBounds( const Instance& instance ) const
+{
+    const mesh::Bounds& bounds = m_meshBounds[ instance.uiMesh ];
+    return transform( getModelMatrix( instance ),
+                      Aabb{ Vec3{ bounds.min[ 0 ], bounds.min[ 1 ], bounds.min[ 2 ] },
+                            Vec3{ bounds.max[ 0 ], bounds.max[ 1 ], bounds.max[ 2 ] } } );
+}
+
+} // namespace retail
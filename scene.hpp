@@ -0,0 +1,64 @@
+#ifndef SCENE_14_OCTOBER_2022
+#define SCENE_14_OCTOBER_2022
+
+#include "math.hpp"
+#include "mesh_file.hpp"
+#include "transform_store.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace retail
+{
+
+class WorkerPool;
+
+// A store layout of mesh instances - shelves of products along an aisle with a camera dollying down it.
+// Each instance is a transform node under its shelf which is under its aisle section.
+class Scene
+{
+public:
+    struct Instance
+    {
+        std::uint32_t        uiMesh;
+        TransformStore::Node transform;
+        Vec3                 position; // world position of the mesh bounds centre
+        float                fScale;   // uniform scale fitting the mesh into a shelf slot
+        float                fRadius;  // world space bounding sphere radius
+    };
+
+    struct Camera
+    {
+        Vec3  eye, target;
+        float fFovY = 1.0471976f; // 60 degrees
+        float fNear = 0.05f, fFar = 1000.0f;
+    };
+
+    Scene( const std::vector< mesh::Bounds >& meshBounds, std::uint32_t uiInstanceCount );
+
+    // moves the camera and brings world transforms up to date across the pool or inline when null
+    void update( float fTimeSeconds, WorkerPool* pWorkers = nullptr );
+
+    const std::vector< Instance >& getInstances() const { return m_instances; }
+    const Camera&                  getCamera() const { return m_camera; }
+    TransformStore&                getTransforms() { return m_transforms; }
+
+    // object to world including re-centring on the mesh bounds - valid after update
+    const Mat4& getModelMatrix( const Instance& instance ) const
+    {
+        return m_transforms.getWorld( instance.transform );
+    }
+    // world space box around the instance's mesh bounds - valid after update
+    Aabb getWorldBounds( const Instance& instance ) const;
+
+private:
+    std::vector< mesh::Bounds > m_meshBounds;
+    std::vector< Instance >     m_instances;
+    TransformStore              m_transforms;
+    Camera                      m_camera;
+    float                       m_fAisleLength = 0.0f;
+};
+
+} // namespace retail
+
+#endif // SCENE_14_OCTOBER_2022
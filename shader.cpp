@@ -0,0 +1,60 @@
+#include "shader.hpp"
+#include "counters.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include "spdlog/spdlog.h"
+
+namespace retail
+{
+
+vk::ShaderModule createShaderModule( vk::Device device, const AssetPack& shaders, std::string_view strName )
+{
+    const AssetPack::View shaderCode = shaders.get( strName );
+    // entries are at least 64 byte aligned so the code can be read as words in place
+    VERIFY_RTE_MSG( shaderCode.uiSize != 0U && shaderCode.uiSize % sizeof( std::uint32_t ) == 0U,
+                    "Invalid SPIR-V size for shader: " << strName );
+    const vk::ShaderModuleCreateInfo shaderModuleCreateInfo{
+        vk::ShaderModuleCreateFlags{},
+        static_cast< std::size_t >( shaderCode.uiSize ),
+        reinterpret_cast< const std::uint32_t* >( shaderCode.pData ) };
+    vk::ShaderModule shaderModule = device.createShaderModule( shaderModuleCreateInfo );
+    SPDLOG_INFO( "Loaded shader: {} from: {}", strName, shaders.getPath().string() );
+    return shaderModule;
+}
+
+vk::Pipeline createComputePipeline( vk::Device         device,
+                                    vk::PipelineCache  pipelineCache,
+                                    vk::PipelineLayout layout,
+                                    vk::ShaderModule   shader )
+{
+    const vk::ComputePipelineCreateInfo createInfo{
+        vk::PipelineCreateFlags{},
+        vk::PipelineShaderStageCreateInfo{
+            vk::PipelineShaderStageCreateFlags{}, vk::ShaderStageFlagBits::eCompute, shader, "main" },
+        layout };
+    const vk::ResultValue< vk::Pipeline > result = device.createComputePipeline( pipelineCache, createInfo );
+    VERIFY_RTE_MSG( result.result == vk::Result::eSuccess,
+                    "Failed to create compute pipeline: " << vk::to_string( result.result ) );
+    count( Counter::ePipelineBuilds );
+    return result.value;
+}
+
+void computeBarrier( const DeviceDispatch&  dispatch,
+                     vk::CommandBuffer      commandBuffer,
+                     vk::PipelineStageFlags extraDstStages,
+                     vk::AccessFlags        extraDstAccess )
+{
+    const vk::MemoryBarrier barrier{ vk::AccessFlagBits::eShaderWrite,
+                                     vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite
+                                         | extraDstAccess };
+    dispatch.cmdPipelineBarrier( commandBuffer,
+                                 vk::PipelineStageFlagBits::eComputeShader,
+                                 vk::PipelineStageFlagBits::eComputeShader | extraDstStages,
+                                 1U,
+                                 &barrier,
+                                 0U,
+                                 nullptr );
+}
+
+} // namespace retail
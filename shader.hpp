@@ -0,0 +1,33 @@
+#ifndef SHADER_15_OCTOBER_2022
+#define SHADER_15_OCTOBER_2022
+
+#include "asset_pack.hpp"
+#include "device_dispatch.hpp"
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include <string_view>
+
+namespace retail
+{
+
+// caller owns the returned module - the SPIR-V is passed to the driver straight from the pack
+vk::ShaderModule createShaderModule( vk::Device device, const AssetPack& shaders, std::string_view strName );
+
+// caller owns the returned pipeline - the shader's entry point is main
+vk::Pipeline createComputePipeline( vk::Device         device,
+                                    vk::PipelineCache  pipelineCache,
+                                    vk::PipelineLayout layout,
+                                    vk::ShaderModule   shader );
+
+// the next compute pass reads and writes what the previous one wrote - extra stages and accesses
+// cover other consumers such as indirect arguments
+void computeBarrier( const DeviceDispatch&  dispatch,
+                     vk::CommandBuffer      commandBuffer,
+                     vk::PipelineStageFlags extraDstStages = vk::PipelineStageFlags{},
+                     vk::AccessFlags        extraDstAccess = vk::AccessFlags{} );
+
+} // namespace retail
+
+#endif // SHADER_15_OCTOBER_2022
@@ -0,0 +1,12 @@
+#version 450
+
+layout(location = 0) in vec2 fragOffset;
+layout(location = 1) in vec4 fragColour;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    // a soft disc within the quad - added to the scene scaled by alpha
+    const float falloff = max(1.0 - dot(fragOffset, fragOffset), 0.0);
+    outColor            = vec4(fragColour.rgb, fragColour.a * falloff * falloff);
+}
@@ -0,0 +1,46 @@
+#version 450
+
+struct Particle
+{
+    vec3  position;
+    float life; // seconds left
+    vec3  velocity;
+    uint  colour;
+};
+layout(std430, set = 0, binding = 0) readonly buffer Particles
+{
+    Particle particles[];
+};
+
+// drawn with one instance per entry
+layout(std430, set = 0, binding = 1) readonly buffer Alive
+{
+    uint header[8];
+    uint indices[];
+} alive;
+
+// ParticleSystem CameraParams - see particle_system.cpp
+layout(set = 0, binding = 2) uniform Camera
+{
+    mat4 viewProjection;
+    vec4 right; // w is the half size of a quad
+    vec4 up;
+} camera;
+
+layout(location = 0) out vec2 fragOffset;
+layout(location = 1) out vec4 fragColour;
+
+const vec2 corners[6] = vec2[](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+                               vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0));
+
+void main() {
+    const Particle particle = particles[alive.indices[gl_InstanceIndex]];
+    const vec2     corner   = corners[gl_VertexIndex];
+    const vec3     world
+        = particle.position + (camera.right.xyz * corner.x + camera.up.xyz * corner.y) * camera.right.w;
+
+    gl_Position = camera.viewProjection * vec4(world, 1.0);
+    fragOffset  = corner;
+    // bright enough to bloom and fading out over the last half second
+    fragColour  = vec4(unpackUnorm4x8(particle.colour).rgb * 4.0, clamp(particle.life * 2.0, 0.0, 1.0));
+}
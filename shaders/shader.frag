@@ -1,9 +1,79 @@
 #version 450
 
+// LightClusters::kTileSize
+const uint kTileSize = 64u;
+
+// LightClusters LightingParams - see light_clusters.cpp
+layout(std140, set = 2, binding = 0) uniform LightingParams
+{
+    mat4  view;
+    vec4  projection; // view space x and y per unit depth at the frustum edge, near and far
+    vec4  slices;     // log(depth) * x + y is the slice
+    uvec4 grid;       // tiles across, tiles down, slices and lights
+    uvec4 screen;     // width, height, index capacity and the region counted into
+} lighting;
+
+// LightClusters::Light
+struct Light
+{
+    vec3  position;
+    float radius;
+    vec3  colour;
+    float padding;
+};
+layout(std430, set = 2, binding = 1) readonly buffer Lights
+{
+    Light lights[];
+};
+
+// offset and count into the indices per cluster - written by light_cull.comp
+layout(std430, set = 2, binding = 2) readonly buffer Clusters
+{
+    uvec2 clusters[];
+};
+
+layout(std430, set = 2, binding = 3) readonly buffer Indices
+{
+    uint indices[];
+};
+
+// 0 the cluster's lights, 1 every light - selected per pipeline variant
+layout(constant_id = 1) const uint kLightingMode = 0;
+
 layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec3 fragAlbedo;
+layout(location = 2) in vec3 fragNormal;
+layout(location = 3) in vec3 fragPosition;
 
 layout(location = 0) out vec4 outColor;
 
+vec3 shade(const Light light, vec3 normal) {
+    const vec3  toLight  = light.position - fragPosition;
+    const float distance = length(toLight);
+    // smooth falloff reaching zero at the radius
+    const float ratio   = min(distance / light.radius, 1.0);
+    const float falloff = (1.0 - ratio * ratio) * (1.0 - ratio * ratio);
+    return light.colour * falloff * max(dot(normal, toLight / max(distance, 1e-4)), 0.0);
+}
+
 void main() {
-    outColor = vec4(fragColor, 1.0);
+    const vec3 normal = normalize(fragNormal);
+    vec3       lit    = vec3(0.0);
+    if (kLightingMode == 1) {
+        for (uint i = 0u; i < lighting.grid.w; ++i) {
+            lit += shade(lights[i], normal);
+        }
+    } else {
+        // gl_FragCoord starts at the top left like the tiles
+        const float depth   = -(lighting.view * vec4(fragPosition, 1.0)).z;
+        const uint  slice   = uint(clamp(log(depth) * lighting.slices.x + lighting.slices.y,
+                                         0.0,
+                                         float(lighting.grid.z - 1u)));
+        const uvec2 tile    = min(uvec2(gl_FragCoord.xy) / kTileSize, lighting.grid.xy - 1u);
+        const uvec2 cluster = clusters[(slice * lighting.grid.y + tile.y) * lighting.grid.x + tile.x];
+        for (uint i = 0u; i < cluster.y; ++i) {
+            lit += shade(lights[indices[cluster.x + i]], normal);
+        }
+    }
+    outColor = vec4(fragColor + fragAlbedo * lit, 1.0);
 }
@@ -1,20 +1,88 @@
 #version 450
 
-layout(location = 0) out vec3 fragColor;
+// vertex pulling of mesh::QuantisedVertex - see quantise.hpp
+//
+// uvec4.x  position.xy unorm16
+// uvec4.y  position.z unorm16 ( high half unused )
+// uvec4.z  normal octahedral snorm16 x 2
+// uvec4.w  uv half x 2
+layout(std430, set = 0, binding = 0) readonly buffer Vertices
+{
+    uvec4 vertices[];
+};
+
+// per window parameters - Demo::FrameParams
+layout(std140, set = 1, binding = 0) uniform FrameParams
+{
+    vec4 lightDirection; // world space, xyz normalised
+    vec4 ambient;
+} frame;
+
+// per draw parameters written with one allocation per window - Demo::DrawParams
+struct DrawParams
+{
+    mat4 objectToClip; // dequantisation folded together with the object to clip transform by the CPU
+    vec4 tint;
+    vec4 positionScale;  // dequantised position to world - instances are only translated and uniformly scaled
+    vec4 positionOffset;
+};
+layout(std430, set = 1, binding = 1) readonly buffer Draws
+{
+    DrawParams draws[];
+};
 
-vec2 positions[3] = vec2[](
-    vec2(0.0, -0.5),
-    vec2(0.5, 0.5),
-    vec2(-0.5, 0.5)
-);
+// 0 lit, 1 colour by level of detail - selected per pipeline variant
+layout(constant_id = 0) const uint kShadingMode = 0;
 
-vec3 colors[3] = vec3[](
-    vec3(1.0, 0.0, 0.0),
-    vec3(0.0, 1.0, 0.0),
-    vec3(0.0, 0.0, 1.0)
-);
+layout(push_constant) uniform MeshParams
+{
+    uint drawIndex;
+} mesh;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragAlbedo;
+layout(location = 2) out vec3 fragNormal;
+layout(location = 3) out vec3 fragPosition; // world space
+
+vec3 decodeOctahedral(vec2 oct)
+{
+    vec3 n = vec3(oct, 1.0 - abs(oct.x) - abs(oct.y));
+    if (n.z < 0.0)
+    {
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
 
 void main() {
-    gl_Position = vec4(positions[gl_VertexIndex], 0.0, 1.0);
-    fragColor = colors[gl_VertexIndex];
+    const uvec4 vertex = vertices[gl_VertexIndex];
+
+    const vec3 position = vec3(unpackUnorm2x16(vertex.x), unpackUnorm2x16(vertex.y).x);
+    const vec3 normal   = decodeOctahedral(unpackSnorm2x16(vertex.z));
+    const vec2 uv       = unpackHalf2x16(vertex.w);
+
+    const DrawParams draw = draws[mesh.drawIndex];
+
+    // instances are only translated and uniformly scaled so object space normals are world space
+    const float diffuse = max(dot(normal, frame.lightDirection.xyz), 0.0);
+    vec3 albedo;
+    if (kShadingMode == 1)
+    {
+        // tint.w holds the level of detail
+        const vec3 lodColours[4] = vec3[](vec3(0.2, 0.9, 0.2),
+                                          vec3(0.9, 0.9, 0.2),
+                                          vec3(0.9, 0.5, 0.1),
+                                          vec3(0.9, 0.1, 0.1));
+        albedo = lodColours[min(uint(draw.tint.w), 3u)];
+    }
+    else
+    {
+        albedo = mix(normal * 0.5 + 0.5, vec3(uv, 0.0), 0.25) * draw.tint.rgb;
+    }
+
+    gl_Position  = draw.objectToClip * vec4(position, 1.0);
+    fragColor    = albedo * (frame.ambient.rgb + diffuse);
+    fragAlbedo   = albedo;
+    fragNormal   = normal;
+    fragPosition = position * draw.positionScale.xyz + draw.positionOffset.xyz;
 }
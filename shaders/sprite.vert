@@ -0,0 +1,22 @@
+#version 450
+
+// SpriteBatch::Vertex - see sprite_batch.hpp
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec2 inUV;
+layout(location = 2) in vec4 inColour;
+
+// pixels to normalised device coordinates
+layout(push_constant) uniform SpriteParams
+{
+    vec2 scale;
+    vec2 offset;
+} params;
+
+layout(location = 0) out vec2 fragUV;
+layout(location = 1) out vec4 fragColour;
+
+void main() {
+    gl_Position = vec4(inPosition * params.scale + params.offset, 0.0, 1.0);
+    fragUV      = inUV;
+    fragColour  = inColour;
+}
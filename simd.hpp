@@ -0,0 +1,64 @@
+#ifndef SIMD_19_OCTOBER_2022
+#define SIMD_19_OCTOBER_2022
+
+#include <cstdint>
+
+// x86-64 always has SSE2 - AVX2 kernels are compiled per function with RETAIL_TARGET_AVX2 and
+// only called after isSupported so the build needs no extra instruction set flags
+#if defined( __x86_64__ )
+#define RETAIL_SIMD_X86 1
+#include <immintrin.h>
+#define RETAIL_TARGET_AVX2 __attribute__( ( target( "avx2,fma" ) ) )
+#endif
+
+namespace retail
+{
+
+enum class SimdKernel : std::uint32_t
+{
+    eScalar,
+    eSSE,
+    eAVX2
+};
+
+inline bool isSupported( SimdKernel kernel )
+{
+    switch ( kernel )
+    {
+        case SimdKernel::eScalar:
+            return true;
+#ifdef RETAIL_SIMD_X86
+        case SimdKernel::eSSE:
+            return __builtin_cpu_supports( "sse2" );
+        case SimdKernel::eAVX2:
+            return __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "fma" );
+#endif
+        default:
+            return false;
+    }
+}
+
+inline const char* toString( SimdKernel kernel )
+{
+    switch ( kernel )
+    {
+        case SimdKernel::eScalar:
+            return "scalar";
+        case SimdKernel::eSSE:
+            return "sse";
+        case SimdKernel::eAVX2:
+            return "avx2";
+    }
+    return "unknown";
+}
+
+inline SimdKernel getBestSimdKernel()
+{
+    return isSupported( SimdKernel::eAVX2 ) ? SimdKernel::eAVX2
+           : isSupported( SimdKernel::eSSE ) ? SimdKernel::eSSE
+                                             : SimdKernel::eScalar;
+}
+
+} // namespace retail
+
+#endif // SIMD_19_OCTOBER_2022
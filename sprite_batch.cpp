@@ -0,0 +1,320 @@
+#include "sprite_batch.hpp"
+#include "shader.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+namespace retail
+{
+
+namespace
+{
+// must match the push_constant block in shaders/sprite.vert
+struct SpritePushConstants
+{
+    float scale[ 2 ];
+    float offset[ 2 ];
+};
+} // namespace
+
+SpriteBatch::SpriteBatch( vk::PhysicalDevice physicalDevice,
+                          vk::Device         device,
+                          vk::RenderPass     renderPass,
+                          vk::PipelineCache  pipelineCache,
+                          const AssetPack&   shaders,
+                          Uploader&          uploader,
+                          std::uint32_t      uiFramesInFlight,
+                          std::uint32_t      uiMaxSprites )
+    : m_device( device )
+    , m_uiFramesInFlight( uiFramesInFlight )
+    , m_uiMaxSprites( uiMaxSprites )
+{
+    VERIFY_RTE( uiFramesInFlight > 0U );
+    VERIFY_RTE( uiMaxSprites > 0U );
+
+    {
+        const std::array< vk::DescriptorSetLayoutBinding, 1 > bindings = { vk::DescriptorSetLayoutBinding{
+            0, vk::DescriptorType::eCombinedImageSampler, 1, vk::ShaderStageFlagBits::eFragment, nullptr } };
+        m_descriptorSetLayout = m_device.createDescriptorSetLayout(
+            vk::DescriptorSetLayoutCreateInfo{ vk::DescriptorSetLayoutCreateFlags{}, bindings } );
+
+        const std::array< vk::PushConstantRange, 1 > pushConstantRanges
+            = { vk::PushConstantRange{ vk::ShaderStageFlagBits::eVertex, 0, sizeof( SpritePushConstants ) } };
+        const vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo
+            = { vk::PipelineLayoutCreateFlags{}, m_descriptorSetLayout, pushConstantRanges };
+        m_pipelineLayout = m_device.createPipelineLayout( pipelineLayoutCreateInfo );
+    }
+    {
+        const std::array< vk::DescriptorPoolSize, 1 > poolSizes
+            = { vk::DescriptorPoolSize{ vk::DescriptorType::eCombinedImageSampler, kMaxTextures } };
+        m_descriptorPool = m_device.createDescriptorPool(
+            vk::DescriptorPoolCreateInfo{ vk::DescriptorPoolCreateFlags{}, kMaxTextures, poolSizes } );
+    }
+    {
+        vk::SamplerCreateInfo samplerCreateInfo;
+        samplerCreateInfo.magFilter    = vk::Filter::eLinear;
+        samplerCreateInfo.minFilter    = vk::Filter::eLinear;
+        samplerCreateInfo.mipmapMode   = vk::SamplerMipmapMode::eLinear;
+        samplerCreateInfo.addressModeU = vk::SamplerAddressMode::eClampToEdge;
+        samplerCreateInfo.addressModeV = vk::SamplerAddressMode::eClampToEdge;
+        samplerCreateInfo.addressModeW = vk::SamplerAddressMode::eClampToEdge;
+        samplerCreateInfo.maxLod       = VK_LOD_CLAMP_NONE;
+        m_sampler                      = m_device.createSampler( samplerCreateInfo );
+    }
+
+    m_vertexShader   = createShaderModule( m_device, shaders, "sprite_vert.spv" );
+    m_fragmentShader = createShaderModule( m_device, shaders, "sprite_frag.spv" );
+
+    {
+        PipelineVariants::Program program;
+        program.vertexShader   = m_vertexShader;
+        program.fragmentShader = m_fragmentShader;
+        program.vertexBindings
+            = { vk::VertexInputBindingDescription{ 0, sizeof( Vertex ), vk::VertexInputRate::eVertex } };
+        program.vertexAttributes = {
+            vk::VertexInputAttributeDescription{ 0, 0, vk::Format::eR32G32Sfloat, offsetof( Vertex, position ) },
+            vk::VertexInputAttributeDescription{ 1, 0, vk::Format::eR32G32Sfloat, offsetof( Vertex, uv ) },
+            vk::VertexInputAttributeDescription{ 2, 0, vk::Format::eR8G8B8A8Unorm, offsetof( Vertex, uiColour ) } };
+        program.layout     = m_pipelineLayout;
+        program.renderPass = renderPass;
+        m_pPipelines       = std::make_unique< PipelineVariants >( m_device, pipelineCache, program );
+    }
+
+    // every quad uses the same four vertex pattern so one index buffer serves every draw
+    {
+        const vk::DeviceSize indexBufferSize = kMaxSpritesPerDraw * 6U * sizeof( std::uint16_t );
+        m_pIndexBuffer                       = std::make_unique< Buffer >( physicalDevice,
+                                                     m_device,
+                                                     indexBufferSize,
+                                                     vk::BufferUsageFlagBits::eIndexBuffer
+                                                         | vk::BufferUsageFlagBits::eTransferDst,
+                                                     vk::MemoryPropertyFlagBits::eDeviceLocal );
+        std::uint16_t* pIndices
+            = reinterpret_cast< std::uint16_t* >( uploader.stage( *m_pIndexBuffer, 0U, indexBufferSize ) );
+        for ( std::uint32_t i = 0; i != kMaxSpritesPerDraw; ++i )
+        {
+            const std::uint16_t uiBase = static_cast< std::uint16_t >( i * 4U );
+            *pIndices++                = uiBase;
+            *pIndices++                = static_cast< std::uint16_t >( uiBase + 1U );
+            *pIndices++                = static_cast< std::uint16_t >( uiBase + 2U );
+            *pIndices++                = static_cast< std::uint16_t >( uiBase + 2U );
+            *pIndices++                = static_cast< std::uint16_t >( uiBase + 3U );
+            *pIndices++                = uiBase;
+        }
+    }
+
+    const vk::DeviceSize ringSize = vk::DeviceSize{ uiFramesInFlight } * uiMaxSprites * 4U * sizeof( Vertex );
+    m_pVertexRing                 = std::make_unique< Buffer >( physicalDevice,
+                                                m_device,
+                                                ringSize,
+                                                vk::BufferUsageFlagBits::eVertexBuffer,
+                                                vk::MemoryPropertyFlagBits::eHostVisible
+                                                    | vk::MemoryPropertyFlagBits::eHostCoherent );
+
+    m_sprites.reserve( uiMaxSprites );
+    m_sortKeys.reserve( uiMaxSprites );
+    SPDLOG_INFO( "Created sprite batch for: {} sprites with ring of: {} bytes",
+                 uiMaxSprites,
+                 m_pVertexRing->getSize() );
+}
+
+SpriteBatch::~SpriteBatch()
+{
+    m_pPipelines.reset();
+    if ( m_vertexShader )
+    {
+        m_device.destroyShaderModule( m_vertexShader );
+    }
+    if ( m_fragmentShader )
+    {
+        m_device.destroyShaderModule( m_fragmentShader );
+    }
+    if ( m_sampler )
+    {
+        m_device.destroySampler( m_sampler );
+    }
+    if ( m_descriptorPool )
+    {
+        m_device.destroyDescriptorPool( m_descriptorPool );
+    }
+    if ( m_pipelineLayout )
+    {
+        m_device.destroyPipelineLayout( m_pipelineLayout );
+    }
+    if ( m_descriptorSetLayout )
+    {
+        m_device.destroyDescriptorSetLayout( m_descriptorSetLayout );
+    }
+}
+
+std::uint16_t SpriteBatch::createPipeline( PipelineVariants::Blend blend )
+{
+    // quads are emitted with either winding
+    PipelineVariants::Variant variant;
+    variant.blend = blend;
+    variant.cull  = PipelineVariants::Cull::eNone;
+
+    const PipelineVariants::Handle handle = m_pPipelines->request( variant );
+    VERIFY_RTE( handle <= 0xFFFFU );
+    return static_cast< std::uint16_t >( handle );
+}
+
+std::uint32_t SpriteBatch::addTexture( const Texture& texture )
+{
+    VERIFY_RTE_MSG( m_textureSets.size() < kMaxTextures, "Sprite batch texture limit reached: " << kMaxTextures );
+
+    const vk::DescriptorSetAllocateInfo allocateInfo{ m_descriptorPool, m_descriptorSetLayout };
+    const vk::DescriptorSet             descriptorSet = m_device.allocateDescriptorSets( allocateInfo ).front();
+
+    const vk::DescriptorImageInfo imageInfo{ m_sampler, texture.getView(), vk::ImageLayout::eShaderReadOnlyOptimal };
+    const vk::WriteDescriptorSet  write{
+        descriptorSet, 0, 0, vk::DescriptorType::eCombinedImageSampler, imageInfo, nullptr, nullptr };
+    m_device.updateDescriptorSets( write, nullptr );
+
+    m_textureSets.push_back( descriptorSet );
+    return static_cast< std::uint32_t >( m_textureSets.size() - 1U );
+}
+
+void SpriteBatch::begin( std::uint32_t uiFrameSlot )
+{
+    VERIFY_RTE( uiFrameSlot < m_uiFramesInFlight );
+    m_uiFrameSlot = uiFrameSlot;
+    m_sprites.clear();
+    m_batches.clear();
+    m_stats = Stats{};
+}
+
+void SpriteBatch::draw( const Sprite& sprite )
+{
+    if ( m_sprites.size() == m_uiMaxSprites )
+    {
+        ++m_stats.uiDropped;
+        return;
+    }
+    m_sprites.push_back( sprite );
+}
+
+void SpriteBatch::end()
+{
+    // sort on layer then pipeline then texture - the sprite index keeps the order deterministic
+    m_sortKeys.clear();
+    for ( std::uint32_t i = 0; i != m_sprites.size(); ++i )
+    {
+        const Sprite& sprite = m_sprites[ i ];
+        VERIFY_RTE( sprite.uiPipeline < m_pPipelines->getVariantCount() );
+        VERIFY_RTE( sprite.uiTexture < m_textureSets.size() );
+        m_sortKeys.push_back( SortKey{ ( std::uint64_t{ sprite.uiLayer } << 48U )
+                                           | ( std::uint64_t{ sprite.uiPipeline } << 32U ) | sprite.uiTexture,
+                                       i } );
+    }
+    std::sort( m_sortKeys.begin(),
+               m_sortKeys.end(),
+               []( const SortKey& left, const SortKey& right )
+               { return left.uiKey != right.uiKey ? left.uiKey < right.uiKey : left.uiSprite < right.uiSprite; } );
+
+    // stream the sorted quads linearly into this frame's region of the mapped ring
+    Vertex* pVertex = reinterpret_cast< Vertex* >( m_pVertexRing->getMapped()
+                                                   + vk::DeviceSize{ m_uiFrameSlot } * m_uiMaxSprites * 4U
+                                                         * sizeof( Vertex ) );
+    for ( std::uint32_t i = 0; i != m_sortKeys.size(); ++i )
+    {
+        const Sprite& sprite = m_sprites[ m_sortKeys[ i ].uiSprite ];
+        const float   fX0    = sprite.position[ 0 ];
+        const float   fY0    = sprite.position[ 1 ];
+        const float   fX1    = fX0 + sprite.size[ 0 ];
+        const float   fY1    = fY0 + sprite.size[ 1 ];
+
+        *pVertex++ = Vertex{ { fX0, fY0 }, { sprite.uv[ 0 ], sprite.uv[ 1 ] }, sprite.uiColour };
+        *pVertex++ = Vertex{ { fX1, fY0 }, { sprite.uv[ 2 ], sprite.uv[ 1 ] }, sprite.uiColour };
+        *pVertex++ = Vertex{ { fX1, fY1 }, { sprite.uv[ 2 ], sprite.uv[ 3 ] }, sprite.uiColour };
+        *pVertex++ = Vertex{ { fX0, fY1 }, { sprite.uv[ 0 ], sprite.uv[ 3 ] }, sprite.uiColour };
+
+        if ( m_batches.empty() || m_batches.back().uiPipeline != sprite.uiPipeline
+             || m_batches.back().uiTexture != sprite.uiTexture )
+        {
+            m_batches.push_back( Batch{ sprite.uiPipeline, sprite.uiTexture, i, 0U } );
+        }
+        ++m_batches.back().uiSpriteCount;
+    }
+    m_pVertexRing->flush();
+
+    m_stats.uiSprites     = static_cast< std::uint32_t >( m_sprites.size() );
+    m_stats.uiBatches     = static_cast< std::uint32_t >( m_batches.size() );
+    m_stats.bytesStreamed = vk::DeviceSize{ m_stats.uiSprites } * 4U * sizeof( Vertex );
+    {
+        std::uint32_t uiPipeline = 0xFFFFFFFFU;
+        std::uint32_t uiTexture  = 0xFFFFFFFFU;
+        for ( const Batch& batch : m_batches )
+        {
+            if ( batch.uiPipeline != uiPipeline )
+            {
+                ++m_stats.uiPipelineBinds;
+                uiPipeline = batch.uiPipeline;
+            }
+            if ( batch.uiTexture != uiTexture )
+            {
+                ++m_stats.uiTextureBinds;
+                uiTexture = batch.uiTexture;
+            }
+            m_stats.uiDraws += ( batch.uiSpriteCount + kMaxSpritesPerDraw - 1U ) / kMaxSpritesPerDraw;
+        }
+    }
+}
+
+void SpriteBatch::record( const DeviceDispatch& dispatch, vk::CommandBuffer commandBuffer, vk::Extent2D extent ) const
+{
+    if ( m_batches.empty() )
+        return;
+
+    const SpritePushConstants pushConstants{
+        { 2.0f / static_cast< float >( extent.width ), 2.0f / static_cast< float >( extent.height ) },
+        { -1.0f, -1.0f } };
+    dispatch.cmdPushConstants( commandBuffer,
+                               m_pipelineLayout,
+                               vk::ShaderStageFlagBits::eVertex,
+                               0U,
+                               sizeof( SpritePushConstants ),
+                               &pushConstants );
+
+    const vk::DeviceSize vertexOffset = vk::DeviceSize{ m_uiFrameSlot } * m_uiMaxSprites * 4U * sizeof( Vertex );
+    dispatch.cmdBindVertexBuffer( commandBuffer, 0U, m_pVertexRing->get(), vertexOffset );
+    dispatch.cmdBindIndexBuffer( commandBuffer, m_pIndexBuffer->get(), 0U, vk::IndexType::eUint16 );
+
+    std::uint32_t uiPipeline = 0xFFFFFFFFU;
+    std::uint32_t uiTexture  = 0xFFFFFFFFU;
+    for ( const Batch& batch : m_batches )
+    {
+        if ( batch.uiPipeline != uiPipeline )
+        {
+            dispatch.cmdBindPipeline(
+                commandBuffer, vk::PipelineBindPoint::eGraphics, m_pPipelines->get( batch.uiPipeline ) );
+            uiPipeline = batch.uiPipeline;
+        }
+        if ( batch.uiTexture != uiTexture )
+        {
+            dispatch.cmdBindDescriptorSet( commandBuffer,
+                                           vk::PipelineBindPoint::eGraphics,
+                                           m_pipelineLayout,
+                                           0U,
+                                           m_textureSets[ batch.uiTexture ] );
+            uiTexture = batch.uiTexture;
+        }
+        for ( std::uint32_t uiFirst = 0; uiFirst < batch.uiSpriteCount; uiFirst += kMaxSpritesPerDraw )
+        {
+            const std::uint32_t uiCount = std::min( batch.uiSpriteCount - uiFirst, kMaxSpritesPerDraw );
+            dispatch.cmdDrawIndexed( commandBuffer,
+                                     uiCount * 6U,
+                                     1U,
+                                     0U,
+                                     static_cast< std::int32_t >( ( batch.uiFirstSprite + uiFirst ) * 4U ),
+                                     0U );
+        }
+    }
+}
+
+} // namespace retail
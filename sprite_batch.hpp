@@ -0,0 +1,127 @@
+#ifndef SPRITE_BATCH_15_OCTOBER_2022
+#define SPRITE_BATCH_15_OCTOBER_2022
+
+#include "asset_pack.hpp"
+#include "buffer.hpp"
+#include "device_dispatch.hpp"
+#include "pipeline_variants.hpp"
+#include "texture.hpp"
+#include "uploader.hpp"
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace retail
+{
+
+// Batches screen space quads - panels, labels, price tags - into as few draws as possible.
+//
+// Sprites are collected between begin() and end().  end() sorts them by layer, pipeline and texture
+// and streams the vertices in that order into a persistently mapped ring with one region per frame
+// in flight.  record() then issues one draw per run of identical state and may be called for each
+// render pass that shows the sprites.  The caller must ensure the GPU has finished with a frame slot
+// before calling begin() for it again.
+class SpriteBatch
+{
+public:
+    struct Sprite
+    {
+        float         position[ 2 ]; // top left in pixels
+        float         size[ 2 ];
+        float         uv[ 4 ];                  // u0, v0, u1, v1
+        std::uint32_t uiColour   = 0xFFFFFFFFU; // rgba8 with red in the low byte
+        std::uint16_t uiLayer    = 0U;          // drawn back to front - order within a layer is unspecified
+        std::uint16_t uiPipeline = 0U;          // from createPipeline()
+        std::uint32_t uiTexture  = 0U;          // from addTexture()
+    };
+
+    struct Vertex
+    {
+        float         position[ 2 ];
+        float         uv[ 2 ];
+        std::uint32_t uiColour;
+    };
+
+    struct Stats
+    {
+        std::uint32_t  uiSprites       = 0U;
+        std::uint32_t  uiDropped       = 0U; // sprites beyond the ring capacity
+        std::uint32_t  uiBatches       = 0U; // runs of identical state
+        std::uint32_t  uiDraws         = 0U; // batches split at the shared index buffer size
+        std::uint32_t  uiPipelineBinds = 0U;
+        std::uint32_t  uiTextureBinds  = 0U;
+        vk::DeviceSize bytesStreamed   = 0U;
+    };
+
+    SpriteBatch( vk::PhysicalDevice physicalDevice,
+                 vk::Device         device,
+                 vk::RenderPass     renderPass,
+                 vk::PipelineCache  pipelineCache,
+                 const AssetPack&   shaders,
+                 Uploader&          uploader,
+                 std::uint32_t      uiFramesInFlight,
+                 std::uint32_t      uiMaxSprites );
+    ~SpriteBatch();
+
+    SpriteBatch( const SpriteBatch& )            = delete;
+    SpriteBatch& operator=( const SpriteBatch& ) = delete;
+
+    std::uint16_t createPipeline( PipelineVariants::Blend blend );
+    std::uint32_t addTexture( const Texture& texture );
+
+    void begin( std::uint32_t uiFrameSlot );
+    void draw( const Sprite& sprite );
+    void end();
+
+    void record( const DeviceDispatch& dispatch, vk::CommandBuffer commandBuffer, vk::Extent2D extent ) const;
+
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    struct SortKey
+    {
+        std::uint64_t uiKey;
+        std::uint32_t uiSprite;
+    };
+    struct Batch
+    {
+        std::uint16_t uiPipeline;
+        std::uint32_t uiTexture;
+        std::uint32_t uiFirstSprite;
+        std::uint32_t uiSpriteCount;
+    };
+
+    // largest draw addressable by the shared 16 bit quad index buffer
+    static constexpr std::uint32_t kMaxSpritesPerDraw = 16384U;
+    static constexpr std::uint32_t kMaxTextures       = 64U;
+
+    vk::Device    m_device;
+    std::uint32_t m_uiFramesInFlight;
+    std::uint32_t m_uiMaxSprites;
+
+    vk::DescriptorSetLayout          m_descriptorSetLayout;
+    vk::PipelineLayout               m_pipelineLayout;
+    vk::DescriptorPool               m_descriptorPool;
+    vk::Sampler                      m_sampler;
+    vk::ShaderModule                 m_vertexShader;
+    vk::ShaderModule                 m_fragmentShader;
+    std::unique_ptr< PipelineVariants > m_pPipelines;
+    std::vector< vk::DescriptorSet > m_textureSets;
+
+    std::unique_ptr< Buffer > m_pIndexBuffer;
+    std::unique_ptr< Buffer > m_pVertexRing;
+
+    std::uint32_t         m_uiFrameSlot = 0U;
+    std::vector< Sprite > m_sprites;
+    std::vector< SortKey > m_sortKeys;
+    std::vector< Batch >  m_batches;
+    Stats                 m_stats;
+};
+
+} // namespace retail
+
+#endif // SPRITE_BATCH_15_OCTOBER_2022
@@ -0,0 +1,212 @@
+
+#include "swapchain.hpp"
+#include "counters.hpp"
+#include "metrics.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <array>
+
+namespace retail
+{
+
+Swapchain::Swapchain( const Window&                         window,
+                      vk::PhysicalDevice                    physicalDevice,
+                      vk::Device                            device,
+                      vk::SurfaceKHR                        surface,
+                      std::uint32_t                         uiQueueFamilyIndex,
+                      std::uint32_t                         uiFramesInFlight,
+                      std::optional< vk::SurfaceFormatKHR > requiredFormat )
+    : m_window( window )
+    , m_device( device )
+{
+    const vk::SurfaceCapabilitiesKHR surfaceCapabilities     = physicalDevice.getSurfaceCapabilitiesKHR( surface );
+    const std::vector< vk::SurfaceFormatKHR > surfaceFormats = physicalDevice.getSurfaceFormatsKHR( surface );
+    const std::vector< vk::PresentModeKHR >   presentModes   = physicalDevice.getSurfacePresentModesKHR( surface );
+
+    VERIFY_RTE( !surfaceFormats.empty() );
+    VERIFY_RTE( !presentModes.empty() );
+
+    std::optional< vk::SurfaceFormatKHR > idealFormatOpt;
+    if ( requiredFormat.has_value() )
+    {
+        // every swapchain must be compatible with the shared render pass and pipeline
+        for ( const auto& format : surfaceFormats )
+        {
+            if ( format == requiredFormat.value() )
+            {
+                idealFormatOpt = format;
+                break;
+            }
+        }
+        VERIFY_RTE_MSG( idealFormatOpt.has_value(),
+                        "Surface does not support format: " << vk::to_string( requiredFormat.value().format )
+                                                            << " required by the shared render pass" );
+    }
+    else
+    {
+        for ( const auto& format : surfaceFormats )
+        {
+            if ( !idealFormatOpt.has_value() )
+                idealFormatOpt = format;
+            if ( format.format == vk::Format::eR32G32B32A32Sfloat /*&& 
+                format.colorSpace == vk::ColorSpaceKHR::eSrgbNonlinear*/ )
+            {
+                SPDLOG_INFO( "Found format and colour space" );
+                idealFormatOpt = format;
+                break;
+            }
+        }
+        VERIFY_RTE_MSG( idealFormatOpt.has_value(), "Failed to find ideal format" );
+    }
+    m_format = idealFormatOpt.value();
+
+    {
+        const vk::Extent2D windowExtent = m_window.getDrawableSize();
+        m_extent = vk::Extent2D{ std::min( std::max( windowExtent.width, surfaceCapabilities.minImageExtent.width ),
+                                           surfaceCapabilities.maxImageExtent.width ),
+                                 std::min( std::max( windowExtent.height, surfaceCapabilities.minImageExtent.height ),
+                                           surfaceCapabilities.maxImageExtent.height ) };
+        SPDLOG_INFO( "Created Vulkan Window with width: {} and height: {}", m_extent.width, m_extent.height );
+    }
+
+    std::optional< vk::PresentModeKHR > bestPresentationMode;
+    {
+        for ( const vk::PresentModeKHR& presentationMode : presentModes )
+        {
+            switch ( presentationMode )
+            {
+                case vk::PresentModeKHR::eImmediate: //= VK_PRESENT_MODE_IMMEDIATE_KHR,
+                    break;
+                case vk::PresentModeKHR::eMailbox: //= VK_PRESENT_MODE_MAILBOX_KHR,
+                    break;
+                case vk::PresentModeKHR::eFifo:                       //= VK_PRESENT_MODE_FIFO_KHR,
+                    bestPresentationMode = vk::PresentModeKHR::eFifo; // guarenteed to be available
+                    break;
+                case vk::PresentModeKHR::eFifoRelaxed: //= VK_PRESENT_MODE_FIFO_RELAXED_KHR,
+                    break;
+                case vk::PresentModeKHR::eSharedDemandRefresh: //= VK_PRESENT_MODE_SHARED_DEMAND_REFRESH_KHR,
+                    break;
+                case vk::PresentModeKHR::eSharedContinuousRefresh: //= VK_PRESENT_MODE_SHARED_CONTINUOUS_REFRESH_KHR
+                    break;
+                default:
+                    break;
+            }
+        }
+        VERIFY_RTE_MSG( bestPresentationMode.has_value(), "Failed to find presentation mode" );
+    }
+
+    // post processed output is blitted into the swapchain image before the UI is drawn over it
+    const vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferDst;
+    VERIFY_RTE_MSG( ( surfaceCapabilities.supportedUsageFlags & usage ) == usage,
+                    "Surface does not support swapchain usage: " << vk::to_string( usage ) );
+
+    {
+        // maxImageCount of zero means there is no limit
+        std::uint32_t uiImageCount = surfaceCapabilities.minImageCount + 1;
+        if ( surfaceCapabilities.maxImageCount > 0 )
+            uiImageCount = std::min( uiImageCount, surfaceCapabilities.maxImageCount );
+
+        std::array< std::uint32_t, 1 > queues{ uiQueueFamilyIndex };
+        vk::SwapchainCreateInfoKHR     swapchainCreateInfo{
+            vk::SwapchainCreateFlagsKHR{},
+            surface,
+            uiImageCount,
+            m_format.format,
+            m_format.colorSpace,
+            m_extent,
+            1, // imageArrayLayers_
+            usage,
+            VULKAN_HPP_NAMESPACE::SharingMode::eExclusive,
+            queues,
+            surfaceCapabilities.currentTransform, // vk::SurfaceTransformFlagBitsKHR::eIdentity,
+            vk::CompositeAlphaFlagBitsKHR::eOpaque,
+            bestPresentationMode.value(),
+            true, // clipped_
+            {}    // oldSwapchain_
+        };
+
+        m_swapchain       = m_device.createSwapchainKHR( swapchainCreateInfo );
+        m_swapChainImages = m_device.getSwapchainImagesKHR( m_swapchain );
+        count( Counter::eSwapchainBuilds );
+        setGauge( Gauge::ePresentMode, static_cast< std::int64_t >( bestPresentationMode.value() ) );
+    }
+
+    for ( const vk::Image& image : m_swapChainImages )
+    {
+        // clang-format off
+        vk::ImageViewCreateInfo imageViewCreateInfo = 
+        {
+            vk::ImageViewCreateFlags{},
+            image,
+            vk::ImageViewType::e2D,
+            m_format.format,
+            vk::ComponentMapping{},
+            vk::ImageSubresourceRange
+            {
+                vk::ImageAspectFlagBits::eColor,
+                0, //baseMipLevel
+                1, //levelCount
+                0, //baseArrayLayer_
+                1  //layerCount_
+            }
+        };
+        // clang-format on
+        vk::ImageView imageView = m_device.createImageView( imageViewCreateInfo );
+        m_swapChainImageViews.push_back( imageView );
+    }
+
+    {
+        // acquire and present only accept binary semaphores
+        vk::SemaphoreCreateInfo semaphoreCreateInfo = { vk::SemaphoreCreateFlags{} };
+        for ( std::uint32_t i = 0; i != uiFramesInFlight; ++i )
+        {
+            m_imageAvailableSemaphores.push_back( m_device.createSemaphore( semaphoreCreateInfo ) );
+        }
+    }
+}
+
+void Swapchain::createFramebuffers( vk::RenderPass renderPass )
+{
+    VERIFY_RTE_MSG( m_frameBuffers.empty(), "Swapchain framebuffers already created" );
+    for ( const vk::ImageView& imageView : m_swapChainImageViews )
+    {
+        std::array< vk::ImageView, 1 > attachments{ imageView };
+        vk::FramebufferCreateInfo      frameBufferCreateInfo = {
+            vk::FramebufferCreateFlags{},
+            renderPass,
+            attachments,
+            m_extent.width,
+            m_extent.height,
+            1 // layers
+        };
+
+        vk::Framebuffer frameBuffer = m_device.createFramebuffer( frameBufferCreateInfo );
+        m_frameBuffers.push_back( frameBuffer );
+    }
+}
+
+Swapchain::~Swapchain()
+{
+    for ( vk::Semaphore& semaphore : m_imageAvailableSemaphores )
+    {
+        m_device.destroySemaphore( semaphore );
+    }
+    for ( vk::Framebuffer& frameBuffer : m_frameBuffers )
+    {
+        m_device.destroyFramebuffer( frameBuffer );
+    }
+    for ( vk::ImageView& imageView : m_swapChainImageViews )
+    {
+        m_device.destroyImageView( imageView );
+    }
+    if ( m_swapchain )
+    {
+        m_device.destroySwapchainKHR( m_swapchain );
+    }
+}
+
+} // namespace retail
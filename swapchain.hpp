@@ -0,0 +1,59 @@
+#ifndef SWAPCHAIN_3_OCTOBER_2022
+#define SWAPCHAIN_3_OCTOBER_2022
+
+#include "window.hpp"
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include <optional>
+#include <vector>
+
+namespace retail
+{
+
+// The per window presentation state - one surface, one swapchain and the image views
+// and framebuffers targeting it.  All swapchains share the device and queue of the Demo.
+class Swapchain
+{
+public:
+    Swapchain( const Window&                         window,
+               vk::PhysicalDevice                    physicalDevice,
+               vk::Device                            device,
+               vk::SurfaceKHR                        surface,
+               std::uint32_t                         uiQueueFamilyIndex,
+               std::uint32_t                         uiFramesInFlight,
+               std::optional< vk::SurfaceFormatKHR > requiredFormat );
+    ~Swapchain();
+
+    Swapchain( const Swapchain& )            = delete;
+    Swapchain& operator=( const Swapchain& ) = delete;
+
+    void createFramebuffers( vk::RenderPass renderPass );
+
+    const Window&               getWindow() const { return m_window; }
+    vk::SwapchainKHR            getSwapchain() const { return m_swapchain; }
+    const vk::SurfaceFormatKHR& getFormat() const { return m_format; }
+    const vk::Extent2D&         getExtent() const { return m_extent; }
+    vk::Image                   getImage( std::uint32_t uiImageIndex ) const { return m_swapChainImages[ uiImageIndex ]; }
+    vk::Framebuffer             getFramebuffer( std::uint32_t uiImageIndex ) const { return m_frameBuffers[ uiImageIndex ]; }
+    vk::Semaphore               getImageAvailableSemaphore( std::uint32_t uiFrameSlot ) const
+    {
+        return m_imageAvailableSemaphores[ uiFrameSlot ];
+    }
+
+private:
+    const Window&                  m_window;
+    vk::Device                     m_device;
+    vk::SwapchainKHR               m_swapchain;
+    vk::SurfaceFormatKHR           m_format;
+    vk::Extent2D                   m_extent;
+    std::vector< vk::Image >       m_swapChainImages;
+    std::vector< vk::ImageView >   m_swapChainImageViews;
+    std::vector< vk::Framebuffer > m_frameBuffers;
+    std::vector< vk::Semaphore >   m_imageAvailableSemaphores; // binary - one per frame in flight
+};
+
+} // namespace retail
+
+#endif // SWAPCHAIN_3_OCTOBER_2022
@@ -0,0 +1,115 @@
+#include "texture.hpp"
+#include "buffer.hpp"
+#include "counters.hpp"
+#include "texture_file.hpp"
+#include "uploader.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include <cstring>
+
+namespace retail
+{
+
+Texture::Texture( vk::PhysicalDevice physicalDevice,
+                  vk::Device         device,
+                  vk::Format         format,
+                  vk::Extent2D       extent,
+                  std::uint32_t      uiMipLevels )
+    : m_device( device )
+    , m_format( format )
+    , m_extent( extent )
+    , m_uiMipLevels( uiMipLevels )
+{
+    VERIFY_RTE( extent.width > 0U && extent.height > 0U );
+    VERIFY_RTE( uiMipLevels > 0U );
+
+    const vk::ImageCreateInfo imageCreateInfo{ vk::ImageCreateFlags{},
+                                               vk::ImageType::e2D,
+                                               format,
+                                               vk::Extent3D{ extent.width, extent.height, 1U },
+                                               uiMipLevels,
+                                               1U,
+                                               vk::SampleCountFlagBits::e1,
+                                               vk::ImageTiling::eOptimal,
+                                               vk::ImageUsageFlagBits::eSampled
+                                                   | vk::ImageUsageFlagBits::eTransferDst,
+                                               vk::SharingMode::eExclusive,
+                                               {},
+                                               vk::ImageLayout::eUndefined };
+    m_image = m_device.createImage( imageCreateInfo );
+
+    const vk::MemoryRequirements requirements = m_device.getImageMemoryRequirements( m_image );
+    const vk::MemoryAllocateInfo allocateInfo{
+        requirements.size,
+        findMemoryType( physicalDevice, requirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal ) };
+    m_memory     = m_device.allocateMemory( allocateInfo );
+    m_memorySize = requirements.size;
+    count( Counter::eAllocations );
+    m_device.bindImageMemory( m_image, m_memory, 0U );
+
+    const vk::ImageViewCreateInfo viewCreateInfo{
+        vk::ImageViewCreateFlags{},
+        m_image,
+        vk::ImageViewType::e2D,
+        format,
+        vk::ComponentMapping{},
+        vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, 0U, uiMipLevels, 0U, 1U } };
+    m_view = m_device.createImageView( viewCreateInfo );
+}
+
+Texture::~Texture()
+{
+    if ( m_view )
+    {
+        m_device.destroyImageView( m_view );
+    }
+    if ( m_image )
+    {
+        m_device.destroyImage( m_image );
+    }
+    if ( m_memory )
+    {
+        m_device.freeMemory( m_memory );
+    }
+}
+
+std::unique_ptr< Texture > createTexture( vk::PhysicalDevice physicalDevice,
+                                          vk::Device         device,
+                                          Uploader&          uploader,
+                                          const TextureFile& textureFile )
+{
+    vk::Format format = vk::Format::eUndefined;
+    switch ( textureFile.getFormat() )
+    {
+        case texture::Format::eBC1:
+            format = textureFile.isSrgb() ? vk::Format::eBc1RgbSrgbBlock : vk::Format::eBc1RgbUnormBlock;
+            break;
+        case texture::Format::eBC3:
+            format = textureFile.isSrgb() ? vk::Format::eBc3SrgbBlock : vk::Format::eBc3UnormBlock;
+            break;
+        case texture::Format::eBC7:
+            format = textureFile.isSrgb() ? vk::Format::eBc7SrgbBlock : vk::Format::eBc7UnormBlock;
+            break;
+    }
+    const vk::FormatProperties properties = physicalDevice.getFormatProperties( format );
+    VERIFY_RTE_MSG( properties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImage,
+                    "Texture format not supported: " << vk::to_string( format ) );
+
+    auto pTexture = std::make_unique< Texture >( physicalDevice,
+                                                 device,
+                                                 format,
+                                                 vk::Extent2D{ textureFile.getWidth(), textureFile.getHeight() },
+                                                 textureFile.getMipCount() );
+
+    // a mip's blocks in the file are already the tightly packed layout the copy expects
+    for ( std::uint32_t i = 0; i != textureFile.getMipCount(); ++i )
+    {
+        std::memcpy( uploader.stage( *pTexture, i, textureFile.getMipSize( i ) ),
+                     textureFile.getMipData( i ),
+                     textureFile.getMipSize( i ) );
+    }
+    return pTexture;
+}
+
+} // namespace retail
@@ -0,0 +1,68 @@
+#ifndef TEXTURE_15_OCTOBER_2022
+#define TEXTURE_15_OCTOBER_2022
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+
+namespace retail
+{
+
+class TextureFile;
+class Uploader;
+
+// A sampled 2D image with its own dedicated device local allocation and a view of every mip.
+//
+// Contents are written through Uploader::stage() which leaves the image in eShaderReadOnlyOptimal.
+class Texture
+{
+public:
+    Texture( vk::PhysicalDevice physicalDevice,
+             vk::Device         device,
+             vk::Format         format,
+             vk::Extent2D       extent,
+             std::uint32_t      uiMipLevels = 1U );
+    ~Texture();
+
+    Texture( const Texture& )            = delete;
+    Texture& operator=( const Texture& ) = delete;
+
+    vk::Image     get() const { return m_image; }
+    vk::ImageView getView() const { return m_view; }
+    vk::Format    getFormat() const { return m_format; }
+    vk::Extent2D  getExtent() const { return m_extent; }
+    std::uint32_t getMipLevels() const { return m_uiMipLevels; }
+
+    // bytes of the dedicated allocation
+    vk::DeviceSize getMemorySize() const { return m_memorySize; }
+
+    vk::Extent2D getMipExtent( std::uint32_t uiMipLevel ) const
+    {
+        return vk::Extent2D{ std::max( m_extent.width >> uiMipLevel, 1U ),
+                             std::max( m_extent.height >> uiMipLevel, 1U ) };
+    }
+
+private:
+    vk::Device       m_device;
+    vk::Image        m_image;
+    vk::DeviceMemory m_memory;
+    vk::ImageView    m_view;
+    vk::Format       m_format;
+    vk::Extent2D     m_extent;
+    std::uint32_t    m_uiMipLevels;
+    vk::DeviceSize   m_memorySize = 0U;
+};
+
+// A texture of every mip of a block compressed texture file with the blocks staged as they are -
+// the caller flushes the uploader.  The device must have enabled textureCompressionBC.
+std::unique_ptr< Texture > createTexture( vk::PhysicalDevice physicalDevice,
+                                          vk::Device         device,
+                                          Uploader&          uploader,
+                                          const TextureFile& textureFile );
+
+} // namespace retail
+
+#endif // TEXTURE_15_OCTOBER_2022
@@ -0,0 +1,124 @@
+#include "texture_file.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+namespace retail
+{
+namespace texture
+{
+namespace
+{
+std::uint64_t alignUp( std::uint64_t uiValue, std::uint64_t uiAlignment )
+{
+    return ( uiValue + uiAlignment - 1U ) & ~( uiAlignment - 1U );
+}
+
+void pad( std::ofstream& os, std::uint64_t uiTo )
+{
+    static const char zeros[ kMipAlignment ] = {};
+    std::uint64_t     uiPos                  = static_cast< std::uint64_t >( os.tellp() );
+    VERIFY_RTE( uiPos <= uiTo );
+    while ( uiPos != uiTo )
+    {
+        const std::uint64_t uiCount = std::min< std::uint64_t >( uiTo - uiPos, kMipAlignment );
+        os.write( zeros, static_cast< std::streamsize >( uiCount ) );
+        uiPos += uiCount;
+    }
+}
+} // namespace
+
+void writeTextureFile( const boost::filesystem::path& filePath, const TextureData& texture )
+{
+    VERIFY_RTE_MSG( texture.uiWidth > 0U && texture.uiHeight > 0U, "Empty texture: " << filePath.string() );
+    VERIFY_RTE_MSG( !texture.mips.empty() && texture.mips.size() <= kMaxMips,
+                    "Invalid mip count: " << texture.mips.size() << " for: " << filePath.string() );
+
+    FileHeader header{};
+    header.uiMagic    = kMagic;
+    header.uiVersion  = kVersion;
+    header.format     = texture.format;
+    header.uiFlags    = texture.uiFlags;
+    header.uiWidth    = texture.uiWidth;
+    header.uiHeight   = texture.uiHeight;
+    header.uiMipCount = static_cast< std::uint32_t >( texture.mips.size() );
+
+    std::uint64_t uiOffset = alignUp( sizeof( FileHeader ), kMipAlignment );
+    for ( std::uint32_t i = 0; i != header.uiMipCount; ++i )
+    {
+        const std::uint64_t uiExpected = getMipSize(
+            texture.format, getMipDimension( texture.uiWidth, i ), getMipDimension( texture.uiHeight, i ) );
+        VERIFY_RTE_MSG( texture.mips[ i ].size() == uiExpected,
+                        "Mip: " << i << " size mismatch for: " << filePath.string() );
+        header.mips[ i ] = MipRecord{ uiOffset, uiExpected };
+        uiOffset         = alignUp( uiOffset + uiExpected, kMipAlignment );
+    }
+
+    std::ofstream os( filePath.native().c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+    if ( !os.good() )
+    {
+        THROW_RTE( "Failed to open file: " << filePath.string() );
+    }
+    os.write( reinterpret_cast< const char* >( &header ), sizeof( FileHeader ) );
+    for ( std::uint32_t i = 0; i != header.uiMipCount; ++i )
+    {
+        pad( os, header.mips[ i ].uiOffset );
+        os.write( reinterpret_cast< const char* >( texture.mips[ i ].data() ),
+                  static_cast< std::streamsize >( texture.mips[ i ].size() ) );
+    }
+    pad( os, uiOffset );
+    VERIFY_RTE_MSG( os.good(), "Failed writing file: " << filePath.string() );
+}
+
+} // namespace texture
+
+TextureFile::TextureFile( const boost::filesystem::path& filePath )
+    : m_file( filePath )
+{
+    const std::uint64_t uiFileSize = m_file.size();
+    VERIFY_RTE_MSG( uiFileSize >= sizeof( texture::FileHeader ), "Texture file too small: " << filePath.string() );
+
+    m_pHeader = reinterpret_cast< const texture::FileHeader* >( m_file.data() );
+    VERIFY_RTE_MSG( m_pHeader->uiMagic == texture::kMagic, "Not a texture file: " << filePath.string() );
+    VERIFY_RTE_MSG( m_pHeader->uiVersion == texture::kVersion,
+                    "Unsupported texture file version: " << m_pHeader->uiVersion << " in: " << filePath.string() );
+    VERIFY_RTE_MSG( m_pHeader->format == texture::Format::eBC1 || m_pHeader->format == texture::Format::eBC3
+                        || m_pHeader->format == texture::Format::eBC7,
+                    "Unknown texture format: " << static_cast< std::uint32_t >( m_pHeader->format )
+                                               << " in: " << filePath.string() );
+    VERIFY_RTE_MSG( m_pHeader->uiWidth > 0U && m_pHeader->uiHeight > 0U && m_pHeader->uiMipCount >= 1U
+                        && m_pHeader->uiMipCount <= texture::kMaxMips,
+                    "Corrupt texture file header: " << filePath.string() );
+
+    for ( std::uint32_t i = 0; i != m_pHeader->uiMipCount; ++i )
+    {
+        const texture::MipRecord& mip = m_pHeader->mips[ i ];
+        VERIFY_RTE_MSG( mip.uiSize
+                                == texture::getMipSize( m_pHeader->format,
+                                                        texture::getMipDimension( m_pHeader->uiWidth, i ),
+                                                        texture::getMipDimension( m_pHeader->uiHeight, i ) )
+                            && mip.uiOffset % texture::kMipAlignment == 0U && mip.uiOffset + mip.uiSize <= uiFileSize,
+                        "Corrupt texture mip: " << i << " in: " << filePath.string() );
+    }
+}
+
+std::uint64_t TextureFile::getUncompressedSize() const
+{
+    std::uint64_t uiSize = 0U;
+    for ( std::uint32_t i = 0; i != m_pHeader->uiMipCount; ++i )
+    {
+        uiSize += static_cast< std::uint64_t >( texture::getMipDimension( m_pHeader->uiWidth, i ) )
+                  * texture::getMipDimension( m_pHeader->uiHeight, i ) * 4U;
+    }
+    return uiSize;
+}
+
+const texture::MipRecord& TextureFile::getMip( std::uint32_t uiMip ) const
+{
+    VERIFY_RTE( uiMip < m_pHeader->uiMipCount );
+    return m_pHeader->mips[ uiMip ];
+}
+
+} // namespace retail
@@ -0,0 +1,130 @@
+#ifndef TEXTURE_FILE_19_OCTOBER_2022
+#define TEXTURE_FILE_19_OCTOBER_2022
+
+#include "mapped_file.hpp"
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace retail
+{
+namespace texture
+{
+    // Block compressed texture layout
+    //
+    // FileHeader                   - including a MipRecord per mip, finest first
+    // payload                      - each mip's blocks aligned to kMipAlignment
+    //
+    // A mip is its 4x4 texel blocks in rows, tightly packed, so it is copied to the image as is.
+    // All offsets are from the start of the file.
+    static constexpr std::uint32_t kMagic        = 0x58455452U; // "RTEX"
+    static constexpr std::uint32_t kVersion      = 1U;
+    static constexpr std::uint64_t kMipAlignment = 64U;
+    static constexpr std::uint32_t kMaxMips      = 16U;
+    static constexpr std::uint32_t kBlockSize    = 4U; // texels across and down a block
+
+    enum class Format : std::uint32_t
+    {
+        eBC1 = 0, // opaque rgb - 8 bytes per block
+        eBC3 = 1, // rgb with interpolated alpha - 16 bytes per block
+        eBC7 = 2  // rgba - 16 bytes per block
+    };
+
+    // the colour channels hold sRGB encoded values rather than linear ones
+    static constexpr std::uint32_t kFlagSrgb = 1U;
+
+    struct MipRecord
+    {
+        std::uint64_t uiOffset;
+        std::uint64_t uiSize;
+    };
+
+    struct FileHeader
+    {
+        std::uint32_t uiMagic;
+        std::uint32_t uiVersion;
+        Format        format;
+        std::uint32_t uiFlags;
+        std::uint32_t uiWidth;
+        std::uint32_t uiHeight;
+        std::uint32_t uiMipCount;
+        std::uint32_t uiReserved;
+        MipRecord     mips[ kMaxMips ];
+    };
+
+    static_assert( std::is_trivially_copyable< FileHeader >::value && sizeof( FileHeader ) == 288U );
+
+    inline std::uint32_t getBlockBytes( Format format ) { return format == Format::eBC1 ? 8U : 16U; }
+
+    inline const char* toString( Format format )
+    {
+        switch ( format )
+        {
+            case Format::eBC1:
+                return "bc1";
+            case Format::eBC3:
+                return "bc3";
+            case Format::eBC7:
+                return "bc7";
+        }
+        return "unknown";
+    }
+
+    inline std::uint32_t getMipDimension( std::uint32_t uiDimension, std::uint32_t uiMip )
+    {
+        return uiDimension >> uiMip ? uiDimension >> uiMip : 1U;
+    }
+
+    // bytes of the blocks covering a uiWidth by uiHeight mip
+    inline std::uint64_t getMipSize( Format format, std::uint32_t uiWidth, std::uint32_t uiHeight )
+    {
+        return static_cast< std::uint64_t >( ( uiWidth + kBlockSize - 1U ) / kBlockSize )
+               * ( ( uiHeight + kBlockSize - 1U ) / kBlockSize ) * getBlockBytes( format );
+    }
+
+    // in memory texture used to write a file
+    struct TextureData
+    {
+        Format                                     format   = Format::eBC7;
+        std::uint32_t                              uiFlags  = 0U;
+        std::uint32_t                              uiWidth  = 0U;
+        std::uint32_t                              uiHeight = 0U;
+        std::vector< std::vector< std::uint8_t > > mips; // finest first
+    };
+
+    void writeTextureFile( const boost::filesystem::path& filePath, const TextureData& texture );
+
+} // namespace texture
+
+// Memory mapped block compressed texture.  Opening validates the header only so the blocks are
+// paged in as each mip is copied out.
+class TextureFile
+{
+public:
+    TextureFile( const boost::filesystem::path& filePath );
+
+    texture::Format getFormat() const { return m_pHeader->format; }
+    bool            isSrgb() const { return ( m_pHeader->uiFlags & texture::kFlagSrgb ) != 0U; }
+    std::uint32_t   getWidth() const { return m_pHeader->uiWidth; }
+    std::uint32_t   getHeight() const { return m_pHeader->uiHeight; }
+    std::uint32_t   getMipCount() const { return m_pHeader->uiMipCount; }
+
+    const std::uint8_t* getMipData( std::uint32_t uiMip ) const { return m_file.data() + getMip( uiMip ).uiOffset; }
+    std::uint64_t       getMipSize( std::uint32_t uiMip ) const { return getMip( uiMip ).uiSize; }
+
+    // bytes the mips would take as uncompressed rgba8 texels
+    std::uint64_t getUncompressedSize() const;
+
+private:
+    const texture::MipRecord& getMip( std::uint32_t uiMip ) const;
+
+    MappedFile                  m_file;
+    const texture::FileHeader*  m_pHeader = nullptr;
+};
+
+} // namespace retail
+
+#endif // TEXTURE_FILE_19_OCTOBER_2022
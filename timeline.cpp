@@ -0,0 +1,106 @@
+
+#include "timeline.hpp"
+#include "debug.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include "spdlog/spdlog.h"
+
+namespace retail
+{
+
+Timeline::Timeline( const DeviceDispatch& dispatch, vk::Queue queue )
+    : m_dispatch( dispatch )
+    , m_device( dispatch.getDevice() )
+    , m_queue( queue )
+{
+    const vk::StructureChain< vk::SemaphoreCreateInfo, vk::SemaphoreTypeCreateInfo > semaphoreCreateInfo
+        = { vk::SemaphoreCreateInfo{ vk::SemaphoreCreateFlags{} },
+            vk::SemaphoreTypeCreateInfo{ vk::SemaphoreType::eTimeline, m_uiSubmitted } };
+    m_semaphore = m_device.createSemaphore( semaphoreCreateInfo.get< vk::SemaphoreCreateInfo >() );
+}
+
+Timeline::~Timeline()
+{
+    if ( m_semaphore )
+    {
+        m_device.destroySemaphore( m_semaphore );
+    }
+}
+
+std::uint64_t Timeline::getCompleted()
+{
+    // the counter only moves forward so the cached value avoids the query once caught up
+    if ( m_uiCompleted < m_uiSubmitted )
+    {
+        std::uint64_t uiValue = 0U;
+        VK_CHECK( static_cast< vk::Result >( m_dispatch.getSemaphoreCounterValue( m_semaphore, uiValue ) ) );
+        m_uiCompleted = uiValue;
+    }
+    return m_uiCompleted;
+}
+
+bool Timeline::isComplete( std::uint64_t uiValue )
+{
+    return uiValue <= m_uiCompleted || uiValue <= getCompleted();
+}
+
+bool Timeline::wait( std::uint64_t uiValue, std::uint64_t uiTimeoutNS )
+{
+    VERIFY_RTE_MSG( uiValue <= m_uiSubmitted, "Waiting on timeline value: " << uiValue << " that was never submitted" );
+    if ( isComplete( uiValue ) )
+        return true;
+
+    const vk::SemaphoreWaitInfo waitInfo{ vk::SemaphoreWaitFlags{}, m_semaphore, uiValue };
+    const vk::Result result = static_cast< vk::Result >( m_dispatch.waitSemaphores( waitInfo, uiTimeoutNS ) );
+    switch ( result )
+    {
+        case vk::Result::eSuccess:
+            m_uiCompleted = std::max( m_uiCompleted, uiValue );
+            return true;
+        case vk::Result::eTimeout:
+            return false;
+        default:
+            VK_CHECK( result );
+            return false;
+    }
+}
+
+std::uint64_t Timeline::submit( vk::ArrayProxy< const vk::CommandBuffer > commandBuffers,
+                                vk::ArrayProxy< const Wait >              waits,
+                                vk::ArrayProxy< const vk::Semaphore >     binarySignals )
+{
+    const std::uint64_t uiSignalValue = m_uiSubmitted + 1U;
+
+    m_waitSemaphores.clear();
+    m_waitValues.clear();
+    m_waitStages.clear();
+    for ( const Wait& wait : waits )
+    {
+        m_waitSemaphores.push_back( wait.semaphore );
+        m_waitValues.push_back( wait.uiValue );
+        m_waitStages.push_back( wait.stages );
+    }
+
+    m_signalSemaphores.clear();
+    m_signalValues.clear();
+    m_signalSemaphores.push_back( m_semaphore );
+    m_signalValues.push_back( uiSignalValue );
+    for ( const vk::Semaphore& semaphore : binarySignals )
+    {
+        m_signalSemaphores.push_back( semaphore );
+        m_signalValues.push_back( 0U );
+    }
+
+    const vk::TimelineSemaphoreSubmitInfo timelineSubmitInfo{ m_waitValues, m_signalValues };
+    vk::SubmitInfo                        submitInfo{ m_waitSemaphores, m_waitStages, {}, m_signalSemaphores };
+    submitInfo.setCommandBufferCount( commandBuffers.size() )
+        .setPCommandBuffers( commandBuffers.data() )
+        .setPNext( &timelineSubmitInfo );
+    VK_CHECK( static_cast< vk::Result >( m_dispatch.queueSubmit( m_queue, submitInfo, vk::Fence{} ) ) );
+
+    m_uiSubmitted = uiSignalValue;
+    return uiSignalValue;
+}
+
+} // namespace retail
@@ -0,0 +1,81 @@
+#ifndef TIMELINE_5_OCTOBER_2022
+#define TIMELINE_5_OCTOBER_2022
+
+#include "device_dispatch.hpp"
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace retail
+{
+
+// A monotonically increasing GPU timeline for one queue built on a timeline semaphore.
+//
+// Every submit through the timeline signals the next value so the value returned by submit
+// identifies the work.  The CPU polls getCompleted() without blocking to learn how far the
+// GPU has progressed and only blocks in wait() when it genuinely needs a result.  Other
+// queues express dependencies on this queue as a value wait via Timeline::Wait.
+class Timeline
+{
+public:
+    struct Wait
+    {
+        vk::Semaphore          semaphore;
+        std::uint64_t          uiValue; // ignored for binary semaphores
+        vk::PipelineStageFlags stages;
+    };
+
+    Timeline( const DeviceDispatch& dispatch, vk::Queue queue );
+    ~Timeline();
+
+    Timeline( const Timeline& )            = delete;
+    Timeline& operator=( const Timeline& ) = delete;
+
+    vk::Queue     getQueue() const { return m_queue; }
+    vk::Semaphore getSemaphore() const { return m_semaphore; }
+
+    // value signalled by the most recent submit
+    std::uint64_t getSubmitted() const { return m_uiSubmitted; }
+
+    // non-blocking query of the value the GPU has reached
+    std::uint64_t getCompleted();
+    bool          isComplete( std::uint64_t uiValue );
+
+    // block until uiValue is reached or the timeout expires - returns true if reached
+    bool wait( std::uint64_t uiValue, std::uint64_t uiTimeoutNS = UINT64_MAX );
+    void waitIdle() { wait( m_uiSubmitted ); }
+
+    // dependency on this timeline for a submit on another queue
+    Wait waitFor( std::uint64_t uiValue, vk::PipelineStageFlags stages ) const
+    {
+        return Wait{ m_semaphore, uiValue, stages };
+    }
+
+    // submit the command buffers signalling the next timeline value and any additional binary semaphores.
+    // waits may mix binary semaphores and timeline values.  Returns the signalled timeline value.
+    std::uint64_t submit( vk::ArrayProxy< const vk::CommandBuffer > commandBuffers,
+                          vk::ArrayProxy< const Wait >              waits,
+                          vk::ArrayProxy< const vk::Semaphore >     binarySignals );
+
+private:
+    const DeviceDispatch& m_dispatch;
+    vk::Device            m_device;
+    vk::Queue             m_queue;
+    vk::Semaphore         m_semaphore;
+    std::uint64_t         m_uiSubmitted = 0U;
+    std::uint64_t         m_uiCompleted = 0U;
+
+    // scratch reused by submit
+    std::vector< vk::Semaphore >          m_waitSemaphores;
+    std::vector< std::uint64_t >          m_waitValues;
+    std::vector< vk::PipelineStageFlags > m_waitStages;
+    std::vector< vk::Semaphore >          m_signalSemaphores;
+    std::vector< std::uint64_t >          m_signalValues;
+};
+
+} // namespace retail
+
+#endif // TIMELINE_5_OCTOBER_2022
@@ -0,0 +1,110 @@
+#include "asset_pack.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Asset packer - writes loose files into one asset pack with each entry named by its file name
+int main( int argc, const char* argv[] )
+{
+    namespace po = boost::program_options;
+    using namespace retail;
+
+    try
+    {
+        std::string                strOutput;
+        std::vector< std::string > inputs;
+        bool                       bCompress   = false;
+        std::uint32_t              uiAlignment = pack::kDefaultAlignment;
+
+        po::options_description options( "asset_packer options" );
+        // clang-format off
+        options.add_options()
+            ( "help",           "Produce help message" )
+            ( "output,o",       po::value< std::string >( &strOutput ), "Output asset pack" )
+            ( "input",          po::value< std::vector< std::string > >( &inputs ), "Input files" )
+            ( "compress",       po::bool_switch( &bCompress ),
+                                "Compress entries that get smaller - they are decompressed on first use" )
+            ( "alignment",      po::value< std::uint32_t >( &uiAlignment )->default_value( uiAlignment ),
+                                "Alignment of every entry in bytes - a power of two" )
+            ;
+        // clang-format on
+        po::positional_options_description positional;
+        positional.add( "input", -1 );
+
+        po::variables_map vm;
+        po::store( po::command_line_parser( argc, argv ).options( options ).positional( positional ).run(), vm );
+        po::notify( vm );
+
+        if ( vm.count( "help" ) || strOutput.empty() || inputs.empty() )
+        {
+            std::cout << "asset_packer -o <pack> <file>...\n" << options << std::endl;
+            return vm.count( "help" ) ? 0 : 1;
+        }
+
+        std::vector< pack::EntryData > entries;
+        std::size_t                    szSourceBytes = 0U;
+        for ( const std::string& strInput : inputs )
+        {
+            std::ifstream inputFileStream( strInput, std::ios::in | std::ios::binary );
+            if ( !inputFileStream.good() )
+            {
+                SPDLOG_ERROR( "Failed to open file: {}", strInput );
+                return 1;
+            }
+
+            pack::EntryData entry;
+            entry.strName = boost::filesystem::path( strInput ).filename().string();
+            entry.data.assign( std::istreambuf_iterator< char >( inputFileStream ),
+                               std::istreambuf_iterator< char >() );
+            entry.uiAlignment = uiAlignment;
+            entry.bCompress   = bCompress;
+            szSourceBytes += entry.data.size();
+            entries.emplace_back( std::move( entry ) );
+        }
+
+        pack::writeAssetPack( strOutput, entries );
+
+        // read back through the runtime path so a bad pack fails the build rather than the application
+        const AssetPack assetPack( strOutput );
+        std::size_t     szStoredBytes = 0U;
+        for ( const pack::EntryData& entry : entries )
+        {
+            const pack::EntryRecord* pRecord = assetPack.findEntry( entry.strName );
+            if ( !pRecord )
+            {
+                SPDLOG_ERROR( "Entry missing from pack: {}", entry.strName );
+                return 1;
+            }
+            const AssetPack::View view = assetPack.get( *pRecord );
+            if ( view.uiSize != entry.data.size()
+                 || !std::equal( entry.data.begin(), entry.data.end(), view.pData ) )
+            {
+                SPDLOG_ERROR( "Entry does not read back: {}", entry.strName );
+                return 1;
+            }
+            szStoredBytes += pRecord->uiStoredSize;
+        }
+
+        SPDLOG_INFO( "Wrote {} entries to: {} {} bytes stored from {} bytes - pack is {} bytes",
+                     entries.size(),
+                     strOutput,
+                     szStoredBytes,
+                     szSourceBytes,
+                     boost::filesystem::file_size( strOutput ) );
+    }
+    catch ( std::exception& ex )
+    {
+        SPDLOG_ERROR( "Exception: {}", ex.what() );
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,839 @@
+#include "block_compress.hpp"
+
+#include "mapped_file.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace retail
+{
+namespace tools
+{
+namespace
+{
+constexpr std::uint32_t kBlockTexels = texture::kBlockSize * texture::kBlockSize;
+
+// per channel minimum and maximum over a block's texels
+using BoundsFunction = void ( * )( const std::uint8_t* pTexels, std::uint8_t* pMin, std::uint8_t* pMax );
+
+// index = clamp( round( ( texel - origin ) . axis * fScale ), 0, iMaxIndex ) for each of a block's
+// texels.  The dot product is exact in integers and the one float multiply and round to nearest
+// even are the same in every kernel so they all choose the same indices.
+using ProjectFunction = void ( * )( const std::uint8_t* pTexels,
+                                    const std::int16_t* pOrigin,
+                                    const std::int16_t* pAxis,
+                                    float               fScale,
+                                    std::int16_t        iMaxIndex,
+                                    std::uint8_t*       pIndices );
+
+// per channel sums and sums of products over a block's texels - pProducts[ k * 4 + c ] is the sum
+// of channel c times channel ( c + k ) % 4 for k up to 2, which covers every pair.  Each is an
+// integer below 2^24 so the float sums are exact whatever order a kernel adds in.
+using MomentsFunction = void ( * )( const std::uint8_t* pTexels, float* pSums, float* pProducts );
+
+// the smallest and largest texel . axis over a block's texels - exact in integers
+using ExtentFunction
+    = void ( * )( const std::uint8_t* pTexels, const std::int16_t* pAxis, std::int32_t* pMin, std::int32_t* pMax );
+
+struct Kernels
+{
+    BoundsFunction  pfnBounds;
+    ProjectFunction pfnProject;
+    MomentsFunction pfnMoments;
+    ExtentFunction  pfnExtent;
+};
+
+void boundsScalar( const std::uint8_t* pTexels, std::uint8_t* pMin, std::uint8_t* pMax )
+{
+    for ( std::uint32_t c = 0; c != 4U; ++c )
+    {
+        pMin[ c ] = 0xFFU;
+        pMax[ c ] = 0U;
+    }
+    for ( std::uint32_t i = 0; i != kBlockTexels * 4U; ++i )
+    {
+        pMin[ i % 4U ] = std::min( pMin[ i % 4U ], pTexels[ i ] );
+        pMax[ i % 4U ] = std::max( pMax[ i % 4U ], pTexels[ i ] );
+    }
+}
+
+void projectScalar( const std::uint8_t* pTexels,
+                    const std::int16_t* pOrigin,
+                    const std::int16_t* pAxis,
+                    float               fScale,
+                    std::int16_t        iMaxIndex,
+                    std::uint8_t*       pIndices )
+{
+    for ( std::uint32_t i = 0; i != kBlockTexels; ++i )
+    {
+        std::int32_t iDot = 0;
+        for ( std::uint32_t c = 0; c != 4U; ++c )
+            iDot += ( static_cast< std::int32_t >( pTexels[ i * 4U + c ] ) - pOrigin[ c ] ) * pAxis[ c ];
+        const auto iIndex = static_cast< std::int32_t >( std::nearbyint( static_cast< float >( iDot ) * fScale ) );
+        pIndices[ i ] = static_cast< std::uint8_t >( std::clamp< std::int32_t >( iIndex, 0, iMaxIndex ) );
+    }
+}
+
+void momentsScalar( const std::uint8_t* pTexels, float* pSums, float* pProducts )
+{
+    std::fill_n( pSums, 4U, 0.0f );
+    std::fill_n( pProducts, 12U, 0.0f );
+    for ( std::uint32_t i = 0; i != kBlockTexels; ++i )
+    {
+        const std::uint8_t* pTexel = pTexels + i * 4U;
+        for ( std::uint32_t c = 0; c != 4U; ++c )
+        {
+            pSums[ c ] += pTexel[ c ];
+            for ( std::uint32_t k = 0; k != 3U; ++k )
+                pProducts[ k * 4U + c ] += static_cast< float >( pTexel[ c ] * pTexel[ ( c + k ) % 4U ] );
+        }
+    }
+}
+
+void extentScalar( const std::uint8_t* pTexels, const std::int16_t* pAxis, std::int32_t* pMin, std::int32_t* pMax )
+{
+    *pMin = std::numeric_limits< std::int32_t >::max();
+    *pMax = std::numeric_limits< std::int32_t >::min();
+    for ( std::uint32_t i = 0; i != kBlockTexels; ++i )
+    {
+        std::int32_t iDot = 0;
+        for ( std::uint32_t c = 0; c != 4U; ++c )
+            iDot += pTexels[ i * 4U + c ] * pAxis[ c ];
+        *pMin = std::min( *pMin, iDot );
+        *pMax = std::max( *pMax, iDot );
+    }
+}
+
+#ifdef RETAIL_SIMD_X86
+// the four texels of a register reduced to the one in every lane
+__m128i reduceMin( __m128i texels )
+{
+    texels = _mm_min_epu8( texels, _mm_shuffle_epi32( texels, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+    return _mm_min_epu8( texels, _mm_shuffle_epi32( texels, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+}
+
+__m128i reduceMax( __m128i texels )
+{
+    texels = _mm_max_epu8( texels, _mm_shuffle_epi32( texels, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+    return _mm_max_epu8( texels, _mm_shuffle_epi32( texels, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+}
+
+void storeTexel( __m128i texel, std::uint8_t* pTexel )
+{
+    const std::int32_t iTexel = _mm_cvtsi128_si32( texel );
+    std::memcpy( pTexel, &iTexel, sizeof( iTexel ) );
+}
+
+// four texels per register
+void boundsSSE( const std::uint8_t* pTexels, std::uint8_t* pMin, std::uint8_t* pMax )
+{
+    const __m128i a = _mm_loadu_si128( reinterpret_cast< const __m128i* >( pTexels ) );
+    const __m128i b = _mm_loadu_si128( reinterpret_cast< const __m128i* >( pTexels + 16 ) );
+    const __m128i c = _mm_loadu_si128( reinterpret_cast< const __m128i* >( pTexels + 32 ) );
+    const __m128i d = _mm_loadu_si128( reinterpret_cast< const __m128i* >( pTexels + 48 ) );
+    storeTexel( reduceMin( _mm_min_epu8( _mm_min_epu8( a, b ), _mm_min_epu8( c, d ) ) ), pMin );
+    storeTexel( reduceMax( _mm_max_epu8( _mm_max_epu8( a, b ), _mm_max_epu8( c, d ) ) ), pMax );
+}
+
+// the dot products of four texels - madd leaves rg and ba partial sums per texel
+__m128i dotSSE( const std::uint8_t* pTexels, __m128i origin, __m128i axis )
+{
+    const __m128i texels = _mm_loadu_si128( reinterpret_cast< const __m128i* >( pTexels ) );
+    const __m128i zero   = _mm_setzero_si128();
+    const __m128  lo     = _mm_castsi128_ps(
+        _mm_madd_epi16( _mm_sub_epi16( _mm_unpacklo_epi8( texels, zero ), origin ), axis ) );
+    const __m128 hi = _mm_castsi128_ps(
+        _mm_madd_epi16( _mm_sub_epi16( _mm_unpackhi_epi8( texels, zero ), origin ), axis ) );
+    return _mm_add_epi32( _mm_castps_si128( _mm_shuffle_ps( lo, hi, _MM_SHUFFLE( 2, 0, 2, 0 ) ) ),
+                          _mm_castps_si128( _mm_shuffle_ps( lo, hi, _MM_SHUFFLE( 3, 1, 3, 1 ) ) ) );
+}
+
+void projectSSE( const std::uint8_t* pTexels,
+                 const std::int16_t* pOrigin,
+                 const std::int16_t* pAxis,
+                 float               fScale,
+                 std::int16_t        iMaxIndex,
+                 std::uint8_t*       pIndices )
+{
+    std::int64_t iOrigin = 0, iAxis = 0;
+    std::memcpy( &iOrigin, pOrigin, sizeof( iOrigin ) );
+    std::memcpy( &iAxis, pAxis, sizeof( iAxis ) );
+    const __m128i origin   = _mm_set1_epi64x( iOrigin );
+    const __m128i axis     = _mm_set1_epi64x( iAxis );
+    const __m128  scale    = _mm_set1_ps( fScale );
+    const __m128i maxIndex = _mm_set1_epi16( iMaxIndex );
+
+    // eight texels saturate to 16 bits per pair of registers
+    __m128i halves[ 2 ];
+    for ( std::uint32_t uiHalf = 0; uiHalf != 2U; ++uiHalf )
+    {
+        const std::uint8_t* pHalf = pTexels + uiHalf * 32U;
+        const __m128i a = _mm_cvtps_epi32( _mm_mul_ps( _mm_cvtepi32_ps( dotSSE( pHalf, origin, axis ) ), scale ) );
+        const __m128i b = _mm_cvtps_epi32( _mm_mul_ps( _mm_cvtepi32_ps( dotSSE( pHalf + 16, origin, axis ) ), scale ) );
+        halves[ uiHalf ]
+            = _mm_min_epi16( _mm_max_epi16( _mm_packs_epi32( a, b ), _mm_setzero_si128() ), maxIndex );
+    }
+    _mm_storeu_si128( reinterpret_cast< __m128i* >( pIndices ), _mm_packus_epi16( halves[ 0 ], halves[ 1 ] ) );
+}
+
+// one texel per register as floats with the channels rotated by one and two for the products
+void momentsSSE( const std::uint8_t* pTexels, float* pSums, float* pProducts )
+{
+    const __m128i zero      = _mm_setzero_si128();
+    __m128        sums      = _mm_setzero_ps();
+    __m128        products0 = _mm_setzero_ps();
+    __m128        products1 = _mm_setzero_ps();
+    __m128        products2 = _mm_setzero_ps();
+    for ( std::uint32_t i = 0; i != kBlockTexels * 4U; i += 16U )
+    {
+        const __m128i texels = _mm_loadu_si128( reinterpret_cast< const __m128i* >( pTexels + i ) );
+        const __m128i lo     = _mm_unpacklo_epi8( texels, zero );
+        const __m128i hi     = _mm_unpackhi_epi8( texels, zero );
+        for ( const __m128i texel : { _mm_unpacklo_epi16( lo, zero ),
+                                      _mm_unpackhi_epi16( lo, zero ),
+                                      _mm_unpacklo_epi16( hi, zero ),
+                                      _mm_unpackhi_epi16( hi, zero ) } )
+        {
+            const __m128 channels = _mm_cvtepi32_ps( texel );
+            sums                  = _mm_add_ps( sums, channels );
+            products0             = _mm_add_ps( products0, _mm_mul_ps( channels, channels ) );
+            products1             = _mm_add_ps(
+                products1, _mm_mul_ps( channels, _mm_shuffle_ps( channels, channels, _MM_SHUFFLE( 0, 3, 2, 1 ) ) ) );
+            products2 = _mm_add_ps(
+                products2, _mm_mul_ps( channels, _mm_shuffle_ps( channels, channels, _MM_SHUFFLE( 1, 0, 3, 2 ) ) ) );
+        }
+    }
+    _mm_storeu_ps( pSums, sums );
+    _mm_storeu_ps( pProducts, products0 );
+    _mm_storeu_ps( pProducts + 4, products1 );
+    _mm_storeu_ps( pProducts + 8, products2 );
+}
+
+// sse2 has no 32 bit min or max
+__m128i min32( __m128i a, __m128i b )
+{
+    const __m128i less = _mm_cmplt_epi32( a, b );
+    return _mm_or_si128( _mm_and_si128( less, a ), _mm_andnot_si128( less, b ) );
+}
+
+__m128i max32( __m128i a, __m128i b )
+{
+    const __m128i greater = _mm_cmpgt_epi32( a, b );
+    return _mm_or_si128( _mm_and_si128( greater, a ), _mm_andnot_si128( greater, b ) );
+}
+
+void extentSSE( const std::uint8_t* pTexels, const std::int16_t* pAxis, std::int32_t* pMin, std::int32_t* pMax )
+{
+    std::int64_t iAxis = 0;
+    std::memcpy( &iAxis, pAxis, sizeof( iAxis ) );
+    const __m128i origin = _mm_setzero_si128();
+    const __m128i axis   = _mm_set1_epi64x( iAxis );
+
+    __m128i min = dotSSE( pTexels, origin, axis ), max = min;
+    for ( std::uint32_t i = 16U; i != kBlockTexels * 4U; i += 16U )
+    {
+        const __m128i dots = dotSSE( pTexels + i, origin, axis );
+        min                = min32( min, dots );
+        max                = max32( max, dots );
+    }
+    min   = min32( min, _mm_shuffle_epi32( min, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+    max   = max32( max, _mm_shuffle_epi32( max, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+    *pMin = _mm_cvtsi128_si32( min32( min, _mm_shuffle_epi32( min, _MM_SHUFFLE( 2, 3, 0, 1 ) ) ) );
+    *pMax = _mm_cvtsi128_si32( max32( max, _mm_shuffle_epi32( max, _MM_SHUFFLE( 2, 3, 0, 1 ) ) ) );
+}
+
+// eight texels per register
+RETAIL_TARGET_AVX2 void boundsAVX2( const std::uint8_t* pTexels, std::uint8_t* pMin, std::uint8_t* pMax )
+{
+    const __m256i a   = _mm256_loadu_si256( reinterpret_cast< const __m256i* >( pTexels ) );
+    const __m256i b   = _mm256_loadu_si256( reinterpret_cast< const __m256i* >( pTexels + 32 ) );
+    const __m256i min = _mm256_min_epu8( a, b );
+    const __m256i max = _mm256_max_epu8( a, b );
+    storeTexel( reduceMin( _mm_min_epu8( _mm256_castsi256_si128( min ), _mm256_extracti128_si256( min, 1 ) ) ), pMin );
+    storeTexel( reduceMax( _mm_max_epu8( _mm256_castsi256_si128( max ), _mm256_extracti128_si256( max, 1 ) ) ), pMax );
+}
+
+// the dot products of eight texels in the order 0 1 4 5 2 3 6 7 - madd and the pair shuffles work
+// within each 128 bit lane
+RETAIL_TARGET_AVX2 __m256i dotAVX2( const std::uint8_t* pTexels, __m256i origin, __m256i axis )
+{
+    const __m256 lo = _mm256_castsi256_ps( _mm256_madd_epi16(
+        _mm256_sub_epi16( _mm256_cvtepu8_epi16( _mm_loadu_si128( reinterpret_cast< const __m128i* >( pTexels ) ) ),
+                          origin ),
+        axis ) );
+    const __m256 hi = _mm256_castsi256_ps( _mm256_madd_epi16(
+        _mm256_sub_epi16(
+            _mm256_cvtepu8_epi16( _mm_loadu_si128( reinterpret_cast< const __m128i* >( pTexels + 16 ) ) ), origin ),
+        axis ) );
+    return _mm256_add_epi32( _mm256_castps_si256( _mm256_shuffle_ps( lo, hi, _MM_SHUFFLE( 2, 0, 2, 0 ) ) ),
+                             _mm256_castps_si256( _mm256_shuffle_ps( lo, hi, _MM_SHUFFLE( 3, 1, 3, 1 ) ) ) );
+}
+
+RETAIL_TARGET_AVX2 void projectAVX2( const std::uint8_t* pTexels,
+                                     const std::int16_t* pOrigin,
+                                     const std::int16_t* pAxis,
+                                     float               fScale,
+                                     std::int16_t        iMaxIndex,
+                                     std::uint8_t*       pIndices )
+{
+    std::int64_t iOrigin = 0, iAxis = 0;
+    std::memcpy( &iOrigin, pOrigin, sizeof( iOrigin ) );
+    std::memcpy( &iAxis, pAxis, sizeof( iAxis ) );
+    const __m256i origin   = _mm256_set1_epi64x( iOrigin );
+    const __m256i axis     = _mm256_set1_epi64x( iAxis );
+    const __m256  scale    = _mm256_set1_ps( fScale );
+    const __m256i maxIndex = _mm256_set1_epi16( iMaxIndex );
+
+    // texels 0 1 4 5 8 9 12 13 in the low lane and 2 3 6 7 10 11 14 15 in the high
+    const __m256i a
+        = _mm256_cvtps_epi32( _mm256_mul_ps( _mm256_cvtepi32_ps( dotAVX2( pTexels, origin, axis ) ), scale ) );
+    const __m256i b
+        = _mm256_cvtps_epi32( _mm256_mul_ps( _mm256_cvtepi32_ps( dotAVX2( pTexels + 32, origin, axis ) ), scale ) );
+    const __m256i indices
+        = _mm256_min_epi16( _mm256_max_epi16( _mm256_packs_epi32( a, b ), _mm256_setzero_si256() ), maxIndex );
+
+    // pairs of texels interleave back into order
+    const __m128i lo = _mm256_castsi256_si128( indices );
+    const __m128i hi = _mm256_extracti128_si256( indices, 1 );
+    _mm_storeu_si128( reinterpret_cast< __m128i* >( pIndices ),
+                      _mm_packus_epi16( _mm_unpacklo_epi32( lo, hi ), _mm_unpackhi_epi32( lo, hi ) ) );
+}
+
+// the sum of the two 128 bit lanes
+RETAIL_TARGET_AVX2 __m128 foldAVX2( __m256 value )
+{
+    return _mm_add_ps( _mm256_castps256_ps128( value ), _mm256_extractf128_ps( value, 1 ) );
+}
+
+// two texels per register as floats - the rotations stay within each 128 bit lane
+RETAIL_TARGET_AVX2 void momentsAVX2( const std::uint8_t* pTexels, float* pSums, float* pProducts )
+{
+    __m256 sums      = _mm256_setzero_ps();
+    __m256 products0 = _mm256_setzero_ps();
+    __m256 products1 = _mm256_setzero_ps();
+    __m256 products2 = _mm256_setzero_ps();
+    for ( std::uint32_t i = 0; i != kBlockTexels * 4U; i += 8U )
+    {
+        const __m256 channels = _mm256_cvtepi32_ps(
+            _mm256_cvtepu8_epi32( _mm_loadl_epi64( reinterpret_cast< const __m128i* >( pTexels + i ) ) ) );
+        sums      = _mm256_add_ps( sums, channels );
+        products0 = _mm256_fmadd_ps( channels, channels, products0 );
+        products1 = _mm256_fmadd_ps(
+            channels, _mm256_shuffle_ps( channels, channels, _MM_SHUFFLE( 0, 3, 2, 1 ) ), products1 );
+        products2 = _mm256_fmadd_ps(
+            channels, _mm256_shuffle_ps( channels, channels, _MM_SHUFFLE( 1, 0, 3, 2 ) ), products2 );
+    }
+    _mm_storeu_ps( pSums, foldAVX2( sums ) );
+    _mm_storeu_ps( pProducts, foldAVX2( products0 ) );
+    _mm_storeu_ps( pProducts + 4, foldAVX2( products1 ) );
+    _mm_storeu_ps( pProducts + 8, foldAVX2( products2 ) );
+}
+
+RETAIL_TARGET_AVX2 void
+extentAVX2( const std::uint8_t* pTexels, const std::int16_t* pAxis, std::int32_t* pMin, std::int32_t* pMax )
+{
+    std::int64_t iAxis = 0;
+    std::memcpy( &iAxis, pAxis, sizeof( iAxis ) );
+    const __m256i origin = _mm256_setzero_si256();
+    const __m256i axis   = _mm256_set1_epi64x( iAxis );
+
+    const __m256i a    = dotAVX2( pTexels, origin, axis );
+    const __m256i b    = dotAVX2( pTexels + 32, origin, axis );
+    const __m256i min  = _mm256_min_epi32( a, b );
+    const __m256i max  = _mm256_max_epi32( a, b );
+    __m128i       min4 = _mm_min_epi32( _mm256_castsi256_si128( min ), _mm256_extracti128_si256( min, 1 ) );
+    __m128i       max4 = _mm_max_epi32( _mm256_castsi256_si128( max ), _mm256_extracti128_si256( max, 1 ) );
+    min4               = _mm_min_epi32( min4, _mm_shuffle_epi32( min4, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+    max4               = _mm_max_epi32( max4, _mm_shuffle_epi32( max4, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+    *pMin = _mm_cvtsi128_si32( _mm_min_epi32( min4, _mm_shuffle_epi32( min4, _MM_SHUFFLE( 2, 3, 0, 1 ) ) ) );
+    *pMax = _mm_cvtsi128_si32( _mm_max_epi32( max4, _mm_shuffle_epi32( max4, _MM_SHUFFLE( 2, 3, 0, 1 ) ) ) );
+}
+#endif
+
+Kernels getKernels( SimdKernel kernel )
+{
+    VERIFY_RTE_MSG( isSupported( kernel ), "Compression kernel not supported: " << toString( kernel ) );
+    switch ( kernel )
+    {
+#ifdef RETAIL_SIMD_X86
+        case SimdKernel::eSSE:
+            return Kernels{ &boundsSSE, &projectSSE, &momentsSSE, &extentSSE };
+        case SimdKernel::eAVX2:
+            return Kernels{ &boundsAVX2, &projectAVX2, &momentsAVX2, &extentAVX2 };
+#endif
+        default:
+            return Kernels{ &boundsScalar, &projectScalar, &momentsScalar, &extentScalar };
+    }
+}
+
+// writes values least significant bit first as BC7 expects
+class BitWriter
+{
+public:
+    explicit BitWriter( std::uint8_t* pBlock )
+        : m_pBlock( pBlock )
+    {
+    }
+
+    void write( std::uint32_t uiValue, std::uint32_t uiBits )
+    {
+        for ( std::uint32_t i = 0; i != uiBits; ++i, ++m_uiBit )
+            m_pBlock[ m_uiBit / 8U ] |= static_cast< std::uint8_t >( ( ( uiValue >> i ) & 1U ) << ( m_uiBit % 8U ) );
+    }
+
+private:
+    std::uint8_t* m_pBlock;
+    std::uint32_t m_uiBit = 0U;
+};
+
+std::uint32_t quantise( std::uint32_t uiValue, std::uint32_t uiMax ) { return ( uiValue * uiMax + 127U ) / 255U; }
+
+std::int16_t expand5( std::uint32_t ui ) { return static_cast< std::int16_t >( ( ui << 3U ) | ( ui >> 2U ) ); }
+std::int16_t expand6( std::uint32_t ui ) { return static_cast< std::int16_t >( ( ui << 2U ) | ( ui >> 4U ) ); }
+
+std::array< std::uint32_t, 3 > quantise565( const std::array< std::uint32_t, 3 >& colour )
+{
+    return { quantise( colour[ 0 ], 31U ), quantise( colour[ 1 ], 63U ), quantise( colour[ 2 ], 31U ) };
+}
+
+std::uint16_t pack565( const std::array< std::uint32_t, 3 >& colour )
+{
+    return static_cast< std::uint16_t >( ( colour[ 0 ] << 11U ) | ( colour[ 1 ] << 5U ) | colour[ 2 ] );
+}
+
+// 4 colour mode - colour0 the larger so indices 0 and 1 are the endpoints and 2 and 3 the thirds
+void encodeColour( const std::uint8_t* pTexels,
+                   const std::uint8_t* pMin,
+                   const std::uint8_t* pMax,
+                   const Kernels&      kernels,
+                   std::uint8_t*       pBlock )
+{
+    // inset by a sixteenth so the interpolated colours land inside the range rather than on its ends
+    std::array< std::uint32_t, 3 > hi, lo;
+    for ( std::uint32_t c = 0; c != 3U; ++c )
+    {
+        const std::uint32_t uiInset = ( static_cast< std::uint32_t >( pMax[ c ] ) - pMin[ c ] ) >> 4U;
+        hi[ c ]                     = pMax[ c ] - uiInset;
+        lo[ c ]                     = pMin[ c ] + uiInset;
+    }
+    const std::array< std::uint32_t, 3 > hi565     = quantise565( hi );
+    const std::array< std::uint32_t, 3 > lo565     = quantise565( lo );
+    const std::uint16_t                  uiColour0 = pack565( hi565 );
+    const std::uint16_t                  uiColour1 = pack565( lo565 );
+    std::memcpy( pBlock, &uiColour0, sizeof( uiColour0 ) );
+    std::memcpy( pBlock + 2, &uiColour1, sizeof( uiColour1 ) );
+
+    // the box's corners are ordered per channel so colour0 is never less than colour1 - equal is a
+    // solid block that index 0 covers
+    std::uint32_t uiIndices = 0U;
+    if ( uiColour0 != uiColour1 )
+    {
+        // projected from colour1 towards colour0 as the decoder expands them
+        const std::array< std::int16_t, 4 > origin{
+            expand5( lo565[ 0 ] ), expand6( lo565[ 1 ] ), expand5( lo565[ 2 ] ), 0 };
+        const std::array< std::int16_t, 4 > axis{ static_cast< std::int16_t >( expand5( hi565[ 0 ] ) - origin[ 0 ] ),
+                                                  static_cast< std::int16_t >( expand6( hi565[ 1 ] ) - origin[ 1 ] ),
+                                                  static_cast< std::int16_t >( expand5( hi565[ 2 ] ) - origin[ 2 ] ),
+                                                  0 };
+        const std::int32_t iLengthSquared = axis[ 0 ] * axis[ 0 ] + axis[ 1 ] * axis[ 1 ] + axis[ 2 ] * axis[ 2 ];
+        std::array< std::uint8_t, kBlockTexels > steps;
+        kernels.pfnProject(
+            pTexels, origin.data(), axis.data(), 3.0f / static_cast< float >( iLengthSquared ), 3, steps.data() );
+
+        constexpr std::array< std::uint32_t, 4 > kStepIndices{ 1U, 3U, 2U, 0U };
+        for ( std::uint32_t i = 0; i != kBlockTexels; ++i )
+            uiIndices |= kStepIndices[ steps[ i ] ] << ( i * 2U );
+    }
+    std::memcpy( pBlock + 4, &uiIndices, sizeof( uiIndices ) );
+}
+
+// 8 alpha mode - alpha0 the larger so indices 0 and 1 are the endpoints and 2 to 7 the sevenths
+void encodeAlpha( const std::uint8_t* pTexels,
+                  const std::uint8_t* pMin,
+                  const std::uint8_t* pMax,
+                  const Kernels&      kernels,
+                  std::uint8_t*       pBlock )
+{
+    pBlock[ 0 ] = pMax[ 3 ];
+    pBlock[ 1 ] = pMin[ 3 ];
+
+    std::uint64_t uiIndices = 0U;
+    if ( pMax[ 3 ] != pMin[ 3 ] )
+    {
+        const std::array< std::int16_t, 4 > origin{ 0, 0, 0, pMin[ 3 ] };
+        const std::array< std::int16_t, 4 > axis{ 0, 0, 0, static_cast< std::int16_t >( pMax[ 3 ] - pMin[ 3 ] ) };
+        const float                              fScale = 7.0f / static_cast< float >( axis[ 3 ] * axis[ 3 ] );
+        std::array< std::uint8_t, kBlockTexels > steps;
+        kernels.pfnProject( pTexels, origin.data(), axis.data(), fScale, 7, steps.data() );
+
+        constexpr std::array< std::uint64_t, 8 > kStepIndices{ 1U, 7U, 6U, 5U, 4U, 3U, 2U, 0U };
+        for ( std::uint32_t i = 0; i != kBlockTexels; ++i )
+            uiIndices |= kStepIndices[ steps[ i ] ] << ( i * 3U );
+    }
+    for ( std::uint32_t i = 0; i != 6U; ++i )
+        pBlock[ 2U + i ] = static_cast< std::uint8_t >( uiIndices >> ( i * 8U ) );
+}
+
+void encodeBC1( const std::uint8_t* pTexels, const Kernels& kernels, std::uint8_t* pBlock )
+{
+    std::array< std::uint8_t, 4 > min, max;
+    kernels.pfnBounds( pTexels, min.data(), max.data() );
+    encodeColour( pTexels, min.data(), max.data(), kernels, pBlock );
+}
+
+void encodeBC3( const std::uint8_t* pTexels, const Kernels& kernels, std::uint8_t* pBlock )
+{
+    std::array< std::uint8_t, 4 > min, max;
+    kernels.pfnBounds( pTexels, min.data(), max.data() );
+    encodeAlpha( pTexels, min.data(), max.data(), kernels, pBlock );
+    encodeColour( pTexels, min.data(), max.data(), kernels, pBlock + 8 );
+}
+
+// the closest 7 bit value and shared low bit to each channel of an endpoint
+void quantiseEndpoint( const std::array< float, 4 >& endpoint,
+                       std::array< std::uint32_t, 4 >& quantised,
+                       std::uint32_t&                 uiPBit )
+{
+    float fBestError = std::numeric_limits< float >::max();
+    for ( std::uint32_t uiBit = 0; uiBit != 2U; ++uiBit )
+    {
+        std::array< std::uint32_t, 4 > candidate;
+        float                          fError = 0.0f;
+        for ( std::uint32_t c = 0; c != 4U; ++c )
+        {
+            const float fValue = ( endpoint[ c ] - static_cast< float >( uiBit ) ) * 0.5f;
+            candidate[ c ]     = static_cast< std::uint32_t >( std::clamp( fValue + 0.5f, 0.0f, 127.0f ) );
+            const float fDelta = static_cast< float >( candidate[ c ] * 2U + uiBit ) - endpoint[ c ];
+            fError += fDelta * fDelta;
+        }
+        if ( fError < fBestError )
+        {
+            fBestError = fError;
+            quantised  = candidate;
+            uiPBit     = uiBit;
+        }
+    }
+}
+
+// mode 6 - 7 bit rgba endpoints each with a low bit and 4 bit indices
+void encodeBC7( const std::uint8_t* pTexels, const Kernels& kernels, std::uint8_t* pBlock )
+{
+    std::array< std::uint8_t, 4 > min, max;
+    kernels.pfnBounds( pTexels, min.data(), max.data() );
+
+    // the covariance scaled by the texel count - every term is an integer below 2^24 so it is exact
+    // and the same in every kernel
+    std::array< float, 4 >                  sums, mean;
+    std::array< float, 12 >                 products;
+    std::array< std::array< float, 4 >, 4 > covariance;
+    kernels.pfnMoments( pTexels, sums.data(), products.data() );
+    for ( std::uint32_t c = 0; c != 4U; ++c )
+    {
+        mean[ c ] = sums[ c ] / static_cast< float >( kBlockTexels );
+        for ( std::uint32_t k = 0; k != 3U; ++k )
+        {
+            const std::uint32_t uiOther = ( c + k ) % 4U;
+            covariance[ c ][ uiOther ]  = static_cast< float >( kBlockTexels ) * products[ k * 4U + c ]
+                                         - sums[ c ] * sums[ uiOther ];
+            covariance[ uiOther ][ c ] = covariance[ c ][ uiOther ];
+        }
+    }
+
+    // the principal axis by power iteration on the covariance, starting from the box's diagonal
+    std::array< float, 4 > axis;
+    for ( std::uint32_t c = 0; c != 4U; ++c )
+        axis[ c ] = static_cast< float >( max[ c ] - min[ c ] );
+    for ( std::uint32_t uiIteration = 0; uiIteration != 4U; ++uiIteration )
+    {
+        std::array< float, 4 > next{};
+        float                  fLargest = 0.0f;
+        for ( std::uint32_t r = 0; r != 4U; ++r )
+        {
+            for ( std::uint32_t c = 0; c != 4U; ++c )
+                next[ r ] += covariance[ r ][ c ] * axis[ c ];
+            fLargest = std::max( fLargest, std::abs( next[ r ] ) );
+        }
+        if ( fLargest == 0.0f )
+            break;
+        for ( std::uint32_t c = 0; c != 4U; ++c )
+            axis[ c ] = next[ c ] / fLargest;
+    }
+    const float fAxisLargest
+        = std::max( { std::abs( axis[ 0 ] ), std::abs( axis[ 1 ] ), std::abs( axis[ 2 ] ), std::abs( axis[ 3 ] ) } );
+
+    // the extent of the texels along the axis - a solid block has none.  The axis is rounded to
+    // integers so the texels' projections onto it are exact
+    std::array< float, 4 > endpoint0 = mean, endpoint1 = mean;
+    if ( fAxisLargest > 0.0f )
+    {
+        constexpr float               kAxisScale = 1024.0f;
+        std::array< std::int16_t, 4 > integerAxis;
+        float                         fLengthSquared = 0.0f, fMeanDot = 0.0f;
+        for ( std::uint32_t c = 0; c != 4U; ++c )
+        {
+            integerAxis[ c ] = static_cast< std::int16_t >( std::lround( axis[ c ] / fAxisLargest * kAxisScale ) );
+            fLengthSquared += static_cast< float >( integerAxis[ c ] * integerAxis[ c ] );
+            fMeanDot += mean[ c ] * integerAxis[ c ];
+        }
+        std::int32_t iMin = 0, iMax = 0;
+        kernels.pfnExtent( pTexels, integerAxis.data(), &iMin, &iMax );
+        const float fMin = ( static_cast< float >( iMin ) - fMeanDot ) / fLengthSquared;
+        const float fMax = ( static_cast< float >( iMax ) - fMeanDot ) / fLengthSquared;
+        for ( std::uint32_t c = 0; c != 4U; ++c )
+        {
+            endpoint0[ c ] = std::clamp( mean[ c ] + integerAxis[ c ] * fMin, 0.0f, 255.0f );
+            endpoint1[ c ] = std::clamp( mean[ c ] + integerAxis[ c ] * fMax, 0.0f, 255.0f );
+        }
+    }
+
+    std::array< std::array< std::uint32_t, 4 >, 2 > quantised;
+    std::array< std::uint32_t, 2 >                   pBits;
+    quantiseEndpoint( endpoint0, quantised[ 0 ], pBits[ 0 ] );
+    quantiseEndpoint( endpoint1, quantised[ 1 ], pBits[ 1 ] );
+
+    // projected between the endpoints as the decoder expands them - its 4 bit weights are within
+    // rounding of sixteenths of the way
+    std::array< std::uint8_t, kBlockTexels > indices{};
+    std::array< std::int16_t, 4 >            origin, delta;
+    std::int32_t                             iLengthSquared = 0;
+    for ( std::uint32_t c = 0; c != 4U; ++c )
+    {
+        origin[ c ] = static_cast< std::int16_t >( quantised[ 0 ][ c ] * 2U + pBits[ 0 ] );
+        delta[ c ]  = static_cast< std::int16_t >( quantised[ 1 ][ c ] * 2U + pBits[ 1 ] - origin[ c ] );
+        iLengthSquared += delta[ c ] * delta[ c ];
+    }
+    if ( iLengthSquared != 0 )
+    {
+        kernels.pfnProject(
+            pTexels, origin.data(), delta.data(), 15.0f / static_cast< float >( iLengthSquared ), 15, indices.data() );
+    }
+
+    // the first texel's index has an implied zero top bit - swapping the endpoints flips the indices
+    if ( indices[ 0 ] & 8U )
+    {
+        std::swap( quantised[ 0 ], quantised[ 1 ] );
+        std::swap( pBits[ 0 ], pBits[ 1 ] );
+        for ( std::uint8_t& uiIndex : indices )
+            uiIndex = static_cast< std::uint8_t >( 15U - uiIndex );
+    }
+
+    std::memset( pBlock, 0, 16U );
+    BitWriter writer( pBlock );
+    writer.write( 1U << 6U, 7U );
+    for ( std::uint32_t c = 0; c != 4U; ++c )
+    {
+        writer.write( quantised[ 0 ][ c ], 7U );
+        writer.write( quantised[ 1 ][ c ], 7U );
+    }
+    writer.write( pBits[ 0 ], 1U );
+    writer.write( pBits[ 1 ], 1U );
+    writer.write( indices[ 0 ], 3U );
+    for ( std::uint32_t i = 1; i != kBlockTexels; ++i )
+        writer.write( indices[ i ], 4U );
+}
+
+// IEC 61966-2-1 transfer functions
+float toLinear( float fValue )
+{
+    return fValue <= 0.04045f ? fValue / 12.92f : std::pow( ( fValue + 0.055f ) / 1.055f, 2.4f );
+}
+
+float toSrgb( float fValue )
+{
+    return fValue <= 0.0031308f ? fValue * 12.92f : 1.055f * std::pow( fValue, 1.0f / 2.4f ) - 0.055f;
+}
+
+// skips whitespace and # comments then returns the next whitespace delimited token
+std::string nextToken( const std::uint8_t*& pCursor, const std::uint8_t* pEnd )
+{
+    while ( pCursor != pEnd && ( std::isspace( *pCursor ) || *pCursor == '#' ) )
+    {
+        if ( *pCursor == '#' )
+        {
+            while ( pCursor != pEnd && *pCursor != '\n' )
+                ++pCursor;
+        }
+        else
+        {
+            ++pCursor;
+        }
+    }
+    const std::uint8_t* pStart = pCursor;
+    while ( pCursor != pEnd && !std::isspace( *pCursor ) )
+        ++pCursor;
+    return std::string( pStart, pCursor );
+}
+
+std::uint32_t parseDimension( const std::string& strToken, const boost::filesystem::path& filePath )
+{
+    VERIFY_RTE_MSG( !strToken.empty() && strToken.find_first_not_of( "0123456789" ) == std::string::npos
+                        && strToken.size() < 10U,
+                    "Invalid image header value: " << strToken << " in: " << filePath.string() );
+    return static_cast< std::uint32_t >( std::stoul( strToken ) );
+}
+} // namespace
+
+Image loadImage( const boost::filesystem::path& filePath )
+{
+    MappedFile          file( filePath );
+    const std::uint8_t* pCursor = file.data();
+    const std::uint8_t* pEnd    = file.data() + file.size();
+
+    Image               image;
+    std::uint32_t       uiDepth    = 0U;
+    std::uint32_t       uiMaxValue = 0U;
+    const std::string   strMagic   = nextToken( pCursor, pEnd );
+    if ( strMagic == "P6" )
+    {
+        image.uiWidth  = parseDimension( nextToken( pCursor, pEnd ), filePath );
+        image.uiHeight = parseDimension( nextToken( pCursor, pEnd ), filePath );
+        uiMaxValue     = parseDimension( nextToken( pCursor, pEnd ), filePath );
+        uiDepth        = 3U;
+    }
+    else if ( strMagic == "P7" )
+    {
+        for ( std::string strToken = nextToken( pCursor, pEnd ); strToken != "ENDHDR";
+              strToken             = nextToken( pCursor, pEnd ) )
+        {
+            VERIFY_RTE_MSG( !strToken.empty(), "Truncated image header: " << filePath.string() );
+            if ( strToken == "WIDTH" )
+                image.uiWidth = parseDimension( nextToken( pCursor, pEnd ), filePath );
+            else if ( strToken == "HEIGHT" )
+                image.uiHeight = parseDimension( nextToken( pCursor, pEnd ), filePath );
+            else if ( strToken == "DEPTH" )
+                uiDepth = parseDimension( nextToken( pCursor, pEnd ), filePath );
+            else if ( strToken == "MAXVAL" )
+                uiMaxValue = parseDimension( nextToken( pCursor, pEnd ), filePath );
+            else if ( strToken == "TUPLTYPE" )
+                nextToken( pCursor, pEnd ); // implied by the depth
+            else
+                THROW_RTE( "Unknown image header field: " << strToken << " in: " << filePath.string() );
+        }
+    }
+    else
+    {
+        THROW_RTE( "Not a binary ppm or pam image: " << filePath.string() );
+    }
+    VERIFY_RTE_MSG( image.uiWidth > 0U && image.uiHeight > 0U && uiMaxValue == 255U
+                        && ( uiDepth == 3U || uiDepth == 4U ),
+                    "Unsupported image - 8 bit rgb or rgba is required: " << filePath.string() );
+
+    // a single whitespace character separates the header from the texels
+    VERIFY_RTE_MSG( pCursor != pEnd, "Truncated image: " << filePath.string() );
+    ++pCursor;
+    const std::size_t szTexels = static_cast< std::size_t >( image.uiWidth ) * image.uiHeight;
+    VERIFY_RTE_MSG( static_cast< std::size_t >( pEnd - pCursor ) >= szTexels * uiDepth,
+                    "Truncated image: " << filePath.string() );
+
+    image.texels.resize( szTexels * 4U );
+    for ( std::size_t i = 0; i != szTexels; ++i )
+    {
+        std::memcpy( &image.texels[ i * 4U ], pCursor + i * uiDepth, uiDepth );
+        if ( uiDepth == 3U )
+            image.texels[ i * 4U + 3U ] = 0xFFU;
+    }
+    return image;
+}
+
+std::vector< Image > generateMips( const Image& image, bool bSrgb, WorkerPool* pWorkers )
+{
+    std::array< float, 256 > linear;
+    for ( std::uint32_t i = 0; i != 256U; ++i )
+        linear[ i ] = bSrgb ? toLinear( static_cast< float >( i ) / 255.0f ) : static_cast< float >( i ) / 255.0f;
+
+    std::vector< Image > mips{ image };
+    while ( ( mips.back().uiWidth > 1U || mips.back().uiHeight > 1U ) && mips.size() < texture::kMaxMips )
+    {
+        Image        mip;
+        const Image& source = mips.back();
+        mip.uiWidth         = std::max( source.uiWidth / 2U, 1U );
+        mip.uiHeight        = std::max( source.uiHeight / 2U, 1U );
+        mip.texels.resize( static_cast< std::size_t >( mip.uiWidth ) * mip.uiHeight * 4U );
+
+        // odd dimensions drop the last row or column
+        auto filterRows = [ & ]( std::uint32_t uiBegin, std::uint32_t uiEnd )
+        {
+            for ( std::uint32_t y = uiBegin; y != uiEnd; ++y )
+            {
+                const std::uint32_t y0 = y * 2U, y1 = std::min( y0 + 1U, source.uiHeight - 1U );
+                for ( std::uint32_t x = 0; x != mip.uiWidth; ++x )
+                {
+                    const std::uint32_t x0 = x * 2U, x1 = std::min( x0 + 1U, source.uiWidth - 1U );
+                    const std::array< const std::uint8_t*, 4 > corners{
+                        &source.texels[ ( static_cast< std::size_t >( y0 ) * source.uiWidth + x0 ) * 4U ],
+                        &source.texels[ ( static_cast< std::size_t >( y0 ) * source.uiWidth + x1 ) * 4U ],
+                        &source.texels[ ( static_cast< std::size_t >( y1 ) * source.uiWidth + x0 ) * 4U ],
+                        &source.texels[ ( static_cast< std::size_t >( y1 ) * source.uiWidth + x1 ) * 4U ] };
+                    std::uint8_t* pTexel = &mip.texels[ ( static_cast< std::size_t >( y ) * mip.uiWidth + x ) * 4U ];
+                    for ( std::uint32_t c = 0; c != 3U; ++c )
+                    {
+                        const float fSum = linear[ corners[ 0 ][ c ] ] + linear[ corners[ 1 ][ c ] ]
+                                           + linear[ corners[ 2 ][ c ] ] + linear[ corners[ 3 ][ c ] ];
+                        const float fValue = bSrgb ? toSrgb( fSum * 0.25f ) : fSum * 0.25f;
+                        pTexel[ c ] = static_cast< std::uint8_t >( std::clamp( fValue, 0.0f, 1.0f ) * 255.0f + 0.5f );
+                    }
+                    pTexel[ 3 ] = static_cast< std::uint8_t >(
+                        ( corners[ 0 ][ 3 ] + corners[ 1 ][ 3 ] + corners[ 2 ][ 3 ] + corners[ 3 ][ 3 ] + 2U ) / 4U );
+                }
+            }
+        };
+        if ( pWorkers )
+            pWorkers->parallelFor( mip.uiHeight, 16U, filterRows );
+        else
+            filterRows( 0U, mip.uiHeight );
+        mips.push_back( std::move( mip ) );
+    }
+    return mips;
+}
+
+std::vector< std::uint8_t >
+compressImage( const Image& image, texture::Format format, SimdKernel kernel, WorkerPool* pWorkers )
+{
+    using EncodeFunction = void ( * )( const std::uint8_t*, const Kernels&, std::uint8_t* );
+    const EncodeFunction pfnEncode = format == texture::Format::eBC1   ? &encodeBC1
+                                     : format == texture::Format::eBC3 ? &encodeBC3
+                                                                       : &encodeBC7;
+    const Kernels       kernels      = getKernels( kernel );
+    const std::uint32_t uiBlockBytes = texture::getBlockBytes( format );
+    const std::uint32_t uiBlocksX    = ( image.uiWidth + texture::kBlockSize - 1U ) / texture::kBlockSize;
+    const std::uint32_t uiBlocksY    = ( image.uiHeight + texture::kBlockSize - 1U ) / texture::kBlockSize;
+
+    std::vector< std::uint8_t > blocks( static_cast< std::size_t >( uiBlocksX ) * uiBlocksY * uiBlockBytes );
+    auto                        encodeRows = [ & ]( std::uint32_t uiBegin, std::uint32_t uiEnd )
+    {
+        std::array< std::uint8_t, kBlockTexels * 4U > texels;
+        for ( std::uint32_t uiBlockY = uiBegin; uiBlockY != uiEnd; ++uiBlockY )
+        {
+            for ( std::uint32_t uiBlockX = 0; uiBlockX != uiBlocksX; ++uiBlockX )
+            {
+                for ( std::uint32_t i = 0; i != kBlockTexels; ++i )
+                {
+                    const std::uint32_t x = std::min( uiBlockX * texture::kBlockSize + i % texture::kBlockSize,
+                                                      image.uiWidth - 1U );
+                    const std::uint32_t y = std::min( uiBlockY * texture::kBlockSize + i / texture::kBlockSize,
+                                                      image.uiHeight - 1U );
+                    std::memcpy( &texels[ i * 4U ],
+                                 &image.texels[ ( static_cast< std::size_t >( y ) * image.uiWidth + x ) * 4U ],
+                                 4U );
+                }
+                const std::size_t szBlock = static_cast< std::size_t >( uiBlockY ) * uiBlocksX + uiBlockX;
+                pfnEncode( texels.data(), kernels, &blocks[ szBlock * uiBlockBytes ] );
+            }
+        }
+    };
+    if ( pWorkers )
+        pWorkers->parallelFor( uiBlocksY, 1U, encodeRows );
+    else
+        encodeRows( 0U, uiBlocksY );
+    return blocks;
+}
+
+} // namespace tools
+} // namespace retail
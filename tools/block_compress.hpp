@@ -0,0 +1,48 @@
+#ifndef BLOCK_COMPRESS_19_OCTOBER_2022
+#define BLOCK_COMPRESS_19_OCTOBER_2022
+
+#include "simd.hpp"
+#include "texture_file.hpp"
+#include "worker_pool.hpp"
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace retail
+{
+namespace tools
+{
+    // rgba8 texels in rows with red in the first byte
+    struct Image
+    {
+        std::uint32_t               uiWidth  = 0U;
+        std::uint32_t               uiHeight = 0U;
+        std::vector< std::uint8_t > texels;
+    };
+
+    // binary netpbm - ppm (P6) or pam (P7) with a maximum value of 255 and rgb or rgb_alpha
+    // tuples.  rgb images are made opaque.
+    Image loadImage( const boost::filesystem::path& filePath );
+
+    // the image followed by every mip down to 1x1 or texture::kMaxMips in all, each a 2x2 box filter
+    // of the one before.  With bSrgb the colour channels are averaged as linear light.
+    std::vector< Image > generateMips( const Image& image, bool bSrgb, WorkerPool* pWorkers );
+
+    // Encodes the 4x4 blocks covering the image in rows - edge blocks repeat the last column and row.
+    //
+    // BC1 and BC3 colour fit an inset bounding box and BC3 alpha its range.  BC7 uses mode 6 only -
+    // one subset of rgba endpoints along the block's principal axis with 16 levels - which suits
+    // photographic product images.  The per texel work runs in the given kernel - channel bounds,
+    // BC7's channel sums and products for the covariance and the extent of the texels along its
+    // principal axis, and projecting texels onto the endpoints to find their indices.  It is exact
+    // so every kernel produces the same blocks.  The remaining per block fit is scalar.  Rows of
+    // blocks are spread across the workers when given.
+    std::vector< std::uint8_t >
+    compressImage( const Image& image, texture::Format format, SimdKernel kernel, WorkerPool* pWorkers );
+
+} // namespace tools
+} // namespace retail
+
+#endif // BLOCK_COMPRESS_19_OCTOBER_2022
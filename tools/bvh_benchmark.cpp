@@ -0,0 +1,229 @@
+#include "bvh_culler.hpp"
+#include "worker_pool.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+// every box intersecting the frustum by the culler's own plane test - no hierarchy so nothing to
+// get wrong
+std::vector< std::uint32_t > bruteForceCull( const std::vector< retail::Aabb >&  bounds,
+                                             const retail::BvhCuller::Frustum& frustum )
+{
+    std::vector< std::uint32_t > visible;
+    for ( std::uint32_t i = 0; i != static_cast< std::uint32_t >( bounds.size() ); ++i )
+    {
+        const retail::Aabb& box      = bounds[ i ];
+        bool                bOutside = false;
+        for ( const std::array< float, 4 >& plane : frustum.planes )
+        {
+            const float fFar = plane[ 0 ] * ( plane[ 0 ] >= 0.0f ? box.max.x : box.min.x )
+                               + plane[ 1 ] * ( plane[ 1 ] >= 0.0f ? box.max.y : box.min.y )
+                               + plane[ 2 ] * ( plane[ 2 ] >= 0.0f ? box.max.z : box.min.z ) + plane[ 3 ];
+            bOutside = bOutside || fFar < 0.0f;
+        }
+        if ( !bOutside )
+            visible.push_back( i );
+    }
+    return visible;
+}
+} // namespace
+
+// Bounding volume hierarchy culling benchmark - checks BvhCuller against a brute force test of every
+// box on a random scene through each kernel the cpu supports, on one thread and across the worker
+// pool, before and after moving some of the boxes and refitting, and times each
+int main( int argc, const char* argv[] )
+{
+    namespace po = boost::program_options;
+    using namespace retail;
+
+    try
+    {
+        std::uint32_t uiObjects = 100000U;
+        std::uint32_t uiViews   = 16U;
+        float         fMoved    = 10.0f;
+        std::uint32_t uiRepeats = 10U;
+        std::uint32_t uiWorkers = WorkerPool::getDefaultWorkerCount();
+
+        po::options_description options( "bvh_benchmark options" );
+        // clang-format off
+        options.add_options()
+            ( "help",       "Produce help message" )
+            ( "objects",    po::value< std::uint32_t >( &uiObjects )->default_value( uiObjects ), "Boxes in the scene" )
+            ( "views",      po::value< std::uint32_t >( &uiViews )->default_value( uiViews ),
+                            "Random cameras culled per repeat" )
+            ( "moved",      po::value< float >( &fMoved )->default_value( fMoved ),
+                            "Percentage of boxes moved before the refit" )
+            ( "repeats",    po::value< std::uint32_t >( &uiRepeats )->default_value( uiRepeats ),
+                            "Timed repeats - the best is reported" )
+            ( "workers",    po::value< std::uint32_t >( &uiWorkers )->default_value( uiWorkers ),
+                            "Worker threads in addition to the main thread" )
+            ;
+        // clang-format on
+
+        po::variables_map vm;
+        po::store( po::parse_command_line( argc, argv, options ), vm );
+        po::notify( vm );
+
+        if ( vm.count( "help" ) )
+        {
+            std::cout << options << std::endl;
+            return 0;
+        }
+        if ( uiObjects == 0U || uiViews == 0U || uiRepeats == 0U || fMoved < 0.0f || fMoved > 100.0f )
+        {
+            SPDLOG_ERROR( "Invalid options" );
+            return 1;
+        }
+
+        // boxes of varied size scattered through a cube the cameras look around from inside
+        constexpr float                         kWorldSize = 200.0f;
+        std::mt19937                            random( 1234U );
+        std::uniform_real_distribution< float > position( -kWorldSize * 0.5f, kWorldSize * 0.5f );
+        std::uniform_real_distribution< float > size( 0.1f, 2.0f );
+        auto randomBox = [ & ]()
+        {
+            const Vec3 centre{ position( random ), position( random ), position( random ) };
+            const Vec3 halfSize{ size( random ), size( random ), size( random ) };
+            return Aabb{ centre - halfSize, centre + halfSize };
+        };
+        std::vector< Aabb > bounds( uiObjects );
+        for ( Aabb& box : bounds )
+            box = randomBox();
+
+        std::vector< BvhCuller::Frustum > frusta( uiViews );
+        for ( BvhCuller::Frustum& frustum : frusta )
+        {
+            const Vec3 eye{ position( random ), position( random ), position( random ) };
+            const Vec3 target{ position( random ), position( random ), position( random ) };
+            frustum = BvhCuller::extractFrustum( perspective( 1.0f, 16.0f / 9.0f, 0.1f, kWorldSize * 0.5f )
+                                                 * lookAt( eye, target, Vec3{ 0.0f, 1.0f, 0.0f } ) );
+        }
+
+        BvhCuller culler;
+        {
+            const auto startTime = std::chrono::steady_clock::now();
+            culler.build( bounds );
+            SPDLOG_INFO( "BVH benchmark: {} objects {} nodes build: {:.2f}ms",
+                         culler.getObjectCount(),
+                         culler.getNodeCount(),
+                         std::chrono::duration< double, std::milli >( std::chrono::steady_clock::now() - startTime )
+                             .count() );
+        }
+
+        WorkerPool workers( uiWorkers );
+
+        using Clock = std::chrono::steady_clock;
+        auto timeViews = [ & ]( auto&& cull )
+        {
+            std::chrono::nanoseconds best = std::chrono::nanoseconds::max();
+            for ( std::uint32_t i = 0; i != uiRepeats; ++i )
+            {
+                const auto startTime = Clock::now();
+                for ( const BvhCuller::Frustum& frustum : frusta )
+                    cull( frustum );
+                best = std::min( best,
+                                 std::chrono::duration_cast< std::chrono::nanoseconds >( Clock::now() - startTime ) );
+            }
+            return static_cast< double >( best.count() ) / 1000000.0 / uiViews;
+        };
+
+        std::uint32_t uiMismatches = 0U;
+        auto          check        = [ & ]( const char* pszStage )
+        {
+            std::vector< std::vector< std::uint32_t > > reference;
+            const double fBruteForceMS = timeViews( [ & ]( const BvhCuller::Frustum& frustum )
+                                                    { bruteForceCull( bounds, frustum ); } );
+            std::uint64_t uiVisible = 0U;
+            for ( const BvhCuller::Frustum& frustum : frusta )
+            {
+                reference.push_back( bruteForceCull( bounds, frustum ) );
+                uiVisible += reference.back().size();
+            }
+            SPDLOG_INFO( "{}: brute force {:.3f}ms per view - {:.1f} visible per view",
+                         pszStage,
+                         fBruteForceMS,
+                         static_cast< double >( uiVisible ) / uiViews );
+
+            std::vector< std::uint32_t > visible;
+            for ( SimdKernel kernel : { SimdKernel::eScalar, SimdKernel::eSSE, SimdKernel::eAVX2 } )
+            {
+                if ( !isSupported( kernel ) )
+                {
+                    SPDLOG_INFO( "{}: not supported", toString( kernel ) );
+                    continue;
+                }
+                culler.setKernel( kernel );
+
+                // the objects come back in hierarchy order so both are sorted before comparing
+                std::uint32_t uiDiffering = 0U;
+                for ( WorkerPool* pWorkers : { static_cast< WorkerPool* >( nullptr ), &workers } )
+                {
+                    for ( std::uint32_t uiView = 0; uiView != uiViews; ++uiView )
+                    {
+                        culler.cull( frusta[ uiView ], visible, pWorkers );
+                        std::sort( visible.begin(), visible.end() );
+                        uiDiffering += visible == reference[ uiView ] ? 0U : 1U;
+                    }
+                }
+                uiMismatches += uiDiffering;
+
+                const double fSingleMS = timeViews( [ & ]( const BvhCuller::Frustum& frustum )
+                                                    { culler.cull( frustum, visible ); } );
+                const double fParallelMS = timeViews( [ & ]( const BvhCuller::Frustum& frustum )
+                                                      { culler.cull( frustum, visible, &workers ); } );
+                SPDLOG_INFO( "{} {}: {:.3f}ms per view {:.1f}x brute force - {} threads {:.3f}ms - {}",
+                             pszStage,
+                             toString( kernel ),
+                             fSingleMS,
+                             fBruteForceMS / fSingleMS,
+                             workers.getThreadCount(),
+                             fParallelMS,
+                             uiDiffering == 0U ? "matches brute force" : "DIFFERS FROM BRUTE FORCE" );
+            }
+        };
+
+        check( "built" );
+
+        // moved boxes jump anywhere so the refit grows the hierarchy's bounds well past a rebuild's
+        const std::uint32_t uiMoved = static_cast< std::uint32_t >( uiObjects * fMoved / 100.0f );
+        std::uniform_int_distribution< std::uint32_t > pick( 0U, uiObjects - 1U );
+        for ( std::uint32_t i = 0; i != uiMoved; ++i )
+        {
+            const std::uint32_t uiObject = pick( random );
+            bounds[ uiObject ]           = randomBox();
+            culler.setBounds( uiObject, bounds[ uiObject ] );
+        }
+        {
+            const auto          startTime = Clock::now();
+            const std::uint32_t uiRefits  = culler.refit();
+            SPDLOG_INFO( "BVH benchmark: moved {} objects refit {} nodes: {:.3f}ms",
+                         uiMoved,
+                         uiRefits,
+                         std::chrono::duration< double, std::milli >( Clock::now() - startTime ).count() );
+        }
+
+        check( "refitted" );
+
+        if ( uiMismatches != 0U )
+        {
+            SPDLOG_ERROR( "{} culls differ from brute force", uiMismatches );
+            return 1;
+        }
+    }
+    catch ( std::exception& ex )
+    {
+        SPDLOG_ERROR( "Exception: {}", ex.what() );
+        return 1;
+    }
+    return 0;
+}
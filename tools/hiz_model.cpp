@@ -0,0 +1,282 @@
+#include "spdlog/spdlog.h"
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace
+{
+struct Level
+{
+    std::int32_t         iWidth;
+    std::int32_t         iHeight;
+    std::vector< float > texels;
+
+    float get( std::int32_t x, std::int32_t y ) const { return texels[ static_cast< std::size_t >( y ) * iWidth + x ]; }
+};
+
+// the depth followed by the pyramid levels - level i of the pyramid is levels[ i + 1 ]
+using Pyramid = std::vector< Level >;
+
+// levelExtent and levelCount in occlusion_culler.cpp - level 0 is half the depth and the last is 1x1
+std::int32_t levelSize( std::int32_t iSize, std::int32_t iLevel ) { return std::max( iSize >> iLevel, 1 ); }
+
+std::int32_t levelCount( std::int32_t iWidth, std::int32_t iHeight )
+{
+    std::int32_t iLevels = 1;
+    while ( ( iWidth >> iLevels ) != 0 || ( iHeight >> iLevels ) != 0 )
+        ++iLevels;
+    return iLevels;
+}
+
+// hiz_reduce.comp - the source texels under a destination texel along one axis
+std::array< std::int32_t, 2 > reduceRange( std::int32_t iTexel, std::int32_t iSize, std::int32_t iSourceSize )
+{
+    const std::int32_t iSourceMax = iSourceSize - 1;
+    return { std::min( iTexel * 2, iSourceMax ),
+             iTexel == iSize - 1 ? iSourceMax : std::min( iTexel * 2 + 1, iSourceMax ) };
+}
+
+Level reduce( const Level& source, std::int32_t iWidth, std::int32_t iHeight )
+{
+    Level level{ iWidth, iHeight, std::vector< float >( static_cast< std::size_t >( iWidth ) * iHeight ) };
+    for ( std::int32_t y = 0; y != iHeight; ++y )
+    {
+        const std::array< std::int32_t, 2 > rows = reduceRange( y, iHeight, source.iHeight );
+        for ( std::int32_t x = 0; x != iWidth; ++x )
+        {
+            const std::array< std::int32_t, 2 > columns = reduceRange( x, iWidth, source.iWidth );
+            float                               fDepth  = 0.0f;
+            for ( std::int32_t sy = rows[ 0 ]; sy <= rows[ 1 ]; ++sy )
+            {
+                for ( std::int32_t sx = columns[ 0 ]; sx <= columns[ 1 ]; ++sx )
+                    fDepth = std::max( fDepth, source.get( sx, sy ) );
+            }
+            level.texels[ static_cast< std::size_t >( y ) * iWidth + x ] = fDepth;
+        }
+    }
+    return level;
+}
+
+Pyramid buildPyramid( Level depth )
+{
+    const std::int32_t iWidth  = levelSize( depth.iWidth, 1 );
+    const std::int32_t iHeight = levelSize( depth.iHeight, 1 );
+    const std::int32_t iLevels = levelCount( iWidth, iHeight );
+
+    Pyramid pyramid{ std::move( depth ) };
+    for ( std::int32_t i = 0; i != iLevels; ++i )
+        pyramid.push_back( reduce( pyramid.back(), levelSize( iWidth, i ), levelSize( iHeight, i ) ) );
+    return pyramid;
+}
+
+std::int32_t findMSB( std::int32_t i )
+{
+    std::int32_t iBit = -1;
+    for ( ; i != 0; i >>= 1 )
+        ++iBit;
+    return iBit;
+}
+
+struct Selection
+{
+    std::int32_t                  iLevel;
+    std::array< std::int32_t, 2 > first; // pyramid texels at iLevel
+    std::array< std::int32_t, 2 > last;
+};
+
+// occlusion_cull.comp - the level and up to 2x2 texels read for the depth texels first to last
+Selection select( const Pyramid&                       pyramid,
+                  const std::array< std::int32_t, 2 >& first,
+                  const std::array< std::int32_t, 2 >& last )
+{
+    const std::int32_t iLevels = static_cast< std::int32_t >( pyramid.size() ) - 1;
+    const std::int32_t iSpan   = std::max( last[ 0 ] - first[ 0 ], last[ 1 ] - first[ 1 ] ) + 1;
+    const std::int32_t iLevel  = std::min( std::max( findMSB( std::max( iSpan - 1, 1 ) ), 0 ), iLevels - 1 );
+    const Level&       level   = pyramid[ iLevel + 1 ];
+    const std::array< std::int32_t, 2 > levelMax{ level.iWidth - 1, level.iHeight - 1 };
+
+    Selection selection{ iLevel, {}, {} };
+    for ( int axis = 0; axis != 2; ++axis )
+    {
+        selection.first[ axis ] = std::min( first[ axis ] >> ( iLevel + 1 ), levelMax[ axis ] );
+        selection.last[ axis ]  = std::min( last[ axis ] >> ( iLevel + 1 ), levelMax[ axis ] );
+    }
+    return selection;
+}
+
+// the depth texels under pyramid texels first to last of a level along one axis, following every
+// reduction back to the depth - adjacent texels cover adjacent ranges
+std::array< std::int32_t, 2 > depthRange( const Pyramid& pyramid,
+                                          std::int32_t   iLevel,
+                                          int            axis,
+                                          std::int32_t   iFirst,
+                                          std::int32_t   iLast )
+{
+    auto size = [ & ]( std::int32_t i ) { return axis == 0 ? pyramid[ i ].iWidth : pyramid[ i ].iHeight; };
+    std::array< std::int32_t, 2 > range{ iFirst, iLast };
+    for ( std::int32_t i = iLevel + 1; i != 0; --i )
+    {
+        range = { reduceRange( range[ 0 ], size( i ), size( i - 1 ) )[ 0 ],
+                  reduceRange( range[ 1 ], size( i ), size( i - 1 ) )[ 1 ] };
+    }
+    return range;
+}
+} // namespace
+
+// Brute force CPU model of the occlusion test's pyramid texel selection.
+//
+// Builds the pyramid exactly as hiz_reduce.comp does from random depth at random and awkward
+// resolutions, then for random boxes in depth texels picks the level and texels as
+// occlusion_cull.comp does.  Checks the selected texels cover every depth texel under the box and
+// that their farthest depth is never nearer than the farthest depth under the box - either failure
+// would cull a visible instance
+int main( int argc, const char* argv[] )
+{
+    namespace po = boost::program_options;
+
+    try
+    {
+        std::uint32_t uiSizes  = 64U;
+        std::uint32_t uiBoxes  = 2000U;
+        std::int32_t  iMaxSize = 2048;
+        std::uint32_t uiSeed   = 1234U;
+
+        po::options_description options( "hiz_model options" );
+        // clang-format off
+        options.add_options()
+            ( "help",       "Produce help message" )
+            ( "sizes",      po::value< std::uint32_t >( &uiSizes )->default_value( uiSizes ),
+                            "Random depth resolutions in addition to the fixed awkward ones" )
+            ( "boxes",      po::value< std::uint32_t >( &uiBoxes )->default_value( uiBoxes ),
+                            "Random boxes tested per resolution" )
+            ( "max_size",   po::value< std::int32_t >( &iMaxSize )->default_value( iMaxSize ),
+                            "Largest random depth width or height" )
+            ( "seed",       po::value< std::uint32_t >( &uiSeed )->default_value( uiSeed ), "Random seed" )
+            ;
+        // clang-format on
+
+        po::variables_map vm;
+        po::store( po::parse_command_line( argc, argv, options ), vm );
+        po::notify( vm );
+
+        if ( vm.count( "help" ) )
+        {
+            std::cout << options << std::endl;
+            return 0;
+        }
+        if ( uiBoxes == 0U || iMaxSize <= 0 )
+        {
+            SPDLOG_ERROR( "Invalid options" );
+            return 1;
+        }
+
+        std::mt19937                            random( uiSeed );
+        std::uniform_real_distribution< float > depthValue( 0.0f, 1.0f );
+        std::uniform_int_distribution< std::int32_t > sizeValue( 1, iMaxSize );
+
+        std::vector< std::array< std::int32_t, 2 > > sizes{ { 1, 1 },       { 1, 2 },       { 2, 1 },
+                                                            { 3, 3 },       { 5, 7 },       { 4095, 1 },
+                                                            { 1, 4095 },    { 1280, 720 },  { 1920, 1080 },
+                                                            { 2560, 1440 }, { 1366, 768 },  { 1023, 1025 } };
+        for ( std::uint32_t i = 0; i != uiSizes; ++i )
+            sizes.push_back( { sizeValue( random ), sizeValue( random ) } );
+
+        std::uint64_t uiTested = 0U, uiUncovered = 0U, uiTooNear = 0U;
+        double        fOverfetch = 0.0;
+        for ( const std::array< std::int32_t, 2 >& size : sizes )
+        {
+            Level depth{
+                size[ 0 ], size[ 1 ], std::vector< float >( static_cast< std::size_t >( size[ 0 ] ) * size[ 1 ] ) };
+            for ( float& fDepth : depth.texels )
+                fDepth = depthValue( random );
+            const Pyramid pyramid = buildPyramid( std::move( depth ) );
+
+            // box sizes spread evenly over powers of two so every level is selected
+            const std::int32_t iMaxBits = findMSB( std::max( size[ 0 ], size[ 1 ] ) ) + 1;
+            std::uniform_int_distribution< std::int32_t > bits( 0, iMaxBits );
+            for ( std::uint32_t uiBox = 0; uiBox != uiBoxes; ++uiBox )
+            {
+                std::array< std::int32_t, 2 > first, last;
+                for ( int axis = 0; axis != 2; ++axis )
+                {
+                    const std::int32_t iSpan
+                        = std::min( std::uniform_int_distribution< std::int32_t >( 1, 1 << bits( random ) )( random ),
+                                    size[ axis ] );
+                    first[ axis ] = std::uniform_int_distribution< std::int32_t >( 0, size[ axis ] - iSpan )( random );
+                    last[ axis ]  = first[ axis ] + iSpan - 1;
+                }
+
+                const Selection selection = select( pyramid, first, last );
+                const Level&    level     = pyramid[ selection.iLevel + 1 ];
+
+                bool         bCovered = true;
+                std::int64_t iCovered = 1;
+                for ( int axis = 0; axis != 2; ++axis )
+                {
+                    const std::array< std::int32_t, 2 > range = depthRange(
+                        pyramid, selection.iLevel, axis, selection.first[ axis ], selection.last[ axis ] );
+                    bCovered = bCovered && selection.last[ axis ] - selection.first[ axis ] <= 1
+                               && range[ 0 ] <= first[ axis ] && range[ 1 ] >= last[ axis ];
+                    iCovered *= range[ 1 ] - range[ 0 ] + 1;
+                }
+
+                float fFarthest = 0.0f;
+                for ( std::int32_t y = first[ 1 ]; y <= last[ 1 ]; ++y )
+                {
+                    for ( std::int32_t x = first[ 0 ]; x <= last[ 0 ]; ++x )
+                        fFarthest = std::max( fFarthest, pyramid.front().get( x, y ) );
+                }
+                const float fSelected = std::max(
+                    std::max( level.get( selection.first[ 0 ], selection.first[ 1 ] ),
+                              level.get( selection.last[ 0 ], selection.first[ 1 ] ) ),
+                    std::max( level.get( selection.first[ 0 ], selection.last[ 1 ] ),
+                              level.get( selection.last[ 0 ], selection.last[ 1 ] ) ) );
+
+                ++uiTested;
+                uiUncovered += bCovered ? 0U : 1U;
+                uiTooNear += fSelected < fFarthest ? 1U : 0U;
+                fOverfetch += static_cast< double >( iCovered )
+                              / ( static_cast< double >( last[ 0 ] - first[ 0 ] + 1 )
+                                  * static_cast< double >( last[ 1 ] - first[ 1 ] + 1 ) );
+                if ( !bCovered && uiUncovered <= 10U )
+                {
+                    SPDLOG_ERROR( "{}x{} depth texels {},{} to {},{} level {} texels {},{} to {},{} miss some",
+                                  size[ 0 ],
+                                  size[ 1 ],
+                                  first[ 0 ],
+                                  first[ 1 ],
+                                  last[ 0 ],
+                                  last[ 1 ],
+                                  selection.iLevel,
+                                  selection.first[ 0 ],
+                                  selection.first[ 1 ],
+                                  selection.last[ 0 ],
+                                  selection.last[ 1 ] );
+                }
+            }
+        }
+
+        SPDLOG_INFO( "HiZ model: {} resolutions {} boxes - {} not covered {} tested nearer than the box's depth - "
+                     "selected texels cover {:.1f}x the box on average",
+                     sizes.size(),
+                     uiTested,
+                     uiUncovered,
+                     uiTooNear,
+                     fOverfetch / static_cast< double >( uiTested ) );
+        if ( uiUncovered != 0U || uiTooNear != 0U )
+            return 1;
+    }
+    catch ( std::exception& ex )
+    {
+        SPDLOG_ERROR( "Exception: {}", ex.what() );
+        return 1;
+    }
+    return 0;
+}
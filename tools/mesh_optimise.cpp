@@ -0,0 +1,725 @@
+
+#include "mesh_optimise.hpp"
+
+#include "hash.hpp"
+#include "quantise.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace retail
+{
+namespace tools
+{
+namespace
+{
+constexpr std::size_t kForsythCacheSize = 32U;
+
+float forsythScore( int iCachePosition, std::uint32_t uiRemainingValence )
+{
+    if ( uiRemainingValence == 0U )
+        return -1.0f;
+
+    float fScore = 0.0f;
+    if ( iCachePosition >= 0 )
+    {
+        // the last triangle's vertices get a fixed score so the next triangle does not simply reuse them
+        if ( iCachePosition < 3 )
+            fScore = 0.75f;
+        else
+            fScore = std::pow(
+                1.0f - static_cast< float >( iCachePosition - 3 ) / static_cast< float >( kForsythCacheSize - 3U ),
+                1.5f );
+    }
+    // favour vertices with few triangles left so they leave the working set
+    fScore += 2.0f / std::sqrt( static_cast< float >( uiRemainingValence ) );
+    return fScore;
+}
+
+void cross( const float a[ 3 ], const float b[ 3 ], const float c[ 3 ], float result[ 3 ] )
+{
+    const float e0[ 3 ] = { b[ 0 ] - a[ 0 ], b[ 1 ] - a[ 1 ], b[ 2 ] - a[ 2 ] };
+    const float e1[ 3 ] = { c[ 0 ] - a[ 0 ], c[ 1 ] - a[ 1 ], c[ 2 ] - a[ 2 ] };
+    result[ 0 ]         = e0[ 1 ] * e1[ 2 ] - e0[ 2 ] * e1[ 1 ];
+    result[ 1 ]         = e0[ 2 ] * e1[ 0 ] - e0[ 0 ] * e1[ 2 ];
+    result[ 2 ]         = e0[ 0 ] * e1[ 1 ] - e0[ 1 ] * e1[ 0 ];
+}
+
+std::uint64_t fnvTriangleKey( std::uint32_t a, std::uint32_t b, std::uint32_t c )
+{
+    const std::uint32_t tri[ 3 ] = { a, b, c };
+    return fnv1a64( tri, sizeof( tri ) );
+}
+
+int objIndex( const std::string& str, std::size_t szCount )
+{
+    if ( str.empty() )
+        return -1;
+    const int iIndex = std::stoi( str );
+    // obj indices are one based and negative indices are relative to the end
+    const int iResult = iIndex < 0 ? static_cast< int >( szCount ) + iIndex : iIndex - 1;
+    VERIFY_RTE_MSG( iResult >= 0 && iResult < static_cast< int >( szCount ), "Invalid obj index: " << str );
+    return iResult;
+}
+} // namespace
+
+SourceMesh loadObj( const boost::filesystem::path& filePath )
+{
+    std::ifstream inputFileStream( filePath.native().c_str(), std::ios::in );
+    if ( !inputFileStream.good() )
+    {
+        THROW_RTE( "Failed to open file: " << filePath.string() );
+    }
+
+    SourceMesh result;
+    result.strName = filePath.stem().string();
+
+    std::vector< std::array< float, 3 > >                     positions, normals;
+    std::vector< std::array< float, 2 > >                     uvs;
+    std::map< std::tuple< int, int, int >, std::uint32_t > vertexMap;
+    bool                                                      bGenerateNormals = false;
+
+    std::string line;
+    while ( std::getline( inputFileStream, line ) )
+    {
+        std::istringstream is( line );
+        std::string        strType;
+        is >> strType;
+        if ( strType == "v" )
+        {
+            std::array< float, 3 > p{};
+            is >> p[ 0 ] >> p[ 1 ] >> p[ 2 ];
+            positions.push_back( p );
+        }
+        else if ( strType == "vn" )
+        {
+            std::array< float, 3 > n{};
+            is >> n[ 0 ] >> n[ 1 ] >> n[ 2 ];
+            normals.push_back( n );
+        }
+        else if ( strType == "vt" )
+        {
+            std::array< float, 2 > t{};
+            is >> t[ 0 ] >> t[ 1 ];
+            uvs.push_back( t );
+        }
+        else if ( strType == "f" )
+        {
+            std::vector< std::uint32_t > face;
+            std::string                  strVertex;
+            while ( is >> strVertex )
+            {
+                // v, v/vt, v//vn or v/vt/vn
+                std::string  parts[ 3 ];
+                std::size_t  szPart = 0U;
+                for ( char c : strVertex )
+                {
+                    if ( c == '/' )
+                        ++szPart;
+                    else if ( szPart < 3U )
+                        parts[ szPart ] += c;
+                }
+                const std::tuple< int, int, int > key{ objIndex( parts[ 0 ], positions.size() ),
+                                                       objIndex( parts[ 1 ], uvs.size() ),
+                                                       objIndex( parts[ 2 ], normals.size() ) };
+                VERIFY_RTE_MSG( std::get< 0 >( key ) >= 0, "Face without position in: " << filePath.string() );
+
+                auto iFind = vertexMap.find( key );
+                if ( iFind == vertexMap.end() )
+                {
+                    Vertex vertex{};
+                    std::memcpy( vertex.position, positions[ std::get< 0 >( key ) ].data(), sizeof( vertex.position ) );
+                    if ( std::get< 1 >( key ) >= 0 )
+                        std::memcpy( vertex.uv, uvs[ std::get< 1 >( key ) ].data(), sizeof( vertex.uv ) );
+                    if ( std::get< 2 >( key ) >= 0 )
+                        std::memcpy( vertex.normal, normals[ std::get< 2 >( key ) ].data(), sizeof( vertex.normal ) );
+                    else
+                        bGenerateNormals = true;
+                    iFind = vertexMap.insert( { key, static_cast< std::uint32_t >( result.vertices.size() ) } ).first;
+                    result.vertices.push_back( vertex );
+                }
+                face.push_back( iFind->second );
+            }
+            // triangle fan
+            for ( std::size_t i = 2; i < face.size(); ++i )
+            {
+                result.indices.push_back( face[ 0 ] );
+                result.indices.push_back( face[ i - 1U ] );
+                result.indices.push_back( face[ i ] );
+            }
+        }
+    }
+    VERIFY_RTE_MSG( !result.indices.empty(), "No faces in: " << filePath.string() );
+
+    if ( bGenerateNormals )
+    {
+        // area weighted face normals accumulated per vertex
+        for ( Vertex& vertex : result.vertices )
+            std::fill( std::begin( vertex.normal ), std::end( vertex.normal ), 0.0f );
+        for ( std::size_t i = 0; i < result.indices.size(); i += 3U )
+        {
+            float faceNormal[ 3 ];
+            cross( result.vertices[ result.indices[ i ] ].position,
+                   result.vertices[ result.indices[ i + 1U ] ].position,
+                   result.vertices[ result.indices[ i + 2U ] ].position,
+                   faceNormal );
+            for ( std::size_t j = 0; j != 3U; ++j )
+                for ( std::size_t k = 0; k != 3U; ++k )
+                    result.vertices[ result.indices[ i + j ] ].normal[ k ] += faceNormal[ k ];
+        }
+    }
+    for ( Vertex& vertex : result.vertices )
+    {
+        const float fLength = std::sqrt( vertex.normal[ 0 ] * vertex.normal[ 0 ] + vertex.normal[ 1 ] * vertex.normal[ 1 ]
+                                         + vertex.normal[ 2 ] * vertex.normal[ 2 ] );
+        for ( float& f : vertex.normal )
+            f = fLength > 0.0f ? f / fLength : 0.0f;
+    }
+    return result;
+}
+
+void optimiseVertexCache( std::vector< std::uint32_t >& indices, std::size_t szVertexCount )
+{
+    const std::size_t szTriangleCount = indices.size() / 3U;
+    if ( szTriangleCount == 0U )
+        return;
+
+    // triangle adjacency per vertex
+    std::vector< std::uint32_t > valence( szVertexCount, 0U );
+    for ( std::uint32_t uiIndex : indices )
+        ++valence[ uiIndex ];
+    std::vector< std::uint32_t > adjacencyOffset( szVertexCount + 1U, 0U );
+    std::partial_sum( valence.begin(), valence.end(), adjacencyOffset.begin() + 1U );
+    std::vector< std::uint32_t > adjacency( indices.size() );
+    {
+        std::vector< std::uint32_t > fill( adjacencyOffset.begin(), adjacencyOffset.end() - 1U );
+        for ( std::size_t i = 0; i != indices.size(); ++i )
+            adjacency[ fill[ indices[ i ] ]++ ] = static_cast< std::uint32_t >( i / 3U );
+    }
+
+    std::vector< std::uint32_t > remaining = valence;
+    std::vector< int >           cachePosition( szVertexCount, -1 );
+    std::vector< float >         vertexScore( szVertexCount );
+    for ( std::size_t v = 0; v != szVertexCount; ++v )
+        vertexScore[ v ] = forsythScore( -1, remaining[ v ] );
+
+    std::vector< float > triangleScore( szTriangleCount );
+    for ( std::size_t t = 0; t != szTriangleCount; ++t )
+        triangleScore[ t ] = vertexScore[ indices[ t * 3U ] ] + vertexScore[ indices[ t * 3U + 1U ] ]
+                             + vertexScore[ indices[ t * 3U + 2U ] ];
+
+    std::vector< bool >          emitted( szTriangleCount, false );
+    std::vector< std::uint32_t > output;
+    output.reserve( indices.size() );
+
+    std::vector< std::uint32_t > cache, newCache;
+    cache.reserve( kForsythCacheSize + 3U );
+    newCache.reserve( kForsythCacheSize + 3U );
+
+    std::size_t szCursor = 0U;
+    std::size_t szBest   = std::max_element( triangleScore.begin(), triangleScore.end() ) - triangleScore.begin();
+
+    for ( std::size_t szEmitted = 0U; szEmitted != szTriangleCount; ++szEmitted )
+    {
+        if ( szBest == std::numeric_limits< std::size_t >::max() )
+        {
+            // nothing adjacent to the cache - restart from the next unemitted triangle
+            while ( emitted[ szCursor ] )
+                ++szCursor;
+            szBest = szCursor;
+        }
+
+        emitted[ szBest ]         = true;
+        const std::uint32_t* pTri = &indices[ szBest * 3U ];
+        output.insert( output.end(), pTri, pTri + 3U );
+
+        newCache.clear();
+        for ( std::size_t i = 0; i != 3U; ++i )
+        {
+            const std::uint32_t v = pTri[ i ];
+            if ( std::find( newCache.begin(), newCache.end(), v ) == newCache.end() )
+                newCache.push_back( v );
+
+            // remove the triangle from the live adjacency of the vertex
+            std::uint32_t* pBegin = &adjacency[ adjacencyOffset[ v ] ];
+            std::uint32_t* pEnd   = pBegin + remaining[ v ];
+            std::uint32_t* pFound = std::find( pBegin, pEnd, static_cast< std::uint32_t >( szBest ) );
+            VERIFY_RTE( pFound != pEnd );
+            std::swap( *pFound, *( pEnd - 1 ) );
+            --remaining[ v ];
+        }
+        for ( std::uint32_t v : cache )
+        {
+            if ( std::find( newCache.begin(), newCache.end(), v ) == newCache.end() )
+                newCache.push_back( v );
+        }
+
+        for ( std::size_t i = 0; i != newCache.size(); ++i )
+        {
+            const std::uint32_t v = newCache[ i ];
+            cachePosition[ v ]    = i < kForsythCacheSize ? static_cast< int >( i ) : -1;
+            vertexScore[ v ]      = forsythScore( cachePosition[ v ], remaining[ v ] );
+        }
+
+        szBest           = std::numeric_limits< std::size_t >::max();
+        float fBestScore = -1.0f;
+        for ( std::uint32_t v : newCache )
+        {
+            for ( std::uint32_t i = 0; i != remaining[ v ]; ++i )
+            {
+                const std::uint32_t t = adjacency[ adjacencyOffset[ v ] + i ];
+                triangleScore[ t ]    = vertexScore[ indices[ t * 3U ] ] + vertexScore[ indices[ t * 3U + 1U ] ]
+                                     + vertexScore[ indices[ t * 3U + 2U ] ];
+                if ( triangleScore[ t ] > fBestScore )
+                {
+                    fBestScore = triangleScore[ t ];
+                    szBest     = t;
+                }
+            }
+        }
+
+        if ( newCache.size() > kForsythCacheSize )
+            newCache.resize( kForsythCacheSize );
+        cache.swap( newCache );
+    }
+
+    indices.swap( output );
+}
+
+void optimiseOverdraw( std::vector< std::uint32_t >& indices, const std::vector< Vertex >& vertices, float fThreshold )
+{
+    constexpr std::size_t kCacheSize          = 16U;
+    constexpr std::size_t kMinClusterTriangles = 32U;
+
+    const std::size_t szTriangleCount = indices.size() / 3U;
+    if ( szTriangleCount < kMinClusterTriangles * 2U )
+        return;
+
+    const CacheStats before = analyseVertexCache( indices, vertices.size(), kCacheSize );
+
+    // cluster boundaries - hard where the cache is flushed, soft where the cluster so far
+    // has an ACMR within the threshold so a restart costs little
+    std::vector< std::size_t > clusterStarts{ 0U };
+    {
+        std::vector< std::uint32_t > timestamps( vertices.size(), 0U );
+        std::uint32_t                uiTime                = static_cast< std::uint32_t >( kCacheSize ) + 1U;
+        std::size_t                  szClusterMisses       = 0U;
+        for ( std::size_t t = 0; t != szTriangleCount; ++t )
+        {
+            std::size_t szMisses = 0U;
+            for ( std::size_t i = 0; i != 3U; ++i )
+            {
+                const std::uint32_t v = indices[ t * 3U + i ];
+                if ( uiTime - timestamps[ v ] > kCacheSize )
+                {
+                    timestamps[ v ] = uiTime++;
+                    ++szMisses;
+                }
+            }
+            const std::size_t szClusterSize = t - clusterStarts.back();
+            if ( szClusterSize >= kMinClusterTriangles )
+            {
+                const bool bHard = szMisses == 3U;
+                const bool bSoft = static_cast< float >( szClusterMisses ) / static_cast< float >( szClusterSize )
+                                   <= before.fACMR * fThreshold;
+                if ( bHard || bSoft )
+                {
+                    clusterStarts.push_back( t );
+                    szClusterMisses = 0U;
+                }
+            }
+            szClusterMisses += szMisses;
+        }
+    }
+    clusterStarts.push_back( szTriangleCount );
+
+    struct Cluster
+    {
+        std::size_t szBegin, szEnd;
+        float       fSortKey;
+    };
+    std::vector< Cluster > clusters;
+
+    // area weighted mesh centroid
+    float meshCentroid[ 3 ] = { 0.0f, 0.0f, 0.0f };
+    float fMeshArea         = 0.0f;
+    for ( std::size_t t = 0; t != szTriangleCount; ++t )
+    {
+        const Vertex& a = vertices[ indices[ t * 3U ] ];
+        const Vertex& b = vertices[ indices[ t * 3U + 1U ] ];
+        const Vertex& c = vertices[ indices[ t * 3U + 2U ] ];
+        float         n[ 3 ];
+        cross( a.position, b.position, c.position, n );
+        const float fArea = std::sqrt( n[ 0 ] * n[ 0 ] + n[ 1 ] * n[ 1 ] + n[ 2 ] * n[ 2 ] );
+        for ( std::size_t k = 0; k != 3U; ++k )
+            meshCentroid[ k ] += fArea * ( a.position[ k ] + b.position[ k ] + c.position[ k ] ) / 3.0f;
+        fMeshArea += fArea;
+    }
+    for ( float& f : meshCentroid )
+        f = fMeshArea > 0.0f ? f / fMeshArea : 0.0f;
+
+    for ( std::size_t i = 0; i + 1U < clusterStarts.size(); ++i )
+    {
+        float centroid[ 3 ] = { 0.0f, 0.0f, 0.0f }, normal[ 3 ] = { 0.0f, 0.0f, 0.0f };
+        float fArea         = 0.0f;
+        for ( std::size_t t = clusterStarts[ i ]; t != clusterStarts[ i + 1U ]; ++t )
+        {
+            const Vertex& a = vertices[ indices[ t * 3U ] ];
+            const Vertex& b = vertices[ indices[ t * 3U + 1U ] ];
+            const Vertex& c = vertices[ indices[ t * 3U + 2U ] ];
+            float         n[ 3 ];
+            cross( a.position, b.position, c.position, n );
+            const float fTriArea = std::sqrt( n[ 0 ] * n[ 0 ] + n[ 1 ] * n[ 1 ] + n[ 2 ] * n[ 2 ] );
+            for ( std::size_t k = 0; k != 3U; ++k )
+            {
+                centroid[ k ] += fTriArea * ( a.position[ k ] + b.position[ k ] + c.position[ k ] ) / 3.0f;
+                normal[ k ] += n[ k ];
+            }
+            fArea += fTriArea;
+        }
+        const float fNormalLength = std::sqrt( normal[ 0 ] * normal[ 0 ] + normal[ 1 ] * normal[ 1 ] + normal[ 2 ] * normal[ 2 ] );
+        float       fKey          = 0.0f;
+        if ( fArea > 0.0f && fNormalLength > 0.0f )
+        {
+            for ( std::size_t k = 0; k != 3U; ++k )
+                fKey += ( centroid[ k ] / fArea - meshCentroid[ k ] ) * normal[ k ] / fNormalLength;
+        }
+        clusters.push_back( Cluster{ clusterStarts[ i ], clusterStarts[ i + 1U ], fKey } );
+    }
+
+    // outward facing clusters occlude the rest of the mesh so draw them first
+    std::stable_sort( clusters.begin(), clusters.end(),
+                      []( const Cluster& left, const Cluster& right ) { return left.fSortKey > right.fSortKey; } );
+
+    std::vector< std::uint32_t > result;
+    result.reserve( indices.size() );
+    for ( const Cluster& cluster : clusters )
+        result.insert( result.end(), indices.begin() + cluster.szBegin * 3U, indices.begin() + cluster.szEnd * 3U );
+
+    const CacheStats after = analyseVertexCache( result, vertices.size(), kCacheSize );
+    if ( after.fACMR <= before.fACMR * fThreshold )
+        indices.swap( result );
+}
+
+void optimiseVertexFetch( SourceMesh& mesh )
+{
+    constexpr std::uint32_t      kUnused = std::numeric_limits< std::uint32_t >::max();
+    std::vector< std::uint32_t > remap( mesh.vertices.size(), kUnused );
+    std::vector< Vertex >        vertices;
+    vertices.reserve( mesh.vertices.size() );
+    for ( std::uint32_t& uiIndex : mesh.indices )
+    {
+        if ( remap[ uiIndex ] == kUnused )
+        {
+            remap[ uiIndex ] = static_cast< std::uint32_t >( vertices.size() );
+            vertices.push_back( mesh.vertices[ uiIndex ] );
+        }
+        uiIndex = remap[ uiIndex ];
+    }
+    mesh.vertices.swap( vertices );
+}
+
+namespace
+{
+// simplify by snapping every vertex to the representative vertex of its grid cell
+std::vector< std::uint32_t > clusterVertices( const std::vector< Vertex >&        vertices,
+                                              const std::vector< std::uint32_t >& indices,
+                                              const mesh::Bounds&                 bounds,
+                                              float                               fCellSize )
+{
+    auto cellOf = [ & ]( const Vertex& vertex )
+    {
+        std::uint64_t uiKey = 0U;
+        for ( int k = 0; k != 3; ++k )
+        {
+            const std::uint64_t uiCell
+                = static_cast< std::uint64_t >( ( vertex.position[ k ] - bounds.min[ k ] ) / fCellSize );
+            uiKey = ( uiKey << 21U ) | ( uiCell & 0x1FFFFFU );
+        }
+        return uiKey;
+    };
+
+    // cell average then the used vertex nearest to it represents the cell
+    struct Cell
+    {
+        float         sum[ 3 ] = { 0.0f, 0.0f, 0.0f };
+        std::uint32_t uiCount  = 0U;
+        std::uint32_t uiBest   = 0U;
+        float         fBestDistance = std::numeric_limits< float >::max();
+    };
+    std::unordered_map< std::uint64_t, Cell > cells;
+    std::vector< bool >                       used( vertices.size(), false );
+    for ( std::uint32_t v : indices )
+        used[ v ] = true;
+    for ( std::uint32_t v = 0; v != vertices.size(); ++v )
+    {
+        if ( !used[ v ] )
+            continue;
+        Cell& cell = cells[ cellOf( vertices[ v ] ) ];
+        for ( int k = 0; k != 3; ++k )
+            cell.sum[ k ] += vertices[ v ].position[ k ];
+        ++cell.uiCount;
+    }
+    for ( std::uint32_t v = 0; v != vertices.size(); ++v )
+    {
+        if ( !used[ v ] )
+            continue;
+        Cell& cell      = cells[ cellOf( vertices[ v ] ) ];
+        float fDistance = 0.0f;
+        for ( int k = 0; k != 3; ++k )
+        {
+            const float d = vertices[ v ].position[ k ] - cell.sum[ k ] / static_cast< float >( cell.uiCount );
+            fDistance += d * d;
+        }
+        if ( fDistance < cell.fBestDistance )
+        {
+            cell.fBestDistance = fDistance;
+            cell.uiBest        = v;
+        }
+    }
+
+    // remap and drop triangles that collapsed or duplicate another
+    std::vector< std::uint32_t > result;
+    std::unordered_set< std::uint64_t > seen;
+    for ( std::size_t t = 0; t + 2U < indices.size(); t += 3U )
+    {
+        std::uint32_t tri[ 3 ];
+        for ( std::size_t i = 0; i != 3U; ++i )
+            tri[ i ] = cells[ cellOf( vertices[ indices[ t + i ] ] ) ].uiBest;
+        if ( tri[ 0 ] == tri[ 1 ] || tri[ 1 ] == tri[ 2 ] || tri[ 0 ] == tri[ 2 ] )
+            continue;
+
+        // rotate the smallest index first so identical triangles compare equal but winding is kept
+        const std::size_t szFirst = tri[ 0 ] < tri[ 1 ] ? ( tri[ 0 ] < tri[ 2 ] ? 0U : 2U ) : ( tri[ 1 ] < tri[ 2 ] ? 1U : 2U );
+        const std::uint32_t a = tri[ szFirst ], b = tri[ ( szFirst + 1U ) % 3U ], c = tri[ ( szFirst + 2U ) % 3U ];
+        const std::uint64_t uiKey = fnvTriangleKey( a, b, c );
+        if ( !seen.insert( uiKey ).second )
+            continue;
+        result.push_back( a );
+        result.push_back( b );
+        result.push_back( c );
+    }
+    return result;
+}
+} // namespace
+
+void generateLods( SourceMesh& mesh, std::uint32_t uiMaxLods, float fReduction, std::size_t szMinTriangles )
+{
+    VERIFY_RTE( uiMaxLods >= 1U && uiMaxLods <= mesh::kMaxLods );
+
+    mesh.lods.clear();
+    mesh.lods.push_back( mesh::MeshLod{ 0U, static_cast< std::uint32_t >( mesh.indices.size() ), 0.0f, 0U } );
+
+    const mesh::Bounds bounds  = computeBounds( mesh.vertices );
+    float              fExtent = 0.0f;
+    for ( int k = 0; k != 3; ++k )
+        fExtent = std::max( fExtent, bounds.max[ k ] - bounds.min[ k ] );
+    if ( fExtent <= 0.0f )
+        return;
+
+    // each level clusters the previous one - the grid coarsens until the triangle count target is met
+    std::vector< std::uint32_t > previous = mesh.indices;
+    float                        fCellSize = fExtent / 1024.0f;
+    while ( mesh.lods.size() < uiMaxLods && previous.size() / 3U > szMinTriangles )
+    {
+        const std::size_t szTarget = static_cast< std::size_t >( static_cast< float >( previous.size() / 3U ) * fReduction );
+
+        std::vector< std::uint32_t > simplified;
+        while ( fCellSize < fExtent )
+        {
+            simplified = clusterVertices( mesh.vertices, previous, bounds, fCellSize );
+            if ( simplified.size() / 3U <= szTarget )
+                break;
+            fCellSize *= 1.25f;
+        }
+        if ( simplified.empty() || simplified.size() >= previous.size() )
+            break;
+
+        optimiseVertexCache( simplified, mesh.vertices.size() );
+
+        // a vertex may have moved by up to the cell diagonal of this level
+        mesh.lods.push_back( mesh::MeshLod{ static_cast< std::uint32_t >( mesh.indices.size() ),
+                                            static_cast< std::uint32_t >( simplified.size() ),
+                                            fCellSize * std::sqrt( 3.0f ),
+                                            0U } );
+        mesh.indices.insert( mesh.indices.end(), simplified.begin(), simplified.end() );
+        previous.swap( simplified );
+    }
+}
+
+CacheStats analyseVertexCache( const std::vector< std::uint32_t >& indices,
+                               std::size_t                         szVertexCount,
+                               std::size_t                         szCacheSize )
+{
+    // FIFO cache simulated with timestamps - a vertex is cached if fewer than szCacheSize misses since its own
+    std::vector< std::uint32_t > timestamps( szVertexCount, 0U );
+    std::vector< bool >          used( szVertexCount, false );
+    std::uint32_t                uiTime   = static_cast< std::uint32_t >( szCacheSize ) + 1U;
+    std::size_t                  szMisses = 0U, szUsed = 0U;
+    for ( std::uint32_t v : indices )
+    {
+        if ( uiTime - timestamps[ v ] > szCacheSize )
+        {
+            timestamps[ v ] = uiTime++;
+            ++szMisses;
+        }
+        if ( !used[ v ] )
+        {
+            used[ v ] = true;
+            ++szUsed;
+        }
+    }
+    const std::size_t szTriangleCount = indices.size() / 3U;
+    return CacheStats{ szTriangleCount ? static_cast< float >( szMisses ) / static_cast< float >( szTriangleCount ) : 0.0f,
+                       szUsed ? static_cast< float >( szMisses ) / static_cast< float >( szUsed ) : 0.0f };
+}
+
+float analyseOverdraw( const std::vector< std::uint32_t >& indices, const std::vector< Vertex >& vertices )
+{
+    constexpr int kGrid = 256;
+
+    const mesh::Bounds bounds  = computeBounds( vertices );
+    float              fExtent = 0.0f;
+    for ( int k = 0; k != 3; ++k )
+        fExtent = std::max( fExtent, bounds.max[ k ] - bounds.min[ k ] );
+    if ( fExtent <= 0.0f )
+        return 1.0f;
+    const float fScale = static_cast< float >( kGrid - 1 ) / fExtent;
+
+    std::vector< float > depthBuffer( kGrid * kGrid );
+    std::size_t          szShaded = 0U, szCovered = 0U;
+
+    for ( int iAxis = 0; iAxis != 3; ++iAxis )
+    {
+        // cyclic permutation keeps the screen axes right handed
+        const int iU = ( iAxis + 1 ) % 3, iV = ( iAxis + 2 ) % 3;
+        for ( float fDirection : { 1.0f, -1.0f } )
+        {
+            std::fill( depthBuffer.begin(), depthBuffer.end(), std::numeric_limits< float >::max() );
+
+            for ( std::size_t t = 0; t + 2U < indices.size(); t += 3U )
+            {
+                float x[ 3 ], y[ 3 ], z[ 3 ];
+                for ( std::size_t i = 0; i != 3U; ++i )
+                {
+                    const float* p = vertices[ indices[ t + i ] ].position;
+                    // viewing from the negative side mirrors u
+                    x[ i ] = ( fDirection > 0.0f ? p[ iU ] - bounds.min[ iU ] : bounds.max[ iU ] - p[ iU ] ) * fScale;
+                    y[ i ] = ( p[ iV ] - bounds.min[ iV ] ) * fScale;
+                    z[ i ] = -fDirection * p[ iAxis ];
+                }
+                const float fArea = ( x[ 1 ] - x[ 0 ] ) * ( y[ 2 ] - y[ 0 ] ) - ( x[ 2 ] - x[ 0 ] ) * ( y[ 1 ] - y[ 0 ] );
+                if ( fArea <= 0.0f )
+                    continue; // back facing or degenerate
+
+                const int iMinX = std::max( 0, static_cast< int >( std::floor( std::min( { x[ 0 ], x[ 1 ], x[ 2 ] } ) ) ) );
+                const int iMaxX = std::min( kGrid - 1, static_cast< int >( std::ceil( std::max( { x[ 0 ], x[ 1 ], x[ 2 ] } ) ) ) );
+                const int iMinY = std::max( 0, static_cast< int >( std::floor( std::min( { y[ 0 ], y[ 1 ], y[ 2 ] } ) ) ) );
+                const int iMaxY = std::min( kGrid - 1, static_cast< int >( std::ceil( std::max( { y[ 0 ], y[ 1 ], y[ 2 ] } ) ) ) );
+
+                for ( int py = iMinY; py <= iMaxY; ++py )
+                {
+                    for ( int px = iMinX; px <= iMaxX; ++px )
+                    {
+                        const float fX = static_cast< float >( px ) + 0.5f, fY = static_cast< float >( py ) + 0.5f;
+                        const float w0 = ( x[ 2 ] - x[ 1 ] ) * ( fY - y[ 1 ] ) - ( y[ 2 ] - y[ 1 ] ) * ( fX - x[ 1 ] );
+                        const float w1 = ( x[ 0 ] - x[ 2 ] ) * ( fY - y[ 2 ] ) - ( y[ 0 ] - y[ 2 ] ) * ( fX - x[ 2 ] );
+                        const float w2 = ( x[ 1 ] - x[ 0 ] ) * ( fY - y[ 0 ] ) - ( y[ 1 ] - y[ 0 ] ) * ( fX - x[ 0 ] );
+                        if ( w0 < 0.0f || w1 < 0.0f || w2 < 0.0f )
+                            continue;
+                        const float fDepth = ( w0 * z[ 0 ] + w1 * z[ 1 ] + w2 * z[ 2 ] ) / fArea;
+                        float&      fDest  = depthBuffer[ py * kGrid + px ];
+                        if ( fDepth < fDest )
+                        {
+                            if ( fDest == std::numeric_limits< float >::max() )
+                                ++szCovered;
+                            fDest = fDepth;
+                            ++szShaded;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return szCovered ? static_cast< float >( szShaded ) / static_cast< float >( szCovered ) : 1.0f;
+}
+
+mesh::Bounds computeBounds( const std::vector< Vertex >& vertices )
+{
+    mesh::Bounds bounds;
+    for ( int k = 0; k != 3; ++k )
+    {
+        bounds.min[ k ] = std::numeric_limits< float >::max();
+        bounds.max[ k ] = std::numeric_limits< float >::lowest();
+    }
+    for ( const Vertex& vertex : vertices )
+    {
+        for ( int k = 0; k != 3; ++k )
+        {
+            bounds.min[ k ] = std::min( bounds.min[ k ], vertex.position[ k ] );
+            bounds.max[ k ] = std::max( bounds.max[ k ], vertex.position[ k ] );
+        }
+    }
+    return bounds;
+}
+
+mesh::MeshData toMeshData( const SourceMesh& sourceMesh, bool bQuantise )
+{
+    mesh::MeshData meshData;
+    meshData.strName       = sourceMesh.strName;
+    meshData.bounds        = computeBounds( sourceMesh.vertices );
+    meshData.uiVertexCount = static_cast< std::uint32_t >( sourceMesh.vertices.size() );
+
+    if ( bQuantise )
+    {
+        meshData.vertexFormat   = mesh::VertexFormat::eQuantised;
+        meshData.uiVertexStride = sizeof( mesh::QuantisedVertex );
+        meshData.vertices.resize( sourceMesh.vertices.size() * sizeof( mesh::QuantisedVertex ) );
+        for ( std::size_t i = 0; i != sourceMesh.vertices.size(); ++i )
+        {
+            const Vertex&               vertex    = sourceMesh.vertices[ i ];
+            const mesh::QuantisedVertex quantised = mesh::quantiseVertex( meshData.bounds, vertex.position, vertex.normal, vertex.uv );
+            std::memcpy( meshData.vertices.data() + i * sizeof( mesh::QuantisedVertex ), &quantised, sizeof( quantised ) );
+        }
+    }
+    else
+    {
+        meshData.vertexFormat   = mesh::VertexFormat::eFloat32;
+        meshData.uiVertexStride = sizeof( Vertex );
+        meshData.vertices.resize( sourceMesh.vertices.size() * sizeof( Vertex ) );
+        std::memcpy( meshData.vertices.data(), sourceMesh.vertices.data(), meshData.vertices.size() );
+    }
+
+    meshData.uiIndexCount = static_cast< std::uint32_t >( sourceMesh.indices.size() );
+    meshData.lods         = sourceMesh.lods;
+    if ( sourceMesh.vertices.size() <= 0x10000U )
+    {
+        meshData.indexFormat = mesh::IndexFormat::eUInt16;
+        meshData.indices.resize( sourceMesh.indices.size() * sizeof( std::uint16_t ) );
+        std::uint16_t* pIndices = reinterpret_cast< std::uint16_t* >( meshData.indices.data() );
+        for ( std::size_t i = 0; i != sourceMesh.indices.size(); ++i )
+            pIndices[ i ] = static_cast< std::uint16_t >( sourceMesh.indices[ i ] );
+    }
+    else
+    {
+        meshData.indexFormat = mesh::IndexFormat::eUInt32;
+        meshData.indices.resize( sourceMesh.indices.size() * sizeof( std::uint32_t ) );
+        std::memcpy( meshData.indices.data(), sourceMesh.indices.data(), meshData.indices.size() );
+    }
+    return meshData;
+}
+
+} // namespace tools
+} // namespace retail
@@ -0,0 +1,71 @@
+#ifndef MESH_OPTIMISE_12_OCTOBER_2022
+#define MESH_OPTIMISE_12_OCTOBER_2022
+
+#include "mesh_file.hpp"
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace retail
+{
+namespace tools
+{
+    struct Vertex
+    {
+        float position[ 3 ];
+        float normal[ 3 ];
+        float uv[ 2 ];
+    };
+
+    struct SourceMesh
+    {
+        std::string                  strName;
+        std::vector< Vertex >        vertices;
+        std::vector< std::uint32_t > indices;
+        std::vector< mesh::MeshLod > lods; // ranges of indices - empty until generateLods
+    };
+
+    // triangulated wavefront obj with vertices de-duplicated on position / normal / uv
+    SourceMesh loadObj( const boost::filesystem::path& filePath );
+
+    // Forsyth's linear speed vertex cache optimisation
+    void optimiseVertexCache( std::vector< std::uint32_t >& indices, std::size_t szVertexCount );
+
+    // Split the cache optimised order into clusters at cache flushes and sort the clusters so
+    // outward facing, likely occluding, clusters draw first.  The result is kept only if the
+    // ACMR stays within fThreshold of the input.
+    void optimiseOverdraw( std::vector< std::uint32_t >& indices,
+                           const std::vector< Vertex >&  vertices,
+                           float                         fThreshold = 1.05f );
+
+    // renumber vertices in order of first use so vertex fetch walks memory linearly
+    void optimiseVertexFetch( SourceMesh& mesh );
+
+    // Append a chain of simplified index lists to the mesh by vertex clustering.  Each level keeps
+    // roughly fReduction of the triangles of the previous one and only references existing vertices
+    // so every level shares the vertex stream.  Level 0 is the full detail index list.
+    void generateLods( SourceMesh& mesh, std::uint32_t uiMaxLods, float fReduction = 0.5f,
+                       std::size_t szMinTriangles = 32U );
+
+    struct CacheStats
+    {
+        float fACMR; // transformed vertices per triangle
+        float fATVR; // transformed vertices per vertex
+    };
+    CacheStats analyseVertexCache( const std::vector< std::uint32_t >& indices,
+                                   std::size_t                         szVertexCount,
+                                   std::size_t                         szCacheSize = 16U );
+
+    // shaded pixels over covered pixels averaged over six axis aligned orthographic views
+    float analyseOverdraw( const std::vector< std::uint32_t >& indices, const std::vector< Vertex >& vertices );
+
+    mesh::Bounds   computeBounds( const std::vector< Vertex >& vertices );
+    mesh::MeshData toMeshData( const SourceMesh& sourceMesh, bool bQuantise );
+
+} // namespace tools
+} // namespace retail
+
+#endif // MESH_OPTIMISE_12_OCTOBER_2022
@@ -0,0 +1,126 @@
+
+#include "mesh_optimise.hpp"
+
+#include "mesh_file.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Offline mesh optimiser - converts obj files into a binary mesh catalogue with indices reordered
+// for the post transform cache and overdraw and attributes quantised for shaders/shader.vert
+int main( int argc, const char* argv[] )
+{
+    namespace po = boost::program_options;
+    using namespace retail;
+
+    try
+    {
+        std::string                strOutput;
+        std::vector< std::string > inputs;
+        bool                       bNoQuantise = false;
+        std::uint32_t              uiLods      = 6U;
+
+        po::options_description options( "mesh_optimiser options" );
+        // clang-format off
+        options.add_options()
+            ( "help",           "Produce help message" )
+            ( "output,o",       po::value< std::string >( &strOutput ), "Output mesh catalogue" )
+            ( "input",          po::value< std::vector< std::string > >( &inputs ), "Input obj files" )
+            ( "no_quantise",    po::bool_switch( &bNoQuantise ), "Write float vertices instead of quantised" )
+            ( "lods",           po::value< std::uint32_t >( &uiLods )->default_value( uiLods ),
+                                "Maximum levels of detail including full detail" )
+            ;
+        // clang-format on
+        po::positional_options_description positional;
+        positional.add( "input", -1 );
+
+        po::variables_map vm;
+        po::store( po::command_line_parser( argc, argv ).options( options ).positional( positional ).run(), vm );
+        po::notify( vm );
+
+        if ( vm.count( "help" ) || strOutput.empty() || inputs.empty() )
+        {
+            std::cout << "mesh_optimiser -o <catalogue> <obj>...\n" << options << std::endl;
+            return vm.count( "help" ) ? 0 : 1;
+        }
+
+        std::vector< mesh::MeshData > meshes;
+        std::size_t                   szSourceBytes = 0U, szOutputBytes = 0U;
+        for ( const std::string& strInput : inputs )
+        {
+            tools::SourceMesh sourceMesh = tools::loadObj( strInput );
+
+            const tools::CacheStats before   = tools::analyseVertexCache( sourceMesh.indices, sourceMesh.vertices.size() );
+            const float             fOverdrawBefore = tools::analyseOverdraw( sourceMesh.indices, sourceMesh.vertices );
+
+            const auto startTime = std::chrono::steady_clock::now();
+            tools::optimiseVertexCache( sourceMesh.indices, sourceMesh.vertices.size() );
+            tools::optimiseOverdraw( sourceMesh.indices, sourceMesh.vertices );
+            tools::optimiseVertexFetch( sourceMesh );
+            const auto elapsed = std::chrono::duration_cast< std::chrono::microseconds >(
+                std::chrono::steady_clock::now() - startTime );
+
+            const tools::CacheStats after  = tools::analyseVertexCache( sourceMesh.indices, sourceMesh.vertices.size() );
+            const float             fOverdrawAfter = tools::analyseOverdraw( sourceMesh.indices, sourceMesh.vertices );
+
+            const std::size_t szTriangles = sourceMesh.indices.size() / 3U;
+
+            tools::generateLods( sourceMesh, std::min( std::max( uiLods, 1U ), mesh::kMaxLods ) );
+            for ( std::size_t i = 0; i != sourceMesh.lods.size(); ++i )
+            {
+                SPDLOG_INFO( "{}: lod {} {} triangles error {:.5f}",
+                             sourceMesh.strName,
+                             i,
+                             sourceMesh.lods[ i ].uiIndexCount / 3U,
+                             sourceMesh.lods[ i ].fError );
+            }
+
+            mesh::MeshData meshData = tools::toMeshData( sourceMesh, !bNoQuantise );
+
+            const std::size_t szSource = sourceMesh.vertices.size() * sizeof( tools::Vertex )
+                                         + szTriangles * 3U * sizeof( std::uint32_t );
+            const std::size_t szOutput = meshData.vertices.size() + meshData.indices.size();
+            szSourceBytes += szSource;
+            szOutputBytes += szOutput;
+
+            SPDLOG_INFO( "{}: {} triangles {} vertices optimised in {}us ({:.1f} Mtri/s)",
+                         meshData.strName,
+                         szTriangles,
+                         sourceMesh.vertices.size(),
+                         elapsed.count(),
+                         elapsed.count() ? static_cast< double >( szTriangles ) / elapsed.count() : 0.0 );
+            SPDLOG_INFO( "{}: ACMR {:.3f} -> {:.3f} ATVR {:.3f} -> {:.3f} overdraw {:.3f} -> {:.3f}",
+                         meshData.strName,
+                         before.fACMR,
+                         after.fACMR,
+                         before.fATVR,
+                         after.fATVR,
+                         fOverdrawBefore,
+                         fOverdrawAfter );
+            SPDLOG_INFO( "{}: {} bytes -> {} bytes including lods ({} byte vertices, {} byte indices)",
+                         meshData.strName,
+                         szSource,
+                         szOutput,
+                         meshData.uiVertexStride,
+                         meshData.indexFormat == mesh::IndexFormat::eUInt16 ? 2 : 4 );
+
+            meshes.emplace_back( std::move( meshData ) );
+        }
+
+        mesh::writeMeshFile( strOutput, meshes );
+        SPDLOG_INFO( "Wrote {} meshes to: {} total {} bytes -> {} bytes", meshes.size(), strOutput, szSourceBytes, szOutputBytes );
+    }
+    catch ( std::exception& ex )
+    {
+        SPDLOG_ERROR( "Exception: {}", ex.what() );
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,149 @@
+#include "async_file_reader.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <boost/program_options.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Asynchronous read benchmark - reads a whole file in blocks through each backend at increasing
+// queue depths with the file's pages evicted from the page cache before every pass
+int main( int argc, const char* argv[] )
+{
+    namespace po = boost::program_options;
+    using namespace retail;
+
+    try
+    {
+        std::string   strFile;
+        std::uint32_t uiBlockKB  = 256U;
+        std::uint32_t uiMaxDepth = 64U;
+        std::uint32_t uiThreads  = 4U;
+        bool          bBuffered  = false;
+
+        po::options_description options( "read_benchmark options" );
+        // clang-format off
+        options.add_options()
+            ( "help",       "Produce help message" )
+            ( "file",       po::value< std::string >( &strFile ), "File to read" )
+            ( "block_kb",   po::value< std::uint32_t >( &uiBlockKB )->default_value( uiBlockKB ),
+                            "Kilobytes per read" )
+            ( "depth",      po::value< std::uint32_t >( &uiMaxDepth )->default_value( uiMaxDepth ),
+                            "Largest queue depth - every power of two up to it is timed" )
+            ( "threads",    po::value< std::uint32_t >( &uiThreads )->default_value( uiThreads ),
+                            "Threads for the thread pool backend" )
+            ( "buffered",   po::bool_switch( &bBuffered ),
+                            "Read through the page cache instead of with O_DIRECT" )
+            ;
+        // clang-format on
+
+        po::variables_map vm;
+        po::store( po::parse_command_line( argc, argv, options ), vm );
+        po::notify( vm );
+
+        if ( vm.count( "help" ) || strFile.empty() )
+        {
+            std::cout << options << std::endl;
+            return vm.count( "help" ) ? 0 : 1;
+        }
+        if ( uiBlockKB == 0U || uiMaxDepth == 0U || uiMaxDepth > 4096U || uiThreads == 0U )
+        {
+            SPDLOG_ERROR( "Invalid options" );
+            return 1;
+        }
+
+        const std::uint64_t uiBlockSize = static_cast< std::uint64_t >( uiBlockKB ) * 1024U;
+
+        for ( AsyncFileReader::Backend backend :
+              { AsyncFileReader::Backend::eIoUring, AsyncFileReader::Backend::eThreadPool } )
+        {
+            for ( std::uint32_t uiDepth = 1U; uiDepth <= uiMaxDepth; uiDepth *= 2U )
+            {
+                AsyncFileReader reader( backend, uiDepth, uiThreads );
+                if ( reader.getBackend() != backend )
+                    break;
+
+                const AsyncFileReader::File file       = reader.open( strFile, !bBuffered );
+                const std::uint64_t         uiFileSize = reader.getFileSize( file );
+                if ( uiFileSize == 0U )
+                {
+                    SPDLOG_ERROR( "Empty file: {}", strFile );
+                    return 1;
+                }
+
+                // clean pages are dropped without privileges so every pass reads from the device
+                {
+                    const int iFile = ::open( strFile.c_str(), O_RDONLY | O_CLOEXEC );
+                    if ( iFile >= 0 )
+                    {
+                        ::posix_fadvise( iFile, 0, 0, POSIX_FADV_DONTNEED );
+                        ::close( iFile );
+                    }
+                }
+
+                // one page aligned block per read in flight - each completion reads the next block
+                // into the block it filled
+                std::unique_ptr< std::uint8_t, decltype( &std::free ) > pBlocks(
+                    static_cast< std::uint8_t* >( std::aligned_alloc(
+                        AsyncFileReader::kDirectAlignment, uiBlockSize * uiDepth ) ),
+                    &std::free );
+                std::uint64_t uiNextOffset = 0U;
+                std::uint32_t uiFailed     = 0U;
+
+                std::function< void( std::uint8_t* ) > readNext = [ & ]( std::uint8_t* pBlock )
+                {
+                    if ( uiNextOffset == uiFileSize )
+                        return;
+                    const std::uint64_t uiSize = std::min( uiBlockSize, uiFileSize - uiNextOffset );
+                    reader.read( file,
+                                 uiNextOffset,
+                                 uiSize,
+                                 pBlock,
+                                 [ &, pBlock ]( std::int64_t iResult )
+                                 {
+                                     if ( iResult < 0 )
+                                         ++uiFailed;
+                                     readNext( pBlock );
+                                 } );
+                    uiNextOffset += uiSize;
+                };
+
+                const auto startTime = std::chrono::steady_clock::now();
+                for ( std::uint32_t i = 0; i != uiDepth; ++i )
+                    readNext( pBlocks.get() + i * uiBlockSize );
+                reader.wait();
+                const double fSeconds
+                    = std::chrono::duration< double >( std::chrono::steady_clock::now() - startTime ).count();
+
+                const AsyncFileReader::Stats& stats = reader.getStats();
+                SPDLOG_INFO( "{} depth {}: {:.1f}MB/s {} reads {} pieces {} direct {} failed queue depth mean {:.1f} "
+                             "max {}",
+                             AsyncFileReader::toString( backend ),
+                             uiDepth,
+                             static_cast< double >( uiFileSize ) / ( fSeconds * 1024.0 * 1024.0 ),
+                             stats.uiRequests,
+                             stats.uiPieces,
+                             stats.uiDirect,
+                             uiFailed,
+                             stats.getMeanDepth(),
+                             stats.uiMaxDepth );
+            }
+        }
+    }
+    catch ( std::exception& ex )
+    {
+        SPDLOG_ERROR( "Exception: {}", ex.what() );
+        return 1;
+    }
+    return 0;
+}
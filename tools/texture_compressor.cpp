@@ -0,0 +1,180 @@
+#include "block_compress.hpp"
+
+#include "texture_file.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Offline texture compressor - encodes a ppm or pam image and its mip chain into BC1, BC3 or BC7
+// blocks the runtime copies straight into a compressed image
+int main( int argc, const char* argv[] )
+{
+    namespace po = boost::program_options;
+    using namespace retail;
+
+    try
+    {
+        std::string   strOutput;
+        std::string   strInput;
+        std::string   strFormat   = "bc7";
+        std::string   strKernel   = toString( getBestSimdKernel() );
+        bool          bLinear     = false;
+        bool          bNoMips     = false;
+        std::uint32_t uiWorkers   = WorkerPool::getDefaultWorkerCount();
+        std::uint32_t uiBenchmark = 0U;
+
+        po::options_description options( "texture_compressor options" );
+        // clang-format off
+        options.add_options()
+            ( "help",       "Produce help message" )
+            ( "output,o",   po::value< std::string >( &strOutput ), "Output texture file" )
+            ( "input",      po::value< std::string >( &strInput ), "Input ppm or pam image" )
+            ( "format",     po::value< std::string >( &strFormat )->default_value( strFormat ),
+                            "Block format - bc1, bc3 or bc7" )
+            ( "linear",     po::bool_switch( &bLinear ), "Colour is linear rather than sRGB encoded" )
+            ( "no_mips",    po::bool_switch( &bNoMips ), "Write the full resolution image only" )
+            ( "kernel",     po::value< std::string >( &strKernel )->default_value( strKernel ),
+                            "Encoding kernel - scalar, sse or avx2" )
+            ( "workers",    po::value< std::uint32_t >( &uiWorkers )->default_value( uiWorkers ),
+                            "Worker threads in addition to the main thread" )
+            ( "benchmark",  po::value< std::uint32_t >( &uiBenchmark )->default_value( uiBenchmark ),
+                            "Timed repeats of the full resolution image through each kernel - the best is reported" )
+            ;
+        // clang-format on
+        po::positional_options_description positional;
+        positional.add( "input", 1 );
+
+        po::variables_map vm;
+        po::store( po::command_line_parser( argc, argv ).options( options ).positional( positional ).run(), vm );
+        po::notify( vm );
+
+        if ( vm.count( "help" ) || strOutput.empty() || strInput.empty() )
+        {
+            std::cout << "texture_compressor -o <texture> <image>\n" << options << std::endl;
+            return vm.count( "help" ) ? 0 : 1;
+        }
+
+        texture::Format format = texture::Format::eBC7;
+        if ( strFormat == texture::toString( texture::Format::eBC1 ) )
+            format = texture::Format::eBC1;
+        else if ( strFormat == texture::toString( texture::Format::eBC3 ) )
+            format = texture::Format::eBC3;
+        else if ( strFormat != texture::toString( texture::Format::eBC7 ) )
+        {
+            SPDLOG_ERROR( "Unknown format: {}", strFormat );
+            return 1;
+        }
+
+        const std::vector< SimdKernel > kernels{ SimdKernel::eScalar, SimdKernel::eSSE, SimdKernel::eAVX2 };
+        const auto                      iKernel = std::find_if(
+            kernels.begin(), kernels.end(), [ & ]( SimdKernel kernel ) { return strKernel == toString( kernel ); } );
+        if ( iKernel == kernels.end() || !isSupported( *iKernel ) )
+        {
+            SPDLOG_ERROR( "Unknown or unsupported kernel: {}", strKernel );
+            return 1;
+        }
+
+        WorkerPool         workers( uiWorkers );
+        const tools::Image image = tools::loadImage( strInput );
+        const double       fMegaTexels
+            = static_cast< double >( image.uiWidth ) * static_cast< double >( image.uiHeight ) / 1000000.0;
+
+        using Clock = std::chrono::steady_clock;
+        if ( uiBenchmark != 0U )
+        {
+            // scalar blocks are the reference the simd kernels must match exactly
+            const std::vector< std::uint8_t > reference
+                = tools::compressImage( image, format, SimdKernel::eScalar, nullptr );
+            auto timeCompress = [ & ]( SimdKernel kernel, WorkerPool* pWorkers, bool& bMatches )
+            {
+                std::chrono::nanoseconds best = std::chrono::nanoseconds::max();
+                for ( std::uint32_t i = 0; i != uiBenchmark; ++i )
+                {
+                    const auto startTime = Clock::now();
+                    const std::vector< std::uint8_t > blocks
+                        = tools::compressImage( image, format, kernel, pWorkers );
+                    best = std::min(
+                        best, std::chrono::duration_cast< std::chrono::nanoseconds >( Clock::now() - startTime ) );
+                    bMatches = blocks == reference;
+                }
+                return static_cast< double >( best.count() ) / 1000000.0;
+            };
+
+            for ( SimdKernel kernel : kernels )
+            {
+                if ( !isSupported( kernel ) )
+                {
+                    SPDLOG_INFO( "{}: not supported", toString( kernel ) );
+                    continue;
+                }
+                bool         bSingleMatches = false, bParallelMatches = false;
+                const double fSingleMS   = timeCompress( kernel, nullptr, bSingleMatches );
+                const double fParallelMS = timeCompress( kernel, &workers, bParallelMatches );
+                SPDLOG_INFO( "{} {}: {:.3f}ms {:.1f} Mtexels/s - {} threads {:.3f}ms {:.1f} Mtexels/s - {}",
+                             texture::toString( format ),
+                             toString( kernel ),
+                             fSingleMS,
+                             fMegaTexels * 1000.0 / fSingleMS,
+                             workers.getThreadCount(),
+                             fParallelMS,
+                             fMegaTexels * 1000.0 / fParallelMS,
+                             bSingleMatches && bParallelMatches ? "matches scalar" : "DIFFERS FROM SCALAR" );
+            }
+        }
+
+        texture::TextureData textureData;
+        textureData.format   = format;
+        textureData.uiFlags  = bLinear ? 0U : texture::kFlagSrgb;
+        textureData.uiWidth  = image.uiWidth;
+        textureData.uiHeight = image.uiHeight;
+
+        const auto                        startTime = Clock::now();
+        const std::vector< tools::Image > mips
+            = bNoMips ? std::vector< tools::Image >{ image } : tools::generateMips( image, !bLinear, &workers );
+        const auto mipTime = Clock::now();
+
+        std::uint64_t uiTexels = 0U, uiUncompressedBytes = 0U, uiCompressedBytes = 0U;
+        for ( const tools::Image& mip : mips )
+        {
+            textureData.mips.push_back( tools::compressImage( mip, format, *iKernel, &workers ) );
+            uiTexels += static_cast< std::uint64_t >( mip.uiWidth ) * mip.uiHeight;
+            uiUncompressedBytes += mip.texels.size();
+            uiCompressedBytes += textureData.mips.back().size();
+        }
+        const auto endTime = Clock::now();
+
+        texture::writeTextureFile( strOutput, textureData );
+
+        const double fEncodeMS = std::chrono::duration< double, std::milli >( endTime - mipTime ).count();
+        SPDLOG_INFO( "{}: {}x{} {} mips {} {} - mips {:.2f}ms encode {:.2f}ms {:.1f} Mtexels/s {} kernel {} threads",
+                     strInput,
+                     image.uiWidth,
+                     image.uiHeight,
+                     mips.size(),
+                     texture::toString( format ),
+                     bLinear ? "linear" : "srgb",
+                     std::chrono::duration< double, std::milli >( mipTime - startTime ).count(),
+                     fEncodeMS,
+                     static_cast< double >( uiTexels ) / 1000.0 / fEncodeMS,
+                     toString( *iKernel ),
+                     workers.getThreadCount() );
+        SPDLOG_INFO( "{}: {} bytes against {} bytes as rgba8 - {:.1f}x smaller",
+                     strOutput,
+                     uiCompressedBytes,
+                     uiUncompressedBytes,
+                     static_cast< double >( uiUncompressedBytes ) / static_cast< double >( uiCompressedBytes ) );
+    }
+    catch ( std::exception& ex )
+    {
+        SPDLOG_ERROR( "Exception: {}", ex.what() );
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,180 @@
+#include "transform_store.hpp"
+#include "worker_pool.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Transform hierarchy benchmark - times full and dirty subtree world matrix updates through each
+// kernel the cpu supports on one thread and across the worker pool
+int main( int argc, const char* argv[] )
+{
+    namespace po = boost::program_options;
+    using namespace retail;
+
+    try
+    {
+        std::uint32_t uiNodes   = 131072U;
+        std::uint32_t uiFanout  = 4U;
+        float         fDirty    = 1.0f;
+        std::uint32_t uiRepeats = 10U;
+        std::uint32_t uiWorkers = WorkerPool::getDefaultWorkerCount();
+
+        po::options_description options( "transform_benchmark options" );
+        // clang-format off
+        options.add_options()
+            ( "help",       "Produce help message" )
+            ( "nodes",      po::value< std::uint32_t >( &uiNodes )->default_value( uiNodes ), "Transform nodes" )
+            ( "fanout",     po::value< std::uint32_t >( &uiFanout )->default_value( uiFanout ),
+                            "Children per node" )
+            ( "dirty",      po::value< float >( &fDirty )->default_value( fDirty ),
+                            "Percentage of nodes moved per frame for the dirty subtree update" )
+            ( "repeats",    po::value< std::uint32_t >( &uiRepeats )->default_value( uiRepeats ),
+                            "Timed repeats - the best is reported" )
+            ( "workers",    po::value< std::uint32_t >( &uiWorkers )->default_value( uiWorkers ),
+                            "Worker threads in addition to the main thread" )
+            ;
+        // clang-format on
+
+        po::variables_map vm;
+        po::store( po::parse_command_line( argc, argv, options ), vm );
+        po::notify( vm );
+
+        if ( vm.count( "help" ) )
+        {
+            std::cout << options << std::endl;
+            return 0;
+        }
+        if ( uiNodes == 0U || uiFanout == 0U || uiRepeats == 0U || fDirty < 0.0f || fDirty > 100.0f )
+        {
+            SPDLOG_ERROR( "Invalid options" );
+            return 1;
+        }
+
+        std::mt19937                            random( 1234U );
+        std::uniform_real_distribution< float > offset( -1.0f, 1.0f );
+        auto randomLocal = [ & ]()
+        {
+            return translation( Vec3{ offset( random ), offset( random ), offset( random ) } )
+                   * scaling( Vec3{ 0.99f, 0.99f, 0.99f } );
+        };
+
+        // node i has children i * fanout + 1 onwards - created depth first so the store has to
+        // sort them into depth order
+        TransformStore store;
+        store.reserve( uiNodes );
+        std::vector< TransformStore::Node > nodes( uiNodes );
+        {
+            std::vector< std::uint32_t > stack{ 0U };
+            while ( !stack.empty() )
+            {
+                const std::uint32_t i = stack.back();
+                stack.pop_back();
+                const TransformStore::Node parent
+                    = i == 0U ? TransformStore::kNoParent : nodes[ ( i - 1U ) / uiFanout ];
+                nodes[ i ] = store.add( randomLocal(), parent );
+                for ( std::uint32_t uiChild = uiFanout; uiChild != 0U; --uiChild )
+                {
+                    const std::uint64_t uiChildIndex = static_cast< std::uint64_t >( i ) * uiFanout + uiChild;
+                    if ( uiChildIndex < uiNodes )
+                        stack.push_back( static_cast< std::uint32_t >( uiChildIndex ) );
+                }
+            }
+        }
+
+        WorkerPool workers( uiWorkers );
+
+        using Clock = std::chrono::steady_clock;
+        auto timeUpdate = [ & ]( WorkerPool* pWorkers, auto&& prepare, std::uint32_t& uiRecomputed )
+        {
+            std::chrono::nanoseconds best = std::chrono::nanoseconds::max();
+            for ( std::uint32_t i = 0; i != uiRepeats; ++i )
+            {
+                prepare();
+                const auto startTime = Clock::now();
+                uiRecomputed         = store.update( pWorkers );
+                best                 = std::min(
+                    best, std::chrono::duration_cast< std::chrono::nanoseconds >( Clock::now() - startTime ) );
+            }
+            return static_cast< double >( best.count() ) / 1000000.0;
+        };
+
+        {
+            const auto startTime = Clock::now();
+            store.update();
+            SPDLOG_INFO( "Transform benchmark: {} nodes {} depths sort and first update: {:.2f}ms",
+                         store.size(),
+                         store.getDepthCount(),
+                         std::chrono::duration< double, std::milli >( Clock::now() - startTime ).count() );
+        }
+
+        // scalar results are the reference the simd kernels are compared against
+        store.setKernel( SimdKernel::eScalar );
+        store.markAllDirty();
+        store.update();
+        std::vector< Mat4 > reference( uiNodes );
+        for ( std::uint32_t i = 0; i != uiNodes; ++i )
+            reference[ i ] = store.getWorld( nodes[ i ] );
+
+        const std::uint32_t uiDirtyNodes = static_cast< std::uint32_t >( uiNodes * fDirty / 100.0f );
+        std::vector< TransformStore::Node > dirtyNodes( uiDirtyNodes );
+        std::uniform_int_distribution< std::uint32_t > pick( 0U, uiNodes - 1U );
+        for ( TransformStore::Node& node : dirtyNodes )
+            node = nodes[ pick( random ) ];
+
+        auto markAll   = [ & ]() { store.markAllDirty(); };
+        auto markDirty = [ & ]()
+        {
+            for ( TransformStore::Node node : dirtyNodes )
+                store.setLocal( node, store.getLocal( node ) );
+        };
+
+        for ( SimdKernel kernel : { SimdKernel::eScalar, SimdKernel::eSSE, SimdKernel::eAVX2 } )
+        {
+            if ( !isSupported( kernel ) )
+            {
+                SPDLOG_INFO( "{}: not supported", toString( kernel ) );
+                continue;
+            }
+            store.setKernel( kernel );
+
+            std::uint32_t uiFull = 0U, uiSubtrees = 0U;
+            const double  fSingleMS   = timeUpdate( nullptr, markAll, uiFull );
+            const double  fParallelMS = timeUpdate( &workers, markAll, uiFull );
+            const double  fDirtyMS    = timeUpdate( &workers, markDirty, uiSubtrees );
+
+            float fMaxError = 0.0f;
+            for ( std::uint32_t i = 0; i != uiNodes; ++i )
+            {
+                const Mat4& world = store.getWorld( nodes[ i ] );
+                for ( int j = 0; j != 16; ++j )
+                    fMaxError = std::max( fMaxError, std::abs( world.m[ j ] - reference[ i ].m[ j ] ) );
+            }
+
+            SPDLOG_INFO( "{}: full {:.3f}ms {:.1f}ns per node - {} threads {:.3f}ms - {} dirty nodes recompute {} "
+                         "in {:.3f}ms - max error {}",
+                         toString( kernel ),
+                         fSingleMS,
+                         fSingleMS * 1000000.0 / uiFull,
+                         workers.getThreadCount(),
+                         fParallelMS,
+                         uiDirtyNodes,
+                         uiSubtrees,
+                         fDirtyMS,
+                         fMaxError );
+        }
+    }
+    catch ( std::exception& ex )
+    {
+        SPDLOG_ERROR( "Exception: {}", ex.what() );
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,324 @@
+#include "transform_store.hpp"
+#include "worker_pool.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace retail
+{
+
+namespace
+{
+struct SlotArrays
+{
+    const float*         pLocal;
+    float*               pWorld;
+    const std::uint32_t* pParents;
+    std::uint8_t*        pDirty;
+};
+
+// every kernel updates a range of slots below the roots so each slot has a parent
+using UpdateFunction = std::uint32_t ( * )( const SlotArrays&, std::uint32_t, std::uint32_t );
+
+// inherits the parent's dirty flag - the parent's depth completed before this one started
+inline bool propagateDirty( const SlotArrays& arrays, std::uint32_t uiSlot )
+{
+    if ( arrays.pDirty[ uiSlot ] )
+        return true;
+    if ( !arrays.pDirty[ arrays.pParents[ uiSlot ] ] )
+        return false;
+    arrays.pDirty[ uiSlot ] = 1U;
+    return true;
+}
+
+std::uint32_t updateScalar( const SlotArrays& arrays, std::uint32_t uiBegin, std::uint32_t uiEnd )
+{
+    std::uint32_t uiRecomputed = 0U;
+    for ( std::uint32_t uiSlot = uiBegin; uiSlot != uiEnd; ++uiSlot )
+    {
+        if ( !propagateDirty( arrays, uiSlot ) )
+            continue;
+        const float* a = arrays.pWorld + arrays.pParents[ uiSlot ] * 16U;
+        const float* b = arrays.pLocal + uiSlot * 16U;
+        float*       r = arrays.pWorld + uiSlot * 16U;
+        for ( int c = 0; c != 4; ++c )
+        {
+            for ( int i = 0; i != 4; ++i )
+            {
+                r[ c * 4 + i ] = a[ i ] * b[ c * 4 ] + a[ 4 + i ] * b[ c * 4 + 1 ] + a[ 8 + i ] * b[ c * 4 + 2 ]
+                                 + a[ 12 + i ] * b[ c * 4 + 3 ];
+            }
+        }
+        ++uiRecomputed;
+    }
+    return uiRecomputed;
+}
+
+#ifdef RETAIL_SIMD_X86
+// result column c is the parent's columns weighted by the four elements of local column c
+std::uint32_t updateSSE( const SlotArrays& arrays, std::uint32_t uiBegin, std::uint32_t uiEnd )
+{
+    std::uint32_t uiRecomputed = 0U;
+    for ( std::uint32_t uiSlot = uiBegin; uiSlot != uiEnd; ++uiSlot )
+    {
+        if ( !propagateDirty( arrays, uiSlot ) )
+            continue;
+        const float* a  = arrays.pWorld + arrays.pParents[ uiSlot ] * 16U;
+        const float* b  = arrays.pLocal + uiSlot * 16U;
+        float*       r  = arrays.pWorld + uiSlot * 16U;
+        const __m128 a0 = _mm_load_ps( a );
+        const __m128 a1 = _mm_load_ps( a + 4 );
+        const __m128 a2 = _mm_load_ps( a + 8 );
+        const __m128 a3 = _mm_load_ps( a + 12 );
+        for ( int c = 0; c != 4; ++c )
+        {
+            const __m128 bc = _mm_load_ps( b + c * 4 );
+            __m128       rc = _mm_mul_ps( a0, _mm_shuffle_ps( bc, bc, _MM_SHUFFLE( 0, 0, 0, 0 ) ) );
+            rc              = _mm_add_ps( rc, _mm_mul_ps( a1, _mm_shuffle_ps( bc, bc, _MM_SHUFFLE( 1, 1, 1, 1 ) ) ) );
+            rc              = _mm_add_ps( rc, _mm_mul_ps( a2, _mm_shuffle_ps( bc, bc, _MM_SHUFFLE( 2, 2, 2, 2 ) ) ) );
+            rc              = _mm_add_ps( rc, _mm_mul_ps( a3, _mm_shuffle_ps( bc, bc, _MM_SHUFFLE( 3, 3, 3, 3 ) ) ) );
+            _mm_store_ps( r + c * 4, rc );
+        }
+        ++uiRecomputed;
+    }
+    return uiRecomputed;
+}
+
+// two result columns per register - the parent's columns are broadcast to both lanes and the
+// in-lane shuffle picks element k of local column c in the low lane and c + 1 in the high lane
+RETAIL_TARGET_AVX2 std::uint32_t updateAVX2( const SlotArrays& arrays, std::uint32_t uiBegin, std::uint32_t uiEnd )
+{
+    std::uint32_t uiRecomputed = 0U;
+    for ( std::uint32_t uiSlot = uiBegin; uiSlot != uiEnd; ++uiSlot )
+    {
+        if ( !propagateDirty( arrays, uiSlot ) )
+            continue;
+        const float* a  = arrays.pWorld + arrays.pParents[ uiSlot ] * 16U;
+        const float* b  = arrays.pLocal + uiSlot * 16U;
+        float*       r  = arrays.pWorld + uiSlot * 16U;
+        const __m256 a0 = _mm256_broadcast_ps( reinterpret_cast< const __m128* >( a ) );
+        const __m256 a1 = _mm256_broadcast_ps( reinterpret_cast< const __m128* >( a + 4 ) );
+        const __m256 a2 = _mm256_broadcast_ps( reinterpret_cast< const __m128* >( a + 8 ) );
+        const __m256 a3 = _mm256_broadcast_ps( reinterpret_cast< const __m128* >( a + 12 ) );
+        for ( int c = 0; c != 4; c += 2 )
+        {
+            const __m256 bc = _mm256_load_ps( b + c * 4 );
+            __m256       rc = _mm256_mul_ps( a0, _mm256_shuffle_ps( bc, bc, _MM_SHUFFLE( 0, 0, 0, 0 ) ) );
+            rc              = _mm256_fmadd_ps( a1, _mm256_shuffle_ps( bc, bc, _MM_SHUFFLE( 1, 1, 1, 1 ) ), rc );
+            rc              = _mm256_fmadd_ps( a2, _mm256_shuffle_ps( bc, bc, _MM_SHUFFLE( 2, 2, 2, 2 ) ), rc );
+            rc              = _mm256_fmadd_ps( a3, _mm256_shuffle_ps( bc, bc, _MM_SHUFFLE( 3, 3, 3, 3 ) ), rc );
+            _mm256_store_ps( r + c * 4, rc );
+        }
+        ++uiRecomputed;
+    }
+    return uiRecomputed;
+}
+#endif
+
+UpdateFunction getUpdateFunction( SimdKernel kernel )
+{
+    switch ( kernel )
+    {
+#ifdef RETAIL_SIMD_X86
+        case SimdKernel::eSSE:
+            return &updateSSE;
+        case SimdKernel::eAVX2:
+            return &updateAVX2;
+#endif
+        default:
+            return &updateScalar;
+    }
+}
+
+// runs fnRange over [uiBegin, uiEnd) in chunks across the pool - returns the summed results
+template < typename TFunction >
+std::uint32_t forRange( WorkerPool* pWorkers, std::uint32_t uiBegin, std::uint32_t uiEnd, TFunction&& fnRange )
+{
+    if ( !pWorkers )
+        return fnRange( uiBegin, uiEnd );
+
+    std::atomic< std::uint32_t > uiTotal{ 0U };
+    pWorkers->parallelFor( uiEnd - uiBegin,
+                           TransformStore::kChunkSize,
+                           [ & ]( std::uint32_t uiChunkBegin, std::uint32_t uiChunkEnd )
+                           {
+                               uiTotal.fetch_add( fnRange( uiBegin + uiChunkBegin, uiBegin + uiChunkEnd ),
+                                                  std::memory_order_relaxed );
+                           } );
+    return uiTotal.load( std::memory_order_relaxed );
+}
+} // namespace
+
+TransformStore::TransformStore()
+    : m_depthStarts{ 0U }
+    , m_kernel( getBestSimdKernel() )
+{
+}
+
+void TransformStore::setKernel( SimdKernel kernel )
+{
+    VERIFY_RTE_MSG( isSupported( kernel ), "Transform kernel not supported: " << toString( kernel ) );
+    m_kernel = kernel;
+}
+
+void TransformStore::reserve( std::uint32_t uiNodes )
+{
+    m_local.reserve( uiNodes );
+    m_world.reserve( uiNodes );
+    m_parentSlots.reserve( uiNodes );
+    m_dirty.reserve( uiNodes );
+    m_depths.reserve( uiNodes );
+    m_slotNodes.reserve( uiNodes );
+    m_nodeSlots.reserve( uiNodes );
+}
+
+TransformStore::Node TransformStore::add( const Mat4& local, Node parent )
+{
+    VERIFY_RTE_MSG( parent == kNoParent || parent < size(), "Invalid transform parent: " << parent );
+
+    const Node          node     = size();
+    const std::uint32_t uiSlot   = node;
+    const std::uint32_t uiParent = parent == kNoParent ? kNoParent : m_nodeSlots[ parent ];
+    const std::uint32_t uiDepth  = parent == kNoParent ? 0U : m_depths[ uiParent ] + 1U;
+    const std::uint32_t uiDepths = static_cast< std::uint32_t >( m_depthStarts.size() ) - 1U;
+
+    m_local.push_back( local );
+    m_world.push_back( local );
+    m_parentSlots.push_back( uiParent );
+    m_dirty.push_back( 1U );
+    m_depths.push_back( uiDepth );
+    m_slotNodes.push_back( node );
+    m_nodeSlots.push_back( uiSlot );
+    m_bDirty = true;
+
+    // appending keeps the depth order while the new node is at the deepest depth or starts the next
+    if ( !m_bSorted )
+        return node;
+    if ( uiDepth == uiDepths )
+        m_depthStarts.push_back( uiSlot + 1U );
+    else if ( uiDepth + 1U == uiDepths )
+        ++m_depthStarts.back();
+    else
+        m_bSorted = false;
+    return node;
+}
+
+void TransformStore::setLocal( Node node, const Mat4& local )
+{
+    const std::uint32_t uiSlot = m_nodeSlots[ node ];
+    m_local[ uiSlot ]          = local;
+    m_dirty[ uiSlot ]          = 1U;
+    m_bDirty                   = true;
+}
+
+TransformStore::Node TransformStore::getParent( Node node ) const
+{
+    const std::uint32_t uiParent = m_parentSlots[ m_nodeSlots[ node ] ];
+    return uiParent == kNoParent ? kNoParent : m_slotNodes[ uiParent ];
+}
+
+std::uint32_t TransformStore::getDepthCount() const
+{
+    if ( m_bSorted )
+        return static_cast< std::uint32_t >( m_depthStarts.size() ) - 1U;
+    return m_depths.empty() ? 0U : *std::max_element( m_depths.begin(), m_depths.end() ) + 1U;
+}
+
+void TransformStore::markAllDirty()
+{
+    std::fill( m_dirty.begin(), m_dirty.end(), std::uint8_t{ 1U } );
+    m_bDirty = !m_dirty.empty();
+}
+
+void TransformStore::sortByDepth()
+{
+    // counting sort keeps creation order within a depth
+    const std::uint32_t          uiDepths = getDepthCount();
+    std::vector< std::uint32_t > depthStarts( uiDepths + 1U, 0U );
+    for ( std::uint32_t uiDepth : m_depths )
+        ++depthStarts[ uiDepth + 1U ];
+    for ( std::uint32_t i = 1U; i != depthStarts.size(); ++i )
+        depthStarts[ i ] += depthStarts[ i - 1U ];
+
+    std::vector< std::uint32_t > newSlots( size() );
+    {
+        std::vector< std::uint32_t > next( depthStarts.begin(), depthStarts.end() - 1 );
+        for ( std::uint32_t uiSlot = 0U; uiSlot != size(); ++uiSlot )
+            newSlots[ uiSlot ] = next[ m_depths[ uiSlot ] ]++;
+    }
+
+    MatrixVector                 local( size() ), world( size() );
+    std::vector< std::uint32_t > parentSlots( size() ), depths( size() );
+    std::vector< std::uint8_t >  dirty( size() );
+    std::vector< Node >          slotNodes( size() );
+    for ( std::uint32_t uiSlot = 0U; uiSlot != size(); ++uiSlot )
+    {
+        const std::uint32_t uiNewSlot = newSlots[ uiSlot ];
+        const std::uint32_t uiParent  = m_parentSlots[ uiSlot ];
+        local[ uiNewSlot ]            = m_local[ uiSlot ];
+        world[ uiNewSlot ]            = m_world[ uiSlot ];
+        parentSlots[ uiNewSlot ]      = uiParent == kNoParent ? kNoParent : newSlots[ uiParent ];
+        depths[ uiNewSlot ]           = m_depths[ uiSlot ];
+        dirty[ uiNewSlot ]            = m_dirty[ uiSlot ];
+        slotNodes[ uiNewSlot ]        = m_slotNodes[ uiSlot ];
+        m_nodeSlots[ m_slotNodes[ uiSlot ] ] = uiNewSlot;
+    }
+
+    m_local.swap( local );
+    m_world.swap( world );
+    m_parentSlots.swap( parentSlots );
+    m_depths.swap( depths );
+    m_dirty.swap( dirty );
+    m_slotNodes.swap( slotNodes );
+    m_depthStarts.swap( depthStarts );
+    m_bSorted = true;
+}
+
+std::uint32_t TransformStore::update( WorkerPool* pWorkers )
+{
+    if ( !m_bSorted )
+        sortByDepth();
+    if ( !m_bDirty )
+        return 0U;
+
+    const SlotArrays arrays{ m_local.front().m, m_world.front().m, m_parentSlots.data(), m_dirty.data() };
+
+    // roots take their local transform as is
+    std::uint32_t uiRecomputed = forRange( pWorkers,
+                                           m_depthStarts[ 0 ],
+                                           m_depthStarts[ 1 ],
+                                           [ &arrays ]( std::uint32_t uiBegin, std::uint32_t uiEnd )
+                                           {
+                                               std::uint32_t uiCopied = 0U;
+                                               for ( std::uint32_t uiSlot = uiBegin; uiSlot != uiEnd; ++uiSlot )
+                                               {
+                                                   if ( !arrays.pDirty[ uiSlot ] )
+                                                       continue;
+                                                   std::memcpy( arrays.pWorld + uiSlot * 16U,
+                                                                arrays.pLocal + uiSlot * 16U,
+                                                                sizeof( Mat4 ) );
+                                                   ++uiCopied;
+                                               }
+                                               return uiCopied;
+                                           } );
+
+    // each depth completes before the next starts as children read their parent's world and flag
+    const UpdateFunction pfnUpdate = getUpdateFunction( m_kernel );
+    for ( std::uint32_t uiDepth = 1U; uiDepth + 1U < m_depthStarts.size(); ++uiDepth )
+    {
+        uiRecomputed += forRange( pWorkers,
+                                  m_depthStarts[ uiDepth ],
+                                  m_depthStarts[ uiDepth + 1U ],
+                                  [ &arrays, pfnUpdate ]( std::uint32_t uiBegin, std::uint32_t uiEnd )
+                                  { return pfnUpdate( arrays, uiBegin, uiEnd ); } );
+    }
+
+    std::fill( m_dirty.begin(), m_dirty.end(), std::uint8_t{ 0U } );
+    m_bDirty = false;
+    return uiRecomputed;
+}
+
+} // namespace retail
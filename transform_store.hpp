@@ -0,0 +1,80 @@
+#ifndef TRANSFORM_STORE_19_OCTOBER_2022
+#define TRANSFORM_STORE_19_OCTOBER_2022
+
+#include "math.hpp"
+#include "simd.hpp"
+
+#include <boost/align/aligned_allocator.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace retail
+{
+
+class WorkerPool;
+
+// Transform hierarchy stored as structure of arrays.
+//
+// Local and world matrices, parent slots and dirty flags live in separate contiguous arrays
+// ordered by depth so every parent is updated before any of its children and each depth is a
+// contiguous range that is split into chunks across the worker pool.  Nodes are addressed through
+// stable handles mapped to their current slot - adding nodes re-sorts the arrays on the next update.
+//
+// Only nodes marked dirty by setLocal and their descendants are recomputed.
+class TransformStore
+{
+public:
+    using Node                                = std::uint32_t;
+    static constexpr Node          kNoParent  = ~0U;
+    static constexpr std::uint32_t kChunkSize = 2048U; // nodes per parallel chunk
+
+    TransformStore();
+
+    // parent must already exist - new nodes are dirty
+    Node add( const Mat4& local, Node parent = kNoParent );
+    void reserve( std::uint32_t uiNodes );
+
+    void        setLocal( Node node, const Mat4& local );
+    const Mat4& getLocal( Node node ) const { return m_local[ m_nodeSlots[ node ] ]; }
+    // valid after the update following the last change
+    const Mat4& getWorld( Node node ) const { return m_world[ m_nodeSlots[ node ] ]; }
+    Node        getParent( Node node ) const;
+
+    std::uint32_t size() const { return static_cast< std::uint32_t >( m_nodeSlots.size() ); }
+    std::uint32_t getDepthCount() const;
+
+    void markAllDirty();
+
+    // recompute world matrices for dirty subtrees across the pool or inline when null - returns
+    // the number of nodes recomputed
+    std::uint32_t update( WorkerPool* pWorkers = nullptr );
+
+    // best kernel the cpu supports is used by default
+    void       setKernel( SimdKernel kernel );
+    SimdKernel getKernel() const { return m_kernel; }
+
+private:
+    // a matrix per cache line so the kernels use aligned loads and chunks never share a line
+    using MatrixVector = std::vector< Mat4, boost::alignment::aligned_allocator< Mat4, 64 > >;
+
+    void sortByDepth();
+
+    // slot order
+    MatrixVector                 m_local;
+    MatrixVector                 m_world;
+    std::vector< std::uint32_t > m_parentSlots; // kNoParent for roots
+    std::vector< std::uint8_t >  m_dirty;
+    std::vector< std::uint32_t > m_depths;
+    std::vector< Node >          m_slotNodes; // slot to handle
+
+    std::vector< std::uint32_t > m_nodeSlots;   // handle to slot
+    std::vector< std::uint32_t > m_depthStarts; // first slot of each depth followed by the end
+    bool                         m_bSorted = true;
+    bool                         m_bDirty  = false; // any node marked since the last update
+    SimdKernel                   m_kernel;
+};
+
+} // namespace retail
+
+#endif // TRANSFORM_STORE_19_OCTOBER_2022
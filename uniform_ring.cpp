@@ -0,0 +1,67 @@
+#include "uniform_ring.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace retail
+{
+
+UniformRing::UniformRing( vk::PhysicalDevice physicalDevice,
+                          vk::Device         device,
+                          std::uint32_t      uiFramesInFlight,
+                          vk::DeviceSize     frameSize,
+                          vk::DeviceSize     maxBindingRange )
+    : m_uiFramesInFlight( uiFramesInFlight )
+{
+    VERIFY_RTE( uiFramesInFlight > 0U );
+    VERIFY_RTE( frameSize > 0U );
+
+    const vk::PhysicalDeviceLimits& limits = physicalDevice.getProperties().limits;
+    m_uniformAlignment                     = std::max< vk::DeviceSize >( limits.minUniformBufferOffsetAlignment, 16U );
+    m_storageAlignment                     = std::max< vk::DeviceSize >( limits.minStorageBufferOffsetAlignment, 16U );
+
+    // keep each frame region aligned for either descriptor type
+    const vk::DeviceSize alignment = std::max( m_uniformAlignment, m_storageAlignment );
+    m_frameSize                    = ( frameSize + alignment - 1U ) / alignment * alignment;
+
+    const vk::DeviceSize bufferSize = m_frameSize * uiFramesInFlight + maxBindingRange;
+    VERIFY_RTE_MSG( bufferSize <= std::numeric_limits< std::uint32_t >::max(),
+                    "Uniform ring too large for 32 bit dynamic offsets: " << bufferSize );
+
+    m_pBuffer = std::make_unique< Buffer >( physicalDevice,
+                                            device,
+                                            bufferSize,
+                                            vk::BufferUsageFlagBits::eUniformBuffer
+                                                | vk::BufferUsageFlagBits::eStorageBuffer,
+                                            vk::MemoryPropertyFlagBits::eHostVisible
+                                                | vk::MemoryPropertyFlagBits::eHostCoherent );
+
+    SPDLOG_INFO( "Created uniform ring of: {} bytes per frame uniform alignment: {} storage alignment: {}",
+                 m_frameSize,
+                 m_uniformAlignment,
+                 m_storageAlignment );
+}
+
+void UniformRing::begin( std::uint32_t uiFrameSlot )
+{
+    VERIFY_RTE( uiFrameSlot < m_uiFramesInFlight );
+    m_frameStart = m_frameSize * uiFrameSlot;
+    m_used       = m_frameStart;
+}
+
+UniformRing::Allocation UniformRing::allocate( vk::DeviceSize size, vk::DeviceSize alignment )
+{
+    const vk::DeviceSize offset = ( m_used + alignment - 1U ) / alignment * alignment;
+    VERIFY_RTE_MSG( offset + size <= m_frameStart + m_frameSize,
+                    "Uniform ring exhausted: " << offset + size - m_frameStart << " of " << m_frameSize
+                                               << " bytes" );
+    m_used          = offset + size;
+    m_highWaterMark = std::max( m_highWaterMark, m_used - m_frameStart );
+    return Allocation{ m_pBuffer->getMapped() + offset, static_cast< std::uint32_t >( offset ) };
+}
+
+} // namespace retail
@@ -0,0 +1,68 @@
+#ifndef UNIFORM_RING_16_OCTOBER_2022
+#define UNIFORM_RING_16_OCTOBER_2022
+
+#include "buffer.hpp"
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include <cstdint>
+#include <memory>
+
+namespace retail
+{
+
+// Per frame parameter memory bound through dynamic uniform and storage buffer descriptors.
+//
+// One persistently mapped buffer holds a region per frame in flight.  allocate() bumps a pointer
+// through the current region and returns the dynamic offset to pass to bindDescriptorSets so
+// per draw data never requires a descriptor update.  Descriptors are written once against the
+// buffer with a fixed range - the buffer is padded by that range so any offset stays in bounds.
+// The caller must ensure the GPU has finished with a frame slot before calling begin() for it again.
+class UniformRing
+{
+public:
+    struct Allocation
+    {
+        std::uint8_t* pData;
+        std::uint32_t uiOffset; // dynamic offset
+    };
+
+    UniformRing( vk::PhysicalDevice physicalDevice,
+                 vk::Device         device,
+                 std::uint32_t      uiFramesInFlight,
+                 vk::DeviceSize     frameSize,
+                 vk::DeviceSize     maxBindingRange );
+
+    UniformRing( const UniformRing& )            = delete;
+    UniformRing& operator=( const UniformRing& ) = delete;
+
+    void begin( std::uint32_t uiFrameSlot );
+
+    Allocation allocateUniform( vk::DeviceSize size ) { return allocate( size, m_uniformAlignment ); }
+    Allocation allocateStorage( vk::DeviceSize size ) { return allocate( size, m_storageAlignment ); }
+
+    // required when the memory is not host coherent
+    void flush() const { m_pBuffer->flush(); }
+
+    vk::Buffer     get() const { return m_pBuffer->get(); }
+    vk::DeviceSize getFrameSize() const { return m_frameSize; }
+    vk::DeviceSize getFrameUsed() const { return m_used - m_frameStart; }
+    vk::DeviceSize getHighWaterMark() const { return m_highWaterMark; }
+
+private:
+    Allocation allocate( vk::DeviceSize size, vk::DeviceSize alignment );
+
+    std::unique_ptr< Buffer > m_pBuffer;
+    std::uint32_t             m_uiFramesInFlight;
+    vk::DeviceSize            m_frameSize;
+    vk::DeviceSize            m_uniformAlignment;
+    vk::DeviceSize            m_storageAlignment;
+    vk::DeviceSize            m_frameStart    = 0U;
+    vk::DeviceSize            m_used          = 0U;
+    vk::DeviceSize            m_highWaterMark = 0U;
+};
+
+} // namespace retail
+
+#endif // UNIFORM_RING_16_OCTOBER_2022
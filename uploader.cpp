@@ -0,0 +1,249 @@
+
+#include "uploader.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+
+namespace retail
+{
+
+Uploader::Uploader( vk::PhysicalDevice physicalDevice,
+                    vk::Device         device,
+                    std::uint32_t      uiQueueFamilyIndex,
+                    Timeline&          timeline )
+    : m_physicalDevice( physicalDevice )
+    , m_device( device )
+    , m_timeline( timeline )
+{
+    const vk::CommandPoolCreateInfo commandPoolCreateInfo
+        = { vk::CommandPoolCreateFlagBits::eTransient | vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+            uiQueueFamilyIndex };
+    m_commandPool = m_device.createCommandPool( commandPoolCreateInfo );
+}
+
+Uploader::~Uploader()
+{
+    flush();
+    m_timeline.waitIdle();
+    collect();
+    if ( m_commandPool )
+    {
+        m_device.destroyCommandPool( m_commandPool );
+    }
+}
+
+std::uint8_t* Uploader::stage( const Buffer& dst, vk::DeviceSize dstOffset, vk::DeviceSize size )
+{
+    return stage( dst, dstOffset, size, 16U, 0U );
+}
+
+std::uint8_t* Uploader::stage( const Buffer&  dst,
+                               vk::DeviceSize dstOffset,
+                               vk::DeviceSize size,
+                               vk::DeviceSize alignment,
+                               vk::DeviceSize phase )
+{
+    VERIFY_RTE( dstOffset + size <= dst.getSize() );
+    VERIFY_RTE( size > 0U );
+    VERIFY_RTE( alignment >= 16U && ( alignment & ( alignment - 1U ) ) == 0U );
+    VERIFY_RTE( phase < alignment && phase % 16U == 0U );
+
+    vk::Buffer     stagingBuffer;
+    vk::DeviceSize srcOffset = 0U;
+    std::uint8_t*  pStaging  = allocateStaging( size, stagingBuffer, srcOffset, alignment, phase );
+    m_copies.push_back( Copy{ stagingBuffer, dst.get(), vk::BufferCopy{ srcOffset, dstOffset, size } } );
+    return pStaging;
+}
+
+std::uint8_t* Uploader::stage( const Texture& dst, std::uint32_t uiMipLevel, vk::DeviceSize size )
+{
+    VERIFY_RTE( uiMipLevel < dst.getMipLevels() );
+    VERIFY_RTE( size > 0U );
+
+    vk::Buffer     stagingBuffer;
+    vk::DeviceSize srcOffset = 0U;
+    std::uint8_t*  pStaging  = allocateStaging( size, stagingBuffer, srcOffset );
+
+    const vk::Extent2D        mipExtent = dst.getMipExtent( uiMipLevel );
+    const vk::BufferImageCopy region{ srcOffset,
+                                      0U, // bufferRowLength_ - tightly packed
+                                      0U, // bufferImageHeight_
+                                      vk::ImageSubresourceLayers{ vk::ImageAspectFlagBits::eColor, uiMipLevel, 0U, 1U },
+                                      vk::Offset3D{ 0, 0, 0 },
+                                      vk::Extent3D{ mipExtent.width, mipExtent.height, 1U } };
+    m_imageCopies.push_back( ImageCopy{ stagingBuffer, dst.get(), dst.getMipLevels(), region } );
+    return pStaging;
+}
+
+std::uint8_t* Uploader::allocateStaging( vk::DeviceSize  size,
+                                         vk::Buffer&     stagingBuffer,
+                                         vk::DeviceSize& srcOffset,
+                                         vk::DeviceSize  alignment,
+                                         vk::DeviceSize  phase )
+{
+    // padding from the mapped address rather than the block offset as the mapping is only
+    // guaranteed minMemoryMapAlignment
+    auto getPadding = [ alignment, phase ]( const Buffer& staging, vk::DeviceSize used )
+    {
+        const vk::DeviceSize address = reinterpret_cast< std::uintptr_t >( staging.getMapped() ) + used;
+        return ( phase - address ) & ( alignment - 1U );
+    };
+
+    // sub allocate from the current block or start a new one - oversized copies get their own block
+    if ( m_pending.staging.empty()
+         || m_pendingBlockUsed + getPadding( *m_pending.staging.back(), m_pendingBlockUsed ) + size
+                > m_pending.staging.back()->getSize() )
+    {
+        m_pending.staging.emplace_back( std::make_unique< Buffer >(
+            m_physicalDevice, m_device, std::max( size + alignment - 16U, kStagingBlockSize ),
+            vk::BufferUsageFlagBits::eTransferSrc,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent ) );
+        m_pendingBlockUsed = 0U;
+    }
+
+    const Buffer& staging = *m_pending.staging.back();
+    stagingBuffer         = staging.get();
+    srcOffset             = m_pendingBlockUsed + getPadding( staging, m_pendingBlockUsed );
+    // keep every copy 16 byte aligned so callers can stream with vector stores - this also
+    // satisfies the texel block alignment of compressed formats
+    m_pendingBlockUsed = ( srcOffset + size + 15U ) & ~vk::DeviceSize( 15U );
+
+    m_totalUploaded += size;
+    return staging.getMapped() + srcOffset;
+}
+
+void Uploader::recordImageCopies( vk::CommandBuffer commandBuffer )
+{
+    if ( m_imageCopies.empty() )
+        return;
+
+    // each texture appears once in the barriers however many mips were staged
+    std::vector< vk::Image > images;
+    for ( const ImageCopy& copy : m_imageCopies )
+    {
+        if ( std::find( images.begin(), images.end(), copy.dst ) == images.end() )
+            images.push_back( copy.dst );
+    }
+
+    auto makeBarriers = [ this, &images ]( vk::AccessFlags srcAccess,
+                                           vk::AccessFlags dstAccess,
+                                           vk::ImageLayout oldLayout,
+                                           vk::ImageLayout newLayout )
+    {
+        std::vector< vk::ImageMemoryBarrier > barriers;
+        for ( vk::Image image : images )
+        {
+            const auto iFind = std::find_if( m_imageCopies.begin(),
+                                             m_imageCopies.end(),
+                                             [ image ]( const ImageCopy& copy ) { return copy.dst == image; } );
+            barriers.push_back( vk::ImageMemoryBarrier{
+                srcAccess,
+                dstAccess,
+                oldLayout,
+                newLayout,
+                VK_QUEUE_FAMILY_IGNORED,
+                VK_QUEUE_FAMILY_IGNORED,
+                image,
+                vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, 0U, iFind->uiMipLevels, 0U, 1U } } );
+        }
+        return barriers;
+    };
+
+    commandBuffer.pipelineBarrier( vk::PipelineStageFlagBits::eTopOfPipe,
+                                   vk::PipelineStageFlagBits::eTransfer,
+                                   vk::DependencyFlags{},
+                                   nullptr,
+                                   nullptr,
+                                   makeBarriers( vk::AccessFlags{},
+                                                 vk::AccessFlagBits::eTransferWrite,
+                                                 vk::ImageLayout::eUndefined,
+                                                 vk::ImageLayout::eTransferDstOptimal ) );
+
+    for ( const ImageCopy& copy : m_imageCopies )
+    {
+        commandBuffer.copyBufferToImage( copy.src, copy.dst, vk::ImageLayout::eTransferDstOptimal, copy.region );
+    }
+
+    commandBuffer.pipelineBarrier( vk::PipelineStageFlagBits::eTransfer,
+                                   vk::PipelineStageFlagBits::eFragmentShader
+                                       | vk::PipelineStageFlagBits::eComputeShader,
+                                   vk::DependencyFlags{},
+                                   nullptr,
+                                   nullptr,
+                                   makeBarriers( vk::AccessFlagBits::eTransferWrite,
+                                                 vk::AccessFlagBits::eShaderRead,
+                                                 vk::ImageLayout::eTransferDstOptimal,
+                                                 vk::ImageLayout::eShaderReadOnlyOptimal ) );
+}
+
+std::uint64_t Uploader::flush()
+{
+    if ( m_copies.empty() && m_imageCopies.empty() )
+        return m_timeline.getSubmitted();
+
+    {
+        const vk::CommandBufferAllocateInfo commandBufferAllocateInfo
+            = { m_commandPool, vk::CommandBufferLevel::ePrimary, 1 };
+        m_pending.commandBuffer = m_device.allocateCommandBuffers( commandBufferAllocateInfo ).front();
+    }
+
+    vk::CommandBuffer commandBuffer = m_pending.commandBuffer;
+    commandBuffer.begin( vk::CommandBufferBeginInfo{ vk::CommandBufferUsageFlagBits::eOneTimeSubmit, nullptr } );
+    {
+        // merge consecutive copies between the same buffers into one command
+        std::vector< vk::BufferCopy > regions;
+        for ( std::size_t i = 0; i != m_copies.size(); ++i )
+        {
+            regions.push_back( m_copies[ i ].region );
+            const bool bLast = ( i + 1U == m_copies.size() ) || m_copies[ i + 1U ].src != m_copies[ i ].src
+                               || m_copies[ i + 1U ].dst != m_copies[ i ].dst;
+            if ( bLast )
+            {
+                commandBuffer.copyBuffer( m_copies[ i ].src, m_copies[ i ].dst, regions );
+                regions.clear();
+            }
+        }
+        recordImageCopies( commandBuffer );
+
+        // make the copies visible to any later use on the queue
+        const vk::MemoryBarrier barrier{ vk::AccessFlagBits::eTransferWrite,
+                                         vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead
+                                             | vk::AccessFlagBits::eUniformRead | vk::AccessFlagBits::eShaderRead };
+        commandBuffer.pipelineBarrier( vk::PipelineStageFlagBits::eTransfer,
+                                       vk::PipelineStageFlagBits::eVertexInput
+                                           | vk::PipelineStageFlagBits::eVertexShader
+                                           | vk::PipelineStageFlagBits::eFragmentShader
+                                           | vk::PipelineStageFlagBits::eComputeShader,
+                                       vk::DependencyFlags{},
+                                       barrier,
+                                       nullptr,
+                                       nullptr );
+    }
+    commandBuffer.end();
+
+    m_pending.uiTimelineValue = m_timeline.submit( commandBuffer, {}, {} );
+    const std::uint64_t uiValue = m_pending.uiTimelineValue;
+
+    m_inFlight.emplace_back( std::move( m_pending ) );
+    m_pending          = Batch{};
+    m_pendingBlockUsed = 0U;
+    m_copies.clear();
+    m_imageCopies.clear();
+
+    return uiValue;
+}
+
+void Uploader::collect()
+{
+    while ( !m_inFlight.empty() && m_timeline.isComplete( m_inFlight.front().uiTimelineValue ) )
+    {
+        Batch& batch = m_inFlight.front();
+        m_device.freeCommandBuffers( m_commandPool, batch.commandBuffer );
+        m_inFlight.pop_front();
+    }
+}
+
+} // namespace retail
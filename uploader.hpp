@@ -0,0 +1,103 @@
+#ifndef UPLOADER_10_OCTOBER_2022
+#define UPLOADER_10_OCTOBER_2022
+
+#include "buffer.hpp"
+#include "texture.hpp"
+#include "timeline.hpp"
+
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace retail
+{
+
+// Batches copies from host visible staging memory into device local buffers and textures.
+//
+// stage() returns a pointer into mapped staging memory that the caller fills directly - i.e.
+// straight from a memory mapped file - so there is no intermediate copy.  flush() records and
+// submits the batch on the timeline and the staging memory is recycled once the GPU passes it.
+//
+// Texture contents are discarded on upload so every mip of a texture must be staged before the
+// same flush().  The texture is left in eShaderReadOnlyOptimal.
+class Uploader
+{
+public:
+    Uploader( vk::PhysicalDevice physicalDevice,
+              vk::Device         device,
+              std::uint32_t      uiQueueFamilyIndex,
+              Timeline&          timeline );
+    ~Uploader();
+
+    Uploader( const Uploader& )            = delete;
+    Uploader& operator=( const Uploader& ) = delete;
+
+    std::uint8_t* stage( const Buffer& dst, vk::DeviceSize dstOffset, vk::DeviceSize size );
+    // the returned pointer sits phase bytes past a multiple of the power of two alignment - lets an
+    // O_DIRECT read land in staging memory by matching the alignment of its file offset
+    std::uint8_t* stage( const Buffer&  dst,
+                         vk::DeviceSize dstOffset,
+                         vk::DeviceSize size,
+                         vk::DeviceSize alignment,
+                         vk::DeviceSize phase );
+
+    // tightly packed texel data for one whole mip level - rows of 4x4 blocks for block compressed
+    // formats
+    std::uint8_t* stage( const Texture& dst, std::uint32_t uiMipLevel, vk::DeviceSize size );
+
+    // submit the pending copies - returns the timeline value after which the destinations are valid
+    std::uint64_t flush();
+
+    // release staging memory for batches the GPU has completed
+    void collect();
+
+    vk::DeviceSize getTotalUploaded() const { return m_totalUploaded; }
+
+private:
+    std::uint8_t* allocateStaging( vk::DeviceSize  size,
+                                   vk::Buffer&     stagingBuffer,
+                                   vk::DeviceSize& srcOffset,
+                                   vk::DeviceSize  alignment = 16U,
+                                   vk::DeviceSize  phase     = 0U );
+    void          recordImageCopies( vk::CommandBuffer commandBuffer );
+
+    struct Copy
+    {
+        vk::Buffer     src, dst;
+        vk::BufferCopy region;
+    };
+    struct ImageCopy
+    {
+        vk::Buffer          src;
+        vk::Image           dst;
+        std::uint32_t       uiMipLevels;
+        vk::BufferImageCopy region;
+    };
+    struct Batch
+    {
+        std::vector< std::unique_ptr< Buffer > > staging;
+        vk::CommandBuffer                        commandBuffer;
+        std::uint64_t                            uiTimelineValue = 0U;
+    };
+
+    static constexpr vk::DeviceSize kStagingBlockSize = 4U * 1024U * 1024U;
+
+    vk::PhysicalDevice m_physicalDevice;
+    vk::Device         m_device;
+    Timeline&          m_timeline;
+    vk::CommandPool    m_commandPool;
+
+    Batch                m_pending;
+    vk::DeviceSize       m_pendingBlockUsed = 0U;
+    std::vector< Copy >  m_copies;
+    std::vector< ImageCopy > m_imageCopies;
+    std::deque< Batch >  m_inFlight;
+    vk::DeviceSize       m_totalUploaded = 0U;
+};
+
+} // namespace retail
+
+#endif // UPLOADER_10_OCTOBER_2022
@@ -5,15 +5,37 @@
 
 #include "common/assert_verify.hpp"
 
+namespace
+{
+// resolve SDL_WINDOWPOS_CENTERED / SDL_WINDOWPOS_UNDEFINED against the configured display
+int windowPosition( int iPos, int iDisplay )
+{
+    if ( iPos == SDL_WINDOWPOS_CENTERED )
+        return SDL_WINDOWPOS_CENTERED_DISPLAY( iDisplay );
+    if ( iPos == SDL_WINDOWPOS_UNDEFINED )
+        return SDL_WINDOWPOS_UNDEFINED_DISPLAY( iDisplay );
+    return iPos;
+}
+} // namespace
+
 namespace retail
 {
 
 Window::Window( const Window::Config& config )
-    : m_pWnd(
-        SDL_CreateWindow( config.strName.c_str(), config.left, config.top, config.width, config.height, config.flags ),
-        std::bind( &SDL_DestroyWindow, std::placeholders::_1 ) )
+    : m_pWnd( SDL_CreateWindow( config.strName.c_str(),
+                                windowPosition( config.left, config.iDisplay ),
+                                windowPosition( config.top, config.iDisplay ),
+                                config.width,
+                                config.height,
+                                config.flags ),
+              std::bind( &SDL_DestroyWindow, std::placeholders::_1 ) )
 {
-    VERIFY_RTE( m_pWnd );
+    VERIFY_RTE_MSG( m_pWnd, "Failed to create window: " << config.strName << " Error: " << SDL_GetError() );
+}
+
+std::uint32_t Window::getID() const
+{
+    return SDL_GetWindowID( m_pWnd.get() );
 }
 
 std::set< std::string > Window::getRequiredSDLVulkanExtensions() const
@@ -52,6 +74,4 @@ vk::Extent2D Window::getDrawableSize() const
     return vk::Extent2D{ static_cast< uint32_t >( iWidth ), static_cast< uint32_t >( iHeight ) };
 }
 
-void Window::onResize() {}
-
 } // namespace retail
@@ -19,20 +19,22 @@ namespace retail
         struct Config
         {
             std::string  strName = "retail test";
+            int          iDisplay = 0;
             int          left = SDL_WINDOWPOS_CENTERED, top = SDL_WINDOWPOS_CENTERED, width = 512, height = 512;
             unsigned int flags = SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI | SDL_WINDOW_VULKAN;
         };
 
         Window( const Config& config );
 
+        // SDL window ID used to route events - see SDL_GetWindowID
+        std::uint32_t getID() const;
+
         std::set< std::string > getRequiredSDLVulkanExtensions() const;
 
         vk::SurfaceKHR createVulkanSurface( VkInstance instance ) const;
 
         vk::Extent2D getDrawableSize() const;
 
-        void onResize();
-
     private:
         std::unique_ptr< SDL_Window, decltype( std::bind( &SDL_DestroyWindow, std::placeholders::_1 ) ) > m_pWnd;
     };
@@ -0,0 +1,106 @@
+#include "worker_pool.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include <algorithm>
+
+namespace retail
+{
+
+WorkerPool::WorkerPool( std::uint32_t uiWorkers )
+{
+    m_workers.reserve( uiWorkers );
+    for ( std::uint32_t i = 0; i != uiWorkers; ++i )
+    {
+        m_workers.emplace_back( [ this ]() { workerThread(); } );
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+        m_bStop = true;
+    }
+    m_wake.notify_all();
+    for ( std::thread& worker : m_workers )
+    {
+        worker.join();
+    }
+}
+
+std::uint32_t WorkerPool::getDefaultWorkerCount()
+{
+    const std::uint32_t uiHardwareThreads = std::thread::hardware_concurrency();
+    return uiHardwareThreads > 1U ? uiHardwareThreads - 1U : 0U;
+}
+
+void WorkerPool::parallelFor( std::uint32_t uiCount, std::uint32_t uiChunkSize, const ChunkFunction& fnChunk )
+{
+    VERIFY_RTE( uiChunkSize != 0U );
+
+    // waking the workers costs more than a single chunk
+    if ( m_workers.empty() || uiCount <= uiChunkSize )
+    {
+        if ( uiCount != 0U )
+            fnChunk( 0U, uiCount );
+        return;
+    }
+
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+        m_pfnChunk    = &fnChunk;
+        m_uiCount     = uiCount;
+        m_uiChunkSize = uiChunkSize;
+        m_uiNextChunk.store( 0U, std::memory_order_relaxed );
+        m_uiBusy = static_cast< std::uint32_t >( m_workers.size() );
+        ++m_uiGeneration;
+    }
+    m_wake.notify_all();
+
+    runChunks();
+
+    std::unique_lock< std::mutex > lock( m_mutex );
+    m_done.wait( lock, [ this ]() { return m_uiBusy == 0U; } );
+    m_pfnChunk = nullptr;
+}
+
+void WorkerPool::runChunks()
+{
+    const std::uint32_t uiChunks = ( m_uiCount + m_uiChunkSize - 1U ) / m_uiChunkSize;
+    while ( true )
+    {
+        const std::uint32_t uiChunk = m_uiNextChunk.fetch_add( 1U, std::memory_order_relaxed );
+        if ( uiChunk >= uiChunks )
+            return;
+        const std::uint32_t uiBegin = uiChunk * m_uiChunkSize;
+        ( *m_pfnChunk )( uiBegin, std::min( uiBegin + m_uiChunkSize, m_uiCount ) );
+    }
+}
+
+void WorkerPool::workerThread()
+{
+    std::uint64_t uiGeneration = 0U;
+    while ( true )
+    {
+        {
+            std::unique_lock< std::mutex > lock( m_mutex );
+            m_wake.wait( lock, [ & ]() { return m_bStop || m_uiGeneration != uiGeneration; } );
+            if ( m_bStop )
+                return;
+            uiGeneration = m_uiGeneration;
+        }
+
+        runChunks();
+
+        bool bLast = false;
+        {
+            std::lock_guard< std::mutex > lock( m_mutex );
+            bLast = --m_uiBusy == 0U;
+        }
+        if ( bLast )
+            m_done.notify_one();
+    }
+}
+
+} // namespace retail
@@ -0,0 +1,60 @@
+#ifndef WORKER_POOL_19_OCTOBER_2022
+#define WORKER_POOL_19_OCTOBER_2022
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace retail
+{
+
+// Fixed set of threads for data parallel loops.  The calling thread takes chunks alongside the
+// workers and parallelFor returns once every chunk has completed so each call is a barrier.
+class WorkerPool
+{
+public:
+    // calls fnChunk( uiBegin, uiEnd ) - must not throw
+    using ChunkFunction = std::function< void( std::uint32_t, std::uint32_t ) >;
+
+    // uiWorkers threads in addition to the caller - zero runs every loop inline
+    explicit WorkerPool( std::uint32_t uiWorkers );
+    ~WorkerPool();
+
+    WorkerPool( const WorkerPool& )            = delete;
+    WorkerPool& operator=( const WorkerPool& ) = delete;
+
+    // threads taking part in a loop including the caller
+    std::uint32_t getThreadCount() const { return static_cast< std::uint32_t >( m_workers.size() ) + 1U; }
+
+    void parallelFor( std::uint32_t uiCount, std::uint32_t uiChunkSize, const ChunkFunction& fnChunk );
+
+    // workers for the hardware threads besides the caller
+    static std::uint32_t getDefaultWorkerCount();
+
+private:
+    void workerThread();
+    void runChunks();
+
+    std::vector< std::thread > m_workers;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    std::uint64_t           m_uiGeneration = 0U; // incremented per loop to wake the workers
+    std::uint32_t           m_uiBusy       = 0U; // workers yet to finish the current loop
+    bool                    m_bStop        = false;
+
+    // the current loop - written under m_mutex before the workers are woken
+    const ChunkFunction*         m_pfnChunk    = nullptr;
+    std::uint32_t                m_uiCount     = 0U;
+    std::uint32_t                m_uiChunkSize = 1U;
+    std::atomic< std::uint32_t > m_uiNextChunk{ 0U };
+};
+
+} // namespace retail
+
+#endif // WORKER_POOL_19_OCTOBER_2022